@@ -1,4 +1,7 @@
-unsigned char g_model[] = {
+#include "accel_model.h"
+
+// Const so the model stays in flash, aligned for the flatbuffer's tensor data.
+alignas(16) const unsigned char g_model[] = {
   0x1c, 0x00, 0x00, 0x00, 0x54, 0x46, 0x4c, 0x33, 0x14, 0x00, 0x20, 0x00,
   0x04, 0x00, 0x08, 0x00, 0x0c, 0x00, 0x10, 0x00, 0x14, 0x00, 0x00, 0x00,
   0x18, 0x00, 0x1c, 0x00, 0x14, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
@@ -242,4 +245,4 @@ unsigned char g_model[] = {
   0x02, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00,
   0xfc, 0xff, 0xff, 0xff, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00
 };
-unsigned int g_model_len = 2904;
+const int g_model_len = 2904;
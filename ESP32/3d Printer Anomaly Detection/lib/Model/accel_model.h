@@ -1,2 +1,9 @@
+#ifndef ACCEL_MODEL_H_
+#define ACCEL_MODEL_H_
+
+// Model embedded in the firmware, used when no model partition holds a valid
+// container.
 extern const unsigned char g_model[];
-extern const int g_model_len;
\ No newline at end of file
+extern const int g_model_len;
+
+#endif  // ACCEL_MODEL_H_
@@ -4,8 +4,11 @@
 #include <TensorFlowLite_ESP32.h>
 #include "accel_model.h"
 #include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_error_reporter.h"
 #include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_model_loader.h"
+#include "tensorflow/lite/micro/micro_time.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
 // Globals, used for compatibility with Arduino-style sketches.
@@ -13,21 +16,44 @@ namespace {
 tflite::ErrorReporter* error_reporter = nullptr;
 const tflite::Model* model = nullptr;
 tflite::MicroInterpreter* interpreter = nullptr;
-TfLiteTensor* input = nullptr;
 TfLiteTensor* output = nullptr;
 
+// Flash partitions (see partitions.csv) holding retrained models. The newest
+// valid one is mapped in place, otherwise the model built into the firmware is
+// used.
+const char* const kModelPartitions[] = {"model0", "model1"};
+constexpr int kModelPartitionCount =
+    sizeof(kModelPartitions) / sizeof(kModelPartitions[0]);
+
 // Accelerometer object
 Adafruit_ADXL343 accel = Adafruit_ADXL343(3);
 
 
-constexpr int kTensorArenaSize = 2800;
+// Leaves room for decoding a compressed model from a model partition into
+// the arena, next to the tensors it needs.
+constexpr int kTensorArenaSize = 6144;
 uint8_t tensor_arena[kTensorArenaSize];
+// Part of the arena kernels may fill with repacked weights. The built-in model
+// uses 176 bytes of it, layers of larger models that don't fit keep reading
+// their weights from the model.
+constexpr size_t kPackedWeightBudget = 512;
+
+// Model input, bound to the interpreter so averaged samples are written
+// straight into the tensor without a copy through the arena
+alignas(16) float modelInput[3];
 
 // various globals for accelerometer data
 float accelData[3], accelSum[3], initSum, finalSum, diff;
 
 int count = 0;
 
+// set while a window is being scored across several loop() calls
+bool inferencePending = false;
+
+// time budget for each inference slice (2 ms of the 1 MHz ESP32 timer), leaving
+// room in the 5 ms sample period for reading the accelerometer
+constexpr int32_t kInferenceBudgetTicks = 2000;
+
 // time
 float t1, t2;
 
@@ -42,9 +68,25 @@ void setup() {
   static tflite::MicroErrorReporter micro_error_reporter;
   error_reporter = &micro_error_reporter;
 
-  // Map the model into a usable data structure. This doesn't involve any
-  // copying or parsing, it's a very lightweight operation.
-  model = tflite::GetModel(g_model);
+  // The allocator is created first so a compressed model can be decoded into
+  // the same arena the interpreter uses.
+  const int32_t load_start = tflite::GetCurrentTimeTicks();
+  tflite::MicroAllocator* allocator = tflite::MicroAllocator::Create(
+      tensor_arena, kTensorArenaSize, error_reporter);
+
+  // Map the model into a usable data structure. An uncompressed model isn't
+  // copied or parsed, it's a very lightweight operation.
+  static tflite::MappedModel mapped_model(error_reporter);
+  if (mapped_model.MapNewest(kModelPartitions, kModelPartitionCount) ==
+          kTfLiteOk &&
+      (model = mapped_model.Decode(allocator)) != nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Using model version %d from '%s'",
+                         mapped_model.header()->model_version,
+                         mapped_model.source());
+  } else {
+    model = tflite::GetModel(g_model);
+    TF_LITE_REPORT_ERROR(error_reporter, "Using built-in model");
+  }
   if (model->version() != TFLITE_SCHEMA_VERSION) {
     TF_LITE_REPORT_ERROR(error_reporter,
                          "Model provided is schema version %d not equal "
@@ -57,10 +99,18 @@ void setup() {
   static tflite::AllOpsResolver resolver;
 
   // Build an interpreter to run the model with.
-  static tflite::MicroInterpreter static_interpreter(
-      model, resolver, tensor_arena, kTensorArenaSize, error_reporter);
+  static tflite::MicroInterpreter static_interpreter(model, resolver, allocator,
+                                                     error_reporter);
   interpreter = &static_interpreter;
 
+  // Bind the input before allocating so it takes no space in the arena
+  if (interpreter->BindInput(0, modelInput) != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter, "BindInput() failed");
+    return;
+  }
+
+  interpreter->SetWeightPacking(kPackedWeightBudget);
+
   // Allocate memory from the tensor_arena for the model's tensors.
   TfLiteStatus allocate_status = interpreter->AllocateTensors();
   if (allocate_status != kTfLiteOk) {
@@ -68,10 +118,15 @@ void setup() {
     return;
   }
 
-  // Obtain pointers to the model's input and output tensors.
-  input = interpreter->input(0);
+  // Obtain a pointer to the model's output tensor.
   output = interpreter->output(0);
 
+  if (logLevel > 0) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Model ready in %d us, arena %d bytes",
+                         tflite::GetCurrentTimeTicks() - load_start,
+                         interpreter->arena_used_bytes());
+  }
+
   // Initializing the accelerometer
   if(!accel.begin())
   {
@@ -123,50 +178,68 @@ void loop() {
 
     // Once we have 5 data points
     if (count == 5) {
-      // Writing to input tensor
-      for (int i = 0; i < 3; i++) {
-          input->data.f[i] = accelSum[i]/5;
-          initSum += accelSum[i] / 5;
-          if (logLevel > 1) {
-            TF_LITE_REPORT_ERROR(error_reporter, "Initial Sum: %f \n", initSum);
-          }    
+      if (inferencePending) {
+        // The previous window is still being scored, drop this one
+        if (logLevel > 0) {
+          TF_LITE_REPORT_ERROR(error_reporter, "Dropped window, inference still running");
+        }
+      } else {
+        // Writing to input tensor
+        for (int i = 0; i < 3; i++) {
+            modelInput[i] = accelSum[i]/5;
+            initSum += accelSum[i] / 5;
+            if (logLevel > 1) {
+              TF_LITE_REPORT_ERROR(error_reporter, "Initial Sum: %f \n", initSum);
+            }    
+        }
+        inferencePending = true;
       }
 
-      // Run inference, and report any error
-      TfLiteStatus invoke_status = interpreter->Invoke();
-      if (invoke_status != kTfLiteOk) {
-        TF_LITE_REPORT_ERROR(error_reporter, "Invoke failed on data: %f, %f, %f \n", accelSum[0], accelSum[1], accelSum[2]);
-        return;
-      }
-      
+      // resetting variables for next window
+      count = 0;
       for (int i = 0; i < 3; i++) {
-        finalSum += output->data.f[i];
+        accelSum[i] = 0;
       }
+    }
 
-      // calculating percent difference
-      diff = abs(initSum - finalSum) / abs(initSum);
-
-      if (diff > .1) {
-        pinMode(LED_BUILTIN, HIGH);
-        TF_LITE_REPORT_ERROR(error_reporter, "Diff: %f ", diff);
-        TF_LITE_REPORT_ERROR(error_reporter, "Input data: %f, %f, %f \n", accelSum[0], accelSum[1], accelSum[2]);
-        TF_LITE_REPORT_ERROR(error_reporter, "Output data: %f, %f, %f \n", output->data.f[0], output->data.f[1], output->data.f[2]);
-        
-        delay(3000);
-        pinMode(LED_BUILTIN, LOW);
-      }
+  }
 
+  // Run inference in slices between samples so a model that takes longer than
+  // the sample period never delays the next reading
+  if (inferencePending) {
+    TfLiteStatus invoke_status = interpreter->InvokeStep(kInferenceBudgetTicks);
+    if (invoke_status == tflite::kTfLiteInvokeContinue) {
+      return;
+    }
+    inferencePending = false;
 
-      // resetting variables for next iteration
+    // Report any error
+    if (invoke_status != kTfLiteOk) {
+      TF_LITE_REPORT_ERROR(error_reporter, "Invoke failed on data: %f, %f, %f \n", modelInput[0], modelInput[1], modelInput[2]);
       initSum = 0;
-      finalSum = 0;
-      count = 0;
-      for (int i = 0; i < 3; i++) {
-        accelSum[i] = 0;
-      }
+      return;
+    }
+      
+    for (int i = 0; i < 3; i++) {
+      finalSum += output->data.f[i];
+    }
+
+    // calculating percent difference
+    diff = abs(initSum - finalSum) / abs(initSum);
 
+    if (diff > .1) {
+      pinMode(LED_BUILTIN, HIGH);
+      TF_LITE_REPORT_ERROR(error_reporter, "Diff: %f ", diff);
+      TF_LITE_REPORT_ERROR(error_reporter, "Input data: %f, %f, %f \n", modelInput[0], modelInput[1], modelInput[2]);
+      TF_LITE_REPORT_ERROR(error_reporter, "Output data: %f, %f, %f \n", output->data.f[0], output->data.f[1], output->data.f[2]);
+      
+      delay(3000);
+      pinMode(LED_BUILTIN, LOW);
     }
 
+    // resetting variables for next iteration
+    initSum = 0;
+    finalSum = 0;
   }
 
 }
@@ -73,6 +73,10 @@ typedef enum {
   kTfLiteFloat64 = 11,
   kTfLiteComplex128 = 12,
   kTfLiteUInt64 = 13,
+  // Signed 4-bit integers, packed two per byte with the first one in the low
+  // nibble. 18 as in TensorFlow Lite, where 14 to 17 are types micro does not
+  // support.
+  kTfLiteInt4 = 18,
 } TfLiteType;
 
 // Legacy. Will be deprecated in favor of TfLiteAffineQuantization.
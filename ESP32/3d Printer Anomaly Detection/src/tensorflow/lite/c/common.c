@@ -219,6 +219,8 @@ const char* TfLiteTypeGetName(TfLiteType type) {
       return "FLOAT16";
     case kTfLiteFloat64:
       return "FLOAT64";
+    case kTfLiteInt4:
+      return "INT4";
   }
   return "Unknown type";
 }
@@ -875,6 +875,9 @@ TfLiteStatus ConvertTensorType(TensorType tensor_type, TfLiteType* type,
     case TensorType_COMPLEX128:
       *type = kTfLiteComplex128;
       return kTfLiteOk;
+    case TensorType_INT4:
+      *type = kTfLiteInt4;
+      return kTfLiteOk;
     default:
       *type = kTfLiteNoType;
       TF_LITE_REPORT_ERROR(error_reporter,
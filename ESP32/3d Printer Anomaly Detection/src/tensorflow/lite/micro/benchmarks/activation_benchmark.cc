@@ -0,0 +1,150 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Times the int8 and uint8 TANH and the int8 LOGISTIC kernels, which look
+// their outputs up in a table, against the fixed-point reference kernels that
+// fill the table, on a 1x32x32x64 tensor.
+
+#include <cmath>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/cppmath.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/logistic.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/tanh.h"
+#include "tensorflow/lite/kernels/internal/reference/tanh.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+
+namespace {
+
+constexpr int kElements = 32 * 32 * 64;
+constexpr float kInputScale = 0.05f;
+constexpr float kTanhOutputScale = 1.0f / 128;
+constexpr float kLogisticOutputScale = 1.0f / 256;
+
+int8_t int8_input[kElements];
+int8_t int8_output[kElements];
+uint8_t uint8_input[kElements];
+uint8_t uint8_output[kElements];
+
+enum class Activation { kTanh, kLogistic };
+
+void FillInput() {
+  for (int i = 0; i < kElements; ++i) {
+    int8_input[i] = static_cast<int8_t>(i * 37 + 11);
+    uint8_input[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+}
+
+// The zero point of the activation inputs, and of the TANH outputs, of
+// `type`.
+int GetZeroPoint(TfLiteType type) { return type == kTfLiteUInt8 ? 128 : 0; }
+
+// Runs the TANH or LOGISTIC kernel `iterations` times on `type` tensors.
+void InvokeKernel(Activation activation, TfLiteType type, int iterations) {
+  int dims_data[] = {1, kElements};
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(dims_data);
+  const bool tanh = activation == Activation::kTanh;
+  const float output_scale = tanh ? kTanhOutputScale : kLogisticOutputScale;
+  const int output_zero_point = tanh ? GetZeroPoint(type) : -128;
+  TfLiteTensor tensors[2];
+  if (type == kTfLiteUInt8) {
+    tensors[0] = tflite::testing::CreateQuantizedTensor(
+        uint8_input, dims, kInputScale, GetZeroPoint(type));
+    tensors[1] = tflite::testing::CreateQuantizedTensor(
+        uint8_output, dims, output_scale, output_zero_point);
+  } else {
+    tensors[0] = tflite::testing::CreateQuantizedTensor(
+        int8_input, dims, kInputScale, GetZeroPoint(type));
+    tensors[1] = tflite::testing::CreateQuantizedTensor(
+        int8_output, dims, output_scale, output_zero_point);
+  }
+  int inputs_data[] = {1, 0};
+  int outputs_data[] = {1, 1};
+  tflite::micro::KernelRunner runner(
+      tanh ? tflite::ops::micro::Register_TANH()
+           : tflite::ops::micro::Register_LOGISTIC(),
+      tensors, 2, tflite::testing::IntArrayFromInts(inputs_data),
+      tflite::testing::IntArrayFromInts(outputs_data), nullptr,
+      micro_benchmark::reporter);
+  if (runner.InitAndPrepare() != kTfLiteOk) {
+    return;
+  }
+  for (int i = 0; i < iterations; ++i) {
+    runner.Invoke();
+  }
+}
+
+// Runs the fixed-point reference kernel of TANH or LOGISTIC `iterations`
+// times on `type` data, with the parameters the Prepare() of its kernel
+// computes.
+void InvokeFixedPointKernel(Activation activation, TfLiteType type,
+                            int iterations) {
+  static constexpr int kInputIntegerBits = 4;
+  const double input_real_multiplier =
+      static_cast<double>(kInputScale) *
+      static_cast<double>(1 << (31 - kInputIntegerBits));
+  int input_left_shift;
+  const double q = std::frexp(input_real_multiplier, &input_left_shift);
+  const int32_t input_multiplier =
+      static_cast<int32_t>(tflite::TfLiteRound(q * (1ll << 31)));
+  const int32_t input_range_radius =
+      tflite::CalculateInputRadius(kInputIntegerBits, input_left_shift, 31);
+  tflite::TanhParams params;
+  params.input_zero_point = GetZeroPoint(type);
+  params.input_range_radius = input_range_radius;
+  params.input_multiplier = input_multiplier;
+  params.input_left_shift = input_left_shift;
+  const tflite::RuntimeShape shape({kElements});
+  for (int i = 0; i < iterations; ++i) {
+    if (type == kTfLiteUInt8) {
+      tflite::reference_ops::Tanh(params, shape, uint8_input, shape,
+                                  uint8_output);
+    } else if (activation == Activation::kTanh) {
+      tflite::reference_integer_ops::Tanh(
+          params.input_zero_point, input_range_radius, input_multiplier,
+          input_left_shift, shape, int8_input, shape, int8_output);
+    } else {
+      tflite::reference_integer_ops::Logistic(
+          params.input_zero_point, input_range_radius, input_multiplier,
+          input_left_shift, kElements, int8_input, int8_output);
+    }
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_BENCHMARKS_BEGIN
+
+FillInput();
+
+TF_LITE_MICRO_BENCHMARK(InvokeKernel(Activation::kTanh, kTfLiteInt8, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeFixedPointKernel(Activation::kTanh, kTfLiteInt8, 100))
+TF_LITE_MICRO_BENCHMARK(InvokeKernel(Activation::kTanh, kTfLiteUInt8, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeFixedPointKernel(Activation::kTanh, kTfLiteUInt8, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeKernel(Activation::kLogistic, kTfLiteInt8, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeFixedPointKernel(Activation::kLogistic, kTfLiteInt8, 100))
+
+TF_LITE_MICRO_BENCHMARKS_END
@@ -0,0 +1,228 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Times the broadcasting ADD and MUL kernels, which take the
+// BroadcastFivefold() fast paths, against the Slow reference kernels they
+// replace. Covers float and int8 on a 1x32x32x64 tensor combined with a
+// scalar, a per-channel row and a per-pixel outer row.
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/add.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/add.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/mul.h"
+#include "tensorflow/lite/kernels/internal/reference/mul.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+
+namespace {
+
+constexpr int kMaxElements = 32 * 32 * 64;
+constexpr float kInput1Scale = 0.02f;
+constexpr int kInput1ZeroPoint = 3;
+constexpr float kInput2Scale = 0.035f;
+constexpr int kInput2ZeroPoint = -7;
+constexpr float kAddOutputScale = 0.04f;
+constexpr float kMulOutputScale = 0.01f;
+constexpr int kOutputZeroPoint = 2;
+
+float float_input1[kMaxElements];
+float float_input2[kMaxElements];
+float float_output[kMaxElements];
+int8_t int8_input1[kMaxElements];
+int8_t int8_input2[kMaxElements];
+int8_t int8_output[kMaxElements];
+
+enum class BinaryOp { kAdd, kMul };
+
+// Dims in the IntArrayFromInts() layout.
+struct BroadcastShapes {
+  int input1_dims[5];
+  int input2_dims[5];
+  int output_dims[5];
+};
+
+constexpr BroadcastShapes kScalar = {
+    {4, 1, 32, 32, 64}, {1, 1}, {4, 1, 32, 32, 64}};
+constexpr BroadcastShapes kRow = {
+    {4, 1, 32, 32, 64}, {1, 64}, {4, 1, 32, 32, 64}};
+constexpr BroadcastShapes kOuterRow = {
+    {4, 1, 32, 32, 64}, {4, 1, 32, 32, 1}, {4, 1, 32, 32, 64}};
+
+void FillInputs() {
+  for (int i = 0; i < kMaxElements; ++i) {
+    float_input1[i] = 0.37f * ((i * 7 + 3) % 11) - 1.5f;
+    float_input2[i] = 0.29f * ((i * 5 + 1) % 13) - 1.7f;
+    int8_input1[i] = static_cast<int8_t>(i * 37 + 11);
+    int8_input2[i] = static_cast<int8_t>(i * 53 + 5);
+  }
+}
+
+tflite::RuntimeShape GetShape(const int* dims) {
+  return tflite::RuntimeShape(dims[0], &dims[1]);
+}
+
+// Runs the ADD or MUL kernel `iterations` times on `type` tensors.
+void InvokeKernel(BinaryOp op, TfLiteType type, const BroadcastShapes& shapes,
+                  int iterations) {
+  TfLiteIntArray* input1_dims =
+      tflite::testing::IntArrayFromInts(shapes.input1_dims);
+  TfLiteIntArray* input2_dims =
+      tflite::testing::IntArrayFromInts(shapes.input2_dims);
+  TfLiteIntArray* output_dims =
+      tflite::testing::IntArrayFromInts(shapes.output_dims);
+  const float output_scale =
+      op == BinaryOp::kMul ? kMulOutputScale : kAddOutputScale;
+  TfLiteTensor tensors[3];
+  if (type == kTfLiteFloat32) {
+    tensors[0] = tflite::testing::CreateTensor(float_input1, input1_dims);
+    tensors[1] = tflite::testing::CreateTensor(float_input2, input2_dims);
+    tensors[2] = tflite::testing::CreateTensor(float_output, output_dims);
+  } else {
+    tensors[0] = tflite::testing::CreateQuantizedTensor(
+        int8_input1, input1_dims, kInput1Scale, kInput1ZeroPoint);
+    tensors[1] = tflite::testing::CreateQuantizedTensor(
+        int8_input2, input2_dims, kInput2Scale, kInput2ZeroPoint);
+    tensors[2] = tflite::testing::CreateQuantizedTensor(
+        int8_output, output_dims, output_scale, kOutputZeroPoint);
+  }
+  int inputs_data[] = {2, 0, 1};
+  int outputs_data[] = {1, 2};
+  TfLiteAddParams add_params = {};
+  TfLiteMulParams mul_params = {};
+  tflite::micro::KernelRunner runner(
+      op == BinaryOp::kAdd ? tflite::ops::micro::Register_ADD()
+                           : tflite::ops::micro::Register_MUL(),
+      tensors, 3, tflite::testing::IntArrayFromInts(inputs_data),
+      tflite::testing::IntArrayFromInts(outputs_data),
+      op == BinaryOp::kAdd ? static_cast<void*>(&add_params)
+                           : static_cast<void*>(&mul_params),
+      micro_benchmark::reporter);
+  if (runner.InitAndPrepare() != kTfLiteOk) {
+    return;
+  }
+  for (int i = 0; i < iterations; ++i) {
+    runner.Invoke();
+  }
+}
+
+// The int8 parameters of `op`, as the Prepare() of its kernel computes them.
+tflite::ArithmeticParams GetInt8Params(BinaryOp op) {
+  tflite::ArithmeticParams params = {};
+  params.input1_offset = -kInput1ZeroPoint;
+  params.input2_offset = -kInput2ZeroPoint;
+  params.output_offset = kOutputZeroPoint;
+  params.quantized_activation_min = std::numeric_limits<int8_t>::min();
+  params.quantized_activation_max = std::numeric_limits<int8_t>::max();
+  if (op == BinaryOp::kMul) {
+    tflite::QuantizeMultiplier(static_cast<double>(kInput1Scale) *
+                                   static_cast<double>(kInput2Scale) /
+                                   static_cast<double>(kMulOutputScale),
+                               &params.output_multiplier,
+                               &params.output_shift);
+    return params;
+  }
+  params.left_shift = 20;
+  const double twice_max_input_scale =
+      2 * static_cast<double>(std::max(kInput1Scale, kInput2Scale));
+  tflite::QuantizeMultiplierSmallerThanOneExp(
+      static_cast<double>(kInput1Scale) / twice_max_input_scale,
+      &params.input1_multiplier, &params.input1_shift);
+  tflite::QuantizeMultiplierSmallerThanOneExp(
+      static_cast<double>(kInput2Scale) / twice_max_input_scale,
+      &params.input2_multiplier, &params.input2_shift);
+  tflite::QuantizeMultiplierSmallerThanOneExp(
+      twice_max_input_scale /
+          ((1 << params.left_shift) * static_cast<double>(kAddOutputScale)),
+      &params.output_multiplier, &params.output_shift);
+  return params;
+}
+
+// Runs the Slow reference kernel of ADD or MUL `iterations` times.
+void InvokeSlowKernel(BinaryOp op, TfLiteType type,
+                      const BroadcastShapes& shapes, int iterations) {
+  const tflite::RuntimeShape input1_shape = GetShape(shapes.input1_dims);
+  const tflite::RuntimeShape input2_shape = GetShape(shapes.input2_dims);
+  const tflite::RuntimeShape output_shape = GetShape(shapes.output_dims);
+  tflite::ArithmeticParams params = GetInt8Params(op);
+  params.float_activation_min = std::numeric_limits<float>::lowest();
+  params.float_activation_max = std::numeric_limits<float>::max();
+  for (int i = 0; i < iterations; ++i) {
+    if (type == kTfLiteFloat32 && op == BinaryOp::kAdd) {
+      tflite::reference_ops::BroadcastAdd4DSlow(
+          params, input1_shape, float_input1, input2_shape, float_input2,
+          output_shape, float_output);
+    } else if (type == kTfLiteFloat32) {
+      tflite::reference_ops::BroadcastMul4DSlow(
+          params, input1_shape, float_input1, input2_shape, float_input2,
+          output_shape, float_output);
+    } else if (op == BinaryOp::kAdd) {
+      tflite::reference_integer_ops::BroadcastAdd4DSlow(
+          params, input1_shape, int8_input1, input2_shape, int8_input2,
+          output_shape, int8_output);
+    } else {
+      tflite::reference_integer_ops::BroadcastMul4DSlow(
+          params, input1_shape, int8_input1, input2_shape, int8_input2,
+          output_shape, int8_output);
+    }
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_BENCHMARKS_BEGIN
+
+FillInputs();
+
+TF_LITE_MICRO_BENCHMARK(
+    InvokeKernel(BinaryOp::kAdd, kTfLiteFloat32, kScalar, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeSlowKernel(BinaryOp::kAdd, kTfLiteFloat32, kScalar, 100))
+TF_LITE_MICRO_BENCHMARK(InvokeKernel(BinaryOp::kAdd, kTfLiteFloat32, kRow, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeSlowKernel(BinaryOp::kAdd, kTfLiteFloat32, kRow, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeKernel(BinaryOp::kAdd, kTfLiteFloat32, kOuterRow, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeSlowKernel(BinaryOp::kAdd, kTfLiteFloat32, kOuterRow, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeKernel(BinaryOp::kMul, kTfLiteFloat32, kOuterRow, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeSlowKernel(BinaryOp::kMul, kTfLiteFloat32, kOuterRow, 100))
+
+TF_LITE_MICRO_BENCHMARK(InvokeKernel(BinaryOp::kAdd, kTfLiteInt8, kScalar, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeSlowKernel(BinaryOp::kAdd, kTfLiteInt8, kScalar, 100))
+TF_LITE_MICRO_BENCHMARK(InvokeKernel(BinaryOp::kAdd, kTfLiteInt8, kRow, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeSlowKernel(BinaryOp::kAdd, kTfLiteInt8, kRow, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeKernel(BinaryOp::kAdd, kTfLiteInt8, kOuterRow, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeSlowKernel(BinaryOp::kAdd, kTfLiteInt8, kOuterRow, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeKernel(BinaryOp::kMul, kTfLiteInt8, kOuterRow, 100))
+TF_LITE_MICRO_BENCHMARK(
+    InvokeSlowKernel(BinaryOp::kMul, kTfLiteInt8, kOuterRow, 100))
+
+TF_LITE_MICRO_BENCHMARKS_END
@@ -0,0 +1,149 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Times the bulk conversions of conversion_util.h and QuantizeSamples()
+// against the reference AffineQuantize(), Dequantize() and Requantize() they
+// replace, on 4096 elements: float to int8, int8 to float, raw int16
+// accelerometer counts to int8 and int8 to int8.
+
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/dequantize.h"
+#include "tensorflow/lite/kernels/internal/reference/quantize.h"
+#include "tensorflow/lite/kernels/internal/reference/requantize.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/micro/kernels/conversion_util.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+namespace {
+
+constexpr int kElements = 4096;
+constexpr float kScale = 0.035f;
+constexpr int kZeroPoint = -7;
+// One count of the accelerometer at +-2 g full scale, in g.
+constexpr float kSampleScale = 0.0039f;
+constexpr float kRequantizeScale = 0.02f;
+constexpr int kRequantizeZeroPoint = 3;
+
+float float_data[kElements];
+int8_t int8_data[kElements];
+int16_t samples[kElements];
+float float_output[kElements];
+int8_t int8_output[kElements];
+
+void FillInputs() {
+  for (int i = 0; i < kElements; ++i) {
+    float_data[i] = 0.37f * ((i * 7 + 3) % 23) - 4.0f;
+    int8_data[i] = static_cast<int8_t>(i * 37 + 11);
+    samples[i] = static_cast<int16_t>((i * 97 + 13) % 1024 - 512);
+  }
+}
+
+void QuantizeRepeatedly(int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    tflite::micro::QuantizeFloat(float_data, kElements, kScale, kZeroPoint,
+                                 std::numeric_limits<int8_t>::min(),
+                                 std::numeric_limits<int8_t>::max(),
+                                 int8_output);
+  }
+}
+
+void AffineQuantizeRepeatedly(int iterations) {
+  tflite::QuantizationParams params;
+  params.scale = kScale;
+  params.zero_point = kZeroPoint;
+  const tflite::RuntimeShape shape({kElements});
+  for (int i = 0; i < iterations; ++i) {
+    tflite::reference_ops::AffineQuantize(params, shape, float_data, shape,
+                                          int8_output);
+  }
+}
+
+void DequantizeRepeatedly(int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    tflite::micro::DequantizeToFloat(int8_data, kElements,
+                                     static_cast<double>(kScale), kZeroPoint,
+                                     float_output);
+  }
+}
+
+void ReferenceDequantizeRepeatedly(int iterations) {
+  tflite::DequantizationParams params;
+  params.scale = kScale;
+  params.zero_point = kZeroPoint;
+  const tflite::RuntimeShape shape({kElements});
+  for (int i = 0; i < iterations; ++i) {
+    tflite::reference_ops::Dequantize(params, shape, int8_data, shape,
+                                      float_output);
+  }
+}
+
+void QuantizeSamplesRepeatedly(int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    tflite::QuantizeSamples(samples, kElements, kSampleScale, kScale,
+                            kZeroPoint, int8_output);
+  }
+}
+
+// Runs the reference Requantize() `iterations` times on `input`, scaling by
+// input_scale / kRequantizeScale.
+template <typename T>
+void ReferenceRequantizeRepeatedly(const T* input, float input_scale,
+                                   int32_t input_zero_point, int iterations) {
+  int32_t multiplier;
+  int shift;
+  tflite::QuantizeMultiplier(
+      static_cast<double>(input_scale) / kRequantizeScale, &multiplier,
+      &shift);
+  for (int i = 0; i < iterations; ++i) {
+    tflite::reference_ops::Requantize(input, kElements, multiplier, shift,
+                                      input_zero_point, kRequantizeZeroPoint,
+                                      int8_output);
+  }
+}
+
+void RequantizeRepeatedly(int iterations) {
+  int32_t multiplier;
+  int shift;
+  tflite::QuantizeMultiplier(
+      static_cast<double>(kScale) / kRequantizeScale, &multiplier, &shift);
+  for (int i = 0; i < iterations; ++i) {
+    tflite::micro::RequantizeToType(int8_data, kElements, multiplier, shift,
+                                    kZeroPoint, kRequantizeZeroPoint,
+                                    int8_output);
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_BENCHMARKS_BEGIN
+
+FillInputs();
+
+TF_LITE_MICRO_BENCHMARK(QuantizeRepeatedly(10000))
+TF_LITE_MICRO_BENCHMARK(AffineQuantizeRepeatedly(10000))
+TF_LITE_MICRO_BENCHMARK(DequantizeRepeatedly(10000))
+TF_LITE_MICRO_BENCHMARK(ReferenceDequantizeRepeatedly(10000))
+TF_LITE_MICRO_BENCHMARK(QuantizeSamplesRepeatedly(10000))
+TF_LITE_MICRO_BENCHMARK(
+    ReferenceRequantizeRepeatedly(samples, kSampleScale, 0, 10000))
+TF_LITE_MICRO_BENCHMARK(RequantizeRepeatedly(10000))
+TF_LITE_MICRO_BENCHMARK(
+    ReferenceRequantizeRepeatedly(int8_data, kScale, kZeroPoint, 10000))
+
+TF_LITE_MICRO_BENCHMARKS_END
@@ -0,0 +1,253 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Times a 256->256 FULLY_CONNECTED layer and a 16x16x16 3x3->32 CONV_2D layer
+// with float and float16 filters. Without a weight packing budget, float16
+// weights are widened as the kernels read them; with one, they are widened
+// once while packing.
+
+#include <cstdint>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/micro/kernels/float16_util.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr int kArenaSize = 320 * 1024;
+alignas(16) uint8_t arena[kArenaSize];
+
+// Enough to pack the float filter of the FULLY_CONNECTED layer.
+constexpr size_t kMaxPackedBytes = 288 * 1024;
+
+constexpr int kMaxWeights = 256 * 256;
+constexpr int kMaxChannels = 256;
+TfLiteFloat16 half_filter[kMaxWeights];
+float float_filter[kMaxWeights];
+float bias[kMaxChannels];
+
+// A single layer with float input, bias and output. Dims are in the
+// IntArrayFromInts() layout.
+struct Layer {
+  tflite::BuiltinOperator op;
+  int input_dims[5];
+  int filter_dims[5];
+  int output_dims[5];
+};
+
+constexpr Layer kFullyConnected = {tflite::BuiltinOperator_FULLY_CONNECTED,
+                                   {2, 1, 256},
+                                   {2, 256, 256},
+                                   {2, 1, 256}};
+constexpr Layer kConv = {tflite::BuiltinOperator_CONV_2D,
+                         {4, 1, 16, 16, 16},
+                         {4, 32, 3, 3, 16},
+                         {4, 1, 16, 16, 32}};
+
+// Fills the filters with the same finite weights, of magnitudes between 2^-6
+// and 1, as float16 and widened to float.
+void FillFilters() {
+  for (int i = 0; i < kMaxWeights; ++i) {
+    const int sign = i % 3 == 0 ? 0x8000 : 0;
+    const int exponent = 9 + (i * 5) % 6;
+    const int mantissa = (i * 389 + 11) % 1024;
+    half_filter[i].data =
+        static_cast<uint16_t>(sign | (exponent << 10) | mantissa);
+    float_filter[i] = tflite::micro::Float16ToFloat(half_filter[i]);
+  }
+  for (int i = 0; i < kMaxChannels; ++i) {
+    bias[i] = 0.01f * (i % 13) - 0.06f;
+  }
+}
+
+int FlatSize(const int* dims) {
+  int size = 1;
+  for (int i = 1; i <= dims[0]; ++i) {
+    size *= dims[i];
+  }
+  return size;
+}
+
+// Builds a model of `layer` with a filter of `filter_type`, FLOAT32 or
+// FLOAT16.
+const tflite::Model* BuildModel(flatbuffers::FlatBufferBuilder* builder,
+                                const Layer& layer,
+                                tflite::TensorType filter_type) {
+  using flatbuffers::Offset;
+  const bool half = filter_type == tflite::TensorType_FLOAT16;
+  const int filter_count = FlatSize(layer.filter_dims);
+  const int channels = layer.filter_dims[1];
+  const Offset<tflite::Buffer> buffers[] = {
+      tflite::CreateBuffer(*builder),
+      tflite::CreateBuffer(
+          *builder,
+          builder->CreateVector(
+              half ? reinterpret_cast<const uint8_t*>(half_filter)
+                   : reinterpret_cast<const uint8_t*>(float_filter),
+              filter_count * (half ? sizeof(TfLiteFloat16) : sizeof(float)))),
+      tflite::CreateBuffer(
+          *builder,
+          builder->CreateVector(reinterpret_cast<const uint8_t*>(bias),
+                                channels * sizeof(float)))};
+
+  const Offset<tflite::Tensor> tensors[] = {
+      tflite::CreateTensor(
+          *builder,
+          builder->CreateVector(&layer.input_dims[1], layer.input_dims[0]),
+          tflite::TensorType_FLOAT32, 0),
+      tflite::CreateTensor(
+          *builder,
+          builder->CreateVector(&layer.filter_dims[1], layer.filter_dims[0]),
+          filter_type, 1),
+      tflite::CreateTensor(*builder, builder->CreateVector(&channels, 1),
+                           tflite::TensorType_FLOAT32, 2),
+      tflite::CreateTensor(
+          *builder,
+          builder->CreateVector(&layer.output_dims[1], layer.output_dims[0]),
+          tflite::TensorType_FLOAT32, 0)};
+
+  const bool conv = layer.op == tflite::BuiltinOperator_CONV_2D;
+  const int32_t operator_inputs[] = {0, 1, 2};
+  const int32_t operator_outputs[] = {3};
+  const Offset<tflite::Operator> operators[] = {tflite::CreateOperator(
+      *builder, 0, builder->CreateVector(operator_inputs, 3),
+      builder->CreateVector(operator_outputs, 1),
+      conv ? tflite::BuiltinOptions_Conv2DOptions
+           : tflite::BuiltinOptions_FullyConnectedOptions,
+      conv ? tflite::CreateConv2DOptions(*builder, tflite::Padding_SAME, 1, 1)
+                 .Union()
+           : tflite::CreateFullyConnectedOptions(*builder).Union())};
+  const Offset<tflite::OperatorCode> opcodes[] = {
+      tflite::CreateOperatorCode(*builder, layer.op, 0, 1, layer.op)};
+  const int32_t inputs[] = {0};
+  const int32_t outputs[] = {3};
+  const Offset<tflite::SubGraph> subgraphs[] = {tflite::CreateSubGraph(
+      *builder, builder->CreateVector(tensors, 4),
+      builder->CreateVector(inputs, 1), builder->CreateVector(outputs, 1),
+      builder->CreateVector(operators, 1))};
+  builder->Finish(tflite::CreateModel(
+      *builder, TFLITE_SCHEMA_VERSION, builder->CreateVector(opcodes, 1),
+      builder->CreateVector(subgraphs, 1), builder->CreateString("layer"),
+      builder->CreateVector(buffers, 3)));
+  return tflite::GetModel(builder->GetBufferPointer());
+}
+
+// Allocates `interpreter` with a weight packing budget of `packing_bytes`, 0
+// to leave the filter as the model stores it, fills its input and reports
+// its arena use.
+void SetUp(const char* name, tflite::MicroInterpreter* interpreter,
+           size_t packing_bytes) {
+  if (packing_bytes != 0) {
+    interpreter->SetWeightPacking(packing_bytes);
+  }
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    return;
+  }
+  TfLiteTensor* input = interpreter->input(0);
+  for (size_t i = 0; i < input->bytes / sizeof(float); ++i) {
+    input->data.f[i] = 0.1f * (i % 7) - 0.2f;
+  }
+  TF_LITE_REPORT_ERROR(micro_benchmark::reporter,
+                       "%s: %d arena bytes, %d of them packed weights", name,
+                       static_cast<int>(interpreter->arena_used_bytes()),
+                       static_cast<int>(interpreter->packed_weight_bytes()));
+}
+
+void InvokeRepeatedly(tflite::MicroInterpreter* interpreter, int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    interpreter->Invoke();
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_BENCHMARKS_BEGIN
+
+FillFilters();
+tflite::MicroMutableOpResolver<2> op_resolver;
+op_resolver.AddConv2D();
+op_resolver.AddFullyConnected();
+
+{
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::MicroInterpreter fc(
+      BuildModel(&builder, kFullyConnected, tflite::TensorType_FLOAT32),
+      op_resolver, arena, kArenaSize, micro_benchmark::reporter);
+  SetUp("fc", &fc, 0);
+  TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&fc, 10000))
+}
+{
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::MicroInterpreter fc_packed(
+      BuildModel(&builder, kFullyConnected, tflite::TensorType_FLOAT32),
+      op_resolver, arena, kArenaSize, micro_benchmark::reporter);
+  SetUp("fc_packed", &fc_packed, kMaxPackedBytes);
+  TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&fc_packed, 10000))
+}
+{
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::MicroInterpreter fc_float16(
+      BuildModel(&builder, kFullyConnected, tflite::TensorType_FLOAT16),
+      op_resolver, arena, kArenaSize, micro_benchmark::reporter);
+  SetUp("fc_float16", &fc_float16, 0);
+  TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&fc_float16, 10000))
+}
+{
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::MicroInterpreter fc_float16_packed(
+      BuildModel(&builder, kFullyConnected, tflite::TensorType_FLOAT16),
+      op_resolver, arena, kArenaSize, micro_benchmark::reporter);
+  SetUp("fc_float16_packed", &fc_float16_packed, kMaxPackedBytes);
+  TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&fc_float16_packed, 10000))
+}
+
+{
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::MicroInterpreter conv(
+      BuildModel(&builder, kConv, tflite::TensorType_FLOAT32), op_resolver,
+      arena, kArenaSize, micro_benchmark::reporter);
+  SetUp("conv", &conv, 0);
+  TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&conv, 100))
+}
+{
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::MicroInterpreter conv_packed(
+      BuildModel(&builder, kConv, tflite::TensorType_FLOAT32), op_resolver,
+      arena, kArenaSize, micro_benchmark::reporter);
+  SetUp("conv_packed", &conv_packed, kMaxPackedBytes);
+  TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&conv_packed, 100))
+}
+{
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::MicroInterpreter conv_float16(
+      BuildModel(&builder, kConv, tflite::TensorType_FLOAT16), op_resolver,
+      arena, kArenaSize, micro_benchmark::reporter);
+  SetUp("conv_float16", &conv_float16, 0);
+  TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&conv_float16, 100))
+}
+{
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::MicroInterpreter conv_float16_packed(
+      BuildModel(&builder, kConv, tflite::TensorType_FLOAT16), op_resolver,
+      arena, kArenaSize, micro_benchmark::reporter);
+  SetUp("conv_float16_packed", &conv_float16_packed, kMaxPackedBytes);
+  TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&conv_float16_packed, 100))
+}
+
+TF_LITE_MICRO_BENCHMARKS_END
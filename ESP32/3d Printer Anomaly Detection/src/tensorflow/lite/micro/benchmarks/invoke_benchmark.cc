@@ -0,0 +1,84 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Times Invoke() on the accelerometer, keyword and conv models. The nine
+// operators of the accelerometer autoencoder do little work, so its time is
+// mostly the per-invoke overhead of walking the execution plan.
+
+#include <cstdint>
+
+#include "accel_model.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/benchmarks/keyword_scrambled_model_data.h"
+#include "tensorflow/lite/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+
+namespace {
+
+constexpr int kAccelArenaSize = 8 * 1024;
+constexpr int kKeywordArenaSize = 32 * 1024;
+constexpr int kConvArenaSize = 48 * 1024;
+alignas(16) uint8_t accel_arena[kAccelArenaSize];
+alignas(16) uint8_t keyword_arena[kKeywordArenaSize];
+alignas(16) uint8_t conv_arena[kConvArenaSize];
+
+// Fills the first input with values that keep float kernels off denormals.
+void FillInput(tflite::MicroInterpreter* interpreter) {
+  TfLiteTensor* input = interpreter->input(0);
+  if (input->type == kTfLiteFloat32) {
+    for (size_t i = 0; i < input->bytes / sizeof(float); ++i) {
+      input->data.f[i] = 0.1f * (i % 7) - 0.2f;
+    }
+  } else {
+    for (size_t i = 0; i < input->bytes; ++i) {
+      input->data.uint8[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+  }
+}
+
+void InvokeRepeatedly(tflite::MicroInterpreter* interpreter, int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    interpreter->Invoke();
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_BENCHMARKS_BEGIN
+
+tflite::AllOpsResolver op_resolver;
+tflite::MicroInterpreter accel(tflite::GetModel(g_model), op_resolver,
+                               accel_arena, kAccelArenaSize,
+                               micro_benchmark::reporter);
+tflite::MicroInterpreter keyword(
+    tflite::GetModel(g_keyword_scrambled_model_data), op_resolver,
+    keyword_arena, kKeywordArenaSize, micro_benchmark::reporter);
+tflite::MicroInterpreter conv(tflite::GetModel(kTestConvModelData),
+                              op_resolver, conv_arena, kConvArenaSize,
+                              micro_benchmark::reporter);
+accel.AllocateTensors();
+keyword.AllocateTensors();
+conv.AllocateTensors();
+FillInput(&accel);
+FillInput(&keyword);
+FillInput(&conv);
+
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&accel, 1))
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&accel, 100000))
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&keyword, 1000))
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&conv, 100))
+
+TF_LITE_MICRO_BENCHMARKS_END
@@ -0,0 +1,113 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Times the boot of every model container given on the command line: mapping
+// and checking the container, decoding a compressed payload into the arena and
+// allocating the tensors, as the firmware does. Reports the stored and decoded
+// size of each. Containers are written by tools/make_model_container.py from
+// the C arrays of the accelerometer, keyword and conv models, with and
+// without --lz4:
+//
+//   tools/make_model_container.py lib/Model/accel_model.cc accel.bin
+//   tools/make_model_container.py lib/Model/accel_model.cc accel_lz4.bin --lz4
+//
+// The keyword and conv models are in keyword_scrambled_model_data.cc and
+// testing/test_conv_model.cc.
+
+#include <cstdint>
+
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_model_loader.h"
+
+namespace {
+
+constexpr int kArenaSize = 96 * 1024;
+alignas(16) uint8_t tensor_arena[kArenaSize];
+
+tflite::AllOpsResolver op_resolver;
+
+// Boots the container at `source` once and returns the arena bytes used, or
+// 0 on failure.
+size_t Boot(const char* source) {
+  tflite::MappedModel mapped_model(micro_benchmark::reporter);
+  if (mapped_model.Map(source) != kTfLiteOk) {
+    return 0;
+  }
+  tflite::MicroAllocator* allocator = tflite::MicroAllocator::Create(
+      tensor_arena, kArenaSize, micro_benchmark::reporter);
+  const tflite::Model* model = mapped_model.Decode(allocator);
+  if (model == nullptr) {
+    return 0;
+  }
+  tflite::MicroInterpreter interpreter(model, op_resolver, allocator,
+                                       micro_benchmark::reporter);
+  if (interpreter.AllocateTensors() != kTfLiteOk) {
+    return 0;
+  }
+  return interpreter.arena_used_bytes();
+}
+
+void BootRepeatedly(const char* source, int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    Boot(source);
+  }
+}
+
+// Reports the sizes of the container at `source`. Returns false if it does
+// not boot.
+bool ReportSizes(const char* source) {
+  tflite::MappedModel mapped_model(micro_benchmark::reporter);
+  if (mapped_model.Map(source) != kTfLiteOk) {
+    return false;
+  }
+  const size_t arena_bytes = Boot(source);
+  if (arena_bytes == 0) {
+    TF_LITE_REPORT_ERROR(micro_benchmark::reporter, "%s does not boot",
+                         source);
+    return false;
+  }
+  const tflite::MicroModelHeader* header = mapped_model.header();
+  const bool compressed = (header->flags & tflite::kMicroModelLz4) != 0;
+  TF_LITE_REPORT_ERROR(
+      micro_benchmark::reporter,
+      "%s: %d bytes stored, %d bytes decoded, %d arena bytes used", source,
+      static_cast<int>(header->payload_size),
+      static_cast<int>(compressed ? header->decoded_size
+                                  : header->payload_size),
+      static_cast<int>(arena_bytes));
+  return true;
+}
+
+}  // namespace
+
+TF_LITE_MICRO_BENCHMARKS_BEGIN
+
+if (argc < 2) {
+  TF_LITE_REPORT_ERROR(micro_benchmark::reporter,
+                       "Usage: %s <container>...", argv[0]);
+  return 1;
+}
+for (int i = 1; i < argc; ++i) {
+  const char* source = argv[i];
+  if (!ReportSizes(source)) {
+    continue;
+  }
+  TF_LITE_MICRO_BENCHMARK(BootRepeatedly(source, 1000))
+}
+
+TF_LITE_MICRO_BENCHMARKS_END
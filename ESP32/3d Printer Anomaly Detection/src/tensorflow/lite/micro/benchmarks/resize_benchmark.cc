@@ -0,0 +1,104 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Times ResizeInputTensor() on the accelerometer and conv models, and the
+// accelerometer model on the same number of windows at growing batch sizes.
+// The conv model allocates persistent buffers in Prepare, which every resize
+// hands back to it.
+
+#include <cstdint>
+
+#include "accel_model.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+
+namespace {
+
+constexpr int kAccelArenaSize = 64 * 1024;
+constexpr int kConvArenaSize = 64 * 1024;
+alignas(16) uint8_t accel_arena[kAccelArenaSize];
+alignas(16) uint8_t conv_arena[kConvArenaSize];
+
+constexpr int kMaxDims = 4;
+// Every batch size below runs this many windows.
+constexpr int kWindows = 64 * 1024;
+
+// Resizes the first input to `batch` windows, keeping its other dims, and
+// fills it.
+void SetBatch(tflite::MicroInterpreter* interpreter, int batch) {
+  const TfLiteIntArray* dims = interpreter->input_eval_tensor(0)->dims;
+  int dims_data[kMaxDims + 1] = {dims->size};
+  for (int i = 0; i < dims->size; ++i) {
+    dims_data[i + 1] = dims->data[i];
+  }
+  dims_data[1] = batch;
+  if (interpreter->ResizeInputTensor(
+          0, tflite::testing::IntArrayFromInts(dims_data)) != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(micro_benchmark::reporter,
+                         "Resizing to batch %d failed", batch);
+    return;
+  }
+  TfLiteTensor* input = interpreter->input(0);
+  for (size_t i = 0; i < input->bytes / sizeof(float); ++i) {
+    input->data.f[i] = 0.1f * (i % 7) - 0.2f;
+  }
+}
+
+void ResizeRepeatedly(tflite::MicroInterpreter* interpreter, int batch,
+                      int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    SetBatch(interpreter, batch);
+    SetBatch(interpreter, 1);
+  }
+}
+
+void InvokeRepeatedly(tflite::MicroInterpreter* interpreter, int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    interpreter->Invoke();
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_BENCHMARKS_BEGIN
+
+tflite::AllOpsResolver op_resolver;
+tflite::MicroInterpreter accel(tflite::GetModel(g_model), op_resolver,
+                               accel_arena, kAccelArenaSize,
+                               micro_benchmark::reporter);
+tflite::MicroInterpreter conv(tflite::GetModel(kTestConvModelData),
+                              op_resolver, conv_arena, kConvArenaSize,
+                              micro_benchmark::reporter);
+accel.EnableResizing();
+conv.EnableResizing();
+accel.AllocateTensors();
+conv.AllocateTensors();
+
+TF_LITE_MICRO_BENCHMARK(ResizeRepeatedly(&accel, 64, 1000))
+TF_LITE_MICRO_BENCHMARK(ResizeRepeatedly(&conv, 2, 1000))
+
+SetBatch(&accel, 1);
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&accel, kWindows))
+SetBatch(&accel, 4);
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&accel, kWindows / 4))
+SetBatch(&accel, 16);
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&accel, kWindows / 16))
+SetBatch(&accel, 64);
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&accel, kWindows / 64))
+
+TF_LITE_MICRO_BENCHMARKS_END
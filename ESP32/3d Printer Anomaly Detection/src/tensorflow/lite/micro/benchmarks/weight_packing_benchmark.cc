@@ -0,0 +1,113 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Times Invoke() on the accelerometer, keyword and conv models with their
+// FULLY_CONNECTED and CONV_2D weights in the model layout and packed by
+// SetWeightPacking(), and reports the arena bytes packing takes.
+
+#include <cstdint>
+
+#include "accel_model.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/benchmarks/keyword_scrambled_model_data.h"
+#include "tensorflow/lite/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+
+namespace {
+
+constexpr int kAccelArenaSize = 8 * 1024;
+constexpr int kKeywordArenaSize = 32 * 1024;
+constexpr int kConvArenaSize = 48 * 1024;
+alignas(16) uint8_t accel_arena[kAccelArenaSize];
+alignas(16) uint8_t accel_packed_arena[kAccelArenaSize];
+alignas(16) uint8_t keyword_arena[kKeywordArenaSize];
+alignas(16) uint8_t keyword_packed_arena[kKeywordArenaSize];
+alignas(16) uint8_t conv_arena[kConvArenaSize];
+alignas(16) uint8_t conv_packed_arena[kConvArenaSize];
+
+// Enough to pack every layer of the three models.
+constexpr size_t kMaxPackedBytes = 32 * 1024;
+
+// Allocates `interpreter`, fills its first input with values that keep float
+// kernels off denormals and reports its arena use.
+void SetUp(const char* name, tflite::MicroInterpreter* interpreter) {
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    return;
+  }
+  TfLiteTensor* input = interpreter->input(0);
+  if (input->type == kTfLiteFloat32) {
+    for (size_t i = 0; i < input->bytes / sizeof(float); ++i) {
+      input->data.f[i] = 0.1f * (i % 7) - 0.2f;
+    }
+  } else {
+    for (size_t i = 0; i < input->bytes; ++i) {
+      input->data.uint8[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+  }
+  TF_LITE_REPORT_ERROR(micro_benchmark::reporter,
+                       "%s: %d arena bytes, %d of them packed weights", name,
+                       static_cast<int>(interpreter->arena_used_bytes()),
+                       static_cast<int>(interpreter->packed_weight_bytes()));
+}
+
+void InvokeRepeatedly(tflite::MicroInterpreter* interpreter, int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    interpreter->Invoke();
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_BENCHMARKS_BEGIN
+
+tflite::AllOpsResolver op_resolver;
+const tflite::Model* accel_model = tflite::GetModel(g_model);
+const tflite::Model* keyword_model =
+    tflite::GetModel(g_keyword_scrambled_model_data);
+const tflite::Model* conv_model = tflite::GetModel(kTestConvModelData);
+tflite::MicroInterpreter accel(accel_model, op_resolver, accel_arena,
+                               kAccelArenaSize, micro_benchmark::reporter);
+tflite::MicroInterpreter accel_packed(accel_model, op_resolver,
+                                      accel_packed_arena, kAccelArenaSize,
+                                      micro_benchmark::reporter);
+tflite::MicroInterpreter keyword(keyword_model, op_resolver, keyword_arena,
+                                 kKeywordArenaSize, micro_benchmark::reporter);
+tflite::MicroInterpreter keyword_packed(
+    keyword_model, op_resolver, keyword_packed_arena, kKeywordArenaSize,
+    micro_benchmark::reporter);
+tflite::MicroInterpreter conv(conv_model, op_resolver, conv_arena,
+                              kConvArenaSize, micro_benchmark::reporter);
+tflite::MicroInterpreter conv_packed(conv_model, op_resolver,
+                                     conv_packed_arena, kConvArenaSize,
+                                     micro_benchmark::reporter);
+accel_packed.SetWeightPacking(kMaxPackedBytes);
+keyword_packed.SetWeightPacking(kMaxPackedBytes);
+conv_packed.SetWeightPacking(kMaxPackedBytes);
+SetUp("accel", &accel);
+SetUp("accel_packed", &accel_packed);
+SetUp("keyword", &keyword);
+SetUp("keyword_packed", &keyword_packed);
+SetUp("conv", &conv);
+SetUp("conv_packed", &conv_packed);
+
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&accel, 100000))
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&accel_packed, 100000))
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&keyword, 1000))
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&keyword_packed, 1000))
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&conv, 100))
+TF_LITE_MICRO_BENCHMARK(InvokeRepeatedly(&conv_packed, 100))
+
+TF_LITE_MICRO_BENCHMARKS_END
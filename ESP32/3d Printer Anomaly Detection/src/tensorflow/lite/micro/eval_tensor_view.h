@@ -0,0 +1,71 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_EVAL_TENSOR_VIEW_H_
+#define TENSORFLOW_LITE_MICRO_EVAL_TENSOR_VIEW_H_
+
+#include <cstddef>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/portable_type_to_tflitetype.h"
+
+namespace tflite {
+
+// A lightweight, typed view over a TfLiteEvalTensor. Unlike TfLiteTensor, a
+// view does not require any arena allocation, it only wraps the pointer to the
+// TfLiteEvalTensor owned by the interpreter. A view constructed over a tensor
+// of a different type (or over nullptr) is invalid and has no data.
+template <typename T>
+class EvalTensorView {
+ public:
+  EvalTensorView() : tensor_(nullptr) {}
+  explicit EvalTensorView(TfLiteEvalTensor* tensor)
+      : tensor_((tensor != nullptr && tensor->type == typeToTfLiteType<T>())
+                    ? tensor
+                    : nullptr) {}
+
+  bool valid() const { return tensor_ != nullptr; }
+
+  T* data() const {
+    return tensor_ != nullptr ? reinterpret_cast<T*>(tensor_->data.raw)
+                              : nullptr;
+  }
+
+  // Returns the number of elements in the tensor.
+  size_t size() const {
+    if (tensor_ == nullptr) {
+      return 0;
+    }
+    size_t count = 1;
+    for (int i = 0; i < tensor_->dims->size; ++i) {
+      count *= tensor_->dims->data[i];
+    }
+    return count;
+  }
+
+  const TfLiteIntArray* dims() const {
+    return tensor_ != nullptr ? tensor_->dims : nullptr;
+  }
+
+  T& operator[](size_t index) const { return data()[index]; }
+
+  TfLiteEvalTensor* tensor() const { return tensor_; }
+
+ private:
+  TfLiteEvalTensor* tensor_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_EVAL_TENSOR_VIEW_H_
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/kernels/internal/cppmath.h"
@@ -50,6 +51,30 @@ inline float ActivationValFloat(TfLiteFusedActivation act, float a) {
                 // activation is added to the enum and not handled here).
 }
 
+// Entries of the lookup table of an 8-bit activation, one per input value.
+constexpr int kActivationTableSize = 256;
+
+// Fills `table` by calling eval(kActivationTableSize, inputs, table) on every
+// 8-bit value, so that entry i holds the output for the input whose bit
+// pattern is i.
+template <typename T, typename Fn>
+inline void PopulateActivationTable(T* table, const Fn& eval) {
+  T inputs[kActivationTableSize];
+  for (int i = 0; i < kActivationTableSize; ++i) {
+    inputs[i] = static_cast<T>(i);
+  }
+  eval(kActivationTableSize, inputs, table);
+}
+
+// Applies an activation through a table built by PopulateActivationTable().
+template <typename T>
+inline void LookupActivation(const T* table, int size, const T* input_data,
+                             T* output_data) {
+  for (int i = 0; i < size; ++i) {
+    output_data[i] = table[static_cast<uint8_t>(input_data[i])];
+  }
+}
+
 }  // namespace micro
 }  // namespace ops
 }  // namespace tflite
@@ -0,0 +1,229 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_BROADCAST_UTIL_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_BROADCAST_UTIL_H_
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/reference/process_broadcast_shapes.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/kernels/simd_util.h"
+
+namespace tflite {
+namespace micro {
+
+// Broadcast of a binary elementwise operator, found in Prepare by
+// ProcessBroadcastShapes(). The input that broadcasts (called a below) has
+// y0 * y1 * y2 * y4 elements and the other one (b) y0 * y2 * y3 * y4, where
+// y0..y4 are shape[0..4]. This covers the common patterns:
+//  - scalar: y3 is the size of b, everything else is 1.
+//  - innermost row, such as a bias over channels: a is a row of y4 elements
+//    repeated y3 times.
+//  - outer row, such as a per-pixel scale over channels: every element of a
+//    is repeated over a run of y3 elements of b, and y4 is 1.
+struct ElementwiseBroadcast {
+  BroadcastableOpCategory category;
+  int shape[5];
+};
+
+inline void PrepareElementwiseBroadcast(const TfLiteTensor* input1,
+                                        const TfLiteTensor* input2,
+                                        ElementwiseBroadcast* broadcast) {
+  ArithmeticParams params = {};
+  reference_ops::ProcessBroadcastShapes(GetTensorShape(input1),
+                                        GetTensorShape(input2), &params);
+  broadcast->category = params.broadcast_category;
+  for (int i = 0; i < 5; ++i) {
+    broadcast->shape[i] = params.broadcast_shape[i];
+  }
+}
+
+// Returns true if BroadcastFivefold() handles `broadcast`. The other shapes
+// must go through the Slow reference kernels.
+inline bool IsFivefoldBroadcast(const ElementwiseBroadcast& broadcast) {
+  return broadcast.category ==
+             BroadcastableOpCategory::kFirstInputBroadcastsFast ||
+         broadcast.category ==
+             BroadcastableOpCategory::kSecondInputBroadcastsFast;
+}
+
+// Computes a broadcasting binary operator as calls to the row functions of
+// `op`, which keep the order of the inputs so the operator need not be
+// commutative:
+//   op.Elementwise(size, input1, input2, output)
+//   op.BroadcastInput1(size, input1_value, input2, output)
+//   op.BroadcastInput2(size, input1, input2_value, output)
+// where the Broadcast functions combine a single value of one input with
+// `size` values of the other.
+template <typename T, typename Op>
+void BroadcastFivefold(const ElementwiseBroadcast& broadcast,
+                       const T* input1_data, const T* input2_data,
+                       T* output_data, const Op& op) {
+  const bool input1_broadcasts =
+      broadcast.category == BroadcastableOpCategory::kFirstInputBroadcastsFast;
+  const T* a_data = input1_broadcasts ? input1_data : input2_data;
+  const T* b_reset = input1_broadcasts ? input2_data : input1_data;
+  const int y0 = broadcast.shape[0];
+  const int y1 = broadcast.shape[1];
+  const int y2 = broadcast.shape[2];
+  const int y3 = broadcast.shape[3];
+  const int y4 = broadcast.shape[4];
+
+  // b restarts for every i1, a advances once per i2.
+  T* output_ptr = output_data;
+  const T* a_ptr = a_data;
+  for (int i0 = 0; i0 < y0; ++i0) {
+    const T* b_ptr = b_reset;
+    for (int i1 = 0; i1 < y1; ++i1) {
+      b_ptr = b_reset;
+      for (int i2 = 0; i2 < y2; ++i2) {
+        if (y4 == 1) {
+          if (input1_broadcasts) {
+            op.BroadcastInput1(y3, *a_ptr, b_ptr, output_ptr);
+          } else {
+            op.BroadcastInput2(y3, b_ptr, *a_ptr, output_ptr);
+          }
+          b_ptr += y3;
+          output_ptr += y3;
+        } else {
+          for (int i3 = 0; i3 < y3; ++i3) {
+            if (input1_broadcasts) {
+              op.Elementwise(y4, a_ptr, b_ptr, output_ptr);
+            } else {
+              op.Elementwise(y4, b_ptr, a_ptr, output_ptr);
+            }
+            b_ptr += y4;
+            output_ptr += y4;
+          }
+        }
+        a_ptr += y4;
+      }
+    }
+    b_reset = b_ptr;
+  }
+}
+
+enum class FloatBinaryOp { kAdd, kSub, kMul };
+
+// Row functions of a float operator followed by the fused activation. Every
+// element is computed with one add, subtract or multiply and clamped like
+// ActivationFunctionWithMinMax(), so results match the reference kernels with
+// every backend.
+template <FloatBinaryOp kOp>
+struct FloatBroadcastOp {
+  float activation_min;
+  float activation_max;
+
+  static float Apply(float x, float y) {
+    return kOp == FloatBinaryOp::kAdd   ? x + y
+           : kOp == FloatBinaryOp::kSub ? x - y
+                                        : x * y;
+  }
+
+  float Clamp(float x) const {
+    const float lower = x < activation_min ? activation_min : x;
+    return activation_max < lower ? activation_max : lower;
+  }
+
+#if defined(TF_LITE_MICRO_NEON)
+  static float32x4_t Apply(float32x4_t x, float32x4_t y) {
+    return kOp == FloatBinaryOp::kAdd   ? vaddq_f32(x, y)
+           : kOp == FloatBinaryOp::kSub ? vsubq_f32(x, y)
+                                        : vmulq_f32(x, y);
+  }
+
+  float32x4_t Clamp(float32x4_t x) const {
+    const float32x4_t min = vdupq_n_f32(activation_min);
+    const float32x4_t max = vdupq_n_f32(activation_max);
+    const float32x4_t lower = vbslq_f32(vcltq_f32(x, min), min, x);
+    return vbslq_f32(vcltq_f32(max, lower), max, lower);
+  }
+#elif defined(TF_LITE_MICRO_SSE2)
+  static __m128 Apply(__m128 x, __m128 y) {
+    return kOp == FloatBinaryOp::kAdd   ? _mm_add_ps(x, y)
+           : kOp == FloatBinaryOp::kSub ? _mm_sub_ps(x, y)
+                                        : _mm_mul_ps(x, y);
+  }
+
+  // _mm_max_ps(a, b) is (a > b) ? a : b, the same choice as the reference
+  // clamp including for NaN and signed zeros.
+  __m128 Clamp(__m128 x) const {
+    return _mm_min_ps(_mm_set1_ps(activation_max),
+                      _mm_max_ps(_mm_set1_ps(activation_min), x));
+  }
+#endif
+
+  void Elementwise(int size, const float* input1, const float* input2,
+                   float* output) const {
+    int i = 0;
+#if defined(TF_LITE_MICRO_NEON)
+    for (; i + 4 <= size; i += 4) {
+      vst1q_f32(output + i,
+                Clamp(Apply(vld1q_f32(input1 + i), vld1q_f32(input2 + i))));
+    }
+#elif defined(TF_LITE_MICRO_SSE2)
+    for (; i + 4 <= size; i += 4) {
+      _mm_storeu_ps(output + i, Clamp(Apply(_mm_loadu_ps(input1 + i),
+                                            _mm_loadu_ps(input2 + i))));
+    }
+#endif
+    for (; i < size; ++i) {
+      output[i] = Clamp(Apply(input1[i], input2[i]));
+    }
+  }
+
+  void BroadcastInput1(int size, float input1, const float* input2,
+                       float* output) const {
+    int i = 0;
+#if defined(TF_LITE_MICRO_NEON)
+    const float32x4_t value = vdupq_n_f32(input1);
+    for (; i + 4 <= size; i += 4) {
+      vst1q_f32(output + i, Clamp(Apply(value, vld1q_f32(input2 + i))));
+    }
+#elif defined(TF_LITE_MICRO_SSE2)
+    const __m128 value = _mm_set1_ps(input1);
+    for (; i + 4 <= size; i += 4) {
+      _mm_storeu_ps(output + i, Clamp(Apply(value, _mm_loadu_ps(input2 + i))));
+    }
+#endif
+    for (; i < size; ++i) {
+      output[i] = Clamp(Apply(input1, input2[i]));
+    }
+  }
+
+  void BroadcastInput2(int size, const float* input1, float input2,
+                       float* output) const {
+    int i = 0;
+#if defined(TF_LITE_MICRO_NEON)
+    const float32x4_t value = vdupq_n_f32(input2);
+    for (; i + 4 <= size; i += 4) {
+      vst1q_f32(output + i, Clamp(Apply(vld1q_f32(input1 + i), value)));
+    }
+#elif defined(TF_LITE_MICRO_SSE2)
+    const __m128 value = _mm_set1_ps(input2);
+    for (; i + 4 <= size; i += 4) {
+      _mm_storeu_ps(output + i, Clamp(Apply(_mm_loadu_ps(input1 + i), value)));
+    }
+#endif
+    for (; i < size; ++i) {
+      output[i] = Clamp(Apply(input1[i], input2));
+    }
+  }
+};
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_BROADCAST_UTIL_H_
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
 
 namespace tflite {
 namespace ops {
@@ -83,6 +84,25 @@ inline void GetAllInputTensorData(const TfLiteContext* context,
   }
 }
 
+// Returns true if the inputs already lie end to end in the output, which is
+// how the memory planner places the inputs of a concatenation along the
+// outermost dimension when it can.
+bool InputsAreInPlace(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+  size_t offset = 0;
+  for (int i = 0; i < node->inputs->size; ++i) {
+    const TfLiteEvalTensor* t = tflite::micro::GetEvalInput(context, node, i);
+    size_t bytes;
+    if (t->data.raw != output->data.raw + offset ||
+        TfLiteEvalTensorByteLength(t, &bytes) != kTfLiteOk) {
+      return false;
+    }
+    offset += bytes;
+  }
+  return true;
+}
+
 template <typename data_type>
 void EvalUnquantized(TfLiteContext* context, TfLiteNode* node) {
   // Collect the shapes and data pointer of input tensors
@@ -231,6 +251,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, output_tensor != nullptr);
   TfLiteType output_type = output_tensor->type;
 
+  // uint8 inputs may be rescaled, so they are never placed in the output.
+  if (output_type != kTfLiteUInt8 && InputsAreInPlace(context, node)) {
+    return kTfLiteOk;
+  }
+
   switch (output_type) {  // Already know in/outtypes are same.
     case kTfLiteFloat32:
       EvalUnquantized<float>(context, node);
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 
+#include <algorithm>
+
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
@@ -23,7 +25,12 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/float16_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/parallel_util.h"
+#include "tensorflow/lite/micro/kernels/simd_util.h"
+#include "tensorflow/lite/micro/micro_streaming.h"
+#include "tensorflow/lite/micro/micro_weight_packing.h"
 
 namespace tflite {
 namespace {
@@ -60,8 +67,41 @@ struct OpData {
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
   int32_t output_activation_max;
+
+  // Float or int8 filter packed by PackWeightPanels() as an output_depth x
+  // (filter_height * filter_width * input_depth) matrix, with a float16 filter
+  // widened to float, or nullptr when the layer reads its filter from the
+  // model.
+  const void* packed_filter;
+  // For a packed int8 filter, the bias of every packed channel with the input
+  // offset times the sum of its filter folded in.
+  const int32_t* packed_bias;
+  // Float16 filter of a 1-D layer that is not packed (see Prepare), widened
+  // to float in its original layout, or nullptr.
+  const float* widened_filter;
 };
 
+static_assert(kWeightPanelWidth == 4,
+              "PackedConv() unrolls panels of 4 channels");
+
+// Axis along which a CONV_2D is a 1-D convolution, see Conv1DGeometry.
+enum class Conv1DAxis { kNone, kHeight, kWidth };
+
+Conv1DAxis GetConv1DAxis(int input_height, int input_width, int filter_height,
+                         int filter_width, int output_height, int output_width,
+                         int dilation_height_factor,
+                         int dilation_width_factor) {
+  if (input_width == 1 && filter_width == 1 && output_width == 1 &&
+      dilation_height_factor == 1) {
+    return Conv1DAxis::kHeight;
+  }
+  if (input_height == 1 && filter_height == 1 && output_height == 1 &&
+      dilation_width_factor == 1) {
+    return Conv1DAxis::kWidth;
+  }
+  return Conv1DAxis::kNone;
+}
+
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
   switch (padding) {
     case TfLitePadding::kTfLitePaddingSame:
@@ -115,6 +155,76 @@ TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Packs the filter of a float or int8 layer with constant weights for
+// PackedConv() if the interpreter has room for it. Float16 filters are widened
+// to float while packing. Other layers keep using the reference kernels.
+TfLiteStatus PackFilter(TfLiteContext* context, const TfLiteTensor* filter,
+                        const TfLiteTensor* bias, OpData* data) {
+  data->packed_filter = nullptr;
+  data->packed_bias = nullptr;
+  if (!IsConstantTensor(filter) ||
+      (bias != nullptr && !IsConstantTensor(bias))) {
+    return kTfLiteOk;
+  }
+  const int output_depth = filter->dims->data[kConvQuantizedDimension];
+  if (output_depth == 0) {
+    return kTfLiteOk;
+  }
+  const int accum_depth = NumElements(filter) / output_depth;
+  const size_t packed_size = PackedWeightsSize(output_depth, accum_depth);
+
+  if (filter->type == kTfLiteFloat32) {
+    float* packed = static_cast<float*>(
+        AllocatePackedWeights(context, packed_size * sizeof(float)));
+    if (packed != nullptr) {
+      PackWeightPanels(GetTensorData<float>(filter), output_depth, accum_depth,
+                       packed);
+      data->packed_filter = packed;
+    }
+  } else if (filter->type == kTfLiteFloat16) {
+    float* packed = static_cast<float*>(
+        AllocatePackedWeights(context, packed_size * sizeof(float)));
+    if (packed != nullptr) {
+      tflite::micro::PackFloat16WeightPanels(
+          GetTensorData<TfLiteFloat16>(filter), output_depth, accum_depth,
+          packed);
+      data->packed_filter = packed;
+    }
+  } else if (filter->type == kTfLiteInt8) {
+    // As in FULLY_CONNECTED, input_offset * sum(filter) is added to the bias
+    // once instead of adding input_offset to every input. The bias goes first
+    // to keep it aligned.
+    const size_t packed_channels = packed_size / accum_depth;
+    int32_t* packed_bias = static_cast<int32_t*>(AllocatePackedWeights(
+        context, packed_channels * sizeof(int32_t) + packed_size));
+    if (packed_bias == nullptr) {
+      return kTfLiteOk;
+    }
+    int8_t* packed = reinterpret_cast<int8_t*>(packed_bias + packed_channels);
+    const int8_t* filter_data = GetTensorData<int8_t>(filter);
+    const int32_t* bias_data =
+        bias != nullptr ? GetTensorData<int32_t>(bias) : nullptr;
+    const int32_t input_offset = -data->input_zero_point;
+    for (size_t c = 0; c < packed_channels; ++c) {
+      int32_t filter_sum = 0;
+      if (static_cast<int>(c) < output_depth) {
+        for (int d = 0; d < accum_depth; ++d) {
+          filter_sum += filter_data[c * accum_depth + d];
+        }
+      }
+      packed_bias[c] =
+          (bias_data != nullptr && static_cast<int>(c) < output_depth
+               ? bias_data[c]
+               : 0) +
+          input_offset * filter_sum;
+    }
+    PackWeightPanels(filter_data, output_depth, accum_depth, packed);
+    data->packed_filter = packed;
+    data->packed_bias = packed_bias;
+  }
+  return kTfLiteOk;
+}
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
   return context->AllocatePersistentBuffer(context, sizeof(OpData));
@@ -134,6 +244,18 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
   TF_LITE_ENSURE(context, filter != nullptr);
 
+  // Float16 filters that are not packed are widened as they are read, which
+  // needs finite values.
+  if (filter->type == kTfLiteFloat16) {
+    TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_MSG(
+        context,
+        IsConstantTensor(filter) &&
+            tflite::micro::AllFiniteFloat16(
+                GetTensorData<TfLiteFloat16>(filter), NumElements(filter)),
+        "Float16 filters must be constant and finite.");
+  }
+
   int input_width = input->dims->data[2];
   int input_height = input->dims->data[1];
   int filter_width = filter->dims->data[2];
@@ -177,15 +299,447 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   data->filter_zero_point = filter->params.zero_point;
   data->output_zero_point = output->params.zero_point;
 
-  return kTfLiteOk;
+  PrepareStreamingOutput(
+      context, node->inputs->data[kInputTensor],
+      node->outputs->data[kOutputTensor], params->stride_height,
+      WindowReadsPadding(input_height, output_height, filter_height,
+                         params->stride_height,
+                         params->dilation_height_factor, data->padding.height),
+      /*cache_output=*/true);
+
+  // With a vector unit, 1-D layers are faster reading the filter rows as
+  // stored, see Conv1DPerChannel(), and need no packed copy. A float16 filter
+  // is still widened once if the packing budget has room for it.
+  data->widened_filter = nullptr;
+  if (tflite::micro::kHasVectorDotProduct &&
+      GetConv1DAxis(input_height, input_width, filter_height, filter_width,
+                    output_height, output_width,
+                    params->dilation_height_factor,
+                    params->dilation_width_factor) != Conv1DAxis::kNone) {
+    data->packed_filter = nullptr;
+    data->packed_bias = nullptr;
+    if (filter->type == kTfLiteFloat16) {
+      float* widened = static_cast<float*>(
+          AllocatePackedWeights(context, NumElements(filter) * sizeof(float)));
+      if (widened != nullptr) {
+        tflite::micro::WidenFloat16(GetTensorData<TfLiteFloat16>(filter),
+                                    NumElements(filter), widened);
+        data->widened_filter = widened;
+      }
+    }
+    return kTfLiteOk;
+  }
+  return PackFilter(context, filter,
+                    GetOptionalInputTensor(context, node, kBiasTensor), data);
 }  // namespace conv
 
+// Adds the products of `count` inputs, read from `input` or equal to
+// `pad_value` when `input` is nullptr, and their packed weights to the four
+// accumulators of a panel. Returns the weights of the next count inputs.
+template <typename T, typename AccT>
+inline const T* AccumulatePanel(const T* input, AccT pad_value, int count,
+                                const T* weights, AccT* acc) {
+  AccT acc0 = acc[0];
+  AccT acc1 = acc[1];
+  AccT acc2 = acc[2];
+  AccT acc3 = acc[3];
+  if (input != nullptr) {
+    for (int i = 0; i < count; ++i) {
+      const AccT input_value = input[i];
+      acc0 += input_value * weights[0];
+      acc1 += input_value * weights[1];
+      acc2 += input_value * weights[2];
+      acc3 += input_value * weights[3];
+      weights += kWeightPanelWidth;
+    }
+  } else {
+    for (int i = 0; i < count; ++i) {
+      acc0 += pad_value * weights[0];
+      acc1 += pad_value * weights[1];
+      acc2 += pad_value * weights[2];
+      acc3 += pad_value * weights[3];
+      weights += kWeightPanelWidth;
+    }
+  }
+  acc[0] = acc0;
+  acc[1] = acc1;
+  acc[2] = acc2;
+  acc[3] = acc3;
+  return weights;
+}
+
+// Finishes the channels of a panel of a float convolution. The bias is added
+// last, like in the reference kernel.
+inline void StorePanel(const ConvParams& params, const float* bias_data,
+                       int panel, int output_depth, const float* acc,
+                       float* output) {
+  for (int lane = 0; lane < kWeightPanelWidth; ++lane) {
+    const int c = panel + lane;
+    if (c < output_depth) {
+      const float bias_value = bias_data != nullptr ? bias_data[c] : 0.0f;
+      output[c] = ActivationFunctionWithMinMax(acc[lane] + bias_value,
+                                               params.float_activation_min,
+                                               params.float_activation_max);
+    }
+  }
+}
+
+// Finishes the channels of a panel of an int8 convolution, whose bias is
+// already folded into the packed bias.
+inline void StorePanel(const ConvParams& params, const OpData& data, int panel,
+                       int output_depth, const int32_t* acc, int8_t* output) {
+  for (int lane = 0; lane < kWeightPanelWidth; ++lane) {
+    const int c = panel + lane;
+    if (c < output_depth) {
+      int32_t value = MultiplyByQuantizedMultiplier(
+          acc[lane], data.per_channel_output_multiplier[c],
+          data.per_channel_output_shift[c]);
+      value += params.output_offset;
+      value = std::max(value, params.quantized_activation_min);
+      value = std::min(value, params.quantized_activation_max);
+      output[c] = static_cast<int8_t>(value);
+    }
+  }
+}
+
+// Computes `slice` (see ParallelConv()) of a convolution from a filter packed
+// by PackFilter(), kWeightPanelWidth output channels at a time. Float filter
+// taps outside the input are skipped like in the reference kernel, so both
+// produce identical results. For int8 they read the input zero point instead,
+// which cancels the input offset folded into the packed bias. `output_stage`
+// is what StorePanel() needs to finish the channels: the bias for float and
+// `data` for int8.
+template <typename T, typename AccT, typename OutputStage>
+void PackedConv(const ConvParams& params, const OpData& data,
+                const tflite::micro::ConvSlice& slice,
+                const RuntimeShape& filter_shape, const T* input_data,
+                const OutputStage& output_stage, AccT pad_value,
+                bool skip_padding, T* output_data) {
+  const int batches = slice.output_shape.Dims(0);
+  const int input_height = slice.input_shape.Dims(1);
+  const int input_width = slice.input_shape.Dims(2);
+  const int input_depth = slice.input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = slice.output_shape.Dims(1);
+  const int output_width = slice.output_shape.Dims(2);
+  const int output_depth = slice.output_shape.Dims(3);
+  const int accum_depth = filter_height * filter_width * input_depth;
+  const T* packed_filter = static_cast<const T*>(data.packed_filter);
+  input_data += slice.input_offset;
+  output_data += slice.output_offset;
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          out_y * params.stride_height - slice.padding_height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            out_x * params.stride_width - params.padding_values.width;
+        T* output = output_data + Offset(slice.output_shape, batch, out_y,
+                                         out_x, 0);
+        for (int panel = 0; panel < output_depth; panel += kWeightPanelWidth) {
+          const T* weights = packed_filter + panel * accum_depth;
+          AccT acc[kWeightPanelWidth];
+          for (int lane = 0; lane < kWeightPanelWidth; ++lane) {
+            acc[lane] = data.packed_bias != nullptr
+                            ? data.packed_bias[panel + lane]
+                            : 0;
+          }
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            const int in_y =
+                in_y_origin + params.dilation_height_factor * filter_y;
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              const int in_x =
+                  in_x_origin + params.dilation_width_factor * filter_x;
+              const bool is_point_inside_image =
+                  (in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+                  (in_y < input_height);
+              if (is_point_inside_image) {
+                weights = AccumulatePanel(
+                    input_data +
+                        Offset(slice.input_shape, batch, in_y, in_x, 0),
+                    pad_value, input_depth, weights, acc);
+              } else if (skip_padding) {
+                weights += kWeightPanelWidth * input_depth;
+              } else {
+                weights = AccumulatePanel<T, AccT>(nullptr, pad_value,
+                                                   input_depth, weights, acc);
+              }
+            }
+          }
+          StorePanel(params, output_stage, panel, output_depth, acc, output);
+        }
+      }
+    }
+  }
+}
+
+// A slice of a CONV_2D whose input and filter are both 1 wide (or both 1
+// high) and that is not dilated along the other axis. The taps of each output
+// position then cover a contiguous run of filter_length * depth input values,
+// which can be multiplied with a filter row in place, without im2col.
+struct Conv1DGeometry {
+  int batches;
+  int input_length;
+  int output_length;
+  int filter_length;
+  // Number of input channels.
+  int depth;
+  // Number of output channels.
+  int output_depth;
+  int stride;
+  int padding;
+};
+
+// Returns true and fills `geometry` if `slice` is a 1-D convolution.
+bool GetConv1DGeometry(const ConvParams& params,
+                       const tflite::micro::ConvSlice& slice,
+                       const RuntimeShape& filter_shape,
+                       Conv1DGeometry* geometry) {
+  const int input_height = slice.input_shape.Dims(1);
+  const int input_width = slice.input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = slice.output_shape.Dims(1);
+  const int output_width = slice.output_shape.Dims(2);
+
+  switch (GetConv1DAxis(input_height, input_width, filter_height, filter_width,
+                        output_height, output_width,
+                        params.dilation_height_factor,
+                        params.dilation_width_factor)) {
+    case Conv1DAxis::kHeight:
+      geometry->input_length = input_height;
+      geometry->output_length = output_height;
+      geometry->filter_length = filter_height;
+      geometry->stride = params.stride_height;
+      geometry->padding = slice.padding_height;
+      break;
+    case Conv1DAxis::kWidth:
+      geometry->input_length = input_width;
+      geometry->output_length = output_width;
+      geometry->filter_length = filter_width;
+      geometry->stride = params.stride_width;
+      geometry->padding = params.padding_values.width;
+      break;
+    case Conv1DAxis::kNone:
+      return false;
+  }
+  geometry->batches = slice.output_shape.Dims(0);
+  geometry->depth = slice.input_shape.Dims(3);
+  geometry->output_depth = slice.output_shape.Dims(3);
+  return true;
+}
+
+// Returns the range [*first_tap, *end_tap) of filter taps of output position
+// `position` that fall inside the input.
+inline void Conv1DTaps(const Conv1DGeometry& geometry, int position,
+                       int* first_tap, int* end_tap) {
+  const int start = position * geometry.stride - geometry.padding;
+  *first_tap = std::max(0, -start);
+  *end_tap = std::min(geometry.filter_length, geometry.input_length - start);
+  if (*end_tap < *first_tap) {
+    *end_tap = *first_tap;
+  }
+}
+
+// Int8 1-D convolution from the filter as stored in the model. Each channel
+// adds input_offset * sum(filter row) once for all positions whose taps are
+// inside the input, instead of adding input_offset to every input.
+void Conv1DPerChannel(const ConvParams& params, const OpData& data,
+                      const Conv1DGeometry& geometry, const int8_t* input_data,
+                      const int8_t* filter_data, const int32_t* bias_data,
+                      int8_t* output_data) {
+  const int depth = geometry.depth;
+  const int window = geometry.filter_length * depth;
+  for (int c = 0; c < geometry.output_depth; ++c) {
+    const int8_t* filter = filter_data + c * window;
+    const int32_t full_offset =
+        params.input_offset * tflite::micro::SumInt8(filter, window);
+    const int32_t bias_value = bias_data != nullptr ? bias_data[c] : 0;
+    for (int batch = 0; batch < geometry.batches; ++batch) {
+      const int8_t* input = input_data + batch * geometry.input_length * depth;
+      int8_t* output =
+          output_data + batch * geometry.output_length * geometry.output_depth;
+      for (int position = 0; position < geometry.output_length; ++position) {
+        int first_tap, end_tap;
+        Conv1DTaps(geometry, position, &first_tap, &end_tap);
+        const int8_t* taps = filter + first_tap * depth;
+        const int count = (end_tap - first_tap) * depth;
+        int32_t acc = tflite::micro::DotProductInt8(
+            input + (position * geometry.stride - geometry.padding +
+                     first_tap) *
+                        depth,
+            taps, count);
+        acc += count == window
+                   ? full_offset
+                   : params.input_offset * tflite::micro::SumInt8(taps, count);
+        acc += bias_value;
+        acc = MultiplyByQuantizedMultiplier(
+            acc, data.per_channel_output_multiplier[c],
+            data.per_channel_output_shift[c]);
+        acc += params.output_offset;
+        acc = std::max(acc, params.quantized_activation_min);
+        acc = std::min(acc, params.quantized_activation_max);
+        output[position * geometry.output_depth + c] = static_cast<int8_t>(acc);
+      }
+    }
+  }
+}
+
+// Float 1-D convolution from a float or float16 filter as stored in the
+// model. See DotProductFloat() for how results compare to the reference
+// kernel.
+template <typename WeightT>
+void Conv1DFloat(const ConvParams& params, const Conv1DGeometry& geometry,
+                 const float* input_data, const WeightT* filter_data,
+                 const float* bias_data, float* output_data) {
+  const int depth = geometry.depth;
+  const int window = geometry.filter_length * depth;
+  for (int c = 0; c < geometry.output_depth; ++c) {
+    const WeightT* filter = filter_data + c * window;
+    const float bias_value = bias_data != nullptr ? bias_data[c] : 0.0f;
+    for (int batch = 0; batch < geometry.batches; ++batch) {
+      const float* input = input_data + batch * geometry.input_length * depth;
+      float* output =
+          output_data + batch * geometry.output_length * geometry.output_depth;
+      for (int position = 0; position < geometry.output_length; ++position) {
+        int first_tap, end_tap;
+        Conv1DTaps(geometry, position, &first_tap, &end_tap);
+        const float total = tflite::micro::DotProductFloat(
+            input + (position * geometry.stride - geometry.padding +
+                     first_tap) *
+                        depth,
+            filter + first_tap * depth, (end_tap - first_tap) * depth);
+        output[position * geometry.output_depth + c] =
+            ActivationFunctionWithMinMax(total + bias_value,
+                                         params.float_activation_min,
+                                         params.float_activation_max);
+      }
+    }
+  }
+}
+
+// Float convolution of `slice` (see ParallelConv()) from a float16 filter that
+// was not packed, widening every weight as it is read. The products are added
+// in the same order as in the reference kernel, so both produce identical
+// results for the same weights, see FiniteFloat16ToFloat().
+void Float16Conv(const ConvParams& params,
+                 const tflite::micro::ConvSlice& slice,
+                 const RuntimeShape& filter_shape, const float* input_data,
+                 const TfLiteFloat16* filter_data, const float* bias_data,
+                 float* output_data) {
+  const int batches = slice.output_shape.Dims(0);
+  const int input_height = slice.input_shape.Dims(1);
+  const int input_width = slice.input_shape.Dims(2);
+  const int input_depth = slice.input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = slice.output_shape.Dims(1);
+  const int output_width = slice.output_shape.Dims(2);
+  const int output_depth = slice.output_shape.Dims(3);
+  input_data += slice.input_offset;
+  output_data += slice.output_offset;
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          out_y * params.stride_height - slice.padding_height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            out_x * params.stride_width - params.padding_values.width;
+        float* output = output_data + Offset(slice.output_shape, batch, out_y,
+                                             out_x, 0);
+        for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+          float total = 0.0f;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            const int in_y =
+                in_y_origin + params.dilation_height_factor * filter_y;
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              const int in_x =
+                  in_x_origin + params.dilation_width_factor * filter_x;
+              if (in_x < 0 || in_x >= input_width || in_y < 0 ||
+                  in_y >= input_height) {
+                continue;
+              }
+              const float* input =
+                  input_data + Offset(slice.input_shape, batch, in_y, in_x, 0);
+              const TfLiteFloat16* filter =
+                  filter_data +
+                  Offset(filter_shape, out_channel, filter_y, filter_x, 0);
+              for (int in_channel = 0; in_channel < input_depth;
+                   ++in_channel) {
+                const float filter_value =
+                    tflite::micro::FiniteFloat16ToFloat(filter[in_channel]);
+                total += input[in_channel] * filter_value;
+              }
+            }
+          }
+          const float bias_value =
+              bias_data != nullptr ? bias_data[out_channel] : 0.0f;
+          output[out_channel] = ActivationFunctionWithMinMax(
+              total + bias_value, params.float_activation_min,
+              params.float_activation_max);
+        }
+      }
+    }
+  }
+}
+
+// 1-D convolution from a filter packed by PackFilter(), see PackedConv().
+// The taps inside the input are accumulated in a single run.
+template <typename T, typename AccT, typename OutputStage>
+void PackedConv1D(const ConvParams& params, const OpData& data,
+                  const Conv1DGeometry& geometry, const T* input_data,
+                  const OutputStage& output_stage, AccT pad_value,
+                  bool skip_padding, T* output_data) {
+  const int depth = geometry.depth;
+  const int window = geometry.filter_length * depth;
+  const T* packed_filter = static_cast<const T*>(data.packed_filter);
+  for (int batch = 0; batch < geometry.batches; ++batch) {
+    const T* input = input_data + batch * geometry.input_length * depth;
+    for (int position = 0; position < geometry.output_length; ++position) {
+      int first_tap, end_tap;
+      Conv1DTaps(geometry, position, &first_tap, &end_tap);
+      const T* taps_input =
+          input +
+          (position * geometry.stride - geometry.padding + first_tap) * depth;
+      T* output = output_data + (batch * geometry.output_length + position) *
+                                    geometry.output_depth;
+      for (int panel = 0; panel < geometry.output_depth;
+           panel += kWeightPanelWidth) {
+        const T* weights = packed_filter + panel * window;
+        AccT acc[kWeightPanelWidth];
+        for (int lane = 0; lane < kWeightPanelWidth; ++lane) {
+          acc[lane] = data.packed_bias != nullptr
+                          ? data.packed_bias[panel + lane]
+                          : 0;
+        }
+        if (!skip_padding) {
+          AccumulatePanel<T, AccT>(nullptr, pad_value, first_tap * depth,
+                                   weights, acc);
+        }
+        weights = AccumulatePanel(
+            taps_input, pad_value, (end_tap - first_tap) * depth,
+            weights + kWeightPanelWidth * first_tap * depth, acc);
+        if (!skip_padding) {
+          AccumulatePanel<T, AccT>(nullptr, pad_value,
+                                   (geometry.filter_length - end_tap) * depth,
+                                   weights, acc);
+        }
+        StorePanel(params, output_stage, panel, geometry.output_depth, acc,
+                   output);
+      }
+    }
+  }
+}
+
 void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                    TfLiteConvParams* params, const OpData& data,
                    const TfLiteEvalTensor* input,
                    const TfLiteEvalTensor* filter, const TfLiteEvalTensor* bias,
                    TfLiteEvalTensor* im2col, TfLiteEvalTensor* hwcn_weights,
-                   TfLiteEvalTensor* output) {
+                   TfLiteEvalTensor* output, int first_row) {
   const int32_t input_offset = -data.input_zero_point;
   const int32_t filter_offset = -data.filter_zero_point;
   const int32_t output_offset = data.output_zero_point;
@@ -206,16 +760,30 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   op_params.output_shift = -data.output_shift;
   op_params.quantized_activation_min = data.output_activation_min;
   op_params.quantized_activation_max = data.output_activation_max;
-  reference_ops::Conv(op_params, tflite::micro::GetTensorShape(input),
-                      tflite::micro::GetTensorData<uint8_t>(input),
-                      tflite::micro::GetTensorShape(filter),
-                      tflite::micro::GetTensorData<uint8_t>(filter),
-                      tflite::micro::GetTensorShape(bias),
-                      tflite::micro::GetTensorData<int32_t>(bias),
-                      tflite::micro::GetTensorShape(output),
-                      tflite::micro::GetTensorData<uint8_t>(output),
-                      tflite::micro::GetTensorShape(im2col),
-                      tflite::micro::GetTensorData<uint8_t>(im2col), nullptr);
+
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape bias_shape = tflite::micro::GetTensorShape(bias);
+  const uint8_t* input_data = tflite::micro::GetTensorData<uint8_t>(input);
+  const uint8_t* filter_data = tflite::micro::GetTensorData<uint8_t>(filter);
+  const int32_t* bias_data = tflite::micro::GetTensorData<int32_t>(bias);
+  uint8_t* output_data = tflite::micro::GetTensorData<uint8_t>(output);
+  tflite::micro::ParallelConv(
+      context, tflite::micro::GetTensorShape(input),
+      tflite::micro::GetTensorShape(output),
+      filter_shape.FlatSize() / filter_shape.Dims(0), op_params.stride_height,
+      op_params.padding_values.height, first_row,
+      [&](const tflite::micro::ConvSlice& slice) {
+        ConvParams slice_params = op_params;
+        slice_params.padding_values.height = slice.padding_height;
+        reference_ops::Conv(slice_params, slice.input_shape,
+                            input_data + slice.input_offset, filter_shape,
+                            filter_data, bias_shape, bias_data,
+                            slice.output_shape,
+                            output_data + slice.output_offset,
+                            tflite::micro::GetTensorShape(im2col),
+                            tflite::micro::GetTensorData<uint8_t>(im2col),
+                            nullptr);
+      });
 }
 
 void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
@@ -224,7 +792,7 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
                              const TfLiteEvalTensor* filter,
                              const TfLiteEvalTensor* bias,
                              TfLiteEvalTensor* output,
-                             TfLiteEvalTensor* im2col) {
+                             TfLiteEvalTensor* im2col, int first_row) {
   // TODO(b/154032858): Investigate removing extra copies.
   ConvParams op_params;
   op_params.input_offset = -data.input_zero_point;
@@ -238,23 +806,54 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
   op_params.quantized_activation_min = data.output_activation_min;
   op_params.quantized_activation_max = data.output_activation_max;
 
-  reference_integer_ops::ConvPerChannel(
-      op_params, data.per_channel_output_multiplier,
-      data.per_channel_output_shift, tflite::micro::GetTensorShape(input),
-      tflite::micro::GetTensorData<int8_t>(input),
-      tflite::micro::GetTensorShape(filter),
-      tflite::micro::GetTensorData<int8_t>(filter),
-      tflite::micro::GetTensorShape(bias),
-      tflite::micro::GetTensorData<int32_t>(bias),
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape bias_shape = tflite::micro::GetTensorShape(bias);
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  const int32_t* bias_data = tflite::micro::GetTensorData<int32_t>(bias);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  tflite::micro::ParallelConv(
+      context, tflite::micro::GetTensorShape(input),
       tflite::micro::GetTensorShape(output),
-      tflite::micro::GetTensorData<int8_t>(output));
+      filter_shape.FlatSize() / filter_shape.Dims(0), op_params.stride_height,
+      op_params.padding_values.height, first_row,
+      [&](const tflite::micro::ConvSlice& slice) {
+        Conv1DGeometry geometry;
+        const bool is_1d =
+            GetConv1DGeometry(op_params, slice, filter_shape, &geometry);
+        if (is_1d && data.packed_filter != nullptr) {
+          PackedConv1D<int8_t, int32_t>(op_params, data, geometry,
+                                        input_data + slice.input_offset,
+                                        data, data.input_zero_point,
+                                        /*skip_padding=*/false,
+                                        output_data + slice.output_offset);
+        } else if (is_1d) {
+          Conv1DPerChannel(op_params, data, geometry,
+                           input_data + slice.input_offset, filter_data,
+                           bias_data, output_data + slice.output_offset);
+        } else if (data.packed_filter != nullptr) {
+          PackedConv<int8_t, int32_t>(op_params, data, slice, filter_shape,
+                                      input_data, data, data.input_zero_point,
+                                      /*skip_padding=*/false, output_data);
+        } else {
+          ConvParams slice_params = op_params;
+          slice_params.padding_values.height = slice.padding_height;
+          reference_integer_ops::ConvPerChannel(
+              slice_params, data.per_channel_output_multiplier,
+              data.per_channel_output_shift, slice.input_shape,
+              input_data + slice.input_offset, filter_shape, filter_data,
+              bias_shape, bias_data, slice.output_shape,
+              output_data + slice.output_offset);
+        }
+      });
 }
 
 void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteConvParams* params, const OpData& data,
                const TfLiteEvalTensor* input, const TfLiteEvalTensor* filter,
                const TfLiteEvalTensor* bias, TfLiteEvalTensor* im2col,
-               TfLiteEvalTensor* hwcn_weights, TfLiteEvalTensor* output) {
+               TfLiteEvalTensor* hwcn_weights, TfLiteEvalTensor* output,
+               int first_row) {
   float output_activation_min, output_activation_max;
   CalculateActivationRange(params->activation, &output_activation_min,
                            &output_activation_max);
@@ -270,16 +869,59 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
 
-  reference_ops::Conv(op_params, tflite::micro::GetTensorShape(input),
-                      tflite::micro::GetTensorData<float>(input),
-                      tflite::micro::GetTensorShape(filter),
-                      tflite::micro::GetTensorData<float>(filter),
-                      tflite::micro::GetTensorShape(bias),
-                      tflite::micro::GetTensorData<float>(bias),
-                      tflite::micro::GetTensorShape(output),
-                      tflite::micro::GetTensorData<float>(output),
-                      tflite::micro::GetTensorShape(im2col),
-                      tflite::micro::GetTensorData<float>(im2col));
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape bias_shape = tflite::micro::GetTensorShape(bias);
+  const float* input_data = tflite::micro::GetTensorData<float>(input);
+  const float* filter_data = data.widened_filter != nullptr
+                                ? data.widened_filter
+                                : tflite::micro::GetTensorData<float>(filter);
+  const TfLiteFloat16* float16_filter_data =
+      filter->type == kTfLiteFloat16 && data.widened_filter == nullptr
+          ? tflite::micro::GetTensorData<TfLiteFloat16>(filter)
+          : nullptr;
+  const float* bias_data = tflite::micro::GetTensorData<float>(bias);
+  float* output_data = tflite::micro::GetTensorData<float>(output);
+  tflite::micro::ParallelConv(
+      context, tflite::micro::GetTensorShape(input),
+      tflite::micro::GetTensorShape(output),
+      filter_shape.FlatSize() / filter_shape.Dims(0), op_params.stride_height,
+      op_params.padding_values.height, first_row,
+      [&](const tflite::micro::ConvSlice& slice) {
+        Conv1DGeometry geometry;
+        const bool is_1d =
+            GetConv1DGeometry(op_params, slice, filter_shape, &geometry);
+        if (is_1d && data.packed_filter != nullptr) {
+          PackedConv1D<float, float>(op_params, data, geometry,
+                                     input_data + slice.input_offset,
+                                     bias_data, 0.0f, /*skip_padding=*/true,
+                                     output_data + slice.output_offset);
+        } else if (is_1d && float16_filter_data != nullptr) {
+          Conv1DFloat(op_params, geometry, input_data + slice.input_offset,
+                      float16_filter_data, bias_data,
+                      output_data + slice.output_offset);
+        } else if (is_1d) {
+          Conv1DFloat(op_params, geometry, input_data + slice.input_offset,
+                      filter_data, bias_data,
+                      output_data + slice.output_offset);
+        } else if (data.packed_filter != nullptr) {
+          PackedConv<float, float>(op_params, data, slice, filter_shape,
+                                   input_data, bias_data, 0.0f,
+                                   /*skip_padding=*/true, output_data);
+        } else if (float16_filter_data != nullptr) {
+          Float16Conv(op_params, slice, filter_shape, input_data,
+                      float16_filter_data, bias_data, output_data);
+        } else {
+          ConvParams slice_params = op_params;
+          slice_params.padding_values.height = slice.padding_height;
+          reference_ops::Conv(slice_params, slice.input_shape,
+                              input_data + slice.input_offset, filter_shape,
+                              filter_data, bias_shape, bias_data,
+                              slice.output_shape,
+                              output_data + slice.output_offset,
+                              tflite::micro::GetTensorShape(im2col),
+                              tflite::micro::GetTensorData<float>(im2col));
+        }
+      });
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
@@ -300,27 +942,37 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const OpData& data = *(static_cast<const OpData*>(node->user_data));
 
   TF_LITE_ENSURE_EQ(context, input->type, output->type);
-  TF_LITE_ENSURE_MSG(context, input->type == filter->type,
+  // A float16 filter is only a smaller encoding of a float one.
+  TF_LITE_ENSURE_MSG(context,
+                     input->type == filter->type ||
+                         (input->type == kTfLiteFloat32 &&
+                          filter->type == kTfLiteFloat16),
                      "Hybrid models are not supported on TFLite Micro.");
 
+  // Rows the previous window of a stream already computed are taken from its
+  // cache, see MicroInterpreter::SetStreamingHop().
+  const int output_index = node->outputs->data[kOutputTensor];
+  const int first_row = BeginStreamingOutput(context, output_index, output);
+
   switch (input->type) {  // Already know in/out types are same.
     case kTfLiteFloat32:
       EvalFloat(context, node, params, data, input, filter, bias, nullptr,
-                nullptr, output);
+                nullptr, output, first_row);
       break;
     case kTfLiteInt8:
       EvalQuantizedPerChannel(context, node, params, data, input, filter, bias,
-                              output, nullptr);
+                              output, nullptr, first_row);
       break;
     case kTfLiteUInt8:
       EvalQuantized(context, node, params, data, input, filter, bias, nullptr,
-                    nullptr, output);
+                    nullptr, output, first_row);
       break;
     default:
       TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
                          TfLiteTypeGetName(input->type), input->type);
       return kTfLiteError;
   }
+  EndStreamingOutput(context, output_index, output, first_row);
   return kTfLiteOk;
 }
 
@@ -0,0 +1,407 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_CONVERSION_UTIL_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_CONVERSION_UTIL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/cppmath.h"
+#include "tensorflow/lite/micro/kernels/simd_util.h"
+
+// Bulk conversions between float, raw integer samples and quantized tensors.
+// Every backend returns exactly what the reference kernels do: quantization
+// rounds halves away from zero like TfLiteRound() and requantization uses
+// MultiplyByQuantizedMultiplier().
+
+namespace tflite {
+namespace micro {
+
+namespace conversion_internal {
+
+// Scalar version of QuantizeFloat(). The value is clamped before rounding, so
+// out-of-range inputs saturate instead of overflowing the conversion to an
+// integer. NaN becomes min_value, like the reference kernels on most targets.
+template <typename T>
+inline T QuantizeValue(float value, float scale, int32_t zero_point,
+                       int32_t min_value, int32_t max_value) {
+  const float scaled = value / scale;
+  if (sizeof(T) < 4) {
+    // The bounds are exact in float.
+    const float lower = static_cast<float>(min_value - zero_point);
+    const float upper = static_cast<float>(max_value - zero_point);
+    const float clamped_lower = lower < scaled ? scaled : lower;
+    const float clamped = clamped_lower < upper ? clamped_lower : upper;
+    return static_cast<T>(static_cast<int32_t>(TfLiteRound(clamped)) +
+                          zero_point);
+  }
+  const double lower = static_cast<double>(min_value) - zero_point;
+  const double upper = static_cast<double>(max_value) - zero_point;
+  const double clamped_lower = lower < scaled ? scaled : lower;
+  const double clamped = clamped_lower < upper ? clamped_lower : upper;
+  return static_cast<T>(static_cast<int64_t>(TfLiteRound(clamped)) +
+                        zero_point);
+}
+
+#if defined(TF_LITE_MICRO_SSE2)
+// Returns clamp(round(input / scale), lower, upper) for four values.
+inline __m128i QuantizeFloat4(__m128 input, __m128 scale, __m128 lower,
+                              __m128 upper) {
+  // _mm_max_ps(x, lower) is (x > lower) ? x : lower, so NaN becomes lower.
+  const __m128 clamped =
+      _mm_min_ps(_mm_max_ps(_mm_div_ps(input, scale), lower), upper);
+  // Truncate, then move a step away from zero when the dropped fraction is at
+  // least a half. The fraction is exact in float.
+  const __m128i truncated = _mm_cvttps_epi32(clamped);
+  const __m128 fraction = _mm_sub_ps(clamped, _mm_cvtepi32_ps(truncated));
+  const __m128i round_up =
+      _mm_castps_si128(_mm_cmpge_ps(fraction, _mm_set1_ps(0.5f)));
+  const __m128i round_down =
+      _mm_castps_si128(_mm_cmple_ps(fraction, _mm_set1_ps(-0.5f)));
+  return _mm_add_epi32(_mm_sub_epi32(truncated, round_up), round_down);
+}
+
+// Returns static_cast<float>(scale * input) for four values, computed in
+// double like the reference Dequantize().
+inline __m128 DequantizeInt4(__m128i input, __m128d scale) {
+  const __m128 low = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtepi32_pd(input), scale));
+  const __m128 high = _mm_cvtpd_ps(_mm_mul_pd(
+      _mm_cvtepi32_pd(_mm_shuffle_epi32(input, _MM_SHUFFLE(1, 0, 3, 2))),
+      scale));
+  return _mm_movelh_ps(low, high);
+}
+
+// MultiplyByQuantizedMultiplier() of four values with multiplier >= 0.
+// SSE2 has no signed 32x32->64 multiply, so the magnitudes are multiplied and
+// the rounding of SaturatingRoundingDoublingHighMul() is applied per sign.
+// That cannot saturate since the multiplier is below 2^31.
+inline __m128i MultiplyByQuantizedMultiplier4(__m128i x, __m128i multiplier,
+                                              int left_shift,
+                                              int right_shift) {
+  const __m128i a = _mm_sll_epi32(x, _mm_cvtsi32_si128(left_shift));
+  const __m128i sign = _mm_srai_epi32(a, 31);
+  const __m128i magnitude = _mm_sub_epi32(_mm_xor_si128(a, sign), sign);
+  // Nudge of 2^30 for positive products and 2^30 - 1 for negative ones, so
+  // the shifted magnitude is the rounded high half.
+  const __m128i nudge = _mm_set_epi32(0, 1 << 30, 0, 1 << 30);
+  const __m128i product_even = _mm_add_epi64(
+      _mm_add_epi64(_mm_mul_epu32(magnitude, multiplier), nudge),
+      _mm_shuffle_epi32(sign, _MM_SHUFFLE(2, 2, 0, 0)));
+  const __m128i product_odd = _mm_add_epi64(
+      _mm_add_epi64(
+          _mm_mul_epu32(_mm_srli_epi64(magnitude, 32), multiplier), nudge),
+      _mm_shuffle_epi32(sign, _MM_SHUFFLE(3, 3, 1, 1)));
+  const __m128i high = _mm_or_si128(
+      _mm_and_si128(_mm_srli_epi64(product_even, 31),
+                    _mm_set_epi32(0, -1, 0, -1)),
+      _mm_slli_epi64(_mm_srli_epi64(product_odd, 31), 32));
+  const __m128i rounded = _mm_sub_epi32(_mm_xor_si128(high, sign), sign);
+
+  // RoundingDivideByPOT().
+  const __m128i mask = _mm_set1_epi32((1 << right_shift) - 1);
+  const __m128i remainder = _mm_and_si128(rounded, mask);
+  const __m128i threshold = _mm_sub_epi32(_mm_srli_epi32(mask, 1),
+                                          _mm_srai_epi32(rounded, 31));
+  return _mm_sub_epi32(
+      _mm_sra_epi32(rounded, _mm_cvtsi32_si128(right_shift)),
+      _mm_cmpgt_epi32(remainder, threshold));
+}
+
+// Loads eight values widened to int32.
+inline void LoadInt32x8(const int8_t* input, __m128i* low, __m128i* high) {
+  const __m128i bytes =
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input));
+  const __m128i words = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+  *low = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+  *high = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+}
+
+inline void LoadInt32x8(const uint8_t* input, __m128i* low, __m128i* high) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i words = _mm_unpacklo_epi8(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input)), zero);
+  *low = _mm_unpacklo_epi16(words, zero);
+  *high = _mm_unpackhi_epi16(words, zero);
+}
+
+inline void LoadInt32x8(const int16_t* input, __m128i* low, __m128i* high) {
+  const __m128i words =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+  *low = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+  *high = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+}
+
+// Stores eight int32 values that are already within the range of the output
+// type, or saturates them to it.
+inline void StoreInt32x8(__m128i low, __m128i high, int8_t* output) {
+  const __m128i words = _mm_packs_epi32(low, high);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(output),
+                   _mm_packs_epi16(words, words));
+}
+
+inline void StoreInt32x8(__m128i low, __m128i high, uint8_t* output) {
+  const __m128i words = _mm_packs_epi32(low, high);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(output),
+                   _mm_packus_epi16(words, words));
+}
+
+inline void StoreInt32x8(__m128i low, __m128i high, int16_t* output) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+                   _mm_packs_epi32(low, high));
+}
+
+inline void StoreInt32x8(__m128i low, __m128i high, int32_t* output) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(output), low);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 4), high);
+}
+#elif defined(TF_LITE_MICRO_NEON)
+#if defined(__aarch64__)
+// Same as the SSE2 version. vcvtaq_s32_f32() rounds halves away from zero.
+inline int32x4_t QuantizeFloat4(float32x4_t input, float32x4_t scale,
+                                float32x4_t lower, float32x4_t upper) {
+  const float32x4_t scaled = vdivq_f32(input, scale);
+  const float32x4_t clamped_lower =
+      vbslq_f32(vcgtq_f32(scaled, lower), scaled, lower);
+  return vcvtaq_s32_f32(
+      vbslq_f32(vcltq_f32(clamped_lower, upper), clamped_lower, upper));
+}
+
+inline float32x4_t DequantizeInt4(int32x4_t input, float64x2_t scale) {
+  const float64x2_t low =
+      vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(input))), scale);
+  const float64x2_t high =
+      vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(input))), scale);
+  return vcombine_f32(vcvt_f32_f64(low), vcvt_f32_f64(high));
+}
+#endif
+
+inline int32x4_t MultiplyByQuantizedMultiplier4(int32x4_t x,
+                                                int32x4_t multiplier,
+                                                int left_shift,
+                                                int right_shift) {
+  return gemmlowp::RoundingDivideByPOT(
+      gemmlowp::SaturatingRoundingDoublingHighMul(
+          vshlq_s32(x, vdupq_n_s32(left_shift)), multiplier),
+      right_shift);
+}
+
+inline void LoadInt32x8(const int8_t* input, int32x4_t* low, int32x4_t* high) {
+  const int16x8_t words = vmovl_s8(vld1_s8(input));
+  *low = vmovl_s16(vget_low_s16(words));
+  *high = vmovl_s16(vget_high_s16(words));
+}
+
+inline void LoadInt32x8(const uint8_t* input, int32x4_t* low,
+                        int32x4_t* high) {
+  const uint16x8_t words = vmovl_u8(vld1_u8(input));
+  *low = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(words)));
+  *high = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(words)));
+}
+
+inline void LoadInt32x8(const int16_t* input, int32x4_t* low,
+                        int32x4_t* high) {
+  const int16x8_t words = vld1q_s16(input);
+  *low = vmovl_s16(vget_low_s16(words));
+  *high = vmovl_s16(vget_high_s16(words));
+}
+
+inline void StoreInt32x8(int32x4_t low, int32x4_t high, int8_t* output) {
+  vst1_s8(output,
+          vqmovn_s16(vcombine_s16(vqmovn_s32(low), vqmovn_s32(high))));
+}
+
+inline void StoreInt32x8(int32x4_t low, int32x4_t high, uint8_t* output) {
+  vst1_u8(output,
+          vqmovun_s16(vcombine_s16(vqmovn_s32(low), vqmovn_s32(high))));
+}
+
+inline void StoreInt32x8(int32x4_t low, int32x4_t high, int16_t* output) {
+  vst1q_s16(output, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+}
+
+inline void StoreInt32x8(int32x4_t low, int32x4_t high, int32_t* output) {
+  vst1q_s32(output, low);
+  vst1q_s32(output + 4, high);
+}
+#endif
+
+}  // namespace conversion_internal
+
+// Sets output[i] = clamp(round(input[i] / scale) + zero_point, min_value,
+// max_value) for i in [0, size), which is AffineQuantize() with the clamp of
+// a fused activation or symmetric range folded in. [min_value, max_value] must
+// lie within the range of T.
+template <typename T>
+void QuantizeFloat(const float* input, int size, float scale,
+                   int32_t zero_point, int32_t min_value, int32_t max_value,
+                   T* output) {
+  int i = 0;
+  if (sizeof(T) < 4) {
+#if defined(TF_LITE_MICRO_SSE2) || \
+    (defined(TF_LITE_MICRO_NEON) && defined(__aarch64__))
+#if defined(TF_LITE_MICRO_SSE2)
+    const __m128 scale4 = _mm_set1_ps(scale);
+    const __m128 lower =
+        _mm_set1_ps(static_cast<float>(min_value - zero_point));
+    const __m128 upper =
+        _mm_set1_ps(static_cast<float>(max_value - zero_point));
+    const __m128i offset = _mm_set1_epi32(zero_point);
+    for (; i + 8 <= size; i += 8) {
+      const __m128i low = _mm_add_epi32(
+          conversion_internal::QuantizeFloat4(_mm_loadu_ps(input + i), scale4,
+                                              lower, upper),
+          offset);
+      const __m128i high = _mm_add_epi32(
+          conversion_internal::QuantizeFloat4(_mm_loadu_ps(input + i + 4),
+                                              scale4, lower, upper),
+          offset);
+#else
+    const float32x4_t scale4 = vdupq_n_f32(scale);
+    const float32x4_t lower =
+        vdupq_n_f32(static_cast<float>(min_value - zero_point));
+    const float32x4_t upper =
+        vdupq_n_f32(static_cast<float>(max_value - zero_point));
+    const int32x4_t offset = vdupq_n_s32(zero_point);
+    for (; i + 8 <= size; i += 8) {
+      const int32x4_t low = vaddq_s32(
+          conversion_internal::QuantizeFloat4(vld1q_f32(input + i), scale4,
+                                              lower, upper),
+          offset);
+      const int32x4_t high = vaddq_s32(
+          conversion_internal::QuantizeFloat4(vld1q_f32(input + i + 4),
+                                              scale4, lower, upper),
+          offset);
+#endif
+      conversion_internal::StoreInt32x8(low, high, output + i);
+    }
+#endif
+  }
+  for (; i < size; ++i) {
+    output[i] = conversion_internal::QuantizeValue<T>(
+        input[i], scale, zero_point, min_value, max_value);
+  }
+}
+
+// Sets output[i] = scale * (input[i] - zero_point) for i in [0, size),
+// computed in double and rounded to float like the reference Dequantize().
+template <typename T>
+void DequantizeToFloat(const T* input, int size, double scale,
+                       int32_t zero_point, float* output) {
+  int i = 0;
+#if defined(TF_LITE_MICRO_SSE2)
+  if (sizeof(T) < 4) {
+    const __m128d scale2 = _mm_set1_pd(scale);
+    const __m128i offset = _mm_set1_epi32(zero_point);
+    for (; i + 8 <= size; i += 8) {
+      __m128i low, high;
+      conversion_internal::LoadInt32x8(input + i, &low, &high);
+      _mm_storeu_ps(output + i, conversion_internal::DequantizeInt4(
+                                    _mm_sub_epi32(low, offset), scale2));
+      _mm_storeu_ps(output + i + 4, conversion_internal::DequantizeInt4(
+                                        _mm_sub_epi32(high, offset), scale2));
+    }
+  }
+#elif defined(TF_LITE_MICRO_NEON) && defined(__aarch64__)
+  if (sizeof(T) < 4) {
+    const float64x2_t scale2 = vdupq_n_f64(scale);
+    const int32x4_t offset = vdupq_n_s32(zero_point);
+    for (; i + 8 <= size; i += 8) {
+      int32x4_t low, high;
+      conversion_internal::LoadInt32x8(input + i, &low, &high);
+      vst1q_f32(output + i, conversion_internal::DequantizeInt4(
+                                vsubq_s32(low, offset), scale2));
+      vst1q_f32(output + i + 4, conversion_internal::DequantizeInt4(
+                                    vsubq_s32(high, offset), scale2));
+    }
+  }
+#endif
+  for (; i < size; ++i) {
+    output[i] = static_cast<float>(
+        scale * (static_cast<int32_t>(input[i]) - zero_point));
+  }
+}
+
+// Sets output[i] = MultiplyByQuantizedMultiplier(input[i] - input_zero_point,
+// multiplier, shift) + output_zero_point, saturated to the range of OutputT,
+// for i in [0, size). This is the reference Requantize(). Raw integer samples,
+// such as the counts of an accelerometer, convert to a quantized input tensor
+// with input_zero_point 0 and the multiplier and shift of
+// sample_scale / tensor_scale from QuantizeMultiplier().
+template <typename InputT, typename OutputT>
+void RequantizeToType(const InputT* input, int size, int32_t multiplier,
+                      int shift, int32_t input_zero_point,
+                      int32_t output_zero_point, OutputT* output) {
+  int i = 0;
+#if defined(TF_LITE_MICRO_SSE2) || defined(TF_LITE_MICRO_NEON)
+  const int left_shift = shift > 0 ? shift : 0;
+  const int right_shift = shift > 0 ? 0 : -shift;
+  // The vector multiply needs a non-negative multiplier, which is all
+  // QuantizeMultiplier() produces for the positive scales of a requantize.
+  if (sizeof(InputT) < 4 && multiplier >= 0 && right_shift < 31) {
+#if defined(TF_LITE_MICRO_SSE2)
+    const __m128i multiplier4 = _mm_set1_epi32(multiplier);
+    const __m128i input_offset = _mm_set1_epi32(input_zero_point);
+    const __m128i output_offset = _mm_set1_epi32(output_zero_point);
+    for (; i + 8 <= size; i += 8) {
+      __m128i low, high;
+      conversion_internal::LoadInt32x8(input + i, &low, &high);
+      low = _mm_add_epi32(
+          conversion_internal::MultiplyByQuantizedMultiplier4(
+              _mm_sub_epi32(low, input_offset), multiplier4, left_shift,
+              right_shift),
+          output_offset);
+      high = _mm_add_epi32(
+          conversion_internal::MultiplyByQuantizedMultiplier4(
+              _mm_sub_epi32(high, input_offset), multiplier4, left_shift,
+              right_shift),
+          output_offset);
+#else
+    const int32x4_t multiplier4 = vdupq_n_s32(multiplier);
+    const int32x4_t input_offset = vdupq_n_s32(input_zero_point);
+    const int32x4_t output_offset = vdupq_n_s32(output_zero_point);
+    for (; i + 8 <= size; i += 8) {
+      int32x4_t low, high;
+      conversion_internal::LoadInt32x8(input + i, &low, &high);
+      low = vaddq_s32(conversion_internal::MultiplyByQuantizedMultiplier4(
+                          vsubq_s32(low, input_offset), multiplier4,
+                          left_shift, right_shift),
+                      output_offset);
+      high = vaddq_s32(conversion_internal::MultiplyByQuantizedMultiplier4(
+                           vsubq_s32(high, input_offset), multiplier4,
+                           left_shift, right_shift),
+                       output_offset);
+#endif
+      conversion_internal::StoreInt32x8(low, high, output + i);
+    }
+  }
+#endif
+  static constexpr int32_t kMinOutput = std::numeric_limits<OutputT>::min();
+  static constexpr int32_t kMaxOutput = std::numeric_limits<OutputT>::max();
+  for (; i < size; ++i) {
+    const int32_t value =
+        MultiplyByQuantizedMultiplier(input[i] - input_zero_point, multiplier,
+                                      shift) +
+        output_zero_point;
+    output[i] = static_cast<OutputT>(
+        std::min(std::max(value, kMinOutput), kMaxOutput));
+  }
+}
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_CONVERSION_UTIL_H_
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
 
+#include <algorithm>
+
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
@@ -25,6 +27,9 @@ limitations under the License.
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/parallel_util.h"
+#include "tensorflow/lite/micro/kernels/simd_util.h"
+#include "tensorflow/lite/micro/micro_streaming.h"
 
 namespace tflite {
 namespace {
@@ -162,13 +167,159 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   data->filter_zero_point = filter->params.zero_point;
   data->output_zero_point = output->params.zero_point;
 
+  PrepareStreamingOutput(
+      context, node->inputs->data[kInputTensor],
+      node->outputs->data[kOutputTensor], params->stride_height,
+      WindowReadsPadding(height, SizeOfDimension(output, 1), filter_height,
+                         params->stride_height,
+                         params->dilation_height_factor, data->padding.height),
+      /*cache_output=*/true);
+
   return kTfLiteOk;
 }
 
+// Channels accumulated together by the depth multiplier 1 kernels below.
+// Their accumulators live on the stack.
+constexpr int kDepthwiseChannelBlock = 32;
+
+// Returns the range [*first_tap, *end_tap) of filter taps along one axis that
+// read inside the input, when tap 0 reads input coordinate `origin`.
+inline void DepthwiseTaps(int origin, int dilation, int filter_size,
+                          int input_size, int* first_tap, int* end_tap) {
+  *first_tap = origin < 0 ? (dilation - 1 - origin) / dilation : 0;
+  const int last_input = input_size - 1 - origin;
+  *end_tap =
+      last_input < 0 ? 0 : std::min(filter_size, last_input / dilation + 1);
+  if (*end_tap < *first_tap) {
+    *end_tap = *first_tap;
+  }
+}
+
+// Per-type steps of the depth multiplier 1 kernel below: Accumulate() adds
+// the products of one filter tap to the accumulators of a block of channels,
+// Store() finishes the block into the output.
+struct QuantizedChannels {
+  const DepthwiseParams& params;
+  const OpData& data;
+  const int32_t* bias_data;
+
+  void Accumulate(const int8_t* input, const int8_t* filter, int count,
+                  int32_t* acc) const {
+    tflite::micro::MultiplyAccumulateInt8(input, filter, params.input_offset,
+                                          count, acc);
+  }
+
+  void Store(int channel, int count, const int32_t* acc,
+             int8_t* output) const {
+    for (int i = 0; i < count; ++i) {
+      const int c = channel + i;
+      int32_t value = acc[i];
+      if (bias_data) {
+        value += bias_data[c];
+      }
+      value = MultiplyByQuantizedMultiplier(
+          value, data.per_channel_output_multiplier[c],
+          data.per_channel_output_shift[c]);
+      value += params.output_offset;
+      value = std::max(value, params.quantized_activation_min);
+      value = std::min(value, params.quantized_activation_max);
+      output[i] = static_cast<int8_t>(value);
+    }
+  }
+};
+
+struct FloatChannels {
+  const DepthwiseParams& params;
+  const float* bias_data;
+
+  void Accumulate(const float* input, const float* filter, int count,
+                  float* acc) const {
+    tflite::micro::MultiplyAccumulateFloat(input, filter, count, acc);
+  }
+
+  void Store(int channel, int count, const float* acc, float* output) const {
+    for (int i = 0; i < count; ++i) {
+      const float bias_value = bias_data ? bias_data[channel + i] : 0.0f;
+      output[i] = ActivationFunctionWithMinMax(acc[i] + bias_value,
+                                               params.float_activation_min,
+                                               params.float_activation_max);
+    }
+  }
+};
+
+// Depthwise convolution with a depth multiplier of 1, so output channel c only
+// reads input channel c. The taps of each output pixel that read inside the
+// input are found once, and the inner loop runs without bounds checks over a
+// block of adjacent channels, which are contiguous in the input, the filter
+// and the output. Taps are added in the same order as the reference kernels.
+template <typename T, typename AccT, typename Channels>
+void DepthwiseConvMultiplier1(const DepthwiseParams& params,
+                              const Channels& channels,
+                              const RuntimeShape& input_shape,
+                              const T* input_data,
+                              const RuntimeShape& filter_shape,
+                              const T* filter_data,
+                              const RuntimeShape& output_shape,
+                              T* output_data) {
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int stride_height = params.stride_height;
+  const int stride_width = params.stride_width;
+  const int dilation_height = params.dilation_height_factor;
+  const int dilation_width = params.dilation_width_factor;
+  const int input_row_size = input_width * depth;
+  const int filter_row_size = filter_width * depth;
+
+  AccT acc[kDepthwiseChannelBlock];
+  T* output = output_data;
+  for (int batch = 0; batch < batches; ++batch) {
+    const T* input_batch = input_data + batch * input_height * input_row_size;
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          out_y * stride_height - params.padding_values.height;
+      int first_y, end_y;
+      DepthwiseTaps(in_y_origin, dilation_height, filter_height, input_height,
+                    &first_y, &end_y);
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            out_x * stride_width - params.padding_values.width;
+        int first_x, end_x;
+        DepthwiseTaps(in_x_origin, dilation_width, filter_width, input_width,
+                      &first_x, &end_x);
+        for (int channel = 0; channel < depth;
+             channel += kDepthwiseChannelBlock) {
+          const int count = std::min(kDepthwiseChannelBlock, depth - channel);
+          std::fill(acc, acc + count, static_cast<AccT>(0));
+          for (int filter_y = first_y; filter_y < end_y; ++filter_y) {
+            const int in_y = in_y_origin + dilation_height * filter_y;
+            const T* input_row = input_batch + in_y * input_row_size + channel;
+            const T* filter_row =
+                filter_data + filter_y * filter_row_size + channel;
+            for (int filter_x = first_x; filter_x < end_x; ++filter_x) {
+              const int in_x = in_x_origin + dilation_width * filter_x;
+              channels.Accumulate(input_row + in_x * depth,
+                                  filter_row + filter_x * depth, count, acc);
+            }
+          }
+          channels.Store(channel, count, acc, output + channel);
+        }
+        output += depth;
+      }
+    }
+  }
+}
+
 void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteDepthwiseConvParams* params, const OpData& data,
                const TfLiteEvalTensor* input, const TfLiteEvalTensor* filter,
-               const TfLiteEvalTensor* bias, TfLiteEvalTensor* output) {
+               const TfLiteEvalTensor* bias, TfLiteEvalTensor* output,
+               int first_row) {
   float output_activation_min, output_activation_max;
   CalculateActivationRange(params->activation, &output_activation_min,
                            &output_activation_max);
@@ -186,15 +337,34 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
 
-  tflite::reference_ops::DepthwiseConv(
-      op_params, tflite::micro::GetTensorShape(input),
-      tflite::micro::GetTensorData<float>(input),
-      tflite::micro::GetTensorShape(filter),
-      tflite::micro::GetTensorData<float>(filter),
-      tflite::micro::GetTensorShape(bias),
-      tflite::micro::GetTensorData<float>(bias),
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape bias_shape = tflite::micro::GetTensorShape(bias);
+  const float* input_data = tflite::micro::GetTensorData<float>(input);
+  const float* filter_data = tflite::micro::GetTensorData<float>(filter);
+  const float* bias_data = tflite::micro::GetTensorData<float>(bias);
+  float* output_data = tflite::micro::GetTensorData<float>(output);
+  const FloatChannels channels = {op_params, bias_data};
+  tflite::micro::ParallelConv(
+      context, tflite::micro::GetTensorShape(input),
       tflite::micro::GetTensorShape(output),
-      tflite::micro::GetTensorData<float>(output));
+      filter_shape.FlatSize() / filter_shape.Dims(3), op_params.stride_height,
+      op_params.padding_values.height, first_row,
+      [&](const tflite::micro::ConvSlice& slice) {
+        DepthwiseParams slice_params = op_params;
+        slice_params.padding_values.height = slice.padding_height;
+        if (op_params.depth_multiplier == 1) {
+          DepthwiseConvMultiplier1<float, float>(
+              slice_params, channels, slice.input_shape,
+              input_data + slice.input_offset, filter_shape, filter_data,
+              slice.output_shape, output_data + slice.output_offset);
+        } else {
+          tflite::reference_ops::DepthwiseConv(
+              slice_params, slice.input_shape,
+              input_data + slice.input_offset, filter_shape, filter_data,
+              bias_shape, bias_data, slice.output_shape,
+              output_data + slice.output_offset);
+        }
+      });
 }
 
 void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
@@ -202,7 +372,7 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
                              const OpData& data, const TfLiteEvalTensor* input,
                              const TfLiteEvalTensor* filter,
                              const TfLiteEvalTensor* bias,
-                             TfLiteEvalTensor* output) {
+                             TfLiteEvalTensor* output, int first_row) {
   DepthwiseParams op_params;
   op_params.padding_type = PaddingType::kSame;
   op_params.padding_values.width = data.padding.width;
@@ -219,23 +389,42 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
   op_params.quantized_activation_min = std::numeric_limits<int8_t>::min();
   op_params.quantized_activation_max = std::numeric_limits<int8_t>::max();
 
-  reference_integer_ops::DepthwiseConvPerChannel(
-      op_params, data.per_channel_output_multiplier,
-      data.per_channel_output_shift, tflite::micro::GetTensorShape(input),
-      tflite::micro::GetTensorData<int8_t>(input),
-      tflite::micro::GetTensorShape(filter),
-      tflite::micro::GetTensorData<int8_t>(filter),
-      tflite::micro::GetTensorShape(bias),
-      tflite::micro::GetTensorData<int32_t>(bias),
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape bias_shape = tflite::micro::GetTensorShape(bias);
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  const int32_t* bias_data = tflite::micro::GetTensorData<int32_t>(bias);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  const QuantizedChannels channels = {op_params, data, bias_data};
+  tflite::micro::ParallelConv(
+      context, tflite::micro::GetTensorShape(input),
       tflite::micro::GetTensorShape(output),
-      tflite::micro::GetTensorData<int8_t>(output));
+      filter_shape.FlatSize() / filter_shape.Dims(3), op_params.stride_height,
+      op_params.padding_values.height, first_row,
+      [&](const tflite::micro::ConvSlice& slice) {
+        DepthwiseParams slice_params = op_params;
+        slice_params.padding_values.height = slice.padding_height;
+        if (op_params.depth_multiplier == 1) {
+          DepthwiseConvMultiplier1<int8_t, int32_t>(
+              slice_params, channels, slice.input_shape,
+              input_data + slice.input_offset, filter_shape, filter_data,
+              slice.output_shape, output_data + slice.output_offset);
+        } else {
+          reference_integer_ops::DepthwiseConvPerChannel(
+              slice_params, data.per_channel_output_multiplier,
+              data.per_channel_output_shift, slice.input_shape,
+              input_data + slice.input_offset, filter_shape, filter_data,
+              bias_shape, bias_data, slice.output_shape,
+              output_data + slice.output_offset);
+        }
+      });
 }
 
 void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                    TfLiteDepthwiseConvParams* params, const OpData& data,
                    const TfLiteEvalTensor* input,
                    const TfLiteEvalTensor* filter, const TfLiteEvalTensor* bias,
-                   TfLiteEvalTensor* output) {
+                   TfLiteEvalTensor* output, int first_row) {
   const int32_t input_offset = -data.input_zero_point;
   const int32_t filter_offset = -data.filter_zero_point;
   const int32_t output_offset = data.output_zero_point;
@@ -259,15 +448,26 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   // Legacy ops used mixed left and right shifts. Now all are +ve-means-left.
   op_params.output_shift = -data.output_shift;
 
-  tflite::reference_ops::DepthwiseConv(
-      op_params, tflite::micro::GetTensorShape(input),
-      tflite::micro::GetTensorData<uint8_t>(input),
-      tflite::micro::GetTensorShape(filter),
-      tflite::micro::GetTensorData<uint8_t>(filter),
-      tflite::micro::GetTensorShape(bias),
-      tflite::micro::GetTensorData<int32_t>(bias),
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape bias_shape = tflite::micro::GetTensorShape(bias);
+  const uint8_t* input_data = tflite::micro::GetTensorData<uint8_t>(input);
+  const uint8_t* filter_data = tflite::micro::GetTensorData<uint8_t>(filter);
+  const int32_t* bias_data = tflite::micro::GetTensorData<int32_t>(bias);
+  uint8_t* output_data = tflite::micro::GetTensorData<uint8_t>(output);
+  tflite::micro::ParallelConv(
+      context, tflite::micro::GetTensorShape(input),
       tflite::micro::GetTensorShape(output),
-      tflite::micro::GetTensorData<uint8_t>(output));
+      filter_shape.FlatSize() / filter_shape.Dims(3), op_params.stride_height,
+      op_params.padding_values.height, first_row,
+      [&](const tflite::micro::ConvSlice& slice) {
+        DepthwiseParams slice_params = op_params;
+        slice_params.padding_values.height = slice.padding_height;
+        tflite::reference_ops::DepthwiseConv(
+            slice_params, slice.input_shape,
+            input_data + slice.input_offset, filter_shape, filter_data,
+            bias_shape, bias_data, slice.output_shape,
+            output_data + slice.output_offset);
+      });
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
@@ -289,24 +489,32 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           ? tflite::micro::GetEvalInput(context, node, kBiasTensor)
           : nullptr;
 
+  // Rows the previous window of a stream already computed are taken from its
+  // cache, see MicroInterpreter::SetStreamingHop().
+  const int output_index = node->outputs->data[kOutputTensor];
+  const int first_row = BeginStreamingOutput(context, output_index, output);
+
   // TODO(aselle): Consider whether float conv and quantized conv should be
   // separate ops to avoid dispatch overhead here.
   switch (input->type) {  // Already know in/out types are same.
     case kTfLiteFloat32:
-      EvalFloat(context, node, params, data, input, filter, bias, output);
+      EvalFloat(context, node, params, data, input, filter, bias, output,
+                first_row);
       break;
     case kTfLiteInt8:
       EvalQuantizedPerChannel(context, node, params, data, input, filter, bias,
-                              output);
+                              output, first_row);
       break;
     case kTfLiteUInt8:
-      EvalQuantized(context, node, params, data, input, filter, bias, output);
+      EvalQuantized(context, node, params, data, input, filter, bias, output,
+                    first_row);
       break;
     default:
       TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
                          TfLiteTypeGetName(input->type), input->type);
       return kTfLiteError;
   }
+  EndStreamingOutput(context, output_index, output, first_row);
   return kTfLiteOk;
 }
 
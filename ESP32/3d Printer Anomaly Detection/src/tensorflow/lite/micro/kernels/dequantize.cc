@@ -13,15 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-#include "tensorflow/lite/kernels/internal/reference/dequantize.h"
-
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
-#include "tensorflow/lite/kernels/internal/reference/quantize.h"
-#include "tensorflow/lite/kernels/internal/reference/requantize.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/conversion_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 
 namespace tflite {
@@ -83,28 +80,30 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(context, node, 0);
   TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, 0);
 
+  const int flat_size = MatchingFlatSize(tflite::micro::GetTensorShape(input),
+                                         tflite::micro::GetTensorShape(output));
   if (output->type == kTfLiteFloat32) {
     switch (input->type) {
       case kTfLiteUInt8:
-        reference_ops::Dequantize(data->quantization_params,
-                                  tflite::micro::GetTensorShape(input),
-                                  tflite::micro::GetTensorData<uint8_t>(input),
-                                  tflite::micro::GetTensorShape(output),
-                                  tflite::micro::GetTensorData<float>(output));
+        tflite::micro::DequantizeToFloat(
+            tflite::micro::GetTensorData<uint8_t>(input), flat_size,
+            data->quantization_params.scale,
+            data->quantization_params.zero_point,
+            tflite::micro::GetTensorData<float>(output));
         break;
       case kTfLiteInt8:
-        reference_ops::Dequantize(data->quantization_params,
-                                  tflite::micro::GetTensorShape(input),
-                                  tflite::micro::GetTensorData<int8_t>(input),
-                                  tflite::micro::GetTensorShape(output),
-                                  tflite::micro::GetTensorData<float>(output));
+        tflite::micro::DequantizeToFloat(
+            tflite::micro::GetTensorData<int8_t>(input), flat_size,
+            data->quantization_params.scale,
+            data->quantization_params.zero_point,
+            tflite::micro::GetTensorData<float>(output));
         break;
       case kTfLiteInt16:
-        reference_ops::Dequantize(data->quantization_params,
-                                  tflite::micro::GetTensorShape(input),
-                                  tflite::micro::GetTensorData<int16_t>(input),
-                                  tflite::micro::GetTensorShape(output),
-                                  tflite::micro::GetTensorData<float>(output));
+        tflite::micro::DequantizeToFloat(
+            tflite::micro::GetTensorData<int16_t>(input), flat_size,
+            data->quantization_params.scale,
+            data->quantization_params.zero_point,
+            tflite::micro::GetTensorData<float>(output));
         break;
       default:
         TF_LITE_KERNEL_LOG(context, "Input %s, output %s not supported.",
@@ -113,11 +112,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         return kTfLiteError;
     }
   } else if (output->type == kTfLiteInt32) {
-    int flat_size = MatchingFlatSize(tflite::micro::GetTensorShape(input),
-                                     tflite::micro::GetTensorShape(output));
     switch (input->type) {
       case kTfLiteInt8: {
-        reference_ops::Requantize(
+        tflite::micro::RequantizeToType(
             tflite::micro::GetTensorData<int8_t>(input), flat_size,
             data->output_multiplier, data->output_shift,
             data->quantization_params.zero_point, data->output_zero_point,
@@ -0,0 +1,173 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_FLOAT16_UTIL_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_FLOAT16_UTIL_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/simd_util.h"
+#include "tensorflow/lite/micro/micro_weight_packing.h"
+
+namespace tflite {
+namespace micro {
+
+// Returns the float equal to an IEEE half precision value. Exact for every
+// input, including subnormals, infinities and NaN. Uses integer operations
+// only, so it does not depend on how the FPU treats subnormal floats.
+inline float Float16ToFloat(TfLiteFloat16 half) {
+  const uint32_t sign = static_cast<uint32_t>(half.data & 0x8000) << 16;
+  const uint32_t exponent = half.data & 0x7c00;
+  uint32_t magnitude = half.data & 0x7fff;
+  uint32_t bits;
+  if (exponent != 0 && exponent != 0x7c00) {
+    // Normal values only need their exponent rebiased from 15 to 127.
+    bits = sign | ((magnitude << 13) + ((127 - 15) << 23));
+  } else if (exponent != 0) {
+    bits = sign | 0x7f800000 | ((magnitude & 0x3ff) << 13);
+  } else if (magnitude == 0) {
+    bits = sign;
+  } else {
+    // A subnormal is magnitude * 2^-24. Shift its leading one into the
+    // implicit bit position.
+    uint32_t float_exponent = 127 - 14;
+    while ((magnitude & 0x400) == 0) {
+      magnitude <<= 1;
+      --float_exponent;
+    }
+    bits = sign | (float_exponent << 23) | ((magnitude & 0x3ff) << 13);
+  }
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// 2^(127 - 15), the difference of the float and half precision exponent
+// biases.
+constexpr float kFloat16Rebias = 5.192296858534828e+33f;
+
+// Float16ToFloat() for values that are neither infinite nor NaN, in fewer
+// operations: the bits are moved into place and multiplied by 2^112, which
+// rebiases the exponent. Subnormal values become zero on FPUs that flush
+// subnormal floats, an error below the rounding error of normal values.
+inline float FiniteFloat16ToFloat(TfLiteFloat16 half) {
+  const uint32_t bits = (static_cast<uint32_t>(half.data & 0x8000) << 16) |
+                        (static_cast<uint32_t>(half.data & 0x7fff) << 13);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value * kFloat16Rebias;
+}
+
+#if defined(TF_LITE_MICRO_NEON) && defined(__aarch64__)
+inline float32x4_t FiniteFloat16ToFloat4(const TfLiteFloat16* input) {
+  return vcvt_f32_f16(
+      vreinterpret_f16_u16(vld1_u16(reinterpret_cast<const uint16_t*>(input))));
+}
+#elif defined(TF_LITE_MICRO_NEON)
+inline float32x4_t FiniteFloat16ToFloat4(const TfLiteFloat16* input) {
+  const uint32x4_t half =
+      vmovl_u16(vld1_u16(reinterpret_cast<const uint16_t*>(input)));
+  const uint32x4_t bits =
+      vorrq_u32(vshlq_n_u32(vandq_u32(half, vdupq_n_u32(0x8000)), 16),
+                vshlq_n_u32(vandq_u32(half, vdupq_n_u32(0x7fff)), 13));
+  return vmulq_n_f32(vreinterpretq_f32_u32(bits), kFloat16Rebias);
+}
+#elif defined(TF_LITE_MICRO_SSE2)
+inline __m128 FiniteFloat16ToFloat4(const TfLiteFloat16* input) {
+  const __m128i half = _mm_unpacklo_epi16(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input)),
+      _mm_setzero_si128());
+  const __m128i bits = _mm_or_si128(
+      _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x8000)), 16),
+      _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x7fff)), 13));
+  return _mm_mul_ps(_mm_castsi128_ps(bits), _mm_set1_ps(kFloat16Rebias));
+}
+#endif
+
+// Returns true if none of `size` half precision values is infinite or NaN.
+inline bool AllFiniteFloat16(const TfLiteFloat16* values, int size) {
+  for (int i = 0; i < size; ++i) {
+    if ((values[i].data & 0x7c00) == 0x7c00) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Widens `size` half precision values to float.
+inline void WidenFloat16(const TfLiteFloat16* input, int size, float* output) {
+  for (int i = 0; i < size; ++i) {
+    output[i] = Float16ToFloat(input[i]);
+  }
+}
+
+// Returns the sum of a[i] * b[i] for i in [0, size), widening the finite
+// values of b with FiniteFloat16ToFloat() as it goes. The products are added
+// in the same order as in DotProductFloat(), so apart from flushed subnormals
+// the result is the same as with b widened beforehand.
+inline float DotProductFloat(const float* a, const TfLiteFloat16* b,
+                             int size) {
+  int i = 0;
+  float sum = 0.0f;
+#if defined(TF_LITE_MICRO_NEON)
+  if (size >= 4) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= size; i += 4) {
+      acc = vaddq_f32(
+          acc, vmulq_f32(vld1q_f32(a + i), FiniteFloat16ToFloat4(b + i)));
+    }
+    sum = (vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 2)) +
+          (vgetq_lane_f32(acc, 1) + vgetq_lane_f32(acc, 3));
+  }
+#elif defined(TF_LITE_MICRO_SSE2)
+  if (size >= 4) {
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= size; i += 4) {
+      acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                       FiniteFloat16ToFloat4(b + i)));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+  }
+#endif
+  for (; i < size; ++i) {
+    sum += a[i] * FiniteFloat16ToFloat(b[i]);
+  }
+  return sum;
+}
+
+// PackWeightPanels() for a half precision weight matrix, widening every
+// weight to float.
+inline void PackFloat16WeightPanels(const TfLiteFloat16* weights,
+                                    int output_depth, int accum_depth,
+                                    float* packed) {
+  for (int panel = 0; panel < output_depth; panel += kWeightPanelWidth) {
+    for (int d = 0; d < accum_depth; ++d) {
+      for (int lane = 0; lane < kWeightPanelWidth; ++lane) {
+        const int channel = panel + lane;
+        *packed++ = channel < output_depth
+                        ? Float16ToFloat(weights[channel * accum_depth + d])
+                        : 0.0f;
+      }
+    }
+  }
+}
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_FLOAT16_UTIL_H_
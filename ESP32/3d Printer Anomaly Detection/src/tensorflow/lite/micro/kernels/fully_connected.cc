@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/lite/micro/kernels/fully_connected.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
@@ -23,7 +27,14 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/conversion_util.h"
+#include "tensorflow/lite/micro/kernels/float16_util.h"
+#include "tensorflow/lite/micro/kernels/int4_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/parallel_util.h"
+#include "tensorflow/lite/micro/kernels/simd_util.h"
+#include "tensorflow/lite/micro/micro_sparsity.h"
+#include "tensorflow/lite/micro/micro_weight_packing.h"
 
 namespace tflite {
 namespace {
@@ -34,6 +45,309 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
                                            sizeof(OpDataFullyConnected));
 }
 
+static_assert(kWeightPanelWidth == 4,
+              "PackedFullyConnected() unrolls panels of 4 channels");
+
+// Packs the filter of a float or int8 layer with constant weights for
+// PackedFullyConnected() if the interpreter has room for it. Float16 filters
+// are widened to float while packing. Other layers keep using the reference
+// kernels.
+TfLiteStatus PackFilter(TfLiteContext* context, const TfLiteTensor* filter,
+                        const TfLiteTensor* bias, OpDataFullyConnected* data) {
+  data->packed_filter = nullptr;
+  data->packed_bias = nullptr;
+  if (!IsConstantTensor(filter) ||
+      (bias != nullptr && !IsConstantTensor(bias))) {
+    return kTfLiteOk;
+  }
+  const int accum_depth = filter->dims->data[filter->dims->size - 1];
+  if (accum_depth == 0) {
+    return kTfLiteOk;
+  }
+  const int output_depth = NumElements(filter) / accum_depth;
+  const size_t packed_size = PackedWeightsSize(output_depth, accum_depth);
+
+  if (filter->type == kTfLiteFloat32) {
+    float* packed = static_cast<float*>(
+        AllocatePackedWeights(context, packed_size * sizeof(float)));
+    if (packed != nullptr) {
+      PackWeightPanels(GetTensorData<float>(filter), output_depth, accum_depth,
+                       packed);
+      data->packed_filter = packed;
+    }
+  } else if (filter->type == kTfLiteFloat16) {
+    float* packed = static_cast<float*>(
+        AllocatePackedWeights(context, packed_size * sizeof(float)));
+    if (packed != nullptr) {
+      tflite::micro::PackFloat16WeightPanels(
+          GetTensorData<TfLiteFloat16>(filter), output_depth, accum_depth,
+          packed);
+      data->packed_filter = packed;
+    }
+  } else if (filter->type == kTfLiteInt8 && data->filter_zero_point == 0) {
+    // The reference kernel computes sum((filter) * (input + input_offset)).
+    // Splitting off input_offset * sum(filter) ahead of time leaves a plain
+    // dot product for Eval. The bias goes first to keep it aligned.
+    const size_t packed_channels = packed_size / accum_depth;
+    int32_t* packed_bias = static_cast<int32_t*>(AllocatePackedWeights(
+        context, packed_channels * sizeof(int32_t) + packed_size));
+    if (packed_bias == nullptr) {
+      return kTfLiteOk;
+    }
+    int8_t* packed = reinterpret_cast<int8_t*>(packed_bias + packed_channels);
+    const int8_t* filter_data = GetTensorData<int8_t>(filter);
+    const int32_t* bias_data =
+        bias != nullptr ? GetTensorData<int32_t>(bias) : nullptr;
+    const int32_t input_offset = -data->input_zero_point;
+    for (size_t c = 0; c < packed_channels; ++c) {
+      int32_t filter_sum = 0;
+      if (static_cast<int>(c) < output_depth) {
+        for (int d = 0; d < accum_depth; ++d) {
+          filter_sum += filter_data[c * accum_depth + d];
+        }
+      }
+      packed_bias[c] =
+          (bias_data != nullptr && static_cast<int>(c) < output_depth
+               ? bias_data[c]
+               : 0) +
+          input_offset * filter_sum;
+    }
+    PackWeightPanels(filter_data, output_depth, accum_depth, packed);
+    data->packed_filter = packed;
+    data->packed_bias = packed_bias;
+  }
+  return kTfLiteOk;
+}
+
+// Sets up a hybrid layer, which has float input and output and an int8 or
+// int4 filter with one scale per tensor or per output channel. Int8 filters
+// must be symmetric, while int4 ones may also have a zero point per tensor or
+// per output channel.
+TfLiteStatus PrepareHybrid(TfLiteContext* context, const TfLiteTensor* filter,
+                           const TfLiteTensor* bias, TfLiteTensor* output,
+                           OpDataFullyConnected* data) {
+  TF_LITE_ENSURE(context, bias == nullptr || bias->type == kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, filter->quantization.type,
+                    kTfLiteAffineQuantization);
+  const auto* quantization =
+      static_cast<const TfLiteAffineQuantization*>(filter->quantization.params);
+  TF_LITE_ENSURE(context,
+                 quantization != nullptr && quantization->scale != nullptr);
+
+  const int accum_depth = filter->dims->data[filter->dims->size - 1];
+  TF_LITE_ENSURE(context, accum_depth > 0);
+  const int output_depth = NumElements(filter) / accum_depth;
+  const int scale_count = quantization->scale->size;
+  TF_LITE_ENSURE(context,
+                 scale_count == 1 || (scale_count == output_depth &&
+                                      quantization->quantized_dimension == 0));
+  const bool is_int4 = filter->type == kTfLiteInt4;
+  const TfLiteIntArray* zero_points = quantization->zero_point;
+  bool has_zero_points = false;
+  if (zero_points != nullptr) {
+    TF_LITE_ENSURE(context, !is_int4 || zero_points->size == 1 ||
+                                zero_points->size == output_depth);
+    for (int i = 0; i < zero_points->size; ++i) {
+      if (is_int4) {
+        TF_LITE_ENSURE(context,
+                       zero_points->data[i] >= -8 && zero_points->data[i] <= 7);
+      } else {
+        TF_LITE_ENSURE_EQ(context, zero_points->data[i], 0);
+      }
+      has_zero_points = has_zero_points || zero_points->data[i] != 0;
+    }
+  }
+
+  data->filter_scales = static_cast<float*>(context->AllocatePersistentBuffer(
+      context, output_depth * sizeof(float)));
+  TF_LITE_ENSURE(context, data->filter_scales != nullptr);
+  for (int c = 0; c < output_depth; ++c) {
+    data->filter_scales[c] =
+        quantization->scale->data[scale_count == 1 ? 0 : c];
+  }
+  // Zero points are not folded into the weights, which keeps every path
+  // exact: Eval subtracts each one times the sum of the quantized input row.
+  data->filter_zero_points = nullptr;
+  if (has_zero_points) {
+    int8_t* filter_zero_points = static_cast<int8_t*>(
+        context->AllocatePersistentBuffer(context, output_depth));
+    TF_LITE_ENSURE(context, filter_zero_points != nullptr);
+    for (int c = 0; c < output_depth; ++c) {
+      const int i = zero_points->size == 1 ? 0 : c;
+      filter_zero_points[c] = static_cast<int8_t>(zero_points->data[i]);
+    }
+    data->filter_zero_points = filter_zero_points;
+  }
+  data->packed_filter = nullptr;
+  data->packed_bias = nullptr;
+  data->unpacked_filter = nullptr;
+  // The vector backends compute every channel with DotProductInt8(), or with
+  // DotProductInt4() for an int4 filter that does not fit the weight-packing
+  // budget unpacked. Without one, a packed filter lets kWeightPanelWidth
+  // channels share the input loads.
+  if (!tflite::micro::kHasVectorDotProduct && IsConstantTensor(filter)) {
+    int8_t* packed = static_cast<int8_t*>(AllocatePackedWeights(
+        context, PackedWeightsSize(output_depth, accum_depth)));
+    if (packed != nullptr) {
+      if (is_int4) {
+        tflite::micro::PackInt4WeightPanels(GetTensorData<int8_t>(filter),
+                                            output_depth, accum_depth, packed);
+      } else {
+        PackWeightPanels(GetTensorData<int8_t>(filter), output_depth,
+                         accum_depth, packed);
+      }
+      data->packed_filter = packed;
+    }
+  } else if (is_int4 && IsConstantTensor(filter)) {
+    int8_t* unpacked = static_cast<int8_t*>(
+        AllocatePackedWeights(context, NumElements(filter)));
+    if (unpacked != nullptr) {
+      tflite::micro::UnpackInt4(GetTensorData<int8_t>(filter),
+                                NumElements(filter), unpacked);
+      data->unpacked_filter = unpacked;
+    }
+  }
+
+  const int batches = NumElements(output) / output_depth;
+  const size_t row_sum_size = has_zero_points ? sizeof(int32_t) : 0;
+  return context->RequestScratchBufferInArena(
+      context, batches * (sizeof(float) + row_sum_size + accum_depth),
+      &data->input_quantized_index);
+}
+
+// Returns the number of values of a sparse index vector, or -1 if it is
+// missing or of an unknown type.
+int SparseIndexVectorSize(SparseIndexVector type, const void* vector) {
+  if (vector == nullptr) {
+    return -1;
+  }
+  switch (type) {
+    case SparseIndexVector_Int32Vector: {
+      const auto* values = static_cast<const Int32Vector*>(vector)->values();
+      return values != nullptr ? static_cast<int>(values->size()) : -1;
+    }
+    case SparseIndexVector_Uint16Vector: {
+      const auto* values = static_cast<const Uint16Vector*>(vector)->values();
+      return values != nullptr ? static_cast<int>(values->size()) : -1;
+    }
+    case SparseIndexVector_Uint8Vector: {
+      const auto* values = static_cast<const Uint8Vector*>(vector)->values();
+      return values != nullptr ? static_cast<int>(values->size()) : -1;
+    }
+    default:
+      return -1;
+  }
+}
+
+// Returns value `i` of a sparse index vector that SparseIndexVectorSize()
+// accepted.
+int32_t SparseIndexVectorGet(SparseIndexVector type, const void* vector,
+                             int i) {
+  switch (type) {
+    case SparseIndexVector_Int32Vector:
+      return static_cast<const Int32Vector*>(vector)->values()->Get(i);
+    case SparseIndexVector_Uint16Vector:
+      return static_cast<const Uint16Vector*>(vector)->values()->Get(i);
+    default:
+      return static_cast<const Uint8Vector*>(vector)->values()->Get(i);
+  }
+}
+
+// Sets up a float layer whose filter is stored sparse, in one of the layouts
+// the TFLite converter produces for FULLY_CONNECTED: every weight indexed on
+// its own (dimensions DENSE, SPARSE_CSR), or blocks of 1xB weights along the
+// input depth (dimensions DENSE, SPARSE_CSR, DENSE 1, DENSE B with block map
+// {0, 1}). The segments and indices are copied out of the model into a
+// SparseFullyConnectedFilter, so Eval reads them in one type whichever index
+// vector type the model uses.
+TfLiteStatus PrepareSparse(TfLiteContext* context,
+                           const SparsityParameters& sparsity,
+                           const TfLiteTensor* input,
+                           const TfLiteTensor* filter, const TfLiteTensor* bias,
+                           OpDataFullyConnected* data) {
+  TF_LITE_ENSURE_MSG(context,
+                     input->type == kTfLiteFloat32 &&
+                         filter->type == kTfLiteFloat32 &&
+                         (bias == nullptr || bias->type == kTfLiteFloat32),
+                     "Sparse filters are only supported in float layers.");
+  TF_LITE_ENSURE(context, IsConstantTensor(filter));
+  TF_LITE_ENSURE_EQ(context, NumDimensions(filter), 2);
+  const int output_depth = SizeOfDimension(filter, 0);
+  const int accum_depth = SizeOfDimension(filter, 1);
+
+  const auto* traversal_order = sparsity.traversal_order();
+  const auto* dims = sparsity.dim_metadata();
+  TF_LITE_ENSURE(context, traversal_order != nullptr && dims != nullptr);
+  const int dim_count = static_cast<int>(dims->size());
+  TF_LITE_ENSURE(context, dim_count == 2 || dim_count == 4);
+  TF_LITE_ENSURE_EQ(context, static_cast<int>(traversal_order->size()),
+                    dim_count);
+  for (int i = 0; i < dim_count; ++i) {
+    TF_LITE_ENSURE_EQ(context, traversal_order->Get(i), i);
+  }
+  int block_size = 1;
+  if (dim_count == 4) {
+    const auto* block_map = sparsity.block_map();
+    TF_LITE_ENSURE(context, block_map != nullptr && block_map->size() == 2 &&
+                                block_map->Get(0) == 0 &&
+                                block_map->Get(1) == 1);
+    TF_LITE_ENSURE(context, dims->Get(2)->format() == DimensionType_DENSE &&
+                                dims->Get(2)->dense_size() == 1 &&
+                                dims->Get(3)->format() == DimensionType_DENSE);
+    block_size = dims->Get(3)->dense_size();
+    TF_LITE_ENSURE(context, block_size > 0 && accum_depth % block_size == 0);
+  }
+  const int column_count = accum_depth / block_size;
+  TF_LITE_ENSURE(context, column_count <= 65536);
+  TF_LITE_ENSURE(context, dims->Get(0)->format() == DimensionType_DENSE &&
+                              dims->Get(0)->dense_size() == output_depth);
+  const DimensionMetadata* csr = dims->Get(1);
+  TF_LITE_ENSURE_EQ(context, csr->format(), DimensionType_SPARSE_CSR);
+  const SparseIndexVector segments_type = csr->array_segments_type();
+  const void* segments = csr->array_segments();
+  const SparseIndexVector indices_type = csr->array_indices_type();
+  const void* indices = csr->array_indices();
+  TF_LITE_ENSURE_EQ(context, SparseIndexVectorSize(segments_type, segments),
+                    output_depth + 1);
+  const int index_count = SparseIndexVectorSize(indices_type, indices);
+  TF_LITE_ENSURE(context, index_count >= 0);
+  TF_LITE_ENSURE_EQ(context, SparseIndexVectorGet(segments_type, segments, 0),
+                    0);
+  TF_LITE_ENSURE_EQ(context,
+                    SparseIndexVectorGet(segments_type, segments, output_depth),
+                    index_count);
+  // filter->bytes is the size of the model buffer, see
+  // InitializeTfLiteTensorFromFlatbuffer().
+  TF_LITE_ENSURE(context, filter->bytes >= static_cast<size_t>(index_count) *
+                                               block_size * sizeof(float));
+
+  auto* sparse = static_cast<SparseFullyConnectedFilter*>(
+      context->AllocatePersistentBuffer(context,
+                                        sizeof(SparseFullyConnectedFilter)));
+  int32_t* row_segments =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, (output_depth + 1) * sizeof(int32_t)));
+  uint16_t* block_columns =
+      static_cast<uint16_t*>(context->AllocatePersistentBuffer(
+          context, index_count * sizeof(uint16_t)));
+  TF_LITE_ENSURE(context, sparse != nullptr && row_segments != nullptr &&
+                              block_columns != nullptr);
+  for (int c = 0; c <= output_depth; ++c) {
+    row_segments[c] = SparseIndexVectorGet(segments_type, segments, c);
+    TF_LITE_ENSURE(context, c == 0 || row_segments[c] >= row_segments[c - 1]);
+  }
+  for (int i = 0; i < index_count; ++i) {
+    const int32_t column = SparseIndexVectorGet(indices_type, indices, i);
+    TF_LITE_ENSURE(context, column >= 0 && column < column_count);
+    block_columns[i] = static_cast<uint16_t>(column);
+  }
+  sparse->block_size = block_size;
+  sparse->row_segments = row_segments;
+  sparse->block_columns = block_columns;
+  data->sparse_filter = sparse;
+  return kTfLiteOk;
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TFLITE_DCHECK(node->user_data != nullptr);
   TFLITE_DCHECK(node->builtin_data != nullptr);
@@ -54,11 +368,408 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, output != nullptr);
 
   TF_LITE_ENSURE_TYPES_EQ(context, input->type, output->type);
+  data->sparse_filter = nullptr;
+  const SparsityParameters* sparsity = GetMicroTensorSparsity(
+      context, node->inputs->data[kFullyConnectedWeightsTensor]);
+  if (sparsity != nullptr) {
+    data->packed_filter = nullptr;
+    data->packed_bias = nullptr;
+    return PrepareSparse(context, *sparsity, input, filter, bias, data);
+  }
+  if (input->type == kTfLiteFloat32 &&
+      (filter->type == kTfLiteInt8 || filter->type == kTfLiteInt4)) {
+    return PrepareHybrid(context, filter, bias, output, data);
+  }
+  // A float16 filter is only a smaller encoding of a float one. When it is
+  // not packed it is widened as it is read, which needs finite values.
+  if (input->type == kTfLiteFloat32 && filter->type == kTfLiteFloat16) {
+    TF_LITE_ENSURE(context, bias == nullptr || bias->type == kTfLiteFloat32);
+    TF_LITE_ENSURE_MSG(
+        context,
+        IsConstantTensor(filter) &&
+            tflite::micro::AllFiniteFloat16(
+                GetTensorData<TfLiteFloat16>(filter), NumElements(filter)),
+        "Float16 filters must be constant and finite.");
+    return PackFilter(context, filter, bias, data);
+  }
   TF_LITE_ENSURE_MSG(context, input->type == filter->type,
-                     "Hybrid models are not supported on TFLite Micro.");
+                     "Hybrid models are only supported with float input and "
+                     "int8, int4 or float16 filter on TFLite Micro.");
+
+  TF_LITE_ENSURE_STATUS(CalculateOpDataFullyConnected(
+      context, params->activation, input->type, input, filter, bias, output,
+      data));
+  return PackFilter(context, filter, bias, data);
+}
+
+// Runs `reference_kernel` over the output of the layer, split across the
+// registered thread pool when the layer is large enough.
+template <typename InputT, typename WeightT, typename BiasT, typename OutputT>
+void EvalFullyConnected(
+    TfLiteContext* context, const FullyConnectedParams& op_params,
+    void (*reference_kernel)(const FullyConnectedParams&, const RuntimeShape&,
+                             const InputT*, const RuntimeShape&,
+                             const WeightT*, const RuntimeShape&,
+                             const BiasT*, const RuntimeShape&, OutputT*),
+    const TfLiteEvalTensor* input, const TfLiteEvalTensor* filter,
+    const TfLiteEvalTensor* bias, TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape bias_shape = tflite::micro::GetTensorShape(bias);
+  const InputT* input_data = tflite::micro::GetTensorData<InputT>(input);
+  const WeightT* filter_data = tflite::micro::GetTensorData<WeightT>(filter);
+  const BiasT* bias_data = tflite::micro::GetTensorData<BiasT>(bias);
+  OutputT* output_data = tflite::micro::GetTensorData<OutputT>(output);
+
+  tflite::micro::ParallelFullyConnected(
+      context, tflite::micro::GetTensorShape(filter),
+      tflite::micro::GetTensorShape(output),
+      [&](const tflite::micro::FullyConnectedSlice& slice) {
+        reference_kernel(
+            op_params, input_shape, input_data + slice.input_offset,
+            slice.filter_shape, filter_data + slice.filter_offset, bias_shape,
+            bias_data != nullptr ? bias_data + slice.bias_offset : nullptr,
+            slice.output_shape, output_data + slice.output_offset);
+      });
+}
+
+// Computes the outputs of `slice` (see ParallelFullyConnected()) from a
+// filter packed by PackFilter(), kWeightPanelWidth channels at a time. The
+// float kernel adds up the products of each channel in the same order as the
+// reference kernel, so both produce identical results.
+void PackedFullyConnected(const FullyConnectedParams& op_params,
+                          const OpDataFullyConnected& data,
+                          const tflite::micro::FullyConnectedSlice& slice,
+                          int accum_depth, int output_depth,
+                          const float* input_data, float* output_data,
+                          const float* bias_data) {
+  const int dims_count = slice.output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(slice.output_shape, dims_count - 1);
+  const int channel_begin = slice.filter_offset / accum_depth;
+  const int channel_end =
+      channel_begin + slice.output_shape.Dims(dims_count - 1);
+  const float* packed_filter = static_cast<const float*>(data.packed_filter);
+  input_data += slice.input_offset;
+  output_data += slice.output_offset - channel_begin;
+
+  for (int b = 0; b < batches; ++b) {
+    const float* input = input_data + b * accum_depth;
+    float* output = output_data + b * output_depth;
+    for (int panel = channel_begin - channel_begin % kWeightPanelWidth;
+         panel < channel_end; panel += kWeightPanelWidth) {
+      const float* weights = packed_filter + panel * accum_depth;
+      float acc0 = 0.f;
+      float acc1 = 0.f;
+      float acc2 = 0.f;
+      float acc3 = 0.f;
+      for (int d = 0; d < accum_depth; ++d) {
+        const float input_value = input[d];
+        acc0 += input_value * weights[0];
+        acc1 += input_value * weights[1];
+        acc2 += input_value * weights[2];
+        acc3 += input_value * weights[3];
+        weights += kWeightPanelWidth;
+      }
+      const float acc[kWeightPanelWidth] = {acc0, acc1, acc2, acc3};
+      for (int lane = 0; lane < kWeightPanelWidth; ++lane) {
+        const int c = panel + lane;
+        if (c < channel_begin || c >= channel_end) {
+          continue;
+        }
+        const float bias_value = bias_data != nullptr ? bias_data[c] : 0.0f;
+        output[c] = ActivationFunctionWithMinMax(
+            acc[lane] + bias_value, op_params.float_activation_min,
+            op_params.float_activation_max);
+      }
+    }
+  }
+}
+
+void PackedFullyConnected(const FullyConnectedParams& op_params,
+                          const OpDataFullyConnected& data,
+                          const tflite::micro::FullyConnectedSlice& slice,
+                          int accum_depth, int output_depth,
+                          const int8_t* input_data, int8_t* output_data) {
+  const int dims_count = slice.output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(slice.output_shape, dims_count - 1);
+  const int channel_begin = slice.filter_offset / accum_depth;
+  const int channel_end =
+      channel_begin + slice.output_shape.Dims(dims_count - 1);
+  const int8_t* packed_filter = static_cast<const int8_t*>(data.packed_filter);
+  input_data += slice.input_offset;
+  output_data += slice.output_offset - channel_begin;
+
+  for (int b = 0; b < batches; ++b) {
+    const int8_t* input = input_data + b * accum_depth;
+    int8_t* output = output_data + b * output_depth;
+    for (int panel = channel_begin - channel_begin % kWeightPanelWidth;
+         panel < channel_end; panel += kWeightPanelWidth) {
+      const int8_t* weights = packed_filter + panel * accum_depth;
+      int32_t acc0 = data.packed_bias[panel];
+      int32_t acc1 = data.packed_bias[panel + 1];
+      int32_t acc2 = data.packed_bias[panel + 2];
+      int32_t acc3 = data.packed_bias[panel + 3];
+      for (int d = 0; d < accum_depth; ++d) {
+        const int32_t input_value = input[d];
+        acc0 += input_value * weights[0];
+        acc1 += input_value * weights[1];
+        acc2 += input_value * weights[2];
+        acc3 += input_value * weights[3];
+        weights += kWeightPanelWidth;
+      }
+      const int32_t acc[kWeightPanelWidth] = {acc0, acc1, acc2, acc3};
+      for (int lane = 0; lane < kWeightPanelWidth; ++lane) {
+        const int c = panel + lane;
+        if (c < channel_begin || c >= channel_end) {
+          continue;
+        }
+        int32_t value = MultiplyByQuantizedMultiplier(
+            acc[lane], op_params.output_multiplier, op_params.output_shift);
+        value += op_params.output_offset;
+        value = std::max(value, op_params.quantized_activation_min);
+        value = std::min(value, op_params.quantized_activation_max);
+        output[c] = static_cast<int8_t>(value);
+      }
+    }
+  }
+}
+
+// Runs PackedFullyConnected() over the output of a layer whose filter was
+// packed, split across the registered thread pool like EvalFullyConnected().
+// `bias_data` is only passed for float layers, int8 layers have their bias
+// folded into the packed bias.
+template <typename T, typename... BiasData>
+void EvalPackedFullyConnected(TfLiteContext* context,
+                              const FullyConnectedParams& op_params,
+                              const OpDataFullyConnected& data,
+                              const TfLiteEvalTensor* input,
+                              const TfLiteEvalTensor* filter,
+                              TfLiteEvalTensor* output,
+                              const BiasData&... bias_data) {
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int accum_depth = filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+  const int output_depth =
+      output_shape.Dims(output_shape.DimensionsCount() - 1);
+  const T* input_data = tflite::micro::GetTensorData<T>(input);
+  T* output_data = tflite::micro::GetTensorData<T>(output);
+
+  tflite::micro::ParallelFullyConnected(
+      context, filter_shape, output_shape,
+      [&](const tflite::micro::FullyConnectedSlice& slice) {
+        PackedFullyConnected(op_params, data, slice, accum_depth, output_depth,
+                             input_data, output_data, bias_data...);
+      });
+}
+
+// Computes a float layer from a float16 filter that was not packed, widening
+// the weights of every channel as they are read. See DotProductFloat() for how
+// results compare to the reference kernel.
+void EvalFloat16FullyConnected(TfLiteContext* context,
+                               const FullyConnectedParams& op_params,
+                               const TfLiteEvalTensor* input,
+                               const TfLiteEvalTensor* filter,
+                               const TfLiteEvalTensor* bias,
+                               TfLiteEvalTensor* output) {
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int output_depth = output_shape.Dims(output_dims_count - 1);
+  const int accum_depth = filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+  const float* input_data = tflite::micro::GetTensorData<float>(input);
+  const TfLiteFloat16* filter_data =
+      tflite::micro::GetTensorData<TfLiteFloat16>(filter);
+  const float* bias_data = tflite::micro::GetTensorData<float>(bias);
+  float* output_data = tflite::micro::GetTensorData<float>(output);
+
+  tflite::micro::ParallelFullyConnected(
+      context, filter_shape, output_shape,
+      [&](const tflite::micro::FullyConnectedSlice& slice) {
+        const int batches =
+            FlatSizeSkipDim(slice.output_shape, output_dims_count - 1);
+        const int channels = slice.output_shape.Dims(output_dims_count - 1);
+        const int channel_begin = slice.filter_offset / accum_depth;
+        for (int b = 0; b < batches; ++b) {
+          const float* row = input_data + slice.input_offset + b * accum_depth;
+          float* output_row =
+              output_data + slice.output_offset + b * output_depth;
+          for (int i = 0; i < channels; ++i) {
+            const int c = channel_begin + i;
+            const float total = tflite::micro::DotProductFloat(
+                row, filter_data + c * accum_depth, accum_depth);
+            const float bias_value = bias_data != nullptr ? bias_data[c] : 0.0f;
+            output_row[i] = ActivationFunctionWithMinMax(
+                total + bias_value, op_params.float_activation_min,
+                op_params.float_activation_max);
+          }
+        }
+      });
+}
+
+// Computes a float layer whose filter is stored sparse, see PrepareSparse(),
+// visiting only the blocks of weights that were kept. kBlockSize is the block
+// size if known at compile time, or 0. Without a vector backend the products
+// are added in the order of the reference kernel, which only adds zeros in
+// between, so for finite inputs the results are identical.
+template <int kBlockSize>
+void EvalSparseFullyConnected(TfLiteContext* context,
+                              const FullyConnectedParams& op_params,
+                              const SparseFullyConnectedFilter& sparse,
+                              const TfLiteEvalTensor* input,
+                              const TfLiteEvalTensor* filter,
+                              const TfLiteEvalTensor* bias,
+                              TfLiteEvalTensor* output) {
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int output_depth = output_shape.Dims(output_dims_count - 1);
+  const int accum_depth = filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+  const int block_size = kBlockSize != 0 ? kBlockSize : sparse.block_size;
+  const float* input_data = tflite::micro::GetTensorData<float>(input);
+  const float* values = tflite::micro::GetTensorData<float>(filter);
+  const float* bias_data = tflite::micro::GetTensorData<float>(bias);
+  float* output_data = tflite::micro::GetTensorData<float>(output);
+
+  tflite::micro::ParallelFullyConnected(
+      context, filter_shape, output_shape,
+      [&](const tflite::micro::FullyConnectedSlice& slice) {
+        const int batches =
+            FlatSizeSkipDim(slice.output_shape, output_dims_count - 1);
+        const int channels = slice.output_shape.Dims(output_dims_count - 1);
+        const int channel_begin = slice.filter_offset / accum_depth;
+        for (int i = 0; i < channels; ++i) {
+          const int c = channel_begin + i;
+          const float bias_value = bias_data != nullptr ? bias_data[c] : 0.0f;
+          for (int b = 0; b < batches; ++b) {
+            const float total = tflite::micro::BlockSparseDotProductFloat(
+                values, sparse.block_columns, sparse.row_segments[c],
+                sparse.row_segments[c + 1], block_size,
+                input_data + slice.input_offset + b * accum_depth);
+            output_data[slice.output_offset + b * output_depth + i] =
+                ActivationFunctionWithMinMax(total + bias_value,
+                                             op_params.float_activation_min,
+                                             op_params.float_activation_max);
+          }
+        }
+      });
+}
+
+// Computes a hybrid layer. Every input row is quantized to int8 with its own
+// scaling factor so the products accumulate in int32, then each sum is scaled
+// back to float by the scaling factor of its row and the scale of its channel.
+// An int4 filter read from the model is unpacked by DotProductInt4() as it
+// goes.
+void EvalHybridFullyConnected(TfLiteContext* context,
+                              const FullyConnectedParams& op_params,
+                              const OpDataFullyConnected& data,
+                              const TfLiteEvalTensor* input,
+                              const TfLiteEvalTensor* filter,
+                              const TfLiteEvalTensor* bias,
+                              TfLiteEvalTensor* output) {
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int output_depth = output_shape.Dims(output_dims_count - 1);
+  const int accum_depth = filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+  const float* input_data = tflite::micro::GetTensorData<float>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  const bool is_int4 =
+      filter->type == kTfLiteInt4 && data.unpacked_filter == nullptr;
+  if (data.unpacked_filter != nullptr) {
+    filter_data = data.unpacked_filter;
+  }
+  const float* bias_data = tflite::micro::GetTensorData<float>(bias);
+  float* output_data = tflite::micro::GetTensorData<float>(output);
+
+  float* scaling_factors = static_cast<float*>(
+      context->GetScratchBuffer(context, data.input_quantized_index));
+  int32_t* row_sums = reinterpret_cast<int32_t*>(scaling_factors + batches);
+  int8_t* quantized_input = reinterpret_cast<int8_t*>(
+      row_sums + (data.filter_zero_points != nullptr ? batches : 0));
+  for (int b = 0; b < batches; ++b) {
+    const float* row = input_data + b * accum_depth;
+    int8_t* quantized_row = quantized_input + b * accum_depth;
+    float max_abs = 0.0f;
+    for (int d = 0; d < accum_depth; ++d) {
+      max_abs = std::max(max_abs, std::abs(row[d]));
+    }
+    // A row of zeros gets a scaling factor of 0, which zeroes its products.
+    scaling_factors[b] = max_abs / 127.0f;
+    if (max_abs == 0.0f) {
+      memset(quantized_row, 0, accum_depth);
+    } else {
+      tflite::micro::QuantizeFloat(row, accum_depth, scaling_factors[b], 0,
+                                   -127, 127, quantized_row);
+    }
+    if (data.filter_zero_points != nullptr) {
+      row_sums[b] = tflite::micro::SumInt8(quantized_row, accum_depth);
+    }
+  }
 
-  return CalculateOpDataFullyConnected(context, params->activation, input->type,
-                                       input, filter, bias, output, data);
+  tflite::micro::ParallelFullyConnected(
+      context, filter_shape, output_shape,
+      [&](const tflite::micro::FullyConnectedSlice& slice) {
+        const int slice_batches =
+            FlatSizeSkipDim(slice.output_shape, output_dims_count - 1);
+        const int channels = slice.output_shape.Dims(output_dims_count - 1);
+        const int batch_begin = slice.input_offset / accum_depth;
+        const int channel_begin = slice.filter_offset / accum_depth;
+        for (int b = 0; b < slice_batches; ++b) {
+          const int batch = batch_begin + b;
+          const int8_t* row = quantized_input + batch * accum_depth;
+          float* output_row =
+              output_data + slice.output_offset + b * output_depth;
+          auto store = [&](int i, int32_t acc) {
+            const int c = channel_begin + i;
+            if (data.filter_zero_points != nullptr) {
+              acc -= data.filter_zero_points[c] * row_sums[batch];
+            }
+            float value =
+                acc * (scaling_factors[batch] * data.filter_scales[c]);
+            if (bias_data != nullptr) {
+              value += bias_data[c];
+            }
+            output_row[i] = ActivationFunctionWithMinMax(
+                value, op_params.float_activation_min,
+                op_params.float_activation_max);
+          };
+          if (data.packed_filter == nullptr) {
+            for (int i = 0; i < channels; ++i) {
+              const int offset = (channel_begin + i) * accum_depth;
+              store(i, is_int4 ? tflite::micro::DotProductInt4(
+                                     row, filter_data, offset, accum_depth)
+                               : tflite::micro::DotProductInt8(
+                                     row, filter_data + offset, accum_depth));
+            }
+            continue;
+          }
+          const int8_t* packed_filter =
+              static_cast<const int8_t*>(data.packed_filter);
+          for (int panel = channel_begin - channel_begin % kWeightPanelWidth;
+               panel < channel_begin + channels; panel += kWeightPanelWidth) {
+            const int8_t* weights = packed_filter + panel * accum_depth;
+            int32_t acc0 = 0;
+            int32_t acc1 = 0;
+            int32_t acc2 = 0;
+            int32_t acc3 = 0;
+            for (int d = 0; d < accum_depth; ++d) {
+              const int32_t input_value = row[d];
+              acc0 += input_value * weights[0];
+              acc1 += input_value * weights[1];
+              acc2 += input_value * weights[2];
+              acc3 += input_value * weights[3];
+              weights += kWeightPanelWidth;
+            }
+            const int32_t acc[kWeightPanelWidth] = {acc0, acc1, acc2, acc3};
+            for (int lane = 0; lane < kWeightPanelWidth; ++lane) {
+              const int i = panel + lane - channel_begin;
+              if (i >= 0 && i < channels) {
+                store(i, acc[lane]);
+              }
+            }
+          }
+        }
+      });
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
@@ -79,47 +790,80 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const auto& data =
       *(static_cast<const OpDataFullyConnected*>(node->user_data));
 
-  // Checks in Prepare ensure input, output and filter types are all the same.
+  // Checks in Prepare ensure input, output and filter types are all the same,
+  // except for float layers with an int8 or int4 (hybrid) or float16 filter.
   switch (input->type) {
     case kTfLiteFloat32: {
-      tflite::reference_ops::FullyConnected(
-          FullyConnectedParamsFloat(params->activation),
-          tflite::micro::GetTensorShape(input),
-          tflite::micro::GetTensorData<float>(input),
-          tflite::micro::GetTensorShape(filter),
-          tflite::micro::GetTensorData<float>(filter),
-          tflite::micro::GetTensorShape(bias),
-          tflite::micro::GetTensorData<float>(bias),
-          tflite::micro::GetTensorShape(output),
-          tflite::micro::GetTensorData<float>(output));
+      if (data.sparse_filter != nullptr) {
+        // The common block sizes get unrolled inner loops.
+        const FullyConnectedParams op_params =
+            FullyConnectedParamsFloat(params->activation);
+        switch (data.sparse_filter->block_size) {
+          case 1:
+            EvalSparseFullyConnected<1>(context, op_params,
+                                        *data.sparse_filter, input, filter,
+                                        bias, output);
+            break;
+          case 4:
+            EvalSparseFullyConnected<4>(context, op_params,
+                                        *data.sparse_filter, input, filter,
+                                        bias, output);
+            break;
+          case 16:
+            EvalSparseFullyConnected<16>(context, op_params,
+                                         *data.sparse_filter, input, filter,
+                                         bias, output);
+            break;
+          default:
+            EvalSparseFullyConnected<0>(context, op_params,
+                                        *data.sparse_filter, input, filter,
+                                        bias, output);
+            break;
+        }
+        break;
+      }
+      if (filter->type == kTfLiteInt8 || filter->type == kTfLiteInt4) {
+        EvalHybridFullyConnected(
+            context, FullyConnectedParamsFloat(params->activation), data,
+            input, filter, bias, output);
+        break;
+      }
+      if (data.packed_filter != nullptr) {
+        EvalPackedFullyConnected<float>(
+            context, FullyConnectedParamsFloat(params->activation), data,
+            input, filter, output, tflite::micro::GetTensorData<float>(bias));
+        break;
+      }
+      if (filter->type == kTfLiteFloat16) {
+        EvalFloat16FullyConnected(
+            context, FullyConnectedParamsFloat(params->activation), input,
+            filter, bias, output);
+        break;
+      }
+      EvalFullyConnected<float, float, float, float>(
+          context, FullyConnectedParamsFloat(params->activation),
+          tflite::reference_ops::FullyConnected, input, filter, bias, output);
       break;
     }
 
     case kTfLiteInt8: {
-      tflite::reference_integer_ops::FullyConnected(
-          FullyConnectedParamsQuantized(data),
-          tflite::micro::GetTensorShape(input),
-          tflite::micro::GetTensorData<int8_t>(input),
-          tflite::micro::GetTensorShape(filter),
-          tflite::micro::GetTensorData<int8_t>(filter),
-          tflite::micro::GetTensorShape(bias),
-          tflite::micro::GetTensorData<int32_t>(bias),
-          tflite::micro::GetTensorShape(output),
-          tflite::micro::GetTensorData<int8_t>(output));
+      if (data.packed_filter != nullptr) {
+        EvalPackedFullyConnected<int8_t>(context,
+                                         FullyConnectedParamsQuantized(data),
+                                         data, input, filter, output);
+        break;
+      }
+      EvalFullyConnected<int8_t, int8_t, int32_t, int8_t>(
+          context, FullyConnectedParamsQuantized(data),
+          tflite::reference_integer_ops::FullyConnected, input, filter, bias,
+          output);
       break;
     }
 
     case kTfLiteUInt8: {
-      tflite::reference_ops::FullyConnected(
-          FullyConnectedParamsQuantized(data),
-          tflite::micro::GetTensorShape(input),
-          tflite::micro::GetTensorData<uint8_t>(input),
-          tflite::micro::GetTensorShape(filter),
-          tflite::micro::GetTensorData<uint8_t>(filter),
-          tflite::micro::GetTensorShape(bias),
-          tflite::micro::GetTensorData<int32_t>(bias),
-          tflite::micro::GetTensorShape(output),
-          tflite::micro::GetTensorData<uint8_t>(output));
+      EvalFullyConnected<uint8_t, uint8_t, int32_t, uint8_t>(
+          context, FullyConnectedParamsQuantized(data),
+          tflite::reference_ops::FullyConnected, input, filter, bias, output);
       break;
     }
     default: {
@@ -23,6 +23,17 @@ limitations under the License.
 
 namespace tflite {
 
+// Filter of a float layer stored sparse, as the blocks of block_size
+// consecutive weights along the input depth that pruning kept. The filter
+// tensor holds the weights of those blocks, row by row.
+struct SparseFullyConnectedFilter {
+  int block_size;
+  // Output channel c keeps blocks [row_segments[c], row_segments[c + 1]).
+  const int32_t* row_segments;
+  // Input index of the first weight of every block, divided by block_size.
+  const uint16_t* block_columns;
+};
+
 struct OpDataFullyConnected {
   // The scaling factor from input to output (aka the 'real multiplier') can
   // be represented as a fixed point multiplier plus a left shift.
@@ -33,11 +44,32 @@ struct OpDataFullyConnected {
   int32_t output_activation_min;
   int32_t output_activation_max;
   // The index of the temporary tensor where the quantized inputs are cached.
+  // For a hybrid layer, which has float input and output and an int8 or int4
+  // filter, this is the scratch buffer holding the scaling factor of every
+  // input row, then the sum of every quantized row if filter_zero_points is
+  // set, then the rows quantized to int8.
   int input_quantized_index;
   // Cached zero point values of tensors.
   int32_t input_zero_point;
   int32_t filter_zero_point;
   int32_t output_zero_point;
+  // Float or int8 filter packed by PackWeightPanels(), with a float16 filter
+  // widened to float and an int4 one unpacked to int8, or nullptr when the
+  // layer reads its filter from the model.
+  const void* packed_filter;
+  // For a packed int8 filter, the bias of every packed channel with the input
+  // offset times the sum of its filter row folded in.
+  const int32_t* packed_bias;
+  // For a hybrid layer, the scale of every output channel of the filter.
+  float* filter_scales;
+  // For a hybrid layer with an int4 filter, the filter unpacked to int8 in its
+  // original layout when it is not packed, or nullptr.
+  const int8_t* unpacked_filter;
+  // For a hybrid layer that reads its int4 filter from the model, the zero
+  // point of every output channel, or nullptr when they are all 0.
+  const int8_t* filter_zero_points;
+  // For a float layer with a sparse filter, its blocks, or nullptr.
+  const SparseFullyConnectedFilter* sparse_filter;
 };
 
 extern const int kFullyConnectedInputTensor;
@@ -0,0 +1,126 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_INT4_UTIL_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_INT4_UTIL_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/micro/kernels/simd_util.h"
+#include "tensorflow/lite/micro/micro_weight_packing.h"
+
+// Helpers for kTfLiteInt4 tensors, whose values are packed two per byte with
+// the value of even index in the low nibble.
+
+namespace tflite {
+namespace micro {
+
+// Returns the value at `index` of a packed int4 array.
+inline int8_t UnpackInt4(const int8_t* packed, int index) {
+  const uint8_t byte = static_cast<uint8_t>(packed[index >> 1]);
+  const int nibble = (index & 1) != 0 ? byte >> 4 : byte & 0x0f;
+  // Sign extends the nibble.
+  return static_cast<int8_t>((nibble ^ 8) - 8);
+}
+
+// Returns the sum of a[i] * b[offset + i] for i in [0, size), where b is a
+// packed int4 array. The values of b are unpacked as they are read. Exact
+// with every backend.
+inline int32_t DotProductInt4(const int8_t* a, const int8_t* b, int offset,
+                              int size) {
+  int32_t sum = 0;
+  if ((offset & 1) != 0 && size > 0) {
+    // Starts on a high nibble, so the loops below read whole bytes.
+    sum = a[0] * UnpackInt4(b, offset);
+    ++a;
+    ++offset;
+    --size;
+  }
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(b) + (offset >> 1);
+  int i = 0;
+#if defined(TF_LITE_MICRO_NEON)
+  int32x4_t acc = vdupq_n_s32(0);
+  for (; i + 16 <= size; i += 16) {
+    const int8x8_t packed = vreinterpret_s8_u8(vld1_u8(bytes + i / 2));
+    // Arithmetic shifts sign extend both nibbles, which zip back into order.
+    const int8x8x2_t vb =
+        vzip_s8(vshr_n_s8(vshl_n_s8(packed, 4), 4), vshr_n_s8(packed, 4));
+    const int8x16_t va = vld1q_s8(a + i);
+    acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vb.val[0]));
+    acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vb.val[1]));
+  }
+  sum += vgetq_lane_s32(acc, 0) + vgetq_lane_s32(acc, 1) +
+         vgetq_lane_s32(acc, 2) + vgetq_lane_s32(acc, 3);
+#elif defined(TF_LITE_MICRO_SSE2)
+  const __m128i high_nibbles = _mm_set1_epi8(static_cast<char>(0xf0));
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= size; i += 16) {
+    const __m128i packed =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes + i / 2));
+    // Moves every nibble into the high half of its own byte, in order, so each
+    // byte holds 16 times its value.
+    const __m128i vb = _mm_unpacklo_epi8(
+        _mm_and_si128(_mm_slli_epi16(packed, 4), high_nibbles),
+        _mm_and_si128(packed, high_nibbles));
+    // Sign extends to int16 and divides by 16 in the same shift.
+    const __m128i b_low = _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 12);
+    const __m128i b_high = _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 12);
+    const __m128i va =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i a_low = _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+    const __m128i a_high = _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(a_low, b_low));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(a_high, b_high));
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  sum += _mm_cvtsi128_si32(acc);
+#endif
+  for (; i + 2 <= size; i += 2) {
+    const int byte = bytes[i / 2];
+    sum += a[i] * (((byte & 0x0f) ^ 8) - 8);
+    sum += a[i + 1] * (((byte >> 4) ^ 8) - 8);
+  }
+  if (i < size) {
+    sum += a[i] * (((bytes[i / 2] & 0x0f) ^ 8) - 8);
+  }
+  return sum;
+}
+
+// Unpacks `size` values of a packed int4 array to int8.
+inline void UnpackInt4(const int8_t* packed, int size, int8_t* output) {
+  for (int i = 0; i < size; ++i) {
+    output[i] = UnpackInt4(packed, i);
+  }
+}
+
+// PackWeightPanels() for an int4 weight matrix, unpacking it to int8.
+inline void PackInt4WeightPanels(const int8_t* weights, int output_depth,
+                                 int accum_depth, int8_t* packed) {
+  for (int panel = 0; panel < output_depth; panel += kWeightPanelWidth) {
+    for (int d = 0; d < accum_depth; ++d) {
+      for (int lane = 0; lane < kWeightPanelWidth; ++lane) {
+        const int channel = panel + lane;
+        *packed++ = channel < output_depth
+                        ? UnpackInt4(weights, channel * accum_depth + d)
+                        : 0;
+      }
+    }
+  }
+}
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_INT4_UTIL_H_
@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/lite/micro/kernels/kernel_runner.h"
 
+#include "tensorflow/lite/micro/test_helpers.h"
+
 namespace tflite {
 namespace micro {
 
 namespace {
 constexpr size_t kBufferAlignment = 16;
+constexpr int kMaxKernelTensors = 8;
 }  // namespace
 
 // TODO(b/161841696): Consider moving away from global arena buffers:
@@ -162,5 +165,29 @@ void KernelRunner::ReportOpError(struct TfLiteContext* context,
   va_end(args);
 }
 
+TfLiteStatus RunKernel(const TfLiteRegistration& registration,
+                       TfLiteTensor* tensors, int tensors_size,
+                       int inputs_size, void* builtin_data,
+                       ErrorReporter* error_reporter) {
+  TFLITE_DCHECK(inputs_size <= tensors_size);
+  TFLITE_DCHECK(tensors_size <= kMaxKernelTensors);
+  int inputs_data[kMaxKernelTensors + 1] = {inputs_size};
+  int outputs_data[kMaxKernelTensors + 1] = {tensors_size - inputs_size};
+  for (int i = 0; i < tensors_size; ++i) {
+    if (i < inputs_size) {
+      inputs_data[i + 1] = i;
+    } else {
+      outputs_data[i - inputs_size + 1] = i;
+    }
+  }
+  KernelRunner runner(registration, tensors, tensors_size,
+                      testing::IntArrayFromInts(inputs_data),
+                      testing::IntArrayFromInts(outputs_data), builtin_data,
+                      error_reporter);
+  TF_LITE_ENSURE_STATUS(
+      runner.InitAndPrepare(reinterpret_cast<const char*>(builtin_data)));
+  return runner.Invoke();
+}
+
 }  // namespace micro
 }  // namespace tflite
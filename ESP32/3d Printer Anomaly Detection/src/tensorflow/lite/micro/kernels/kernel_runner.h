@@ -78,6 +78,14 @@ class KernelRunner {
   uint8_t* scratch_buffers_[kNumScratchBuffers_];
 };
 
+// Runs `registration` through init, prepare and invoke on a node whose inputs
+// are the first `inputs_size` entries of `tensors` and whose outputs are the
+// rest. `builtin_data` is passed to init as well, as kernel tests always have.
+TfLiteStatus RunKernel(const TfLiteRegistration& registration,
+                       TfLiteTensor* tensors, int tensors_size,
+                       int inputs_size, void* builtin_data,
+                       ErrorReporter* error_reporter);
+
 }  // namespace micro
 }  // namespace tflite
 
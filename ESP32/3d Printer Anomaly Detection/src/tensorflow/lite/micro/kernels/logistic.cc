@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/op_macros.h"
+#include "tensorflow/lite/micro/kernels/activation_utils.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 
 namespace tflite {
@@ -38,6 +39,8 @@ struct OpData {
   int32_t input_range_radius;
   int32_t input_multiplier;
   int input_left_shift;
+  // Outputs of the fixed-point kernel for every int8 input, or nullptr.
+  int8_t* table;
 };
 
 TfLiteStatus CalculateArithmeticOpData(TfLiteContext* context, TfLiteNode* node,
@@ -64,6 +67,20 @@ TfLiteStatus CalculateArithmeticOpData(TfLiteContext* context, TfLiteNode* node,
 
     data->input_range_radius =
         CalculateInputRadius(kInputIntegerBits, data->input_left_shift, 31);
+
+    // There are only 256 inputs, so Eval looks the outputs of the fixed-point
+    // kernel up instead of evaluating gemmlowp::logistic per element.
+    data->table = static_cast<int8_t*>(
+        context->AllocatePersistentBuffer(context, kActivationTableSize));
+    TF_LITE_ENSURE(context, data->table != nullptr);
+    PopulateActivationTable(
+        data->table,
+        [&](int size, const int8_t* input_data, int8_t* output_data) {
+          reference_integer_ops::Logistic(
+              data->input_zero_point, data->input_range_radius,
+              data->input_multiplier, data->input_left_shift, size,
+              input_data, output_data);
+        });
   }
   return kTfLiteOk;
 }
@@ -108,12 +125,9 @@ TfLiteStatus LogisticEval(TfLiteContext* context, TfLiteNode* node) {
   } else if (input->type == kTfLiteInt8) {
     switch (output->type) {
       case kTfLiteInt8: {
-        reference_integer_ops::Logistic(
-            data->input_zero_point, data->input_range_radius,
-            data->input_multiplier, data->input_left_shift,
-            NumElements(input->dims),
-            tflite::micro::GetTensorData<int8_t>(input),
-            tflite::micro::GetTensorData<int8_t>(output));
+        LookupActivation(data->table, NumElements(input->dims),
+                         tflite::micro::GetTensorData<int8_t>(input),
+                         tflite::micro::GetTensorData<int8_t>(output));
         return kTfLiteOk;
       }
       default:
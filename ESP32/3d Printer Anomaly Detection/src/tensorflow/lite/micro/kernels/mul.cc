@@ -18,9 +18,9 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/mul.h"
-#include "tensorflow/lite/kernels/internal/reference/process_broadcast_shapes.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/broadcast_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/memory_helpers.h"
 
@@ -46,6 +46,8 @@ struct OpData {
 
   float output_activation_min_f32;
   float output_activation_max_f32;
+
+  tflite::micro::ElementwiseBroadcast broadcast;
 };
 
 TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
@@ -62,6 +64,8 @@ TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
 
   TF_LITE_ENSURE_TYPES_EQ(context, input1->type, input2->type);
 
+  tflite::micro::PrepareElementwiseBroadcast(input1, input2, &data->broadcast);
+
   if (output->type == kTfLiteUInt8 || output->type == kTfLiteInt8) {
     TF_LITE_ENSURE_STATUS(CalculateActivationRangeQuantized(
         context, params->activation, output, &data->output_activation_min,
@@ -85,6 +89,46 @@ TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Row functions of the int8 mul for tflite::micro::BroadcastFivefold(). The
+// broadcast value is offset once per row, the rest is computed as in
+// reference_integer_ops::MulElementwise().
+struct Int8MulOp {
+  const ArithmeticParams* params;
+
+  int8_t Output(int32_t input1_val, int32_t input2_val) const {
+    const int32_t unclamped_result =
+        params->output_offset +
+        MultiplyByQuantizedMultiplier(input1_val * input2_val,
+                                      params->output_multiplier,
+                                      params->output_shift);
+    return static_cast<int8_t>(
+        std::min(params->quantized_activation_max,
+                 std::max(params->quantized_activation_min, unclamped_result)));
+  }
+
+  void Elementwise(int size, const int8_t* input1, const int8_t* input2,
+                   int8_t* output) const {
+    for (int i = 0; i < size; ++i) {
+      output[i] = Output(params->input1_offset + input1[i],
+                         params->input2_offset + input2[i]);
+    }
+  }
+  void BroadcastInput1(int size, int8_t input1, const int8_t* input2,
+                       int8_t* output) const {
+    const int32_t input1_val = params->input1_offset + input1;
+    for (int i = 0; i < size; ++i) {
+      output[i] = Output(input1_val, params->input2_offset + input2[i]);
+    }
+  }
+  void BroadcastInput2(int size, const int8_t* input1, int8_t input2,
+                       int8_t* output) const {
+    const int32_t input2_val = params->input2_offset + input2;
+    for (int i = 0; i < size; ++i) {
+      output[i] = Output(params->input1_offset + input1[i], input2_val);
+    }
+  }
+};
+
 }  // namespace
 
 void EvalQuantized(TfLiteContext* context, TfLiteNode* node, const OpData* data,
@@ -100,12 +144,17 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node, const OpData* data,
   op_params.output_multiplier = data->output_multiplier;
   op_params.output_shift = data->output_shift;
 
-  bool need_broadcast = reference_ops::ProcessBroadcastShapes(
-      tflite::micro::GetTensorShape(input1),
-      tflite::micro::GetTensorShape(input2), &op_params);
+  const bool need_broadcast =
+      data->broadcast.category != BroadcastableOpCategory::kNonBroadcast;
 
   if (output->type == kTfLiteInt8) {
-    if (need_broadcast) {
+    if (tflite::micro::IsFivefoldBroadcast(data->broadcast)) {
+      const Int8MulOp op = {&op_params};
+      tflite::micro::BroadcastFivefold(
+          data->broadcast, tflite::micro::GetTensorData<int8_t>(input1),
+          tflite::micro::GetTensorData<int8_t>(input2),
+          tflite::micro::GetTensorData<int8_t>(output), op);
+    } else if (need_broadcast) {
       reference_integer_ops::BroadcastMul4DSlow(
           op_params, tflite::micro::GetTensorShape(input1),
           tflite::micro::GetTensorData<int8_t>(input1),
@@ -151,11 +200,16 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.float_activation_min = data->output_activation_min_f32;
   op_params.float_activation_max = data->output_activation_max_f32;
 
-  bool need_broadcast = reference_ops::ProcessBroadcastShapes(
-      tflite::micro::GetTensorShape(input1),
-      tflite::micro::GetTensorShape(input2), &op_params);
-
-  if (need_broadcast) {
+  if (tflite::micro::IsFivefoldBroadcast(data->broadcast)) {
+    const tflite::micro::FloatBroadcastOp<tflite::micro::FloatBinaryOp::kMul>
+        op = {data->output_activation_min_f32,
+              data->output_activation_max_f32};
+    tflite::micro::BroadcastFivefold(
+        data->broadcast, tflite::micro::GetTensorData<float>(input1),
+        tflite::micro::GetTensorData<float>(input2),
+        tflite::micro::GetTensorData<float>(output), op);
+  } else if (data->broadcast.category !=
+             BroadcastableOpCategory::kNonBroadcast) {
     reference_ops::BroadcastMul4DSlow(
         op_params, tflite::micro::GetTensorShape(input1),
         tflite::micro::GetTensorData<float>(input1),
@@ -0,0 +1,201 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_PARALLEL_UTIL_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_PARALLEL_UTIL_H_
+
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/micro_thread_pool.h"
+
+namespace tflite {
+namespace micro {
+
+// Returns how many tasks an operator doing `work` multiply-accumulates over
+// `units` independent output units should be split into: 1 when no thread
+// pool is registered or the work is too small to be worth waking it.
+inline int ParallelTaskCount(TfLiteContext* context, int64_t work, int units) {
+  MicroThreadPool* pool = GetMicroThreadPool(context);
+  if (pool == nullptr || work < pool->min_parallel_work()) {
+    return 1;
+  }
+  return pool->num_threads() < units ? pool->num_threads() : units;
+}
+
+// A part of the output of a fully connected layer: either a range of batches,
+// or a range of output channels of the only batch. Data pointers of the
+// operands must be advanced by the offsets (in elements) before use.
+struct FullyConnectedSlice {
+  RuntimeShape filter_shape;
+  RuntimeShape output_shape;
+  int input_offset;
+  int filter_offset;
+  int bias_offset;
+  int output_offset;
+};
+
+// Calls fn(slice) for slices covering the output of a fully connected layer,
+// spread over the registered thread pool. With a single task, fn is called
+// once with the unmodified shapes.
+template <typename Fn>
+void ParallelFullyConnected(TfLiteContext* context,
+                            const RuntimeShape& filter_shape,
+                            const RuntimeShape& output_shape, const Fn& fn) {
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int output_depth = output_shape.Dims(output_dims_count - 1);
+  const int accum_depth = filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+  const bool split_batches = batches > 1;
+  const int units = split_batches ? batches : output_depth;
+  const int task_count = ParallelTaskCount(
+      context, static_cast<int64_t>(batches) * output_depth * accum_depth,
+      units);
+
+  if (task_count == 1) {
+    fn(FullyConnectedSlice{filter_shape, output_shape, 0, 0, 0, 0});
+    return;
+  }
+
+  struct Job {
+    const Fn* fn;
+    bool split_batches;
+    int units;
+    int task_count;
+    int output_depth;
+    int accum_depth;
+    static void Run(void* data, int task_index) {
+      const Job& job = *static_cast<const Job*>(data);
+      const int begin = job.units * task_index / job.task_count;
+      const int end = job.units * (task_index + 1) / job.task_count;
+      if (begin == end) {
+        return;
+      }
+      if (job.split_batches) {
+        (*job.fn)(FullyConnectedSlice{
+            RuntimeShape({job.output_depth, job.accum_depth}),
+            RuntimeShape({end - begin, job.output_depth}),
+            begin * job.accum_depth, 0, 0, begin * job.output_depth});
+      } else {
+        (*job.fn)(FullyConnectedSlice{
+            RuntimeShape({end - begin, job.accum_depth}),
+            RuntimeShape({1, end - begin}), 0, begin * job.accum_depth, begin,
+            begin});
+      }
+    }
+  };
+  Job job = {&fn, split_batches, units, task_count, output_depth, accum_depth};
+  GetMicroThreadPool(context)->Run(Job::Run, &job, task_count);
+}
+
+// A range of output rows of a single batch of an NHWC convolution. Data
+// pointers must be advanced by the offsets (in elements), and the padding
+// height replaced, before calling the reference kernel.
+struct ConvSlice {
+  RuntimeShape input_shape;
+  RuntimeShape output_shape;
+  int input_offset;
+  int output_offset;
+  int padding_height;
+};
+
+// Calls fn(slice) for slices covering output rows [first_row, output_height)
+// of every batch of a CONV_2D or DEPTHWISE_CONV_2D, spread over the registered
+// thread pool. Output rows are independent, and shifting the top padding by
+// the first row of a slice makes the reference kernel compute exactly those
+// rows from the full input. With a single task and first_row 0, fn is called
+// once with the unmodified shapes.
+template <typename Fn>
+void ParallelConv(TfLiteContext* context, const RuntimeShape& input_shape,
+                  const RuntimeShape& output_shape, int64_t work_per_output,
+                  int stride_height, int padding_height, int first_row,
+                  const Fn& fn) {
+  const int batches = output_shape.Dims(0);
+  const int output_height = output_shape.Dims(1);
+  const int rows = output_height - first_row;
+  const int units = batches * rows;
+  if (units <= 0) {
+    return;
+  }
+  int task_count = ParallelTaskCount(
+      context,
+      work_per_output * units * output_shape.Dims(2) * output_shape.Dims(3),
+      units);
+  // The shifted padding must still fit PaddingValues.
+  if (static_cast<int64_t>(output_height) * stride_height - padding_height >
+      -static_cast<int64_t>(std::numeric_limits<int16_t>::min())) {
+    task_count = 1;
+  }
+
+  if (task_count == 1 && first_row == 0) {
+    fn(ConvSlice{input_shape, output_shape, 0, 0, padding_height});
+    return;
+  }
+
+  struct Job {
+    const Fn* fn;
+    int units;
+    int task_count;
+    int first_row;
+    int rows;
+    int stride_height;
+    int padding_height;
+    const RuntimeShape* input_shape;
+    const RuntimeShape* output_shape;
+    static void Run(void* data, int task_index) {
+      const Job& job = *static_cast<const Job*>(data);
+      const int input_batch_size = job.input_shape->FlatSize() /
+                                   job.input_shape->Dims(0);
+      const int output_row_size =
+          job.output_shape->Dims(2) * job.output_shape->Dims(3);
+      const int output_height = job.output_shape->Dims(1);
+      const int begin = job.units * task_index / job.task_count;
+      const int end = job.units * (task_index + 1) / job.task_count;
+      // A task's rows may span several batches, run one slice per batch.
+      for (int unit = begin; unit < end;) {
+        const int batch = unit / job.rows;
+        const int row = job.first_row + unit % job.rows;
+        int rows = output_height - row;
+        if (rows > end - unit) {
+          rows = end - unit;
+        }
+        (*job.fn)(ConvSlice{
+            RuntimeShape({1, job.input_shape->Dims(1),
+                          job.input_shape->Dims(2),
+                          job.input_shape->Dims(3)}),
+            RuntimeShape({1, rows, job.output_shape->Dims(2),
+                          job.output_shape->Dims(3)}),
+            batch * input_batch_size,
+            (batch * output_height + row) * output_row_size,
+            job.padding_height - row * job.stride_height});
+        unit += rows;
+      }
+    }
+  };
+  Job job = {&fn,          units,         task_count,     first_row,
+             rows,         stride_height, padding_height, &input_shape,
+             &output_shape};
+  if (task_count == 1) {
+    Job::Run(&job, 0);
+    return;
+  }
+  GetMicroThreadPool(context)->Run(Job::Run, &job, task_count);
+}
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_PARALLEL_UTIL_H_
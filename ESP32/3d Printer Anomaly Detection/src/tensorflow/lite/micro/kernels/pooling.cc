@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_streaming.h"
 
 namespace tflite {
 namespace ops {
@@ -237,6 +238,16 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                       &data->activation_max);
   }
 
+  // Pooling is cheap to recompute, but passes the shift of a stream on to the
+  // layers after it, see MicroInterpreter::SetStreamingHop().
+  PrepareStreamingOutput(
+      context, node->inputs->data[kInputTensor],
+      node->outputs->data[kOutputTensor], params->stride_height,
+      WindowReadsPadding(SizeOfDimension(input, 1), SizeOfDimension(output, 1),
+                         params->filter_height, params->stride_height,
+                         /*dilation=*/1, data->padding.height),
+      /*cache_output=*/false);
+
   return kTfLiteOk;
 }
 
@@ -13,12 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
+
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
-#include "tensorflow/lite/kernels/internal/reference/quantize.h"
-#include "tensorflow/lite/kernels/internal/reference/requantize.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/conversion_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/kernels/quantize.h"
 #include "tensorflow/lite/micro/micro_utils.h"
@@ -33,26 +34,30 @@ TfLiteStatus EvalQuantizeReference(TfLiteContext* context, TfLiteNode* node) {
   TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, 0);
 
   if (input->type == kTfLiteFloat32) {
+    const int size = MatchingFlatSize(tflite::micro::GetTensorShape(input),
+                                      tflite::micro::GetTensorShape(output));
+    const float scale = static_cast<float>(data->quantization_params.scale);
+    const int32_t zero_point = data->quantization_params.zero_point;
     switch (output->type) {
       case kTfLiteInt8:
-        reference_ops::AffineQuantize(
-            data->quantization_params, tflite::micro::GetTensorShape(input),
-            tflite::micro::GetTensorData<float>(input),
-            tflite::micro::GetTensorShape(output),
+        tflite::micro::QuantizeFloat(
+            tflite::micro::GetTensorData<float>(input), size, scale,
+            zero_point, std::numeric_limits<int8_t>::min(),
+            std::numeric_limits<int8_t>::max(),
             tflite::micro::GetTensorData<int8_t>(output));
         break;
       case kTfLiteUInt8:
-        reference_ops::AffineQuantize(
-            data->quantization_params, tflite::micro::GetTensorShape(input),
-            tflite::micro::GetTensorData<float>(input),
-            tflite::micro::GetTensorShape(output),
+        tflite::micro::QuantizeFloat(
+            tflite::micro::GetTensorData<float>(input), size, scale,
+            zero_point, std::numeric_limits<uint8_t>::min(),
+            std::numeric_limits<uint8_t>::max(),
             tflite::micro::GetTensorData<uint8_t>(output));
         break;
       case kTfLiteInt16:
-        reference_ops::AffineQuantize(
-            data->quantization_params, tflite::micro::GetTensorShape(input),
-            tflite::micro::GetTensorData<float>(input),
-            tflite::micro::GetTensorShape(output),
+        tflite::micro::QuantizeFloat(
+            tflite::micro::GetTensorData<float>(input), size, scale,
+            zero_point, std::numeric_limits<int16_t>::min(),
+            std::numeric_limits<int16_t>::max(),
             tflite::micro::GetTensorData<int16_t>(output));
         return kTfLiteOk;
       default:
@@ -65,21 +70,21 @@ TfLiteStatus EvalQuantizeReference(TfLiteContext* context, TfLiteNode* node) {
     size_t size = ElementCount(*input->dims);
     switch (output->type) {
       case kTfLiteInt8:
-        reference_ops::Requantize(
+        tflite::micro::RequantizeToType(
             tflite::micro::GetTensorData<int16_t>(input), size,
             data->requantize_output_multiplier, data->requantize_output_shift,
             data->input_zero_point, data->quantization_params.zero_point,
             tflite::micro::GetTensorData<int8_t>(output));
         break;
       case kTfLiteInt16:
-        reference_ops::Requantize(
+        tflite::micro::RequantizeToType(
             tflite::micro::GetTensorData<int16_t>(input), size,
             data->requantize_output_multiplier, data->requantize_output_shift,
             data->input_zero_point, data->quantization_params.zero_point,
             tflite::micro::GetTensorData<int16_t>(output));
         return kTfLiteOk;
       case kTfLiteInt32:
-        reference_ops::Requantize(
+        tflite::micro::RequantizeToType(
             tflite::micro::GetTensorData<int16_t>(input), size,
             data->requantize_output_multiplier, data->requantize_output_shift,
             data->input_zero_point, data->quantization_params.zero_point,
@@ -97,7 +102,7 @@ TfLiteStatus EvalQuantizeReference(TfLiteContext* context, TfLiteNode* node) {
     size_t size = ElementCount(*input->dims);
     switch (output->type) {
       case kTfLiteInt8:
-        reference_ops::Requantize(
+        tflite::micro::RequantizeToType(
             tflite::micro::GetTensorData<int8_t>(input), size,
             data->requantize_output_multiplier, data->requantize_output_shift,
             data->input_zero_point, data->quantization_params.zero_point,
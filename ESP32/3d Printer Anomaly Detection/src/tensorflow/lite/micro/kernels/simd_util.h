@@ -0,0 +1,261 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_SIMD_UTIL_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_SIMD_UTIL_H_
+
+#include <cstdint>
+
+// Selects the vector backend of the helpers below. NEON is used on ARM hosts
+// and SSE2 on x86 hosts. Define TF_LITE_MICRO_NO_SIMD to always use the
+// portable loops, which are what microcontrollers without a vector unit run.
+#if defined(TF_LITE_MICRO_NO_SIMD)
+// Portable loops only.
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TF_LITE_MICRO_NEON
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#define TF_LITE_MICRO_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace tflite {
+namespace micro {
+
+// True when the dot products below run on a vector backend.
+#if defined(TF_LITE_MICRO_NEON) || defined(TF_LITE_MICRO_SSE2)
+constexpr bool kHasVectorDotProduct = true;
+#else
+constexpr bool kHasVectorDotProduct = false;
+#endif
+
+// Returns the sum of a[i] * b[i] for i in [0, size). Exact with every backend.
+inline int32_t DotProductInt8(const int8_t* a, const int8_t* b, int size) {
+  int i = 0;
+  int32_t sum = 0;
+#if defined(TF_LITE_MICRO_NEON)
+  int32x4_t acc = vdupq_n_s32(0);
+  for (; i + 16 <= size; i += 16) {
+    const int8x16_t va = vld1q_s8(a + i);
+    const int8x16_t vb = vld1q_s8(b + i);
+    // Each product fits an int16, but the sum of two may not.
+    acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+    acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+  }
+  sum = vgetq_lane_s32(acc, 0) + vgetq_lane_s32(acc, 1) +
+        vgetq_lane_s32(acc, 2) + vgetq_lane_s32(acc, 3);
+#elif defined(TF_LITE_MICRO_SSE2)
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= size; i += 16) {
+    const __m128i va =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    // Sign extend to int16 by unpacking each byte into the high half and
+    // shifting it back down.
+    const __m128i a_low = _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+    const __m128i a_high = _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+    const __m128i b_low = _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8);
+    const __m128i b_high = _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8);
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(a_low, b_low));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(a_high, b_high));
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  sum = _mm_cvtsi128_si32(acc);
+#endif
+  for (; i < size; ++i) {
+    sum += static_cast<int32_t>(a[i]) * b[i];
+  }
+  return sum;
+}
+
+// Returns the sum of a[i] for i in [0, size).
+inline int32_t SumInt8(const int8_t* a, int size) {
+  int32_t sum = 0;
+  for (int i = 0; i < size; ++i) {
+    sum += a[i];
+  }
+  return sum;
+}
+
+// Returns the sum of a[i] * b[i] for i in [0, size). The portable loop adds
+// the products in order, like the reference kernels. The vector backends
+// keep four partial sums, so their results may differ in the last bits.
+inline float DotProductFloat(const float* a, const float* b, int size) {
+  int i = 0;
+  float sum = 0.0f;
+#if defined(TF_LITE_MICRO_NEON)
+  if (size >= 4) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= size; i += 4) {
+      acc = vaddq_f32(acc, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+    sum = (vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 2)) +
+          (vgetq_lane_f32(acc, 1) + vgetq_lane_f32(acc, 3));
+  }
+#elif defined(TF_LITE_MICRO_SSE2)
+  if (size >= 4) {
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= size; i += 4) {
+      acc = _mm_add_ps(acc,
+                       _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+  }
+#endif
+  for (; i < size; ++i) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+// Adds (a[i] + a_offset) * b[i] to acc[i] for i in [0, size), where
+// a_offset is in [-255, 255]. Exact with every backend.
+inline void MultiplyAccumulateInt8(const int8_t* a, const int8_t* b,
+                                   int32_t a_offset, int size, int32_t* acc) {
+  int i = 0;
+#if defined(TF_LITE_MICRO_NEON)
+  const int16x8_t offset = vdupq_n_s16(static_cast<int16_t>(a_offset));
+  for (; i + 8 <= size; i += 8) {
+    const int16x8_t va = vaddq_s16(vmovl_s8(vld1_s8(a + i)), offset);
+    const int16x8_t vb = vmovl_s8(vld1_s8(b + i));
+    vst1q_s32(acc + i, vmlal_s16(vld1q_s32(acc + i), vget_low_s16(va),
+                                 vget_low_s16(vb)));
+    vst1q_s32(acc + i + 4, vmlal_s16(vld1q_s32(acc + i + 4),
+                                     vget_high_s16(va), vget_high_s16(vb)));
+  }
+#elif defined(TF_LITE_MICRO_SSE2)
+  const __m128i offset = _mm_set1_epi16(static_cast<int16_t>(a_offset));
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8 <= size; i += 8) {
+    const __m128i va8 =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb8 =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(b + i));
+    const __m128i va =
+        _mm_add_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(va8, va8), 8), offset);
+    const __m128i vb = _mm_srai_epi16(_mm_unpacklo_epi8(vb8, vb8), 8);
+    // Pairing every value with a zero makes _mm_madd_epi16 return the plain
+    // 32-bit products.
+    const __m128i products_low = _mm_madd_epi16(_mm_unpacklo_epi16(va, zero),
+                                                _mm_unpacklo_epi16(vb, zero));
+    const __m128i products_high = _mm_madd_epi16(
+        _mm_unpackhi_epi16(va, zero), _mm_unpackhi_epi16(vb, zero));
+    __m128i* out = reinterpret_cast<__m128i*>(acc + i);
+    _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), products_low));
+    _mm_storeu_si128(out + 1,
+                     _mm_add_epi32(_mm_loadu_si128(out + 1), products_high));
+  }
+#endif
+  for (; i < size; ++i) {
+    acc[i] += (a[i] + a_offset) * b[i];
+  }
+}
+
+// Adds a[i] * b[i] to acc[i] for i in [0, size). Every element is updated
+// with a single multiply and add, so results are the same with every backend.
+inline void MultiplyAccumulateFloat(const float* a, const float* b, int size,
+                                    float* acc) {
+  int i = 0;
+#if defined(TF_LITE_MICRO_NEON)
+  for (; i + 4 <= size; i += 4) {
+    const float32x4_t products = vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+    vst1q_f32(acc + i, vaddq_f32(vld1q_f32(acc + i), products));
+  }
+#elif defined(TF_LITE_MICRO_SSE2)
+  for (; i + 4 <= size; i += 4) {
+    _mm_storeu_ps(acc + i,
+                  _mm_add_ps(_mm_loadu_ps(acc + i),
+                             _mm_mul_ps(_mm_loadu_ps(a + i),
+                                        _mm_loadu_ps(b + i))));
+  }
+#endif
+  for (; i < size; ++i) {
+    acc[i] += a[i] * b[i];
+  }
+}
+
+// Returns the dot product of `input` with a row of a block sparse matrix:
+// the sum of values[k * block_size + j] * input[columns[k] * block_size + j]
+// for k in [begin, end) and j in [0, block_size). Like DotProductFloat(), the
+// portable loop adds the products in order and the vector backends keep four
+// partial sums, for blocks of one weight or of a multiple of four weights.
+inline float BlockSparseDotProductFloat(const float* values,
+                                        const uint16_t* columns, int begin,
+                                        int end, int block_size,
+                                        const float* input) {
+  int k = begin;
+  float sum = 0.0f;
+#if defined(TF_LITE_MICRO_NEON) || defined(TF_LITE_MICRO_SSE2)
+#if defined(TF_LITE_MICRO_NEON)
+  float32x4_t acc = vdupq_n_f32(0.0f);
+#else
+  __m128 acc = _mm_setzero_ps();
+#endif
+  if (block_size == 1) {
+    // Gathers the inputs of four blocks into a vector.
+    for (; k + 4 <= end; k += 4) {
+#if defined(TF_LITE_MICRO_NEON)
+      float32x4_t x = vdupq_n_f32(input[columns[k]]);
+      x = vsetq_lane_f32(input[columns[k + 1]], x, 1);
+      x = vsetq_lane_f32(input[columns[k + 2]], x, 2);
+      x = vsetq_lane_f32(input[columns[k + 3]], x, 3);
+      acc = vaddq_f32(acc, vmulq_f32(vld1q_f32(values + k), x));
+#else
+      const __m128 x =
+          _mm_setr_ps(input[columns[k]], input[columns[k + 1]],
+                      input[columns[k + 2]], input[columns[k + 3]]);
+      acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(values + k), x));
+#endif
+    }
+  } else if (block_size % 4 == 0) {
+    for (; k < end; ++k) {
+      const float* w = values + k * block_size;
+      const float* x = input + columns[k] * block_size;
+      for (int j = 0; j < block_size; j += 4) {
+#if defined(TF_LITE_MICRO_NEON)
+        acc = vaddq_f32(acc, vmulq_f32(vld1q_f32(w + j), vld1q_f32(x + j)));
+#else
+        acc = _mm_add_ps(acc,
+                         _mm_mul_ps(_mm_loadu_ps(w + j), _mm_loadu_ps(x + j)));
+#endif
+      }
+    }
+  }
+#if defined(TF_LITE_MICRO_NEON)
+  sum = (vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 2)) +
+        (vgetq_lane_f32(acc, 1) + vgetq_lane_f32(acc, 3));
+#else
+  acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+  acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+  sum = _mm_cvtss_f32(acc);
+#endif
+#endif
+  for (; k < end; ++k) {
+    const float* w = values + k * block_size;
+    const float* x = input + columns[k] * block_size;
+    for (int j = 0; j < block_size; ++j) {
+      sum += w[j] * x[j];
+    }
+  }
+  return sum;
+}
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_SIMD_UTIL_H_
@@ -63,7 +63,11 @@ TfLiteStatus SplitImpl(TfLiteContext* context, TfLiteNode* node,
       const int copy_size =
           output_tensor->dims->data[axis_value] * base_inner_size;
       T* output_ptr = output_data + k * copy_size;
-      for (int j = 0; j < copy_size; ++j) output_ptr[j] = input_ptr[j];
+      // The memory planner makes the outputs of a split along the outermost
+      // dimension views of the input, which leaves nothing to copy.
+      if (output_ptr != input_ptr) {
+        for (int j = 0; j < copy_size; ++j) output_ptr[j] = input_ptr[j];
+      }
       input_ptr += copy_size;
     }
   }
@@ -19,11 +19,11 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
-#include "tensorflow/lite/kernels/internal/reference/process_broadcast_shapes.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/op_macros.h"
+#include "tensorflow/lite/micro/kernels/broadcast_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 
 namespace tflite {
@@ -37,6 +37,7 @@ constexpr int kOutputTensor = 0;
 
 struct OpData {
   bool requires_broadcast;
+  tflite::micro::ElementwiseBroadcast broadcast;
 
   // These fields are used in both the general 8-bit -> 8bit quantized path,
   // and the special 16-bit -> 16bit quantized path
@@ -61,6 +62,7 @@ TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteSubParams* params,
                              const TfLiteTensor* input2, TfLiteTensor* output,
                              OpData* data) {
   data->requires_broadcast = !HaveSameShapes(input1, input2);
+  tflite::micro::PrepareElementwiseBroadcast(input1, input2, &data->broadcast);
 
   if (output->type == kTfLiteUInt8 || output->type == kTfLiteInt8) {
     // 8bit -> 8bit general quantized path, with general rescalings
@@ -119,6 +121,57 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
 
+// Row functions of the int8 sub for tflite::micro::BroadcastFivefold(). The
+// broadcast value is scaled once per row, the rest is computed as in
+// reference_ops::SubElementwise().
+struct Int8SubOp {
+  const ArithmeticParams* params;
+
+  static int32_t ScaleInput(int8_t value, int32_t offset, int32_t multiplier,
+                            int shift, int left_shift) {
+    return MultiplyByQuantizedMultiplierSmallerThanOneExp(
+        (offset + value) * (1 << left_shift), multiplier, shift);
+  }
+  int32_t ScaleInput1(int8_t value) const {
+    return ScaleInput(value, params->input1_offset, params->input1_multiplier,
+                      params->input1_shift, params->left_shift);
+  }
+  int32_t ScaleInput2(int8_t value) const {
+    return ScaleInput(value, params->input2_offset, params->input2_multiplier,
+                      params->input2_shift, params->left_shift);
+  }
+  int8_t Output(int32_t raw_sub) const {
+    const int32_t raw_output =
+        MultiplyByQuantizedMultiplierSmallerThanOneExp(
+            raw_sub, params->output_multiplier, params->output_shift) +
+        params->output_offset;
+    return static_cast<int8_t>(
+        std::min(params->quantized_activation_max,
+                 std::max(params->quantized_activation_min, raw_output)));
+  }
+
+  void Elementwise(int size, const int8_t* input1, const int8_t* input2,
+                   int8_t* output) const {
+    for (int i = 0; i < size; ++i) {
+      output[i] = Output(ScaleInput1(input1[i]) - ScaleInput2(input2[i]));
+    }
+  }
+  void BroadcastInput1(int size, int8_t input1, const int8_t* input2,
+                       int8_t* output) const {
+    const int32_t scaled_input1 = ScaleInput1(input1);
+    for (int i = 0; i < size; ++i) {
+      output[i] = Output(scaled_input1 - ScaleInput2(input2[i]));
+    }
+  }
+  void BroadcastInput2(int size, const int8_t* input1, int8_t input2,
+                       int8_t* output) const {
+    const int32_t scaled_input2 = ScaleInput2(input2);
+    for (int i = 0; i < size; ++i) {
+      output[i] = Output(ScaleInput1(input1[i]) - scaled_input2);
+    }
+  }
+};
+
 void EvalSub(TfLiteContext* context, TfLiteNode* node, TfLiteSubParams* params,
              const OpData* data, const TfLiteEvalTensor* input1,
              const TfLiteEvalTensor* input2, TfLiteEvalTensor* output) {
@@ -127,7 +180,15 @@ void EvalSub(TfLiteContext* context, TfLiteNode* node, TfLiteSubParams* params,
                            &output_activation_max);
   tflite::ArithmeticParams op_params;
   SetActivationParams(output_activation_min, output_activation_max, &op_params);
-  if (data->requires_broadcast) {
+  if (data->requires_broadcast &&
+      tflite::micro::IsFivefoldBroadcast(data->broadcast)) {
+    const tflite::micro::FloatBroadcastOp<tflite::micro::FloatBinaryOp::kSub>
+        op = {output_activation_min, output_activation_max};
+    tflite::micro::BroadcastFivefold(
+        data->broadcast, tflite::micro::GetTensorData<float>(input1),
+        tflite::micro::GetTensorData<float>(input2),
+        tflite::micro::GetTensorData<float>(output), op);
+  } else if (data->requires_broadcast) {
     tflite::reference_ops::BroadcastSubSlow(
         op_params, tflite::micro::GetTensorShape(input1),
         tflite::micro::GetTensorData<float>(input1),
@@ -165,12 +226,17 @@ TfLiteStatus EvalSubQuantized(TfLiteContext* context, TfLiteNode* node,
     op_params.output_shift = data->output_shift;
     SetActivationParams(data->output_activation_min,
                         data->output_activation_max, &op_params);
-    bool need_broadcast = reference_ops::ProcessBroadcastShapes(
-        tflite::micro::GetTensorShape(input1),
-        tflite::micro::GetTensorShape(input2), &op_params);
+    const bool need_broadcast =
+        data->broadcast.category != BroadcastableOpCategory::kNonBroadcast;
 
     if (output->type == kTfLiteInt8) {
-      if (need_broadcast) {
+      if (tflite::micro::IsFivefoldBroadcast(data->broadcast)) {
+        const Int8SubOp op = {&op_params};
+        tflite::micro::BroadcastFivefold(
+            data->broadcast, tflite::micro::GetTensorData<int8_t>(input1),
+            tflite::micro::GetTensorData<int8_t>(input2),
+            tflite::micro::GetTensorData<int8_t>(output), op);
+      } else if (need_broadcast) {
         tflite::reference_ops::BroadcastSubSlow(
             op_params, tflite::micro::GetTensorShape(input1),
             tflite::micro::GetTensorData<int8_t>(input1),
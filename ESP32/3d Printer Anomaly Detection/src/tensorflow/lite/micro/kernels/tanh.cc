@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/op_macros.h"
+#include "tensorflow/lite/micro/kernels/activation_utils.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/micro_utils.h"
 
@@ -39,6 +40,8 @@ struct OpData {
   int32_t input_range_radius;
   int32_t input_multiplier;
   int input_left_shift;
+  // Outputs of the fixed-point kernel for every 8-bit input, or nullptr.
+  void* table;
 };
 
 void* TanhInit(TfLiteContext* context, const char* buffer, size_t length) {
@@ -72,6 +75,44 @@ TfLiteStatus CalculateArithmeticOpData(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// There are only 256 8-bit inputs, so Eval looks the outputs of the
+// fixed-point kernel up instead of evaluating gemmlowp::tanh per element.
+TfLiteStatus PopulateTable(TfLiteContext* context, TfLiteType type,
+                           OpData* data) {
+  data->table = nullptr;
+  if (type != kTfLiteInt8 && type != kTfLiteUInt8) {
+    return kTfLiteOk;
+  }
+  data->table =
+      context->AllocatePersistentBuffer(context, kActivationTableSize);
+  TF_LITE_ENSURE(context, data->table != nullptr);
+  if (type == kTfLiteInt8) {
+    PopulateActivationTable(
+        static_cast<int8_t*>(data->table),
+        [&](int size, const int8_t* input_data, int8_t* output_data) {
+          const RuntimeShape shape({size});
+          reference_integer_ops::Tanh(data->input_zero_point,
+                                      data->input_range_radius,
+                                      data->input_multiplier,
+                                      data->input_left_shift, shape,
+                                      input_data, shape, output_data);
+        });
+  } else {
+    TanhParams params;
+    params.input_zero_point = data->input_zero_point;
+    params.input_range_radius = data->input_range_radius;
+    params.input_multiplier = data->input_multiplier;
+    params.input_left_shift = data->input_left_shift;
+    PopulateActivationTable(
+        static_cast<uint8_t*>(data->table),
+        [&](int size, const uint8_t* input_data, uint8_t* output_data) {
+          const RuntimeShape shape({size});
+          reference_ops::Tanh(params, shape, input_data, shape, output_data);
+        });
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus TanhPrepare(TfLiteContext* context, TfLiteNode* node) {
   TFLITE_DCHECK(node->user_data != nullptr);
 
@@ -80,7 +121,8 @@ TfLiteStatus TanhPrepare(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* input = GetInput(context, node, kInputTensor);
   TF_LITE_ENSURE(context, input != nullptr);
   data->input_zero_point = input->params.zero_point;
-  return CalculateArithmeticOpData(context, node, data);
+  TF_LITE_ENSURE_STATUS(CalculateArithmeticOpData(context, node, data));
+  return PopulateTable(context, input->type, data);
 }
 
 }  // namespace
@@ -112,25 +154,19 @@ TfLiteStatus TanhEval(TfLiteContext* context, TfLiteNode* node) {
       return kTfLiteOk;
     } break;
     case kTfLiteUInt8: {
-      TanhParams params;
-      params.input_zero_point = data.input_zero_point;
-      params.input_range_radius = data.input_range_radius;
-      params.input_multiplier = data.input_multiplier;
-      params.input_left_shift = data.input_left_shift;
-      reference_ops::Tanh(params, tflite::micro::GetTensorShape(input),
-                          tflite::micro::GetTensorData<uint8_t>(input),
-                          tflite::micro::GetTensorShape(output),
-                          tflite::micro::GetTensorData<uint8_t>(output));
-
+      LookupActivation(static_cast<const uint8_t*>(data.table),
+                       MatchingFlatSize(tflite::micro::GetTensorShape(input),
+                                        tflite::micro::GetTensorShape(output)),
+                       tflite::micro::GetTensorData<uint8_t>(input),
+                       tflite::micro::GetTensorData<uint8_t>(output));
       return kTfLiteOk;
     } break;
     case kTfLiteInt8: {
-      reference_integer_ops::Tanh(
-          data.input_zero_point, data.input_range_radius, data.input_multiplier,
-          data.input_left_shift, tflite::micro::GetTensorShape(input),
-          tflite::micro::GetTensorData<int8_t>(input),
-          tflite::micro::GetTensorShape(output),
-          tflite::micro::GetTensorData<int8_t>(output));
+      LookupActivation(static_cast<const int8_t*>(data.table),
+                       MatchingFlatSize(tflite::micro::GetTensorShape(input),
+                                        tflite::micro::GetTensorShape(output)),
+                       tflite::micro::GetTensorData<int8_t>(input),
+                       tflite::micro::GetTensorData<int8_t>(output));
       return kTfLiteOk;
     } break;
     default:
@@ -51,6 +51,9 @@ TfLiteStatus TfLiteTypeSizeOf(TfLiteType type, size_t* size) {
     case kTfLiteFloat32:
       *size = sizeof(float);
       break;
+    case kTfLiteFloat16:
+      *size = sizeof(TfLiteFloat16);
+      break;
     case kTfLiteInt16:
       *size = sizeof(int16_t);
       break;
@@ -99,11 +102,25 @@ TfLiteStatus BytesRequiredForTensor(const tflite::Tensor& flatbuffer_tensor,
   TfLiteType tf_lite_type;
   TF_LITE_ENSURE_STATUS(ConvertTensorType(flatbuffer_tensor.type(),
                                           &tf_lite_type, error_reporter));
+  if (tf_lite_type == kTfLiteInt4) {
+    // Two values share each byte.
+    *type_size = sizeof(int8_t);
+    *bytes = (element_count + 1) / 2;
+    return kTfLiteOk;
+  }
   TF_LITE_ENSURE_STATUS(TfLiteTypeSizeOf(tf_lite_type, type_size));
   *bytes = element_count * (*type_size);
   return kTfLiteOk;
 }
 
+size_t ConstantTensorByteLength(const tflite::Model& model,
+                                const tflite::Tensor& flatbuffer_tensor) {
+  const Buffer* buffer = model.buffers()->Get(flatbuffer_tensor.buffer());
+  return buffer != nullptr && buffer->data() != nullptr
+             ? buffer->data()->size()
+             : 0;
+}
+
 TfLiteStatus TfLiteEvalTensorByteLength(const TfLiteEvalTensor* eval_tensor,
                                         size_t* out_bytes) {
   TFLITE_DCHECK(out_bytes != nullptr);
@@ -115,6 +132,10 @@ TfLiteStatus TfLiteEvalTensorByteLength(const TfLiteEvalTensor* eval_tensor,
       element_count *= eval_tensor->dims->data[n];
     }
   }
+  if (eval_tensor->type == kTfLiteInt4) {
+    *out_bytes = (element_count + 1) / 2;
+    return kTfLiteOk;
+  }
   size_t type_size;
   TF_LITE_ENSURE_STATUS(TfLiteTypeSizeOf(eval_tensor->type, &type_size));
   *out_bytes = element_count * type_size;
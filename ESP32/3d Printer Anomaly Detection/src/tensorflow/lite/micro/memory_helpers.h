@@ -33,14 +33,22 @@ uint8_t* AlignPointerDown(uint8_t* data, size_t alignment);
 // Returns an increased size that's a multiple of alignment.
 size_t AlignSizeUp(size_t size, size_t alignment);
 
-// Returns size in bytes for a given TfLiteType.
+// Returns size in bytes for a given TfLiteType. Fails for kTfLiteInt4, whose
+// values take half a byte.
 TfLiteStatus TfLiteTypeSizeOf(TfLiteType type, size_t* size);
 
-// How many bytes are needed to hold a tensor's contents.
+// How many bytes are needed to hold a tensor's contents. For an int4 tensor,
+// type_size is that of the int8_t holding two values.
 TfLiteStatus BytesRequiredForTensor(const tflite::Tensor& flatbuffer_tensor,
                                     size_t* bytes, size_t* type_size,
                                     ErrorReporter* error_reporter);
 
+// How many bytes of `model` hold the contents of a constant tensor. Unlike
+// TfLiteEvalTensorByteLength(), this is right for sparse tensors, which only
+// store their non-zero values.
+size_t ConstantTensorByteLength(const tflite::Model& model,
+                                const tflite::Tensor& flatbuffer_tensor);
+
 // How many bytes are used in a TfLiteEvalTensor instance. The byte length is
 // returned in out_bytes.
 TfLiteStatus TfLiteEvalTensorByteLength(const TfLiteEvalTensor* eval_tensor,
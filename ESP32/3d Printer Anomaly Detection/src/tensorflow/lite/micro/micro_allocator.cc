@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "flatbuffers/flatbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/c/common.h"
@@ -54,6 +55,11 @@ struct AllocationInfo {
   int last_used;
   int32_t offline_offset;
   bool needs_allocating;
+  // Index of the buffer this one lives in, or -1 if it is planned on its own.
+  // A shared buffer starts `alias_offset` bytes into that buffer, see
+  // AllocationInfoBuilder::AddAliases().
+  int alias_of;
+  size_t alias_offset;
 };
 
 // We align tensor buffers to 16-byte boundaries, since this is a common
@@ -148,16 +154,81 @@ TfLiteStatus CheckOfflinePlannedOffsets(const Model* model,
 }
 #endif
 
+// How the buffers of an operator's inputs and outputs may be shared.
+enum class BufferSharing {
+  kNone,
+  // Elementwise or reshaping operators, which compute each output element
+  // only from the input element at the same position. Running in place works
+  // as long as both have the same size.
+  kInPlace,
+  // The output of a concatenation along the outermost dimension is its inputs
+  // laid end to end, so the inputs can be produced at their final position.
+  kConcatView,
+  // The outputs of a split along the outermost dimension are consecutive
+  // slices of the input, so they can be read where the input is.
+  kSplitView,
+};
+
+BufferSharing GetBufferSharing(BuiltinOperator op) {
+  switch (op) {
+    case BuiltinOperator_ABS:
+    case BuiltinOperator_CEIL:
+    case BuiltinOperator_COS:
+    case BuiltinOperator_DEQUANTIZE:
+    case BuiltinOperator_FLOOR:
+    case BuiltinOperator_HARD_SWISH:
+    case BuiltinOperator_LOG:
+    case BuiltinOperator_LOGICAL_NOT:
+    case BuiltinOperator_LOGISTIC:
+    case BuiltinOperator_NEG:
+    case BuiltinOperator_QUANTIZE:
+    case BuiltinOperator_RELU:
+    case BuiltinOperator_RELU6:
+    case BuiltinOperator_RESHAPE:
+    case BuiltinOperator_ROUND:
+    case BuiltinOperator_RSQRT:
+    case BuiltinOperator_SIN:
+    case BuiltinOperator_SQRT:
+    case BuiltinOperator_SQUARE:
+    case BuiltinOperator_TANH:
+      return BufferSharing::kInPlace;
+    case BuiltinOperator_CONCATENATION:
+      return BufferSharing::kConcatView;
+    case BuiltinOperator_SPLIT:
+    case BuiltinOperator_SPLIT_V:
+      return BufferSharing::kSplitView;
+    default:
+      return BufferSharing::kNone;
+  }
+}
+
+// Returns true if slicing `dims` along `axis` gives contiguous blocks, i.e.
+// all dimensions before `axis` are 1.
+bool IsOuterDimension(const TfLiteIntArray* dims, int axis) {
+  if (dims == nullptr || axis < 0 || axis >= dims->size) {
+    return false;
+  }
+  for (int i = 0; i < axis; ++i) {
+    if (dims->data[i] != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // A helper class to construct AllocationInfo array. This array contains the
 // lifetime of tensors / scratch_buffer and will be used to calculate the memory
 // plan. Methods need to be called in order from `Init`, `Add*`, to `Finish`.
 class AllocationInfoBuilder {
  public:
   AllocationInfoBuilder(AllocationInfo* info, size_t tensor_count,
-                        size_t scratch_buffer_count, ErrorReporter* reporter)
+                        size_t scratch_buffer_count,
+                        size_t application_buffer_count,
+                        ErrorReporter* reporter)
       : info_(info),
         tensor_count_(tensor_count),
         buffer_count_(scratch_buffer_count),
+        application_buffer_count_(application_buffer_count),
         reporter_(reporter) {}
 
   // Check if model contains offline planned buffer offsets.
@@ -172,18 +243,39 @@ class AllocationInfoBuilder {
                           const int32_t* offline_offsets,
                           TfLiteEvalTensor* eval_tensors);
 
+  // Lets operators that can run in place, or whose outputs are views of their
+  // input (or inputs of their output), share buffers instead of copying.
+  // Must be called after AddTensors() and only for online planned models.
+  void AddAliases(const Model* model, const SubGraph* subgraph,
+                  const TfLiteEvalTensor* eval_tensors);
+
   // Add allocation information for the scratch buffers.
   TfLiteStatus AddScratchBuffers(
       internal::ScratchBufferRequest* scratch_buffer_requests,
       ScratchBufferHandle* scratch_buffer_handles);
 
+  // Add allocation information for the buffers requested by the application.
+  // Persistent buffers are already allocated and only fill their slot.
+  void AddApplicationBuffers(internal::ApplicationBuffer* application_buffers,
+                             const SubGraph* subgraph);
+
   // Returns a pointer to the built AllocationInfo array.
   const AllocationInfo* Finish() const { return info_; }
 
  private:
+  // Returns true if tensor `index` is a planned buffer that may share memory
+  // with others after operator `op_index`, its last use.
+  bool CanShare(const SubGraph* subgraph, int index, int op_index) const;
+  // Returns the index of the buffer tensor `index` lives in.
+  int Root(int index) const;
+  // Moves tensor `index` and every tensor sharing its buffer `offset` bytes
+  // into the buffer of tensor `root`.
+  void MergeInto(int index, int root, size_t offset);
+
   AllocationInfo* info_ = nullptr;
   size_t tensor_count_ = 0;
   size_t buffer_count_ = 0;
+  size_t application_buffer_count_ = 0;
   ErrorReporter* reporter_ = nullptr;
 };
 
@@ -204,6 +296,8 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
     current->last_used = -1;
     current->needs_allocating = (eval_tensors[i].data.data == nullptr) &&
                                 (!subgraph->tensors()->Get(i)->is_variable());
+    current->alias_of = -1;
+    current->alias_offset = 0;
     if (offline_offsets) {
       current->offline_offset = offline_offsets[i];
     } else {
@@ -211,10 +305,13 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
     }
   }
 
+  // Inputs are also kept to the end of the invocation, so that a run that
+  // failed or was discarded can be repeated on the same input.
   for (size_t i = 0; i < subgraph->inputs()->size(); ++i) {
     const int tensor_index = subgraph->inputs()->Get(i);
     AllocationInfo* current = &info_[tensor_index];
     current->first_created = 0;
+    current->last_used = subgraph->operators()->size() - 1;
   }
 
   // Mark all outputs as persistent to the end of the invocation.
@@ -265,6 +362,190 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
   return kTfLiteOk;
 }
 
+void AllocationInfoBuilder::AddAliases(const Model* model,
+                                       const SubGraph* subgraph,
+                                       const TfLiteEvalTensor* eval_tensors) {
+  // Operators run in order, so by the time an operator is visited every
+  // earlier decision about its inputs is final. Each byte of a shared buffer
+  // belongs to at most one live tensor at any time: a tensor only hands its
+  // memory on at its last use.
+  for (size_t i = 0; i < subgraph->operators()->size(); ++i) {
+    const auto* op = subgraph->operators()->Get(i);
+    const auto* opcode = model->operator_codes()->Get(op->opcode_index());
+    const BuiltinOperator code = GetBuiltinCode(opcode);
+    const int op_index = static_cast<int>(i);
+
+    switch (GetBufferSharing(code)) {
+      case BufferSharing::kInPlace: {
+        if (op->inputs()->size() < 1 || op->outputs()->size() != 1) {
+          break;
+        }
+        const int input = op->inputs()->Get(0);
+        const int output = op->outputs()->Get(0);
+        if (!CanShare(subgraph, input, op_index) || output < 0 ||
+            !info_[output].needs_allocating || info_[output].alias_of >= 0 ||
+            info_[output].bytes != info_[input].bytes) {
+          break;
+        }
+        MergeInto(output, Root(input), info_[input].alias_offset);
+        break;
+      }
+
+      case BufferSharing::kConcatView: {
+        const auto* options = op->builtin_options_as_ConcatenationOptions();
+        if (op->outputs()->size() != 1 || options == nullptr) {
+          break;
+        }
+        const int output = op->outputs()->Get(0);
+        if (output < 0 || !info_[output].needs_allocating ||
+            info_[output].alias_of >= 0 ||
+            // Quantized uint8 inputs are rescaled instead of copied.
+            eval_tensors[output].type == kTfLiteUInt8) {
+          break;
+        }
+        const TfLiteIntArray* dims = eval_tensors[output].dims;
+        const int axis =
+            options->axis() < 0 ? options->axis() + dims->size : options->axis();
+        if (!IsOuterDimension(dims, axis)) {
+          break;
+        }
+
+        // Every input moves into the output together with any tensor it
+        // shares a buffer with, so that buffer must hold nothing else.
+        size_t offset = 0;
+        bool can_share = true;
+        for (size_t n = 0; n < op->inputs()->size() && can_share; ++n) {
+          const int input = op->inputs()->Get(n);
+          can_share = CanShare(subgraph, input, op_index) &&
+                      offset % kBufferAlignment == 0 &&
+                      info_[input].alias_offset == 0 &&
+                      info_[Root(input)].bytes == info_[input].bytes &&
+                      info_[Root(input)].last_used == op_index;
+          // The same tensor can not be in two places at once.
+          for (size_t m = 0; m < n && can_share; ++m) {
+            can_share = Root(op->inputs()->Get(m)) != Root(input);
+          }
+          if (can_share) {
+            offset += info_[input].bytes;
+          }
+        }
+        if (!can_share || offset != info_[output].bytes) {
+          break;
+        }
+        offset = 0;
+        for (size_t n = 0; n < op->inputs()->size(); ++n) {
+          const int input = op->inputs()->Get(n);
+          MergeInto(Root(input), output, offset);
+          offset += info_[input].bytes;
+        }
+        break;
+      }
+
+      case BufferSharing::kSplitView: {
+        // SPLIT takes (axis, input), SPLIT_V takes (input, size_splits, axis).
+        const bool split_v = code == BuiltinOperator_SPLIT_V;
+        if (op->inputs()->size() != (split_v ? 3 : 2)) {
+          break;
+        }
+        const int input = op->inputs()->Get(split_v ? 0 : 1);
+        const int axis_tensor = op->inputs()->Get(split_v ? 2 : 0);
+        // The kernels only accept a constant axis, which is readable now.
+        if (axis_tensor < 0 || eval_tensors[axis_tensor].data.data == nullptr ||
+            !CanShare(subgraph, input, op_index) ||
+            info_[Root(input)].last_used != op_index) {
+          break;
+        }
+        const TfLiteIntArray* dims = eval_tensors[input].dims;
+        int axis = *static_cast<const int32_t*>(
+            eval_tensors[axis_tensor].data.data);
+        if (axis < 0) {
+          axis += dims->size;
+        }
+        if (!IsOuterDimension(dims, axis)) {
+          break;
+        }
+
+        const size_t start = info_[input].alias_offset;
+        size_t offset = start;
+        bool can_share = true;
+        for (size_t n = 0; n < op->outputs()->size() && can_share; ++n) {
+          const int output = op->outputs()->Get(n);
+          can_share = output >= 0 && info_[output].needs_allocating &&
+                      info_[output].alias_of < 0 &&
+                      offset % kBufferAlignment == 0;
+          if (can_share) {
+            offset += info_[output].bytes;
+          }
+        }
+        if (!can_share || offset - start != info_[input].bytes) {
+          break;
+        }
+        const int root = Root(input);
+        offset = start;
+        for (size_t n = 0; n < op->outputs()->size(); ++n) {
+          const int output = op->outputs()->Get(n);
+          MergeInto(output, root, offset);
+          offset += info_[output].bytes;
+        }
+        break;
+      }
+
+      case BufferSharing::kNone:
+        break;
+    }
+  }
+}
+
+bool AllocationInfoBuilder::CanShare(const SubGraph* subgraph, int index,
+                                     int op_index) const {
+  if (index < 0 || !info_[index].needs_allocating ||
+      info_[index].last_used != op_index) {
+    return false;
+  }
+  // Outputs are read after the last operator, whatever their last use is.
+  // Inputs must stay intact as well, so the same input can be run again
+  // (e.g. after a failed invoke or a discarded InvokeStep() run).
+  const int root = Root(index);
+  for (size_t i = 0; i < subgraph->outputs()->size(); ++i) {
+    const int output = subgraph->outputs()->Get(i);
+    if (output == index || output == root) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < subgraph->inputs()->size(); ++i) {
+    const int input = subgraph->inputs()->Get(i);
+    if (input == index || input == root) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int AllocationInfoBuilder::Root(int index) const {
+  return info_[index].alias_of < 0 ? index : info_[index].alias_of;
+}
+
+void AllocationInfoBuilder::MergeInto(int index, int root, size_t offset) {
+  // Aliases always point straight at a planned buffer, never at another
+  // alias.
+  for (size_t i = 0; i < tensor_count_; ++i) {
+    if (info_[i].alias_of == index) {
+      info_[i].alias_of = root;
+      info_[i].alias_offset += offset;
+    }
+  }
+  AllocationInfo* current = &info_[index];
+  AllocationInfo* target = &info_[root];
+  current->alias_of = root;
+  current->alias_offset = offset;
+  if (current->first_created < target->first_created) {
+    target->first_created = current->first_created;
+  }
+  if (current->last_used > target->last_used) {
+    target->last_used = current->last_used;
+  }
+}
+
 // The tensor offsets will be encoded in the metadata:[Metadata] field of the
 // Model. The following encoding applies:
 //
@@ -330,10 +611,36 @@ TfLiteStatus AllocationInfoBuilder::AddScratchBuffers(
     current->last_used = current_request->node_idx;
     current->offline_offset = kOnlinePlannedBuffer;
     current->needs_allocating = true;
+    current->alias_of = -1;
+    current->alias_offset = 0;
   }
   return kTfLiteOk;
 }
 
+void AllocationInfoBuilder::AddApplicationBuffers(
+    internal::ApplicationBuffer* application_buffers,
+    const SubGraph* subgraph) {
+  const int last_operator =
+      subgraph->operators()->size() > 0 ? subgraph->operators()->size() - 1 : 0;
+  AllocationInfo* info = &info_[tensor_count_ + buffer_count_];
+  for (size_t i = 0; i < application_buffer_count_; ++i) {
+    internal::ApplicationBuffer* buffer = &application_buffers[i];
+    AllocationInfo* current = &info[i];
+    current->output_ptr = reinterpret_cast<void**>(&buffer->data);
+    current->bytes = buffer->bytes;
+    current->first_created =
+        buffer->lifetime == ApplicationBufferLifetime::kAfterInvoke
+            ? last_operator
+            : 0;
+    current->last_used = current->first_created;
+    current->offline_offset = kOnlinePlannedBuffer;
+    current->needs_allocating =
+        buffer->lifetime != ApplicationBufferLifetime::kPersistent;
+    current->alias_of = -1;
+    current->alias_offset = 0;
+  }
+}
+
 TfLiteStatus CreatePlan(ErrorReporter* error_reporter,
                         GreedyMemoryPlanner* planner,
                         const AllocationInfo* allocation_info,
@@ -341,7 +648,7 @@ TfLiteStatus CreatePlan(ErrorReporter* error_reporter,
   // Add the tensors to our allocation plan.
   for (size_t i = 0; i < allocation_info_size; ++i) {
     const AllocationInfo* current = &allocation_info[i];
-    if (current->needs_allocating) {
+    if (current->needs_allocating && current->alias_of < 0) {
       size_t aligned_bytes_required =
           AlignSizeUp(current->bytes, kBufferAlignment);
       if (current->offline_offset == kOnlinePlannedBuffer) {
@@ -366,7 +673,7 @@ TfLiteStatus CommitPlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
   int planner_index = 0;
   for (size_t i = 0; i < allocation_info_size; ++i) {
     const AllocationInfo* current = &allocation_info[i];
-    if (current->needs_allocating) {
+    if (current->needs_allocating && current->alias_of < 0) {
       int offset = -1;
       TF_LITE_ENSURE_STATUS(
           planner->GetOffsetForBuffer(error_reporter, planner_index, &offset));
@@ -374,6 +681,16 @@ TfLiteStatus CommitPlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
       ++planner_index;
     }
   }
+  // Shared buffers point into the buffer they were merged into.
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    const AllocationInfo* current = &allocation_info[i];
+    if (current->needs_allocating && current->alias_of >= 0) {
+      *current->output_ptr =
+          reinterpret_cast<uint8_t*>(
+              *allocation_info[current->alias_of].output_ptr) +
+          current->alias_offset;
+    }
+  }
   return kTfLiteOk;
 }
 }  // namespace
@@ -567,6 +884,13 @@ TfLiteStatus InitializeTfLiteTensorFromFlatbuffer(
 
     result->quantization = {kTfLiteAffineQuantization, quantization};
   }
+
+  // Only the values that the sparsity parameters keep are stored. Kernels
+  // read the parameters themselves, see GetMicroTensorSparsity().
+  if (flatbuffer_tensor.sparsity() != nullptr &&
+      result->data.data != nullptr) {
+    result->bytes = (*buffers)[flatbuffer_tensor.buffer()]->data()->size();
+  }
   return kTfLiteOk;
 }
 
@@ -672,10 +996,228 @@ TfLiteStatus MicroAllocator::FinishModelAllocation(
   return kTfLiteOk;
 }
 
+TfLiteStatus MicroAllocator::StartModelReplan(const Model* model,
+                                              TfLiteEvalTensor* eval_tensors) {
+  TFLITE_DCHECK(model != nullptr);
+  TFLITE_DCHECK(eval_tensors != nullptr);
+
+  if (model_is_allocating_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "MicroAllocator: Model replan started before "
+                         "finishing previously allocated model");
+    return kTfLiteError;
+  }
+
+  const SubGraph* subgraph = GetSubGraphFromModel(model);
+  TFLITE_DCHECK(subgraph != nullptr);
+
+  // Buffers planned into the head are the only ones the memory planner owns.
+  // Weights stay in the flatbuffer, variables live in the tail and externally
+  // bound buffers are outside of the arena, so all of those are left alone.
+  const uint8_t* head_start = memory_allocator_->GetHeadBuffer();
+  const uint8_t* head_end = head_start + memory_allocator_->GetHeadUsedBytes();
+  for (size_t i = 0; i < subgraph->tensors()->size(); ++i) {
+    const uint8_t* data =
+        reinterpret_cast<const uint8_t*>(eval_tensors[i].data.data);
+    if (data >= head_start && data < head_end) {
+      eval_tensors[i].data.data = nullptr;
+    }
+  }
+
+  model_is_allocating_ = true;
+  return InitScratchBufferData();
+}
+
+TfLiteStatus MicroAllocator::FinishModelReplan(
+    const Model* model, TfLiteEvalTensor* eval_tensors,
+    ScratchBufferHandle* scratch_buffer_handles,
+    size_t scratch_buffer_handle_count) {
+  if (!model_is_allocating_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "MicroAllocator: Model replan finished before "
+                         "starting it");
+    return kTfLiteError;
+  }
+  if (scratch_buffer_request_count_ > scratch_buffer_handle_count) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Replanned model requested %d scratch buffers, only "
+                         "%d were allocated",
+                         scratch_buffer_request_count_,
+                         scratch_buffer_handle_count);
+    return kTfLiteError;
+  }
+
+  const SubGraph* subgraph = GetSubGraphFromModel(model);
+  TFLITE_DCHECK(subgraph != nullptr);
+
+  TF_LITE_ENSURE_STATUS(CommitStaticMemoryPlan(model, subgraph, eval_tensors,
+                                               scratch_buffer_handles));
+  model_is_allocating_ = false;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroAllocator::CloneModelAllocation(
+    const MicroAllocator& source, const Model* model,
+    TfLiteEvalTensor* eval_tensors,
+    const ScratchBufferHandle* source_scratch_buffer_handles,
+    size_t scratch_buffer_handle_count,
+    ScratchBufferHandle** scratch_buffer_handles) {
+  TFLITE_DCHECK(model != nullptr);
+  TFLITE_DCHECK(eval_tensors != nullptr);
+
+  if (model_is_allocating_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "MicroAllocator: Model clone started before "
+                         "finishing previously allocated model");
+    return kTfLiteError;
+  }
+
+  const SubGraph* subgraph = GetSubGraphFromModel(model);
+  TFLITE_DCHECK(subgraph != nullptr);
+
+  const size_t head_usage = source.memory_allocator_->GetHeadUsedBytes();
+  if (max_head_buffer_usage_ < head_usage) {
+    max_head_buffer_usage_ = head_usage;
+  }
+  TF_LITE_ENSURE_STATUS(memory_allocator_->SetHeadBufferSize(
+      max_head_buffer_usage_, kBufferAlignment));
+
+  // The memory planner places buffers at offsets from the start of the head,
+  // so moving them only needs the distance between the two heads.
+  const uint8_t* source_head = source.memory_allocator_->GetHeadBuffer();
+  uint8_t* head = memory_allocator_->GetHeadBuffer();
+  auto relocate = [source_head, head, head_usage](void* data) -> void* {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    if (bytes >= source_head && bytes < source_head + head_usage) {
+      return head + (bytes - source_head);
+    }
+    return data;
+  };
+
+  for (size_t i = 0; i < subgraph->tensors()->size(); ++i) {
+    if (!subgraph->tensors()->Get(i)->is_variable()) {
+      eval_tensors[i].data.data = relocate(eval_tensors[i].data.data);
+    }
+  }
+  TF_LITE_ENSURE_STATUS(AllocateVariables(subgraph, eval_tensors));
+
+  scratch_buffer_request_count_ = scratch_buffer_handle_count;
+  TF_LITE_ENSURE_STATUS(AllocateScratchBufferHandles(
+      scratch_buffer_handles, scratch_buffer_handle_count));
+  if (scratch_buffer_handle_count > 0 && *scratch_buffer_handles == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate %d scratch buffer handles",
+                         scratch_buffer_handle_count);
+    return kTfLiteError;
+  }
+  for (size_t i = 0; i < scratch_buffer_handle_count; ++i) {
+    (*scratch_buffer_handles)[i].data =
+        reinterpret_cast<uint8_t*>(
+            relocate(source_scratch_buffer_handles[i].data));
+  }
+  return kTfLiteOk;
+}
+
 void* MicroAllocator::AllocatePersistentBuffer(size_t bytes) {
   return memory_allocator_->AllocateFromTail(bytes, kBufferAlignment);
 }
 
+TfLiteStatus MicroAllocator::AddMemoryTier(uint8_t* buffer, size_t size,
+                                           int rank) {
+  if (memory_tier_count_ == kMaxMemoryTiers || rank < 0 || rank > 127) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Can not add memory tier of rank %d, at most %d "
+                         "tiers with ranks 0 to 127 are supported",
+                         rank, kMaxMemoryTiers);
+    return kTfLiteError;
+  }
+  if (memory_tiers_ == nullptr) {
+    memory_tiers_ = reinterpret_cast<MemoryTier*>(
+        AllocatePersistentBuffer(sizeof(MemoryTier) * kMaxMemoryTiers));
+    if (memory_tiers_ == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate memory for memory tiers");
+      return kTfLiteError;
+    }
+  }
+  uint8_t* aligned_buffer = AlignPointerUp(buffer, kBufferAlignment);
+  SimpleMemoryAllocator* tier = SimpleMemoryAllocator::Create(
+      error_reporter_, aligned_buffer, buffer + size - aligned_buffer);
+  if (tier == nullptr) {
+    return kTfLiteError;
+  }
+
+  // Keep the tiers sorted by rank, so the first one with room is the fastest.
+  int index = memory_tier_count_++;
+  for (; index > 0 && memory_tiers_[index - 1].rank > rank; --index) {
+    memory_tiers_[index] = memory_tiers_[index - 1];
+  }
+  memory_tiers_[index].allocator = tier;
+  memory_tiers_[index].rank = rank;
+  return kTfLiteOk;
+}
+
+void* MicroAllocator::AllocateFromMemoryTier(size_t bytes, int* rank) {
+  for (int i = 0; i < memory_tier_count_; ++i) {
+    SimpleMemoryAllocator* tier = memory_tiers_[i].allocator;
+    if (tier->GetAvailableMemory(kBufferAlignment) >= bytes) {
+      *rank = memory_tiers_[i].rank;
+      return tier->AllocateFromTail(bytes, kBufferAlignment);
+    }
+  }
+  return nullptr;
+}
+
+TfLiteStatus MicroAllocator::PlaceConstantTensors(
+    const Model* model, TfLiteEvalTensor* eval_tensors,
+    size_t max_tensor_bytes, int8_t* placements) {
+  const SubGraph* subgraph = GetSubGraphFromModel(model);
+  TFLITE_DCHECK(subgraph != nullptr);
+  const size_t tensors_count = subgraph->tensors()->size();
+
+  for (size_t i = 0; i < tensors_count; ++i) {
+    const tflite::Tensor* tensor = subgraph->tensors()->Get(i);
+    const Buffer* buffer = model->buffers()->Get(tensor->buffer());
+    const bool is_constant = !tensor->is_variable() && buffer != nullptr &&
+                             buffer->data() != nullptr &&
+                             buffer->data()->size() > 0;
+    placements[i] =
+        is_constant ? kConstantTensorInModel : kNotConstantTensor;
+  }
+
+  // Repeatedly pick the smallest tensor still in the model. Models have at
+  // most a few hundred tensors, and this only runs once in AllocateTensors().
+  for (;;) {
+    int smallest = -1;
+    size_t smallest_bytes = 0;
+    for (size_t i = 0; i < tensors_count; ++i) {
+      if (placements[i] != kConstantTensorInModel) {
+        continue;
+      }
+      const size_t bytes =
+          ConstantTensorByteLength(*model, *subgraph->tensors()->Get(i));
+      if (bytes <= max_tensor_bytes &&
+          (smallest < 0 || bytes < smallest_bytes)) {
+        smallest = static_cast<int>(i);
+        smallest_bytes = bytes;
+      }
+    }
+    if (smallest < 0) {
+      return kTfLiteOk;
+    }
+
+    int rank;
+    void* copy = AllocateFromMemoryTier(smallest_bytes, &rank);
+    if (copy == nullptr) {
+      // Every remaining candidate is at least as large.
+      return kTfLiteOk;
+    }
+    memcpy(copy, eval_tensors[smallest].data.data, smallest_bytes);
+    eval_tensors[smallest].data.data = copy;
+    placements[smallest] = static_cast<int8_t>(rank);
+  }
+}
+
 TfLiteStatus MicroAllocator::RequestScratchBufferInArena(size_t bytes,
                                                          int* buffer_idx) {
   // All scratch buffer requests are stored in the head section of the arena
@@ -750,6 +1292,61 @@ size_t MicroAllocator::used_bytes() const {
   return memory_allocator_->GetUsedBytes();
 }
 
+TfLiteStatus MicroAllocator::RequestApplicationBuffer(
+    size_t bytes, ApplicationBufferLifetime lifetime, int* buffer_index) {
+  if (application_buffer_count_ == kMaxApplicationBuffers) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Can not request more than %d application buffers",
+                         kMaxApplicationBuffers);
+    return kTfLiteError;
+  }
+  if (application_buffers_ == nullptr) {
+    application_buffers_ =
+        reinterpret_cast<internal::ApplicationBuffer*>(AllocatePersistentBuffer(
+            sizeof(internal::ApplicationBuffer) * kMaxApplicationBuffers));
+    if (application_buffers_ == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate memory for application buffers");
+      return kTfLiteError;
+    }
+  }
+
+  internal::ApplicationBuffer* buffer =
+      &application_buffers_[application_buffer_count_];
+  buffer->bytes = bytes;
+  buffer->lifetime = lifetime;
+  buffer->data = nullptr;
+  if (lifetime == ApplicationBufferLifetime::kPersistent) {
+    buffer->data = reinterpret_cast<uint8_t*>(AllocatePersistentBuffer(bytes));
+    if (buffer->data == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate a %d byte application buffer",
+                           bytes);
+      return kTfLiteError;
+    }
+  }
+  *buffer_index = application_buffer_count_++;
+  return kTfLiteOk;
+}
+
+void* MicroAllocator::GetApplicationBuffer(int buffer_index) const {
+  if (buffer_index < 0 || buffer_index >= application_buffer_count_) {
+    return nullptr;
+  }
+  return application_buffers_[buffer_index].data;
+}
+
+size_t MicroAllocator::application_buffer_bytes(
+    ApplicationBufferLifetime lifetime) const {
+  size_t bytes = 0;
+  for (int i = 0; i < application_buffer_count_; ++i) {
+    if (application_buffers_[i].lifetime == lifetime) {
+      bytes += application_buffers_[i].bytes;
+    }
+  }
+  return bytes;
+}
+
 TfLiteStatus MicroAllocator::AllocateNodeAndRegistrations(
     const Model* model, NodeAndRegistration** node_and_registrations) {
   TFLITE_DCHECK(node_and_registrations);
@@ -928,6 +1525,10 @@ TfLiteTensor* MicroAllocator::AllocateTempTfLiteTensor(
   return tensor;
 }
 
+void* MicroAllocator::AllocateTempBuffer(size_t bytes) {
+  return memory_allocator_->AllocateTemp(bytes, kBufferAlignment);
+}
+
 void MicroAllocator::ResetTempAllocations() {
   memory_allocator_->ResetTempAllocations();
 }
@@ -1034,8 +1635,9 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
   // allocated from the temp section and cleaned up at the bottom of this
   // function.
 
-  size_t allocation_info_count =
-      subgraph->tensors()->size() + scratch_buffer_request_count_;
+  size_t allocation_info_count = subgraph->tensors()->size() +
+                                 scratch_buffer_request_count_ +
+                                 application_buffer_count_;
   size_t bytes = sizeof(AllocationInfo) * allocation_info_count;
 
   // Allocate an array of AllocationInfo structs from the temp section. This
@@ -1053,19 +1655,25 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
   // Use the AllocationInfoBuilder class to help determine where buffers are
   // used in the subgraph.
   AllocationInfoBuilder builder(allocation_info, subgraph->tensors()->size(),
-                                scratch_buffer_request_count_, error_reporter_);
+                                scratch_buffer_request_count_,
+                                application_buffer_count_, error_reporter_);
 
   const int32_t* offline_planner_offsets = nullptr;
   TF_LITE_ENSURE_STATUS(
       builder.GetOfflinePlannedOffsets(model, &offline_planner_offsets));
   TF_LITE_ENSURE_STATUS(
       builder.AddTensors(subgraph, offline_planner_offsets, eval_tensors));
+  // Offline planned offsets already fix where every buffer lives.
+  if (offline_planner_offsets == nullptr) {
+    builder.AddAliases(model, subgraph, eval_tensors);
+  }
 
   internal::ScratchBufferRequest* scratch_buffer_requests =
       GetScratchBufferRequests();
 
   TF_LITE_ENSURE_STATUS(builder.AddScratchBuffers(scratch_buffer_requests,
                                                   scratch_buffer_handles));
+  builder.AddApplicationBuffers(application_buffers_, subgraph);
 
   // Remaining arena size that memory planner can use for calculating offsets.
   size_t remaining_arena_size =
@@ -62,6 +62,53 @@ typedef struct {
 
 }  // namespace internal
 
+// How long a buffer requested with MicroAllocator::RequestApplicationBuffer()
+// keeps its contents.
+enum class ApplicationBufferLifetime {
+  // Allocated from the tail right away and never reused, e.g. a ring buffer
+  // of sensor samples that fills up while the model runs.
+  kPersistent,
+  // Scratch for preparing the inputs, e.g. FFT or window buffers. Planned like
+  // a tensor that is live during the first operator, so it never overlaps the
+  // inputs but is overwritten during Invoke().
+  kBeforeInvoke,
+  // Scratch for post-processing the outputs. Planned like a tensor that is
+  // live during the last operator, so it never overlaps the outputs but is
+  // overwritten during the next Invoke().
+  kAfterInvoke,
+};
+
+namespace internal {
+
+// A buffer requested by the application, see
+// MicroAllocator::RequestApplicationBuffer().
+typedef struct {
+  size_t bytes;
+  ApplicationBufferLifetime lifetime;
+  // Set right away for persistent buffers and when a memory plan is committed
+  // for scratch buffers.
+  uint8_t* data;
+} ApplicationBuffer;
+
+}  // namespace internal
+
+// Maximum number of buffers the application can request, see
+// MicroAllocator::RequestApplicationBuffer().
+constexpr int kMaxApplicationBuffers = 8;
+
+// Maximum number of memory tiers, see MicroAllocator::AddMemoryTier().
+constexpr int kMaxMemoryTiers = 4;
+
+// Placements of a tensor reported by MicroAllocator::PlaceConstantTensors()
+// besides the rank of the memory tier it was copied into.
+// Not a constant tensor.
+constexpr int8_t kNotConstantTensor = -1;
+// A constant tensor read from wherever the model is stored.
+constexpr int8_t kConstantTensorInModel = -2;
+// A constant tensor copied into fast memory before each operator using it, see
+// MicroInterpreter::SetWeightPlacement().
+constexpr int8_t kConstantTensorPrefetched = -3;
+
 typedef struct {
   TfLiteNode node;
   const TfLiteRegistration* registration;
@@ -138,6 +185,44 @@ class MicroAllocator {
       const Model* model, TfLiteEvalTensor* eval_tensors,
       ScratchBufferHandle** scratch_buffer_handles);
 
+  // Re-opens a model that has finished allocation so its kernels can be
+  // prepared again after tensor shapes changed (see
+  // MicroInterpreter::ResizeInputTensor()). Every tensor buffer that was
+  // planned into the head section is released, and the head is reset to hold
+  // new scratch buffer requests. Persistent (tail) allocations are kept.
+  TfLiteStatus StartModelReplan(const Model* model,
+                                TfLiteEvalTensor* eval_tensors);
+
+  // Commits a new memory plan for a model re-opened with StartModelReplan().
+  // The scratch buffer handles allocated by FinishModelAllocation() are
+  // reused, so kernels may not request more scratch buffers than
+  // `scratch_buffer_handle_count` during the re-prepare.
+  TfLiteStatus FinishModelReplan(const Model* model,
+                                 TfLiteEvalTensor* eval_tensors,
+                                 ScratchBufferHandle* scratch_buffer_handles,
+                                 size_t scratch_buffer_handle_count);
+
+  // Takes over the memory plan `source` committed for `model`, so the model
+  // can run from this allocator without being prepared again (see
+  // MicroInterpreter::Clone()). `eval_tensors` is a copy of the eval tensors
+  // of `source`, allocated from this allocator. A head of the same size is
+  // reserved, and every tensor and scratch buffer that `source` planned into
+  // its head is moved to the same offset in this head. Variable tensors get
+  // their own buffers. Scratch buffer handles are stored in the out-param
+  // `scratch_buffer_handles`.
+  TfLiteStatus CloneModelAllocation(
+      const MicroAllocator& source, const Model* model,
+      TfLiteEvalTensor* eval_tensors,
+      const ScratchBufferHandle* source_scratch_buffer_handles,
+      size_t scratch_buffer_handle_count,
+      ScratchBufferHandle** scratch_buffer_handles);
+
+  // Returns the number of scratch buffers requested by the model that was
+  // last allocated.
+  size_t scratch_buffer_request_count() const {
+    return scratch_buffer_request_count_;
+  }
+
   // Allocates a TfLiteTensor struct and populates the returned value with
   // properties from the model flatbuffer. This struct is allocated from
   // persistent arena memory is only guaranteed for the lifetime of the
@@ -157,6 +242,10 @@ class MicroAllocator {
                                                  TfLiteEvalTensor* eval_tensors,
                                                  int tensor_index);
 
+  // Allocates a buffer from temporary arena memory, which is only guaranteed
+  // until a call is made to ResetTempAllocations().
+  virtual void* AllocateTempBuffer(size_t bytes);
+
   // Resets all temporary allocations. This method should be called after a
   // chain of temp allocations (e.g. chain of TfLiteTensor objects via
   // AllocateTfLiteTensor()).
@@ -183,6 +272,51 @@ class MicroAllocator {
   // `FinishModelAllocation`. Otherwise, it will return 0.
   size_t used_bytes() const;
 
+  // Lets application code (signal processing, feature extraction, ...) take
+  // its buffers from the arena instead of separate static arrays. Persistent
+  // buffers come from the tail right away. Scratch buffers are planned with
+  // the model's tensors when the next memory plan is committed (by
+  // MicroInterpreter::AllocateTensors()), so they share the head with tensors
+  // that are not live at the same time and often cost no extra memory.
+  // Scratch buffers must not be used during Invoke() or while an
+  // InvokeStep() run is in progress. Request them before AllocateTensors(),
+  // with a single model per allocator. The buffer index is stored in
+  // `buffer_index`.
+  TfLiteStatus RequestApplicationBuffer(size_t bytes,
+                                        ApplicationBufferLifetime lifetime,
+                                        int* buffer_index);
+
+  // Returns a buffer requested with RequestApplicationBuffer(), or nullptr
+  // for a scratch buffer that has not been planned yet. Scratch buffers move
+  // whenever a plan is committed, e.g. by
+  // MicroInterpreter::ResizeInputTensor(), so fetch them again afterwards.
+  void* GetApplicationBuffer(int buffer_index) const;
+
+  // Total bytes of the buffers requested with RequestApplicationBuffer() that
+  // have the given lifetime.
+  size_t application_buffer_bytes(ApplicationBufferLifetime lifetime) const;
+
+  // Registers `buffer` as an additional memory tier that constant tensors can
+  // be copied into, e.g. internal SRAM on a board whose model sits in flash or
+  // PSRAM. A lower `rank` (0 to 127) means faster memory, which is filled
+  // first. The buffer must outlive the allocator.
+  TfLiteStatus AddMemoryTier(uint8_t* buffer, size_t size, int rank);
+
+  // Allocates `bytes` from the fastest memory tier with enough room and
+  // stores the tier's rank in `rank`. Returns nullptr if no tier has room.
+  void* AllocateFromMemoryTier(size_t bytes, int* rank);
+
+  // Copies every constant tensor of at most `max_tensor_bytes` into the
+  // memory tiers and points its eval tensor at the copy. Tensors are placed
+  // smallest first, so the fast tiers serve as many tensors as possible, and
+  // large weights that are read once per inference stay in the model. For
+  // each tensor, `placements` receives the rank of the tier it was copied to,
+  // kConstantTensorInModel or kNotConstantTensor.
+  TfLiteStatus PlaceConstantTensors(const Model* model,
+                                    TfLiteEvalTensor* eval_tensors,
+                                    size_t max_tensor_bytes,
+                                    int8_t* placements);
+
  protected:
   MicroAllocator(SimpleMemoryAllocator* memory_allocator,
                  ErrorReporter* error_reporter);
@@ -238,7 +372,10 @@ class MicroAllocator {
   // will be allocated into the head section in this function call. The
   // scratch_buffer_handles pointer is the array of pre-allocated
   // ScratchBufferHandle structs that will point to allocated buffers also in
-  // the head section.
+  // the head section. Unless the model carries offline planned offsets,
+  // elementwise and reshaping operators run in place and concatenations and
+  // splits along the outermost dimension become views where that is safe, so
+  // their tensors share one buffer instead of being copied.
   virtual TfLiteStatus CommitStaticMemoryPlan(
       const Model* model, const SubGraph* subgraph,
       TfLiteEvalTensor* eval_tensors,
@@ -272,6 +409,20 @@ class MicroAllocator {
   // to ensure that multi-tenant allocations can share the head for buffers.
   size_t max_head_buffer_usage_ = 0;
 
+  // Additional memory for constant tensors, ordered from fastest to slowest.
+  // Allocated from the tail when the first tier is added.
+  struct MemoryTier {
+    SimpleMemoryAllocator* allocator;
+    int rank;
+  };
+  MemoryTier* memory_tiers_ = nullptr;
+  int memory_tier_count_ = 0;
+
+  // Buffers requested through RequestApplicationBuffer(). Allocated from the
+  // tail on the first request.
+  internal::ApplicationBuffer* application_buffers_ = nullptr;
+  int application_buffer_count_ = 0;
+
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
 
@@ -17,6 +17,8 @@ limitations under the License.
 #include <cstdarg>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <new>
 
 #include "flatbuffers/flatbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/c/common.h"
@@ -26,6 +28,9 @@ limitations under the License.
 #include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
 #include "tensorflow/lite/micro/micro_profiler.h"
+#include "tensorflow/lite/micro/micro_sparsity.h"
+#include "tensorflow/lite/micro/micro_thread_pool.h"
+#include "tensorflow/lite/micro/micro_time.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
 namespace tflite {
@@ -41,6 +46,15 @@ const char* OpNameFromRegistration(const TfLiteRegistration* registration) {
 }
 #endif  // !defined(TF_LITE_STRIP_ERROR_STRINGS)
 
+// Returns true if the tensor is backed by a buffer in the flatbuffer.
+bool HasFlatbufferBuffer(const Model* model, const tflite::Tensor* tensor) {
+  const auto* array = (*model->buffers())[tensor->buffer()]->data();
+  return array != nullptr && array->size() > 0;
+}
+
+// Alignment of constant tensors packed into the weight staging buffer.
+constexpr size_t kWeightPrefetchAlignment = 16;
+
 }  // namespace
 
 namespace internal {
@@ -51,8 +65,57 @@ ContextHelper::ContextHelper(ErrorReporter* error_reporter,
 
 void* ContextHelper::AllocatePersistentBuffer(TfLiteContext* ctx,
                                               size_t bytes) {
-  return reinterpret_cast<ContextHelper*>(ctx->impl_)
-      ->allocator_->AllocatePersistentBuffer(bytes);
+  ContextHelper* helper = reinterpret_cast<ContextHelper*>(ctx->impl_);
+  // The header is padded so that the returned buffer keeps the alignment of
+  // the underlying allocation.
+  constexpr size_t kHeaderSize = (sizeof(RecordedBuffer) + 15) & ~15;
+
+  switch (helper->persistent_buffer_mode_) {
+    case PersistentBufferMode::kAllocate: {
+      void* buffer = helper->allocator_->AllocatePersistentBuffer(bytes);
+      helper->last_buffer_ = buffer;
+      helper->last_buffer_bytes_ = bytes;
+      return buffer;
+    }
+
+    case PersistentBufferMode::kRecord: {
+      uint8_t* raw = reinterpret_cast<uint8_t*>(
+          helper->allocator_->AllocatePersistentBuffer(kHeaderSize + bytes));
+      if (raw == nullptr) {
+        return nullptr;
+      }
+      RecordedBuffer* record = reinterpret_cast<RecordedBuffer*>(raw);
+      record->bytes = bytes;
+      record->next = nullptr;
+      if (helper->recorded_buffers_tail_ == nullptr) {
+        helper->recorded_buffers_head_ = record;
+      } else {
+        helper->recorded_buffers_tail_->next = record;
+      }
+      helper->recorded_buffers_tail_ = record;
+      return raw + kHeaderSize;
+    }
+
+    case PersistentBufferMode::kReplay: {
+      RecordedBuffer* record = helper->replay_cursor_;
+      if (record == nullptr || record->bytes < bytes) {
+        TF_LITE_REPORT_ERROR(helper->error_reporter_,
+                             "Kernel requested a new persistent buffer of %d "
+                             "bytes while re-preparing, which is not "
+                             "supported",
+                             bytes);
+        return nullptr;
+      }
+      helper->replay_cursor_ = record->next;
+      return reinterpret_cast<uint8_t*>(record) + kHeaderSize;
+    }
+  }
+  return nullptr;
+}
+
+void ContextHelper::SetPersistentBufferMode(PersistentBufferMode mode) {
+  persistent_buffer_mode_ = mode;
+  replay_cursor_ = recorded_buffers_head_;
 }
 
 TfLiteStatus ContextHelper::RequestScratchBufferInArena(TfLiteContext* ctx,
@@ -82,6 +145,7 @@ void ContextHelper::ReportOpError(struct TfLiteContext* context,
 TfLiteTensor* ContextHelper::GetTensor(const struct TfLiteContext* context,
                                        int tensor_idx) {
   ContextHelper* helper = static_cast<ContextHelper*>(context->impl_);
+  helper->temp_allocations_pending_ = true;
   return helper->allocator_->AllocateTempTfLiteTensor(
       helper->model_, helper->eval_tensors_, tensor_idx);
 }
@@ -92,6 +156,24 @@ TfLiteEvalTensor* ContextHelper::GetEvalTensor(
   return &helper->eval_tensors_[tensor_idx];
 }
 
+TfLiteExternalContext* ContextHelper::GetExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  ContextHelper* helper = reinterpret_cast<ContextHelper*>(context->impl_);
+  if (type < 0 || type >= kTfLiteMaxExternalContexts) {
+    return nullptr;
+  }
+  return helper->external_contexts_[type];
+}
+
+void ContextHelper::SetExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type,
+    TfLiteExternalContext* external_context) {
+  ContextHelper* helper = reinterpret_cast<ContextHelper*>(context->impl_);
+  if (type >= 0 && type < kTfLiteMaxExternalContexts) {
+    helper->external_contexts_[type] = external_context;
+  }
+}
+
 void ContextHelper::SetTfLiteEvalTensors(TfLiteEvalTensor* eval_tensors) {
   eval_tensors_ = eval_tensors;
 }
@@ -103,6 +185,38 @@ void ContextHelper::SetScratchBufferHandles(
 
 }  // namespace internal
 
+MicroWeightPacking* GetMicroWeightPacking(TfLiteContext* context) {
+  // Only contexts set up by MicroInterpreter have a ContextHelper as impl_.
+  if (context->GetEvalTensor != internal::ContextHelper::GetEvalTensor) {
+    return nullptr;
+  }
+  return reinterpret_cast<internal::ContextHelper*>(context->impl_)
+      ->weight_packing();
+}
+
+MicroStreaming* GetMicroStreaming(TfLiteContext* context) {
+  if (context->GetEvalTensor != internal::ContextHelper::GetEvalTensor) {
+    return nullptr;
+  }
+  return reinterpret_cast<internal::ContextHelper*>(context->impl_)
+      ->streaming();
+}
+
+const SparsityParameters* GetMicroTensorSparsity(TfLiteContext* context,
+                                                 int tensor_index) {
+  if (context->GetEvalTensor != internal::ContextHelper::GetEvalTensor) {
+    return nullptr;
+  }
+  const Model* model =
+      reinterpret_cast<internal::ContextHelper*>(context->impl_)->model();
+  const auto* tensors = (*model->subgraphs())[0]->tensors();
+  if (tensor_index < 0 ||
+      static_cast<flatbuffers::uoffset_t>(tensor_index) >= tensors->size()) {
+    return nullptr;
+  }
+  return tensors->Get(tensor_index)->sparsity();
+}
+
 MicroInterpreter::MicroInterpreter(const Model* model,
                                    const MicroOpResolver& op_resolver,
                                    uint8_t* tensor_arena,
@@ -117,9 +231,7 @@ MicroInterpreter::MicroInterpreter(const Model* model,
       tensors_allocated_(false),
       initialization_status_(kTfLiteError),
       eval_tensors_(nullptr),
-      context_helper_(error_reporter_, &allocator_, model),
-      input_tensor_(nullptr),
-      output_tensor_(nullptr) {
+      context_helper_(error_reporter_, &allocator_, model) {
   Init(profiler);
 }
 
@@ -135,9 +247,7 @@ MicroInterpreter::MicroInterpreter(const Model* model,
       tensors_allocated_(false),
       initialization_status_(kTfLiteError),
       eval_tensors_(nullptr),
-      context_helper_(error_reporter_, &allocator_, model),
-      input_tensor_(nullptr),
-      output_tensor_(nullptr) {
+      context_helper_(error_reporter_, &allocator_, model) {
   Init(profiler);
 }
 
@@ -171,6 +281,8 @@ void MicroInterpreter::Init(tflite::Profiler* profiler) {
   context_.ReportError = context_helper_.ReportOpError;
   context_.GetTensor = context_helper_.GetTensor;
   context_.GetEvalTensor = context_helper_.GetEvalTensor;
+  context_.GetExternalContext = context_helper_.GetExternalContext;
+  context_.SetExternalContext = context_helper_.SetExternalContext;
   context_.recommended_num_threads = 1;
   context_.profiler = profiler;
 
@@ -237,6 +349,21 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
   context_helper_.SetTfLiteEvalTensors(eval_tensors_);
   context_.tensors_size = subgraph_->tensors()->size();
 
+  // Externally bound tensors already have a buffer, which keeps them out of
+  // the memory plan committed in FinishModelAllocation().
+  if (bound_buffers_ != nullptr) {
+    const size_t inputs_count = inputs_size();
+    for (size_t i = 0; i < inputs_count + outputs_size(); ++i) {
+      if (bound_buffers_[i] != nullptr) {
+        const int tensor_index = i < inputs_count
+                                     ? inputs().Get(i)
+                                     : outputs().Get(i - inputs_count);
+        TF_LITE_ENSURE_STATUS(
+            SetExternalBuffer(tensor_index, bound_buffers_[i]));
+      }
+    }
+  }
+
   // If the system is big endian then convert weights from the flatbuffer from
   // little to big endian on startup so that it does not need to be done during
   // inference.
@@ -282,10 +409,188 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
     }
   }
 
+  // Streaming kernels record the shift of their outputs in Prepare.
+  if (streaming_.hop != 0) {
+    streaming_.tensors =
+        reinterpret_cast<StreamingTensor*>(allocator_.AllocatePersistentBuffer(
+            sizeof(StreamingTensor) * tensors_size()));
+    if (streaming_.tensors == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate the streaming state of %d "
+                           "tensors",
+                           tensors_size());
+      return kTfLiteError;
+    }
+    memset(streaming_.tensors, 0, sizeof(StreamingTensor) * tensors_size());
+    context_helper_.SetStreaming(&streaming_);
+  }
+
+  // Kernels are only handed back their buffers on a resize if the buffers
+  // were recorded, which costs a small header per buffer.
+  if (resizing_enabled_) {
+    context_helper_.SetPersistentBufferMode(
+        internal::ContextHelper::PersistentBufferMode::kRecord);
+  }
+  TF_LITE_ENSURE_STATUS(PrepareNodes());
+
+  // Prepare is done, we're ready for Invoke. Memory allocation is no longer
+  // allowed. Kernels can only fetch scratch buffers via GetScratchBuffer.
+  context_.AllocatePersistentBuffer = nullptr;
+  context_.RequestScratchBufferInArena = nullptr;
+  context_.GetScratchBuffer = context_helper_.GetScratchBuffer;
+
+  TF_LITE_ENSURE_OK(&context_,
+                    allocator_.FinishModelAllocation(model_, eval_tensors_,
+                                                     &scratch_buffer_handles_));
+  scratch_buffer_handle_count_ = allocator_.scratch_buffer_request_count();
+  // TODO(b/16157777): Remove this when ContextHelper is rolled into this class.
+  context_helper_.SetScratchBufferHandles(scratch_buffer_handles_);
+
+  if (weight_placement_enabled_) {
+    TF_LITE_ENSURE_STATUS(PlaceWeights());
+  }
+  TF_LITE_ENSURE_STATUS(AllocateStreamingCaches());
+
+  TF_LITE_ENSURE_STATUS(ResetVariableTensors());
+  TF_LITE_ENSURE_STATUS(BuildExecutionPlan());
+  TF_LITE_ENSURE_STATUS(ResolveIoTensors());
+
+  tensors_allocated_ = true;
+  return kTfLiteOk;
+}
+
+MicroInterpreter* MicroInterpreter::Clone(uint8_t* tensor_arena,
+                                          size_t tensor_arena_size,
+                                          tflite::Profiler* profiler) {
+  if (!tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "AllocateTensors() must be called before Clone()");
+    return nullptr;
+  }
+  if (node_prefetches_ != nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Interpreters that prefetch weights can not be "
+                         "cloned");
+    return nullptr;
+  }
+
+  MicroAllocator* allocator =
+      MicroAllocator::Create(tensor_arena, tensor_arena_size, error_reporter_);
+  if (allocator == nullptr) {
+    return nullptr;
+  }
+  void* buffer = allocator->AllocatePersistentBuffer(sizeof(MicroInterpreter));
+  if (buffer == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate %d bytes for a cloned interpreter",
+                         sizeof(MicroInterpreter));
+    return nullptr;
+  }
+  MicroInterpreter* clone = new (buffer) MicroInterpreter(
+      model_, op_resolver_, allocator, error_reporter_, profiler);
+  if (clone->initialization_status() != kTfLiteOk ||
+      clone->CopyAllocationFrom(*this) != kTfLiteOk) {
+    return nullptr;
+  }
+  has_clones_ = true;
+  return clone;
+}
+
+TfLiteStatus MicroInterpreter::CopyAllocationFrom(
+    const MicroInterpreter& prototype) {
+  const size_t tensors_count = subgraph_->tensors()->size();
+  const size_t operators_count = subgraph_->operators()->size();
+
+  eval_tensors_ = reinterpret_cast<TfLiteEvalTensor*>(
+      allocator_.AllocatePersistentBuffer(sizeof(TfLiteEvalTensor) *
+                                          tensors_count));
+  node_and_registrations_ = reinterpret_cast<NodeAndRegistration*>(
+      allocator_.AllocatePersistentBuffer(sizeof(NodeAndRegistration) *
+                                          operators_count));
+  if (eval_tensors_ == nullptr || node_and_registrations_ == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate tensors and nodes for a cloned "
+                         "interpreter");
+    return kTfLiteError;
+  }
+  memcpy(eval_tensors_, prototype.eval_tensors_,
+         sizeof(TfLiteEvalTensor) * tensors_count);
+  memcpy(node_and_registrations_, prototype.node_and_registrations_,
+         sizeof(NodeAndRegistration) * operators_count);
+  context_helper_.SetTfLiteEvalTensors(eval_tensors_);
+  context_.tensors_size = tensors_count;
+
+  // Builtin data and the tensor index arrays are read-only and stay shared.
+  // Each kernel's user_data gets its own copy, since kernels may keep mutable
+  // state there. Init() is run again to size and allocate the copy, then the
+  // prepared contents are copied over it. Buffers referenced from user_data
+  // (allocated in Prepare) remain shared.
+  context_.AllocatePersistentBuffer = context_helper_.AllocatePersistentBuffer;
+  context_.RequestScratchBufferInArena = nullptr;
+  context_.GetScratchBuffer = nullptr;
+  for (size_t i = 0; i < operators_count; ++i) {
+    TfLiteNode* node = &node_and_registrations_[i].node;
+    const TfLiteRegistration* registration =
+        node_and_registrations_[i].registration;
+    if (registration->init == nullptr || node->user_data == nullptr) {
+      continue;
+    }
+    const char* init_data;
+    size_t init_data_size;
+    if (registration->builtin_code == BuiltinOperator_CUSTOM) {
+      init_data = reinterpret_cast<const char*>(node->custom_initial_data);
+      init_data_size = node->custom_initial_data_size;
+    } else {
+      init_data = reinterpret_cast<const char*>(node->builtin_data);
+      init_data_size = 0;
+    }
+    void* prototype_user_data = node->user_data;
+    node->user_data = registration->init(&context_, init_data, init_data_size);
+
+    size_t bytes;
+    if (node->user_data == nullptr ||
+        node->user_data != context_helper_.last_persistent_buffer(&bytes)) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Node %s (number %d) can not be cloned, its "
+                           "user_data is not a single persistent buffer",
+                           OpNameFromRegistration(registration), i);
+      return kTfLiteError;
+    }
+    memcpy(node->user_data, prototype_user_data, bytes);
+  }
+  context_.AllocatePersistentBuffer = nullptr;
+  context_.GetScratchBuffer = context_helper_.GetScratchBuffer;
+
+  TF_LITE_ENSURE_STATUS(allocator_.CloneModelAllocation(
+      prototype.allocator_, model_, eval_tensors_,
+      prototype.scratch_buffer_handles_,
+      prototype.scratch_buffer_handle_count_, &scratch_buffer_handles_));
+  scratch_buffer_handle_count_ = prototype.scratch_buffer_handle_count_;
+  context_helper_.SetScratchBufferHandles(scratch_buffer_handles_);
+
+  is_clone_ = true;
+  target_tensor_index_ = prototype.target_tensor_index_;
+  // Placed weights were copied with the eval tensors and are shared.
+  weight_placements_ = prototype.weight_placements_;
+  TF_LITE_ENSURE_STATUS(ResetVariableTensors());
+  TF_LITE_ENSURE_STATUS(BuildExecutionPlan());
+  TF_LITE_ENSURE_STATUS(ResolveIoTensors());
+
+  tensors_allocated_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::PrepareNodes() {
   // Both AllocatePersistentBuffer and RequestScratchBufferInArena is
   // available in Prepare stage.
+  context_.AllocatePersistentBuffer = context_helper_.AllocatePersistentBuffer;
   context_.RequestScratchBufferInArena =
       context_helper_.RequestScratchBufferInArena;
+  context_.GetScratchBuffer = nullptr;
+  // Kernels pack the same weights again when re-prepared, and are handed
+  // back the buffers they got the first time.
+  weight_packing_.used_bytes = 0;
+  ResetStreamingShifts();
   for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
     auto* node = &(node_and_registrations_[i].node);
     auto* registration = node_and_registrations_[i].registration;
@@ -307,20 +612,388 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
   context_.AllocatePersistentBuffer = nullptr;
   context_.RequestScratchBufferInArena = nullptr;
   context_.GetScratchBuffer = context_helper_.GetScratchBuffer;
+  context_helper_.SetPersistentBufferMode(
+      internal::ContextHelper::PersistentBufferMode::kAllocate);
+  return kTfLiteOk;
+}
 
-  TF_LITE_ENSURE_OK(&context_,
-                    allocator_.FinishModelAllocation(model_, eval_tensors_,
-                                                     &scratch_buffer_handles_));
-  // TODO(b/16157777): Remove this when ContextHelper is rolled into this class.
-  context_helper_.SetScratchBufferHandles(scratch_buffer_handles_);
+TfLiteStatus MicroInterpreter::ResizeInputTensor(size_t index,
+                                                 const TfLiteIntArray* dims) {
+  const size_t length = inputs_size();
+  if (index >= length) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Input index %d out of range (length is %d)", index,
+                         length);
+    return kTfLiteError;
+  }
+  if (!tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(
+        error_reporter_,
+        "AllocateTensors() must be called before ResizeInputTensor()");
+    return kTfLiteError;
+  }
 
-  TF_LITE_ENSURE_STATUS(ResetVariableTensors());
+  if (!resizing_enabled_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "EnableResizing() must be called before "
+                         "AllocateTensors() to use ResizeInputTensor()");
+    return kTfLiteError;
+  }
+  if (is_clone_ || has_clones_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "ResizeInputTensor() is not supported on a clone or "
+                         "an interpreter that was cloned");
+    return kTfLiteError;
+  }
 
-  tensors_allocated_ = true;
+  TfLiteEvalTensor* input = input_eval_tensors_[index];
+  if (dims == nullptr || dims->size != input->dims->size ||
+      dims->size == 0 || dims->data[0] <= 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "ResizeInputTensor() requires a positive batch and "
+                         "the same rank as the input (%d)",
+                         input->dims->size);
+    return kTfLiteError;
+  }
+  for (int d = 1; d < dims->size; ++d) {
+    if (dims->data[d] != input->dims->data[d]) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "ResizeInputTensor() can only change the batch "
+                           "dimension, dimension %d differs",
+                           d);
+      return kTfLiteError;
+    }
+  }
+
+  const int old_batch = input->dims->data[0];
+  const int new_batch = dims->data[0];
+  if (old_batch == new_batch) {
+    return kTfLiteOk;
+  }
+
+  if (!activation_dims_owned_) {
+    TF_LITE_ENSURE_STATUS(CopyActivationDims());
+  }
+
+  // Propagate the batch along the data flow, in execution order: an
+  // activation output of an operator that reads a resized tensor is resized
+  // too if its leading dimension is the old batch. Tensors that do not depend
+  // on this input keep their dims even if their leading dimension matches, and
+  // weights keep their flatbuffer dims.
+  for (size_t i = 0; i < tensors_size(); ++i) {
+    resized_tensors_[i] = false;
+  }
+  input->dims->data[0] = new_batch;
+  resized_tensors_[inputs().Get(index)] = true;
+  for (size_t i = 0; i < operators_size(); ++i) {
+    const TfLiteNode& node = node_and_registrations_[i].node;
+    bool reads_resized_tensor = false;
+    for (int n = 0; n < node.inputs->size && !reads_resized_tensor; ++n) {
+      const int tensor_index = node.inputs->data[n];
+      reads_resized_tensor =
+          tensor_index >= 0 && resized_tensors_[tensor_index];
+    }
+    if (!reads_resized_tensor) {
+      continue;
+    }
+    for (int o = 0; o < node.outputs->size; ++o) {
+      const int tensor_index = node.outputs->data[o];
+      const tflite::Tensor* flatbuffer_tensor =
+          subgraph_->tensors()->Get(tensor_index);
+      TfLiteIntArray* tensor_dims = eval_tensors_[tensor_index].dims;
+      if (!HasFlatbufferBuffer(model_, flatbuffer_tensor) &&
+          !flatbuffer_tensor->is_variable() && tensor_dims->size > 0 &&
+          tensor_dims->data[0] == old_batch) {
+        tensor_dims->data[0] = new_batch;
+        resized_tensors_[tensor_index] = true;
+      }
+    }
+  }
+
+  // The size of a buffer bound through BindInput()/BindOutput() is not known,
+  // so only tensors that are not bound can grow.
+  if (new_batch > old_batch && bound_buffers_ != nullptr) {
+    const size_t inputs_count = inputs_size();
+    for (size_t i = 0; i < inputs_count + outputs_size(); ++i) {
+      const int tensor_index = i < inputs_count
+                                   ? inputs().Get(i)
+                                   : outputs().Get(i - inputs_count);
+      if (bound_buffers_[i] == nullptr || !resized_tensors_[tensor_index]) {
+        continue;
+      }
+      for (size_t t = 0; t < tensors_size(); ++t) {
+        if (resized_tensors_[t]) {
+          eval_tensors_[t].dims->data[0] = old_batch;
+        }
+      }
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "ResizeInputTensor() can not grow tensor %d, "
+                           "which is bound to an external buffer",
+                           tensor_index);
+      return kTfLiteError;
+    }
+  }
+
+  // Any partially completed InvokeStep() run is no longer valid.
+  next_plan_entry_ = 0;
+
+  // Kernels check the propagated shapes when they are prepared again, e.g. a
+  // RESHAPE that folds the batch into another dimension fails here. The old
+  // memory plan is already released at that point, so the interpreter can not
+  // be used anymore.
+  context_helper_.SetPersistentBufferMode(
+      internal::ContextHelper::PersistentBufferMode::kReplay);
+  if (allocator_.StartModelReplan(model_, eval_tensors_) != kTfLiteOk ||
+      PrepareNodes() != kTfLiteOk ||
+      allocator_.FinishModelReplan(model_, eval_tensors_,
+                                   scratch_buffer_handles_,
+                                   scratch_buffer_handle_count_) != kTfLiteOk ||
+      AllocateStreamingCaches() != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "ResizeInputTensor() failed to re-plan the model for "
+                         "a batch of %d. Every operator that reads the input "
+                         "must keep the batch as the leading dimension of its "
+                         "outputs, and the arena must fit the larger tensors",
+                         new_batch);
+    initialization_status_ = kTfLiteError;
+    return kTfLiteError;
+  }
+
+  RefreshCachedTfLiteTensors();
   return kTfLiteOk;
 }
 
-TfLiteStatus MicroInterpreter::Invoke() {
+TfLiteStatus MicroInterpreter::EnableResizing() {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(
+        error_reporter_,
+        "EnableResizing() must be called before AllocateTensors()");
+    return kTfLiteError;
+  }
+  resizing_enabled_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::CopyActivationDims() {
+  for (size_t i = 0; i < tensors_size(); ++i) {
+    const tflite::Tensor* flatbuffer_tensor = subgraph_->tensors()->Get(i);
+    const TfLiteIntArray* dims = eval_tensors_[i].dims;
+    if (HasFlatbufferBuffer(model_, flatbuffer_tensor) ||
+        flatbuffer_tensor->is_variable() || dims->size == 0) {
+      continue;
+    }
+    const size_t bytes = TfLiteIntArrayGetSizeInBytes(dims->size);
+    TfLiteIntArray* copy = reinterpret_cast<TfLiteIntArray*>(
+        allocator_.AllocatePersistentBuffer(bytes));
+    if (copy == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate %d bytes for tensor dims",
+                           bytes);
+      return kTfLiteError;
+    }
+    memcpy(copy, dims, bytes);
+    eval_tensors_[i].dims = copy;
+  }
+  resized_tensors_ = reinterpret_cast<bool*>(
+      allocator_.AllocatePersistentBuffer(sizeof(bool) * tensors_size()));
+  if (resized_tensors_ == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate %d bytes for resize state",
+                         sizeof(bool) * tensors_size());
+    return kTfLiteError;
+  }
+  activation_dims_owned_ = true;
+  return kTfLiteOk;
+}
+
+void MicroInterpreter::RefreshCachedTfLiteTensors() {
+  // Quantization parameters never change at runtime, only buffers and shapes.
+  auto refresh = [this](TfLiteTensor* tensor, int tensor_index) {
+    if (tensor == nullptr) {
+      return;
+    }
+    const TfLiteEvalTensor* eval_tensor = &eval_tensors_[tensor_index];
+    tensor->data.data = eval_tensor->data.data;
+    tensor->dims = eval_tensor->dims;
+    TfLiteEvalTensorByteLength(eval_tensor, &tensor->bytes);
+  };
+  for (size_t i = 0; i < inputs_size(); ++i) {
+    refresh(input_tensors_[i], inputs().Get(i));
+  }
+  for (size_t i = 0; i < outputs_size(); ++i) {
+    refresh(output_tensors_[i], outputs().Get(i));
+  }
+  if (tensors_ != nullptr) {
+    for (size_t i = 0; i < tensors_size(); ++i) {
+      refresh(tensors_[i], i);
+    }
+  }
+}
+
+TfLiteStatus MicroInterpreter::BuildExecutionPlan() {
+  const size_t operators_size = subgraph_->operators()->size();
+  size_t plan_size = 0;
+  for (size_t i = 0; i < operators_size; ++i) {
+    if (node_and_registrations_[i].registration->invoke != nullptr) {
+      ++plan_size;
+    }
+  }
+
+  execution_plan_ = reinterpret_cast<ExecutionPlanEntry*>(
+      allocator_.AllocatePersistentBuffer(sizeof(ExecutionPlanEntry) *
+                                          plan_size));
+  if (plan_size > 0 && execution_plan_ == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for the execution plan, "
+                         "%d bytes required",
+                         sizeof(ExecutionPlanEntry) * plan_size);
+    return kTfLiteError;
+  }
+
+  size_t entry_index = 0;
+  for (size_t i = 0; i < operators_size; ++i) {
+    const TfLiteRegistration* registration =
+        node_and_registrations_[i].registration;
+    if (registration->invoke == nullptr) {
+      continue;
+    }
+    ExecutionPlanEntry* entry = &execution_plan_[entry_index++];
+    entry->node = &(node_and_registrations_[i].node);
+    entry->invoke = registration->invoke;
+    entry->registration = registration;
+    entry->node_index = static_cast<int>(i);
+  }
+  execution_plan_size_ = plan_size;
+
+  if (target_tensor_index_ >= 0) {
+    TF_LITE_ENSURE_STATUS(BuildTargetPlan());
+  }
+
+  // Any temp TfLiteTensors handed out during Prepare have already been
+  // released by FinishPrepareNodeAllocations().
+  context_helper_.ConsumeTempAllocations();
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::BuildTargetPlan() {
+  // One flag per plan entry, marking the operators that must run. Only needed
+  // while the plan is built, so it is taken from temp memory.
+  bool* live = reinterpret_cast<bool*>(
+      allocator_.AllocateTempBuffer(sizeof(bool) * execution_plan_size_));
+  if (execution_plan_size_ > 0 && live == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for the target plan, "
+                         "%d bytes required",
+                         sizeof(bool) * execution_plan_size_);
+    return kTfLiteError;
+  }
+
+  // Operators are stored in execution order, so walking the plan backwards
+  // visits every consumer before its producers. An operator is live if it
+  // writes the target or a tensor read by a live operator that runs later.
+  size_t plan_size = 0;
+  for (size_t i = execution_plan_size_; i-- > 0;) {
+    const TfLiteIntArray* node_outputs = execution_plan_[i].node->outputs;
+    live[i] = false;
+    for (int o = 0; o < node_outputs->size && !live[i]; ++o) {
+      const int tensor_index = node_outputs->data[o];
+      if (tensor_index == target_tensor_index_) {
+        live[i] = true;
+        break;
+      }
+      for (size_t j = i + 1; j < execution_plan_size_ && !live[i]; ++j) {
+        if (!live[j]) {
+          continue;
+        }
+        const TfLiteIntArray* node_inputs = execution_plan_[j].node->inputs;
+        for (int n = 0; n < node_inputs->size; ++n) {
+          if (node_inputs->data[n] == tensor_index) {
+            live[i] = true;
+            break;
+          }
+        }
+      }
+    }
+    if (live[i]) {
+      ++plan_size;
+    }
+  }
+
+  target_plan_ = reinterpret_cast<ExecutionPlanEntry*>(
+      allocator_.AllocatePersistentBuffer(sizeof(ExecutionPlanEntry) *
+                                          plan_size));
+  if (plan_size > 0 && target_plan_ == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for the target plan, "
+                         "%d bytes required",
+                         sizeof(ExecutionPlanEntry) * plan_size);
+    allocator_.ResetTempAllocations();
+    return kTfLiteError;
+  }
+
+  size_t entry_index = 0;
+  for (size_t i = 0; i < execution_plan_size_; ++i) {
+    if (live[i]) {
+      target_plan_[entry_index++] = execution_plan_[i];
+    }
+  }
+  target_plan_size_ = plan_size;
+  allocator_.ResetTempAllocations();
+  return kTfLiteOk;
+}
+
+inline TfLiteStatus MicroInterpreter::InvokeNode(
+    const ExecutionPlanEntry& entry) {
+  const WeightPrefetch* prefetch_begin = nullptr;
+  const WeightPrefetch* prefetch_end = nullptr;
+  if (node_prefetches_ != nullptr) {
+    prefetch_begin = weight_prefetches_ + node_prefetches_[entry.node_index];
+    prefetch_end = weight_prefetches_ + node_prefetches_[entry.node_index + 1];
+    for (const WeightPrefetch* prefetch = prefetch_begin;
+         prefetch != prefetch_end; ++prefetch) {
+      memcpy(prefetch->staging, prefetch->source, prefetch->bytes);
+      prefetch->tensor->data.data = prefetch->staging;
+    }
+  }
+
+  TfLiteStatus invoke_status;
+#ifndef NDEBUG  // Omit profiler overhead from release builds.
+  if (context_.profiler != nullptr) {
+    ScopedOperatorProfile scoped_profiler(
+        reinterpret_cast<tflite::Profiler*>(context_.profiler),
+        OpNameFromRegistration(entry.registration), entry.node_index);
+    invoke_status = entry.invoke(&context_, entry.node);
+  } else {
+    invoke_status = entry.invoke(&context_, entry.node);
+  }
+#else
+  invoke_status = entry.invoke(&context_, entry.node);
+#endif
+
+  // TfLiteTensor structs requested by a kernel through GetTensor() are
+  // allocated from temp memory in the allocator. This creates a chain of
+  // allocations in the temp section, which is only reset if the kernel
+  // actually used it.
+  if (context_helper_.ConsumeTempAllocations()) {
+    allocator_.ResetTempAllocations();
+  }
+
+  // The next operator overwrites the staging buffer.
+  for (const WeightPrefetch* prefetch = prefetch_begin;
+       prefetch != prefetch_end; ++prefetch) {
+    prefetch->tensor->data.data = const_cast<void*>(prefetch->source);
+  }
+
+  if (invoke_status == kTfLiteError) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Node %s (number %d) failed to invoke with status %d",
+                         OpNameFromRegistration(entry.registration),
+                         entry.node_index, invoke_status);
+  }
+  return invoke_status;
+}
+
+TfLiteStatus MicroInterpreter::PrepareForInvoke() {
   if (initialization_status_ != kTfLiteOk) {
     TF_LITE_REPORT_ERROR(error_reporter_,
                          "Invoke() called after initialization failed\n");
@@ -332,43 +1005,231 @@ TfLiteStatus MicroInterpreter::Invoke() {
   if (!tensors_allocated_) {
     TF_LITE_ENSURE_OK(&context_, AllocateTensors());
   }
+  return kTfLiteOk;
+}
 
-  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
-    auto* node = &(node_and_registrations_[i].node);
-    auto* registration = node_and_registrations_[i].registration;
+TfLiteStatus MicroInterpreter::Invoke() {
+  TF_LITE_ENSURE_STATUS(PrepareForInvoke());
 
-    if (registration->invoke) {
-      TfLiteStatus invoke_status;
-#ifndef NDEBUG  // Omit profiler overhead from release builds.
-      // The case where profiler == nullptr is handled by
-      // ScopedOperatorProfile.
-      tflite::Profiler* profiler =
-          reinterpret_cast<tflite::Profiler*>(context_.profiler);
-      ScopedOperatorProfile scoped_profiler(
-          profiler, OpNameFromRegistration(registration), i);
-#endif
-      invoke_status = registration->invoke(&context_, node);
+  // A full invoke supersedes any partially completed InvokeStep() run.
+  next_plan_entry_ = 0;
+  AdvanceStreamingWindow();
 
-      // All TfLiteTensor structs used in the kernel are allocated from temp
-      // memory in the allocator. This creates a chain of allocations in the
-      // temp section. The call below resets the chain of allocations to
-      // prepare for the next call.
-      allocator_.ResetTempAllocations();
+  const ExecutionPlanEntry* const plan_end =
+      execution_plan_ + execution_plan_size_;
+  for (const ExecutionPlanEntry* entry = execution_plan_; entry != plan_end;
+       ++entry) {
+    const TfLiteStatus invoke_status = InvokeNode(*entry);
+    if (invoke_status != kTfLiteOk) {
+      return invoke_status;
+    }
+  }
+  return kTfLiteOk;
+}
 
-      if (invoke_status == kTfLiteError) {
-        TF_LITE_REPORT_ERROR(
-            error_reporter_,
-            "Node %s (number %d) failed to invoke with status %d",
-            OpNameFromRegistration(registration), i, invoke_status);
-        return kTfLiteError;
-      } else if (invoke_status != kTfLiteOk) {
-        return invoke_status;
-      }
+TfLiteStatus MicroInterpreter::InvokeStep(int32_t budget_ticks) {
+  TF_LITE_ENSURE_STATUS(PrepareForInvoke());
+
+  if (next_plan_entry_ == 0) {
+    AdvanceStreamingWindow();
+  }
+  // Without a timer GetCurrentTimeTicks() never advances, so every call
+  // yields after one operator instead of running the whole model.
+  const bool has_timer = ticks_per_second() != 0;
+  const int32_t start_ticks = GetCurrentTimeTicks();
+  while (next_plan_entry_ < execution_plan_size_) {
+    const TfLiteStatus invoke_status =
+        InvokeNode(execution_plan_[next_plan_entry_]);
+    if (invoke_status != kTfLiteOk) {
+      // Errors and early exits (e.g. kTfLiteAbort from a strided model) end
+      // the run just like in Invoke().
+      next_plan_entry_ = 0;
+      return invoke_status;
+    }
+    ++next_plan_entry_;
+
+    // Ticks are compared as unsigned to stay correct when the counter wraps.
+    const uint32_t elapsed_ticks =
+        static_cast<uint32_t>(GetCurrentTimeTicks()) -
+        static_cast<uint32_t>(start_ticks);
+    if (next_plan_entry_ < execution_plan_size_ &&
+        (!has_timer || static_cast<int32_t>(elapsed_ticks) >= budget_ticks)) {
+      return static_cast<TfLiteStatus>(kTfLiteInvokeContinue);
+    }
+  }
+
+  next_plan_entry_ = 0;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::SetTargetTensor(int tensor_index) {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(
+        error_reporter_,
+        "SetTargetTensor() must be called before AllocateTensors()");
+    return kTfLiteError;
+  }
+  // context_.tensors_size is only set up by AllocateTensors().
+  const size_t length = subgraph_->tensors()->size();
+  if (tensor_index < 0 || static_cast<size_t>(tensor_index) >= length) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Tensor index %d out of range (length is %d)",
+                         tensor_index, length);
+    return kTfLiteError;
+  }
+  target_tensor_index_ = tensor_index;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::InvokeTarget() {
+  TF_LITE_ENSURE_STATUS(PrepareForInvoke());
+  if (target_tensor_index_ < 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "InvokeTarget() called without a target tensor");
+    return kTfLiteError;
+  }
+
+  // The pruned plan overwrites activations used by a partial InvokeStep() run.
+  next_plan_entry_ = 0;
+  AdvanceStreamingWindow();
+
+  const ExecutionPlanEntry* const plan_end = target_plan_ + target_plan_size_;
+  for (const ExecutionPlanEntry* entry = target_plan_; entry != plan_end;
+       ++entry) {
+    const TfLiteStatus invoke_status = InvokeNode(*entry);
+    if (invoke_status != kTfLiteOk) {
+      return invoke_status;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteEvalTensor* MicroInterpreter::target_eval_tensor() {
+  if (target_tensor_index_ < 0) {
+    return nullptr;
+  }
+  return eval_tensor(target_tensor_index_);
+}
+
+TfLiteStatus MicroInterpreter::ResolveIoTensors() {
+  const size_t inputs_count = inputs_size();
+  const size_t outputs_count = outputs_size();
+  const size_t io_count = inputs_count + outputs_count;
+
+  // A single allocation holds the eval tensor handles followed by the lazily
+  // populated TfLiteTensor handles.
+  void** handles = reinterpret_cast<void**>(
+      allocator_.AllocatePersistentBuffer(sizeof(void*) * io_count * 2));
+  if (io_count > 0 && handles == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for input/output tensor "
+                         "handles, %d bytes required",
+                         sizeof(void*) * io_count * 2);
+    return kTfLiteError;
+  }
+
+  input_eval_tensors_ = reinterpret_cast<TfLiteEvalTensor**>(handles);
+  output_eval_tensors_ = input_eval_tensors_ + inputs_count;
+  input_tensors_ = reinterpret_cast<TfLiteTensor**>(handles + io_count);
+  output_tensors_ = input_tensors_ + inputs_count;
+
+  for (size_t i = 0; i < inputs_count; ++i) {
+    input_eval_tensors_[i] = &eval_tensors_[inputs().Get(i)];
+    input_tensors_[i] = nullptr;
+  }
+  for (size_t i = 0; i < outputs_count; ++i) {
+    output_eval_tensors_[i] = &eval_tensors_[outputs().Get(i)];
+    output_tensors_[i] = nullptr;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::BindInput(size_t index, void* buffer) {
+  const size_t length = inputs_size();
+  if (index >= length) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Input index %d out of range (length is %d)", index,
+                         length);
+    return kTfLiteError;
+  }
+  return BindIoTensor(index, inputs().Get(index), buffer);
+}
+
+TfLiteStatus MicroInterpreter::BindOutput(size_t index, void* buffer) {
+  const size_t length = outputs_size();
+  if (index >= length) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Output index %d out of range (length is %d)", index,
+                         length);
+    return kTfLiteError;
+  }
+  return BindIoTensor(inputs_size() + index, outputs().Get(index), buffer);
+}
+
+TfLiteStatus MicroInterpreter::BindIoTensor(size_t io_index, int tensor_index,
+                                            void* buffer) {
+  if (buffer == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Can not bind tensor %d to a null buffer",
+                         tensor_index);
+    return kTfLiteError;
+  }
+
+  if (bound_buffers_ == nullptr) {
+    const size_t io_count = inputs_size() + outputs_size();
+    bound_buffers_ = reinterpret_cast<void**>(
+        allocator_.AllocatePersistentBuffer(sizeof(void*) * io_count));
+    if (bound_buffers_ == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate memory for bound buffers, "
+                           "%d bytes required",
+                           sizeof(void*) * io_count);
+      return kTfLiteError;
+    }
+    for (size_t i = 0; i < io_count; ++i) {
+      bound_buffers_[i] = nullptr;
     }
   }
+  bound_buffers_[io_index] = buffer;
+
+  if (tensors_allocated_) {
+    return SetExternalBuffer(tensor_index, buffer);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::SetExternalBuffer(int tensor_index,
+                                                 void* buffer) {
+  TfLiteEvalTensor* eval_tensor = &eval_tensors_[tensor_index];
+  size_t type_size;
+  TF_LITE_ENSURE_STATUS(TfLiteTypeSizeOf(eval_tensor->type, &type_size));
+  if (reinterpret_cast<uintptr_t>(buffer) % type_size != 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Buffer bound to tensor %d is not aligned to %d bytes",
+                         tensor_index, type_size);
+    return kTfLiteError;
+  }
+  eval_tensor->data.data = buffer;
+
+  // Keep any TfLiteTensor structs already returned to the caller in sync with
+  // the source of truth.
+  if (input_tensors_ != nullptr) {
+    RefreshCachedTfLiteTensors();
+  }
   return kTfLiteOk;
 }
 
+TfLiteTensor* MicroInterpreter::GetOrAllocateTfLiteTensor(TfLiteTensor** cache,
+                                                          int tensor_index) {
+  if (*cache == nullptr) {
+    // TODO(b/162311891): Drop these allocations when the interpreter supports
+    // handling buffers from TfLiteEvalTensor.
+    *cache = allocator_.AllocatePersistentTfLiteTensor(model_, eval_tensors_,
+                                                       tensor_index);
+  }
+  return *cache;
+}
+
 TfLiteTensor* MicroInterpreter::input(size_t index) {
   const size_t length = inputs_size();
   if (index >= length) {
@@ -377,20 +1238,30 @@ TfLiteTensor* MicroInterpreter::input(size_t index) {
                          length);
     return nullptr;
   }
-  if (index != 0) {
+  if (!tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "AllocateTensors() must be called before input()");
+    return nullptr;
+  }
+  return GetOrAllocateTfLiteTensor(&input_tensors_[index],
+                                   inputs().Get(index));
+}
+
+TfLiteEvalTensor* MicroInterpreter::input_eval_tensor(size_t index) {
+  const size_t length = inputs_size();
+  if (index >= length) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Input index %d out of range (length is %d)", index,
+                         length);
+    return nullptr;
+  }
+  if (!tensors_allocated_) {
     TF_LITE_REPORT_ERROR(
         error_reporter_,
-        "Input tensors not at index 0 are allocated from the "
-        "persistent memory arena. Repeat calls will cause excess "
-        "allocation!");
-    return allocator_.AllocatePersistentTfLiteTensor(model_, eval_tensors_,
-                                                     inputs().Get(index));
-  }
-  if (input_tensor_ == nullptr) {
-    input_tensor_ = allocator_.AllocatePersistentTfLiteTensor(
-        model_, eval_tensors_, inputs().Get(index));
+        "AllocateTensors() must be called before input_eval_tensor()");
+    return nullptr;
   }
-  return input_tensor_;
+  return input_eval_tensors_[index];
 }
 
 TfLiteTensor* MicroInterpreter::output(size_t index) {
@@ -401,22 +1272,30 @@ TfLiteTensor* MicroInterpreter::output(size_t index) {
                          length);
     return nullptr;
   }
-  if (index != 0) {
+  if (!tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "AllocateTensors() must be called before output()");
+    return nullptr;
+  }
+  return GetOrAllocateTfLiteTensor(&output_tensors_[index],
+                                   outputs().Get(index));
+}
+
+TfLiteEvalTensor* MicroInterpreter::output_eval_tensor(size_t index) {
+  const size_t length = outputs_size();
+  if (index >= length) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Output index %d out of range (length is %d)", index,
+                         length);
+    return nullptr;
+  }
+  if (!tensors_allocated_) {
     TF_LITE_REPORT_ERROR(
         error_reporter_,
-        "Output tensors not at index 0 are allocated from the "
-        "persistent memory arena. Repeat calls will cause excess "
-        "allocation!");
-    return allocator_.AllocatePersistentTfLiteTensor(model_, eval_tensors_,
-                                                     outputs().Get(index));
-  }
-  if (output_tensor_ == nullptr) {
-    // TODO(b/162311891): Drop these allocations when the interpreter supports
-    // handling buffers from TfLiteEvalTensor.
-    output_tensor_ = allocator_.AllocatePersistentTfLiteTensor(
-        model_, eval_tensors_, outputs().Get(index));
+        "AllocateTensors() must be called before output_eval_tensor()");
+    return nullptr;
   }
-  return output_tensor_;
+  return output_eval_tensors_[index];
 }
 
 TfLiteTensor* MicroInterpreter::tensor(size_t index) {
@@ -427,11 +1306,264 @@ TfLiteTensor* MicroInterpreter::tensor(size_t index) {
                          length);
     return nullptr;
   }
-  return allocator_.AllocatePersistentTfLiteTensor(model_, eval_tensors_,
-                                                   index);
+  if (!tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "AllocateTensors() must be called before tensor()");
+    return nullptr;
+  }
+  if (tensors_ == nullptr) {
+    // The cache for arbitrary tensors is only paid for by callers that use
+    // this API.
+    tensors_ = reinterpret_cast<TfLiteTensor**>(
+        allocator_.AllocatePersistentBuffer(sizeof(TfLiteTensor*) * length));
+    if (tensors_ == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate memory for the tensor cache, "
+                           "%d bytes required",
+                           sizeof(TfLiteTensor*) * length);
+      return nullptr;
+    }
+    for (size_t i = 0; i < length; ++i) {
+      tensors_[i] = nullptr;
+    }
+  }
+  return GetOrAllocateTfLiteTensor(&tensors_[index], index);
+}
+
+TfLiteEvalTensor* MicroInterpreter::eval_tensor(size_t index) {
+  const size_t length = tensors_size();
+  if (index >= length) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Tensor index %d out of range (length is %d)", index,
+                         length);
+    return nullptr;
+  }
+  if (!tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(
+        error_reporter_,
+        "AllocateTensors() must be called before eval_tensor()");
+    return nullptr;
+  }
+  return &eval_tensors_[index];
+}
+
+void MicroInterpreter::SetThreadPool(MicroThreadPool* pool) {
+  context_.SetExternalContext(
+      &context_, kTfLiteCpuBackendContext,
+      pool != nullptr ? pool->external_context() : nullptr);
+  context_.recommended_num_threads =
+      pool != nullptr ? pool->num_threads() : 1;
+}
+
+TfLiteStatus MicroInterpreter::AddMemoryTier(uint8_t* buffer, size_t size,
+                                             int rank) {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "AddMemoryTier() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  return allocator_.AddMemoryTier(buffer, size, rank);
+}
+
+void MicroInterpreter::SetWeightPlacement(size_t max_resident_bytes,
+                                          size_t prefetch_bytes) {
+  weight_placement_enabled_ = true;
+  max_resident_weight_bytes_ = max_resident_bytes;
+  weight_prefetch_bytes_ = prefetch_bytes;
+}
+
+void MicroInterpreter::SetWeightPacking(size_t max_packed_bytes) {
+  weight_packing_.max_bytes = max_packed_bytes;
+  context_helper_.SetWeightPacking(max_packed_bytes != 0 ? &weight_packing_
+                                                         : nullptr);
+}
+
+TfLiteStatus MicroInterpreter::SetStreamingHop(int hop) {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(
+        error_reporter_,
+        "SetStreamingHop() must be called before AllocateTensors()");
+    return kTfLiteError;
+  }
+  if (hop < 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Invalid streaming hop %d", hop);
+    return kTfLiteError;
+  }
+  streaming_.hop = hop;
+  return kTfLiteOk;
+}
+
+void MicroInterpreter::ResetStreamingState() {
+  if (streaming_.tensors == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < tensors_size(); ++i) {
+    streaming_.tensors[i].window = 0;
+  }
+}
+
+void MicroInterpreter::ResetStreamingShifts() {
+  if (streaming_.tensors == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < tensors_size(); ++i) {
+    streaming_.tensors[i].shift = kStreamingShiftUnknown;
+    streaming_.tensors[i].cache_requested = false;
+  }
+  for (size_t i = 0; i < inputs_size(); ++i) {
+    const int tensor_index = inputs().Get(i);
+    if (eval_tensors_[tensor_index].dims->size >= 2) {
+      streaming_.tensors[tensor_index].shift = streaming_.hop;
+    }
+  }
+}
+
+TfLiteStatus MicroInterpreter::AllocateStreamingCaches() {
+  if (streaming_.tensors == nullptr) {
+    return kTfLiteOk;
+  }
+  for (size_t i = 0; i < tensors_size(); ++i) {
+    StreamingTensor& entry = streaming_.tensors[i];
+    if (!entry.cache_requested) {
+      entry.cache = nullptr;
+      continue;
+    }
+    size_t bytes;
+    TF_LITE_ENSURE_STATUS(
+        TfLiteEvalTensorByteLength(&eval_tensors_[i], &bytes));
+    if (entry.cache != nullptr && entry.cache_capacity >= bytes) {
+      continue;
+    }
+    // A cache outgrown by a resize is not reclaimed.
+    entry.cache =
+        static_cast<uint8_t*>(allocator_.AllocatePersistentBuffer(bytes));
+    if (entry.cache == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate %d bytes for the streaming "
+                           "cache of tensor %d",
+                           bytes, i);
+      return kTfLiteError;
+    }
+    entry.cache_capacity = bytes;
+    streaming_cache_bytes_ += bytes;
+  }
+  // Cached rows are only valid for the plan and batch they were computed
+  // with.
+  ResetStreamingState();
+  return kTfLiteOk;
+}
+
+void MicroInterpreter::AdvanceStreamingWindow() {
+  if (++streaming_.window == 0) {
+    streaming_.window = 1;
+  }
+}
+
+int MicroInterpreter::weight_placement(size_t tensor_index) const {
+  if (weight_placements_ == nullptr ||
+      tensor_index >= subgraph_->tensors()->size()) {
+    return kNotConstantTensor;
+  }
+  return weight_placements_[tensor_index];
+}
+
+TfLiteStatus MicroInterpreter::PlaceWeights() {
+  const size_t tensors_count = subgraph_->tensors()->size();
+  weight_placements_ = reinterpret_cast<int8_t*>(
+      allocator_.AllocatePersistentBuffer(sizeof(int8_t) * tensors_count));
+  if (weight_placements_ == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for weight placements, "
+                         "%d bytes required",
+                         sizeof(int8_t) * tensors_count);
+    return kTfLiteError;
+  }
+
+  // The staging buffer gets the fastest memory, before resident weights.
+  uint8_t* staging = nullptr;
+  if (weight_prefetch_bytes_ > 0) {
+    int staging_rank;
+    staging = reinterpret_cast<uint8_t*>(allocator_.AllocateFromMemoryTier(
+        weight_prefetch_bytes_, &staging_rank));
+    if (staging == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "No memory tier has room for a %d byte weight "
+                           "staging buffer",
+                           weight_prefetch_bytes_);
+      return kTfLiteError;
+    }
+  }
+  TF_LITE_ENSURE_STATUS(allocator_.PlaceConstantTensors(
+      model_, eval_tensors_, max_resident_weight_bytes_, weight_placements_));
+  if (staging == nullptr) {
+    return kTfLiteOk;
+  }
+
+  const size_t operators_count = subgraph_->operators()->size();
+  node_prefetches_ = reinterpret_cast<size_t*>(
+      allocator_.AllocatePersistentBuffer(sizeof(size_t) *
+                                          (operators_count + 1)));
+  if (node_prefetches_ == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for weight prefetches, "
+                         "%d bytes required",
+                         sizeof(size_t) * (operators_count + 1));
+    return kTfLiteError;
+  }
+
+  // Every operator reuses the staging buffer from the start, packing as many
+  // of its constant inputs that stayed in the model as fit. The first pass
+  // counts the prefetches, the second fills them in.
+  for (int pass = 0; pass < 2; ++pass) {
+    size_t count = 0;
+    for (size_t i = 0; i < operators_count; ++i) {
+      node_prefetches_[i] = count;
+      const TfLiteIntArray* inputs = node_and_registrations_[i].node.inputs;
+      size_t offset = 0;
+      for (int j = 0; j < inputs->size; ++j) {
+        const int tensor_index = inputs->data[j];
+        if (tensor_index < 0 ||
+            (weight_placements_[tensor_index] != kConstantTensorInModel &&
+             weight_placements_[tensor_index] != kConstantTensorPrefetched)) {
+          continue;
+        }
+        const size_t bytes = ConstantTensorByteLength(
+            *model_, *subgraph_->tensors()->Get(tensor_index));
+        if (offset + bytes > weight_prefetch_bytes_) {
+          continue;
+        }
+        if (pass == 1) {
+          WeightPrefetch* prefetch = &weight_prefetches_[count];
+          prefetch->tensor = &eval_tensors_[tensor_index];
+          prefetch->source = eval_tensors_[tensor_index].data.data;
+          prefetch->staging = staging + offset;
+          prefetch->bytes = bytes;
+          weight_placements_[tensor_index] = kConstantTensorPrefetched;
+        }
+        offset += AlignSizeUp(bytes, kWeightPrefetchAlignment);
+        ++count;
+      }
+    }
+    node_prefetches_[operators_count] = count;
+
+    if (pass == 0) {
+      weight_prefetches_ = reinterpret_cast<WeightPrefetch*>(
+          allocator_.AllocatePersistentBuffer(sizeof(WeightPrefetch) * count));
+      if (count > 0 && weight_prefetches_ == nullptr) {
+        TF_LITE_REPORT_ERROR(error_reporter_,
+                             "Failed to allocate memory for weight "
+                             "prefetches, %d bytes required",
+                             sizeof(WeightPrefetch) * count);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
 }
 
 TfLiteStatus MicroInterpreter::ResetVariableTensors() {
+  ResetStreamingState();
   for (size_t i = 0; i < subgraph_->tensors()->size(); ++i) {
     auto* tensor = subgraph_->tensors()->Get(i);
     if (tensor->is_variable()) {
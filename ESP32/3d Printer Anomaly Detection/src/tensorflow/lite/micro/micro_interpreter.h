@@ -23,8 +23,11 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/micro/eval_tensor_view.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/micro/micro_streaming.h"
+#include "tensorflow/lite/micro/micro_weight_packing.h"
 #include "tensorflow/lite/portable_type_to_tflitetype.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -34,6 +37,8 @@ limitations under the License.
 
 namespace tflite {
 
+class MicroThreadPool;
+
 namespace internal {
 
 // A helper class to encapsulate the implementation of APIs in Context.
@@ -57,6 +62,11 @@ class ContextHelper {
                                  int tensor_idx);
   static TfLiteEvalTensor* GetEvalTensor(const struct TfLiteContext* context,
                                          int tensor_idx);
+  static TfLiteExternalContext* GetExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
+  static void SetExternalContext(struct TfLiteContext* context,
+                                 TfLiteExternalContextType type,
+                                 TfLiteExternalContext* external_context);
 
   // Sets the pointer to a list of TfLiteEvalTensor instances.
   void SetTfLiteEvalTensors(TfLiteEvalTensor* eval_tensors);
@@ -64,16 +74,98 @@ class ContextHelper {
   // Sets the pointer to a list of ScratchBufferHandle instances.
   void SetScratchBufferHandles(ScratchBufferHandle* scratch_buffer_handles);
 
+  // Weight packing settings returned by GetMicroWeightPacking(), nullptr
+  // while packing is disabled.
+  void SetWeightPacking(MicroWeightPacking* weight_packing) {
+    weight_packing_ = weight_packing;
+  }
+  MicroWeightPacking* weight_packing() const { return weight_packing_; }
+
+  // Sliding-window state returned by GetMicroStreaming(), nullptr unless the
+  // model is streamed.
+  void SetStreaming(MicroStreaming* streaming) { streaming_ = streaming; }
+  MicroStreaming* streaming() const { return streaming_; }
+
+  // Model whose tensors GetMicroTensorSparsity() looks up.
+  const Model* model() const { return model_; }
+
+  // Persistent buffers requested while kernels are prepared can be recorded
+  // (see MicroInterpreter::EnableResizing()), so that a later re-prepare is
+  // handed back the same buffers in the same order instead of growing the
+  // tail of the arena.
+  enum class PersistentBufferMode { kAllocate, kRecord, kReplay };
+  void SetPersistentBufferMode(PersistentBufferMode mode);
+
+  // Returns the buffer most recently handed out in kAllocate mode, and its
+  // size in `bytes`.
+  void* last_persistent_buffer(size_t* bytes) const {
+    *bytes = last_buffer_bytes_;
+    return last_buffer_;
+  }
+
+  // Returns true if a kernel fetched a TfLiteTensor from temp memory since the
+  // last call to this method, and clears that state.
+  bool ConsumeTempAllocations() {
+    const bool used = temp_allocations_pending_;
+    temp_allocations_pending_ = false;
+    return used;
+  }
+
  private:
   MicroAllocator* allocator_ = nullptr;
   ErrorReporter* error_reporter_ = nullptr;
   const Model* model_ = nullptr;
   TfLiteEvalTensor* eval_tensors_ = nullptr;
   ScratchBufferHandle* scratch_buffer_handles_ = nullptr;
+  bool temp_allocations_pending_ = false;
+  void* last_buffer_ = nullptr;
+  TfLiteExternalContext* external_contexts_[kTfLiteMaxExternalContexts] = {};
+  MicroWeightPacking* weight_packing_ = nullptr;
+  MicroStreaming* streaming_ = nullptr;
+  size_t last_buffer_bytes_ = 0;
+
+  // Header placed in front of every persistent buffer recorded in kRecord
+  // mode, forming a list in allocation order.
+  struct RecordedBuffer {
+    size_t bytes;
+    RecordedBuffer* next;
+  };
+  PersistentBufferMode persistent_buffer_mode_ =
+      PersistentBufferMode::kAllocate;
+  RecordedBuffer* recorded_buffers_head_ = nullptr;
+  RecordedBuffer* recorded_buffers_tail_ = nullptr;
+  RecordedBuffer* replay_cursor_ = nullptr;
 };
 
 }  // namespace internal
 
+// Returned by MicroInterpreter::InvokeStep() when the time budget ran out
+// before the last operator.
+// TODO(b/149795762): Add this to the TfLiteStatus enum.
+constexpr int kTfLiteInvokeContinue = -10;
+
+// A constant input copied into fast memory right before its operator runs,
+// see MicroInterpreter::SetWeightPlacement().
+typedef struct {
+  TfLiteEvalTensor* tensor;
+  // Where the tensor is stored in the model.
+  const void* source;
+  // Where it is copied to, inside the staging buffer.
+  void* staging;
+  size_t bytes;
+} WeightPrefetch;
+
+// A single pre-resolved step of the execution plan built by AllocateTensors().
+// Invoke() walks a contiguous array of these instead of going back to the
+// flatbuffer and the NodeAndRegistration list for every operator.
+typedef struct {
+  TfLiteNode* node;
+  TfLiteStatus (*invoke)(TfLiteContext* context, TfLiteNode* node);
+  // Only used for error reporting and profiling.
+  const TfLiteRegistration* registration;
+  int node_index;
+} ExecutionPlanEntry;
+
 class MicroInterpreter {
  public:
   // The lifetime of the model, op resolver, tensor arena, error reporter and
@@ -103,23 +195,84 @@ class MicroInterpreter {
   // intermediate tensors.
   TfLiteStatus AllocateTensors();
 
+  // Creates a ready-to-run copy of this interpreter, which must have allocated
+  // its tensors, without running Prepare again. The copy and its allocator are
+  // placed in `tensor_arena`, together with its own eval tensors, memory plan,
+  // variable tensors and a copy of every kernel's user_data. Returns nullptr
+  // on failure. There is nothing to release: reusing the arena discards the
+  // copy.
+  //
+  // The model, op resolver, error reporter, tensor dims and all buffers
+  // kernels allocated in Prepare (quantization multipliers, lookup tables,
+  // ...) are shared with this interpreter, which therefore must outlive the
+  // copy. ResizeInputTensor() fails on this interpreter once it was cloned.
+  // Shared data is only read during Invoke(), so the interpreter and its
+  // copies can run concurrently on different threads as long as the error
+  // reporter and profiler are thread-safe. Inputs and outputs bound with
+  // BindInput()/BindOutput() keep pointing to the same buffers until they are
+  // bound again on the copy. The copy can not be resized.
+  MicroInterpreter* Clone(uint8_t* tensor_arena, size_t tensor_arena_size,
+                          tflite::Profiler* profiler = nullptr);
+
   // In order to support partial graph runs for strided models, this can return
   // values other than kTfLiteOk and kTfLiteError.
   // TODO(b/149795762): Add this to the TfLiteStatus enum.
   TfLiteStatus Invoke();
 
+  // Runs the model in time slices. Each call executes operators, resuming
+  // where the previous call stopped, until either the model completes
+  // (kTfLiteOk) or at least `budget_ticks` ticks of GetCurrentTimeTicks() have
+  // elapsed (kTfLiteInvokeContinue). At least one operator runs per call, so a
+  // platform without a timer (ticks_per_second() == 0) runs one operator per
+  // call. Operators are never interrupted, so a slice can overrun the budget
+  // by the duration of one operator.
+  //
+  // Input tensors must not be modified until a run completes. Calling Invoke()
+  // or ResizeInputTensor() discards a partially completed run.
+  TfLiteStatus InvokeStep(int32_t budget_ticks);
+
+  // True between an InvokeStep() that returned kTfLiteInvokeContinue and the
+  // call that completes or discards that run.
+  bool invoke_in_progress() const { return next_plan_entry_ != 0; }
+
+  // Selects an intermediate tensor (e.g. the latent output of an encoder) that
+  // can be computed without running the whole graph. Must be called before
+  // AllocateTensors(), which prunes every operator that does not contribute to
+  // the target into a second, shorter execution plan.
+  TfLiteStatus SetTargetTensor(int tensor_index);
+
+  // Runs only the operators needed to produce the target tensor. The target
+  // can then be read through target_eval_tensor() or typed_target(). Outputs
+  // and any tensor not on the path to the target are left undefined, and a
+  // partially completed InvokeStep() run is discarded.
+  TfLiteStatus InvokeTarget();
+
+  // Allocation-free accessors for the target tensor. Return nullptr (or an
+  // invalid view) if no target was set.
+  TfLiteEvalTensor* target_eval_tensor();
+  template <class T>
+  EvalTensorView<T> typed_target() {
+    return EvalTensorView<T>(target_eval_tensor());
+  }
+
   size_t tensors_size() const { return context_.tensors_size; }
+  // Returns a TfLiteTensor for any tensor in the model. The struct is
+  // allocated from the persistent arena on the first call for a given index
+  // and cached, so repeat calls do not consume additional memory. Prefer
+  // eval_tensor() when the quantization parameters are not needed.
   TfLiteTensor* tensor(size_t tensor_index);
   template <class T>
   T* typed_tensor(int tensor_index) {
-    if (TfLiteTensor* tensor_ptr = tensor(tensor_index)) {
-      if (tensor_ptr->type == typeToTfLiteType<T>()) {
-        return GetTensorData<T>(tensor_ptr);
-      }
-    }
-    return nullptr;
+    return EvalTensorView<T>(eval_tensor(tensor_index)).data();
   }
 
+  // Returns the TfLiteEvalTensor backing any tensor in the model. This never
+  // allocates from the arena.
+  TfLiteEvalTensor* eval_tensor(size_t tensor_index);
+
+  // Returns a TfLiteTensor for the input at `index`. All input handles are
+  // resolved once in AllocateTensors() into a fixed table, so repeat calls are
+  // free.
   TfLiteTensor* input(size_t index);
   size_t inputs_size() const { return subgraph_->inputs()->Length(); }
   const flatbuffers::Vector<int32_t>& inputs() const {
@@ -128,12 +281,14 @@ class MicroInterpreter {
   TfLiteTensor* input_tensor(size_t index) { return input(index); }
   template <class T>
   T* typed_input_tensor(int tensor_index) {
-    if (TfLiteTensor* tensor_ptr = input_tensor(tensor_index)) {
-      if (tensor_ptr->type == typeToTfLiteType<T>()) {
-        return GetTensorData<T>(tensor_ptr);
-      }
-    }
-    return nullptr;
+    return typed_input<T>(tensor_index).data();
+  }
+
+  // Allocation-free accessors for the model inputs.
+  TfLiteEvalTensor* input_eval_tensor(size_t index);
+  template <class T>
+  EvalTensorView<T> typed_input(size_t index) {
+    return EvalTensorView<T>(input_eval_tensor(index));
   }
 
   TfLiteTensor* output(size_t index);
@@ -144,14 +299,111 @@ class MicroInterpreter {
   TfLiteTensor* output_tensor(size_t index) { return output(index); }
   template <class T>
   T* typed_output_tensor(int tensor_index) {
-    if (TfLiteTensor* tensor_ptr = output_tensor(tensor_index)) {
-      if (tensor_ptr->type == typeToTfLiteType<T>()) {
-        return GetTensorData<T>(tensor_ptr);
-      }
-    }
-    return nullptr;
+    return typed_output<T>(tensor_index).data();
   }
 
+  // Allocation-free accessors for the model outputs.
+  TfLiteEvalTensor* output_eval_tensor(size_t index);
+  template <class T>
+  EvalTensorView<T> typed_output(size_t index) {
+    return EvalTensorView<T>(output_eval_tensor(index));
+  }
+
+  // Allows ResizeInputTensor() to be called later. Every persistent buffer
+  // kernels allocate in Prepare then carries a 16 byte header, so that a
+  // resize can hand the same buffers back to them. Must be called before
+  // AllocateTensors().
+  TfLiteStatus EnableResizing();
+
+  // Changes the batch (leading) dimension of the input at `index` after
+  // AllocateTensors(), which requires EnableResizing(). The new batch size is
+  // propagated from the input along the data flow to every activation output
+  // whose leading dimension was the old batch, the kernels are prepared again
+  // and only the non-persistent memory plan is recomputed. Persistent kernel
+  // data is reused, so repeated resizes do not grow the arena.
+  //
+  // Only the leading dimension can change: TFLM kernels take their output
+  // shapes from the flatbuffer instead of inferring them, so other dimensions
+  // can not be propagated through the graph. If an operator does not keep the
+  // batch as its leading dimension, re-preparing fails with an error and the
+  // interpreter can no longer be invoked. Planned tensor contents are not
+  // preserved across a resize. The size of buffers bound through BindInput()
+  // or BindOutput() is not known, so a resize that would grow a bound tensor
+  // fails and leaves the interpreter unchanged.
+  TfLiteStatus ResizeInputTensor(size_t index, const TfLiteIntArray* dims);
+
+  // Points the model input (or output) at `index` to caller-owned memory, so
+  // data can be produced or consumed in place without a copy through the
+  // arena. The buffer must hold at least as many bytes as the tensor, be
+  // aligned to the tensor element type and outlive the interpreter.
+  //
+  // When called before AllocateTensors() the tensor is excluded from the
+  // memory plan and takes no arena space. Calling it afterwards is allowed to
+  // re-point the tensor (e.g. to the next window of a ring buffer), but arena
+  // space already planned for an unbound tensor is not reclaimed.
+  TfLiteStatus BindInput(size_t index, void* buffer);
+  TfLiteStatus BindOutput(size_t index, void* buffer);
+
+  // Lets FULLY_CONNECTED, CONV_2D and DEPTHWISE_CONV_2D split large
+  // operations across the workers of `pool`, which must outlive the
+  // interpreter. Pass nullptr to run single-threaded again. Each interpreter
+  // that is invoked concurrently needs its own pool.
+  void SetThreadPool(MicroThreadPool* pool);
+
+  // Adds memory that AllocateTensors() may copy constant tensors into when
+  // weight placement is enabled, see MicroAllocator::AddMemoryTier(). A lower
+  // rank means faster memory. Must be called before AllocateTensors().
+  TfLiteStatus AddMemoryTier(uint8_t* buffer, size_t size, int rank);
+
+  // Enables weight placement in AllocateTensors(). Constant tensors of at most
+  // `max_resident_bytes` are copied into the memory tiers once, smallest
+  // first. If `prefetch_bytes` is not 0, a staging buffer of that size is
+  // reserved in the fastest tier before that, and the constant inputs of each
+  // operator that stayed in the model are copied into it right before the
+  // operator runs. This pays off when a kernel reads its weights many times
+  // (e.g. convolutions) from memory much slower than a sequential copy.
+  // Interpreters that prefetch can not be cloned.
+  void SetWeightPlacement(size_t max_resident_bytes, size_t prefetch_bytes);
+
+  // Lets FULLY_CONNECTED and CONV_2D repack their float and int8 weights at
+  // Prepare time into a layout their inner loops stream through, with input
+  // offsets pre-summed into the bias. Float16 weights are widened to float and
+  // int4 weights unpacked to int8 in the same pass instead of in every invoke.
+  // The packed copies take up to `max_packed_bytes` of persistent arena in
+  // total; layers that do not fit keep reading the weights from the model.
+  // Pass 0, the default, to disable packing when the arena is tight. Must be
+  // called before AllocateTensors().
+  void SetWeightPacking(size_t max_packed_bytes);
+
+  // Returns the arena bytes used by packed weights, see SetWeightPacking().
+  size_t packed_weight_bytes() const { return weight_packing_.used_bytes; }
+
+  // Runs the model on a sliding window that advances by `hop` rows along
+  // dimension 1 of every input between invokes, e.g. the newest `hop` samples
+  // of a [1, window, 1, channels] sensor input. CONV_2D and DEPTHWISE_CONV_2D
+  // layers none of whose output rows read padding then keep their output of
+  // the previous window in a ring buffer in the persistent arena and only
+  // compute the rows that are new, and pooling layers pass the shift on.
+  // Results are bit-exact with computing the whole window. The first invoke,
+  // the first after ResetStreamingState(), and layers that missed a window
+  // (e.g. skipped by InvokeTarget()) compute everything. Pass 0, the default,
+  // to disable. Must be called before AllocateTensors(); clones run without
+  // streaming.
+  TfLiteStatus SetStreamingHop(int hop);
+
+  // Makes the next invoke compute every layer in full, e.g. when the input
+  // jumped instead of advancing by the hop. ResetVariableTensors() does this
+  // too.
+  void ResetStreamingState();
+
+  // Returns the arena bytes used by streaming caches, see SetStreamingHop().
+  size_t streaming_cache_bytes() const { return streaming_cache_bytes_; }
+
+  // Returns where AllocateTensors() placed the tensor at `tensor_index`: the
+  // rank of the memory tier holding it, kConstantTensorInModel,
+  // kConstantTensorPrefetched or kNotConstantTensor.
+  int weight_placement(size_t tensor_index) const;
+
   // Reset all variable tensors to the default value.
   TfLiteStatus ResetVariableTensors();
 
@@ -159,6 +411,10 @@ class MicroInterpreter {
 
   size_t operators_size() const { return subgraph_->operators()->size(); }
 
+  // For debugging only.
+  // Returns the number of operators run by InvokeTarget().
+  size_t target_operators_size() const { return target_plan_size_; }
+
   // For debugging only.
   const NodeAndRegistration node_and_registration(int node_index) const {
     return node_and_registrations_[node_index];
@@ -183,10 +439,82 @@ class MicroInterpreter {
 
   void CorrectTensorEndianness(TfLiteEvalTensor* tensorCorr);
 
+  // Populates a newly constructed interpreter from `prototype`, see Clone().
+  TfLiteStatus CopyAllocationFrom(const MicroInterpreter& prototype);
+
+  // Flattens all nodes with an invoke function into execution_plan_. Called
+  // once at the end of AllocateTensors().
+  TfLiteStatus BuildExecutionPlan();
+
+  // Copies constant tensors into the memory tiers and sets up the prefetches
+  // requested through SetWeightPlacement().
+  TfLiteStatus PlaceWeights();
+
+  // Copies the entries of execution_plan_ that contribute to
+  // target_tensor_index_ into target_plan_.
+  TfLiteStatus BuildTargetPlan();
+
+  // Runs Prepare on every node, used by AllocateTensors() and
+  // ResizeInputTensor().
+  TfLiteStatus PrepareNodes();
+
+  // Sets the streaming shift of the model inputs to the hop and of every
+  // other tensor to unknown, for kernels to propagate in PrepareNodes().
+  void ResetStreamingShifts();
+
+  // Allocates the streaming caches kernels requested in PrepareNodes() that
+  // do not exist yet or are too small for their tensor.
+  TfLiteStatus AllocateStreamingCaches();
+
+  // Starts a new window for streaming kernels, at the start of every invoke.
+  void AdvanceStreamingWindow();
+
+  // Replaces the flatbuffer-backed dims of all activation tensors with
+  // writable copies in the persistent arena and allocates resized_tensors_.
+  // Only done on the first resize.
+  TfLiteStatus CopyActivationDims();
+
+  // Brings all cached TfLiteTensor structs in line with their eval tensors.
+  void RefreshCachedTfLiteTensors();
+
+  // Resolves the input and output handle tables. Called once at the end of
+  // AllocateTensors().
+  TfLiteStatus ResolveIoTensors();
+
+  // Records an external buffer for the input/output slot `io_index` (outputs
+  // follow inputs) and applies it right away if tensors are allocated.
+  TfLiteStatus BindIoTensor(size_t io_index, int tensor_index, void* buffer);
+
+  // Points the eval tensor at `tensor_index`, and any TfLiteTensor already
+  // handed out for it, to `buffer`.
+  TfLiteStatus SetExternalBuffer(int tensor_index, void* buffer);
+
+  // Returns the cached persistent TfLiteTensor in `cache`, allocating it on
+  // first use.
+  TfLiteTensor* GetOrAllocateTfLiteTensor(TfLiteTensor** cache,
+                                          int tensor_index);
+
+  // Checks initialization and allocates tensors if needed before running the
+  // execution plan.
+  TfLiteStatus PrepareForInvoke();
+
+  // Runs a single entry of the execution plan.
+  inline TfLiteStatus InvokeNode(const ExecutionPlanEntry& entry);
+
   template <class T>
   void CorrectTensorDataEndianness(T* data, int32_t size);
 
   NodeAndRegistration* node_and_registrations_ = nullptr;
+  ExecutionPlanEntry* execution_plan_ = nullptr;
+  size_t execution_plan_size_ = 0;
+  // Index of the next plan entry to run for InvokeStep().
+  size_t next_plan_entry_ = 0;
+
+  // Pruned plan used by InvokeTarget(), empty unless SetTargetTensor() was
+  // called before AllocateTensors().
+  int target_tensor_index_ = -1;
+  ExecutionPlanEntry* target_plan_ = nullptr;
+  size_t target_plan_size_ = 0;
 
   const Model* model_;
   const MicroOpResolver& op_resolver_;
@@ -204,10 +532,52 @@ class MicroInterpreter {
   // TODO(b/16157777): Drop this reference:
   internal::ContextHelper context_helper_;
 
-  // TODO(b/162311891): Clean these pointers up when this class supports buffers
-  // from TfLiteEvalTensor.
-  TfLiteTensor* input_tensor_;
-  TfLiteTensor* output_tensor_;
+  // Handles for the model inputs and outputs, resolved in AllocateTensors().
+  TfLiteEvalTensor** input_eval_tensors_ = nullptr;
+  TfLiteEvalTensor** output_eval_tensors_ = nullptr;
+
+  // Lazily populated TfLiteTensor structs for callers of input(), output() and
+  // tensor(). Entries stay nullptr until first requested.
+  // TODO(b/162311891): Drop these when all callers use TfLiteEvalTensor.
+  TfLiteTensor** input_tensors_ = nullptr;
+  TfLiteTensor** output_tensors_ = nullptr;
+  TfLiteTensor** tensors_ = nullptr;
+
+  // Caller-owned buffers registered through BindInput()/BindOutput(), indexed
+  // by input slot followed by output slot. nullptr until the first bind.
+  void** bound_buffers_ = nullptr;
+
+  size_t scratch_buffer_handle_count_ = 0;
+  bool resizing_enabled_ = false;
+  bool activation_dims_owned_ = false;
+  // One flag per tensor, set on the tensors the last ResizeInputTensor()
+  // changed. Allocated with the activation dims copies.
+  bool* resized_tensors_ = nullptr;
+  // Set on interpreters created by Clone(), which share kernel data with the
+  // prototype and can not re-prepare it.
+  bool is_clone_ = false;
+  // Set once Clone() was called, after which the shared kernel data and
+  // tensor dims must not change anymore.
+  bool has_clones_ = false;
+
+  // Weight placement settings and results, see SetWeightPlacement().
+  bool weight_placement_enabled_ = false;
+  size_t max_resident_weight_bytes_ = 0;
+  size_t weight_prefetch_bytes_ = 0;
+  int8_t* weight_placements_ = nullptr;
+  WeightPrefetch* weight_prefetches_ = nullptr;
+  // The prefetches of node i are weight_prefetches_[node_prefetches_[i]] up
+  // to weight_prefetches_[node_prefetches_[i + 1]]. nullptr unless weights
+  // are prefetched.
+  size_t* node_prefetches_ = nullptr;
+
+  // Handed to the context helper once SetWeightPacking() is called.
+  MicroWeightPacking weight_packing_ = {};
+
+  // Sliding-window state, see SetStreamingHop(). Handed to the context helper
+  // by AllocateTensors() if the hop is not 0.
+  MicroStreaming streaming_ = {};
+  size_t streaming_cache_bytes_ = 0;
 };
 
 }  // namespace tflite
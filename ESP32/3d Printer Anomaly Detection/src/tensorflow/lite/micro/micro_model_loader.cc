@@ -0,0 +1,380 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_model_loader.h"
+
+#include <cstring>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "esp_spi_flash.h"
+#elif defined(__linux__) || defined(__APPLE__)
+#define TF_LITE_MICRO_POSIX_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tflite {
+
+namespace {
+
+// Half-byte lookup table for the reflected 0xEDB88320 polynomial. It is much
+// faster than a bit at a time while only costing 64 bytes of flash.
+constexpr uint32_t kCrc32Nibbles[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+    0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+
+// Adds an LZ4 length extension (a run of bytes ending with one below 255) to
+// `length`. Fails if the input ends or the length exceeds `limit`.
+bool ReadLz4Length(const uint8_t** input, const uint8_t* input_end,
+                   size_t limit, size_t* length) {
+  uint8_t byte;
+  do {
+    if (*input == input_end || *length > limit) {
+      return false;
+    }
+    byte = *(*input)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+// Root table offset and file identifier, present in every model.
+constexpr uint32_t kMinModelSize = 2 * sizeof(flatbuffers::uoffset_t);
+
+// Checks that `size` bytes hold a TFLite model whose offsets all stay within
+// those bytes. Containers come from an updatable partition or file rather
+// than the firmware image, so this runs before GetModel() follows any offset.
+// It also rejects buffers too short to hold the file identifier.
+bool VerifyModel(const uint8_t* data, size_t size) {
+  flatbuffers::Verifier verifier(data, size);
+  return VerifyModelBuffer(verifier);
+}
+
+}  // namespace
+
+namespace internal {
+
+bool DecodeLz4Block(const uint8_t* input, size_t input_size, uint8_t* output,
+                    size_t output_size) {
+  const uint8_t* input_end = input + input_size;
+  uint8_t* out = output;
+  uint8_t* const output_end = output + output_size;
+  while (input < input_end) {
+    // Each sequence is a token, literals, then a back-reference except in
+    // the last sequence.
+    const uint8_t token = *input++;
+    size_t length = token >> 4;
+    if (length == 15 &&
+        !ReadLz4Length(&input, input_end, output_size, &length)) {
+      return false;
+    }
+    if (length > static_cast<size_t>(input_end - input) ||
+        length > static_cast<size_t>(output_end - out)) {
+      return false;
+    }
+    memcpy(out, input, length);
+    input += length;
+    out += length;
+    if (input == input_end) {
+      break;
+    }
+
+    if (input_end - input < 2) {
+      return false;
+    }
+    const size_t offset = input[0] | (input[1] << 8);
+    input += 2;
+    if (offset == 0 || offset > static_cast<size_t>(out - output)) {
+      return false;
+    }
+    length = token & 15;
+    if (length == 15 &&
+        !ReadLz4Length(&input, input_end, output_size, &length)) {
+      return false;
+    }
+    length += 4;
+    if (length > static_cast<size_t>(output_end - out)) {
+      return false;
+    }
+    const uint8_t* match = out - offset;
+    if (offset >= length) {
+      memcpy(out, match, length);
+      out += length;
+    } else {
+      // Overlapping matches repeat the last `offset` bytes.
+      for (size_t i = 0; i < length; ++i) {
+        *out++ = *match++;
+      }
+    }
+  }
+  return out == output_end;
+}
+
+}  // namespace internal
+
+uint32_t MicroModelCrc32(const uint8_t* data, size_t size, uint32_t crc) {
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ kCrc32Nibbles[crc & 0xf];
+    crc = (crc >> 4) ^ kCrc32Nibbles[crc & 0xf];
+  }
+  return ~crc;
+}
+
+TfLiteStatus ParseModelContainer(const uint8_t* data, size_t size,
+                                 ErrorReporter* error_reporter,
+                                 const MicroModelHeader** header,
+                                 const uint8_t** payload) {
+  // The header is read in place, and fields are assumed to be in the
+  // little-endian order of every target this runs on.
+  if (reinterpret_cast<uintptr_t>(data) % kMicroModelAlignment != 0) {
+    // MicroErrorReporter has no %p, so only the required alignment is shown.
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Model container is not %d byte aligned.",
+                         static_cast<int>(kMicroModelAlignment));
+    return kTfLiteError;
+  }
+  if (size < sizeof(MicroModelHeader)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Model container of %d bytes is truncated.", size);
+    return kTfLiteError;
+  }
+  const MicroModelHeader* result =
+      reinterpret_cast<const MicroModelHeader*>(data);
+  if (result->magic != kMicroModelMagic) {
+    TF_LITE_REPORT_ERROR(error_reporter, "No model container found.");
+    return kTfLiteError;
+  }
+  if (result->header_version != kMicroModelHeaderVersion ||
+      (result->flags != 0 && result->flags != kMicroModelLz4)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Unsupported model container version %d, flags %x.",
+                         result->header_version, result->flags);
+    return kTfLiteError;
+  }
+  if (result->header_size < sizeof(MicroModelHeader) ||
+      result->header_size % kMicroModelAlignment != 0 ||
+      result->header_size > size ||
+      result->payload_size > size - result->header_size) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Model container payload (%d bytes at %d) does not "
+                         "fit in %d bytes.",
+                         result->payload_size, result->header_size, size);
+    return kTfLiteError;
+  }
+
+  const uint8_t* result_payload = data + result->header_size;
+  const uint32_t crc = MicroModelCrc32(result_payload, result->payload_size);
+  if (crc != result->payload_crc32) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Model container CRC mismatch: %x, expected %x.", crc,
+                         result->payload_crc32);
+    return kTfLiteError;
+  }
+  // Compressed models are verified once decoded, but a decoded size too short
+  // for the root offset and file identifier can already be rejected.
+  if (result->flags == kMicroModelLz4 &&
+      result->decoded_size < kMinModelSize) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Model container decodes to %d bytes, too few for a "
+                         "TFLite model.",
+                         result->decoded_size);
+    return kTfLiteError;
+  }
+  if (result->flags == 0 &&
+      !VerifyModel(result_payload, result->payload_size)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Model container does not hold a TFLite model.");
+    return kTfLiteError;
+  }
+
+  *header = result;
+  *payload = result_payload;
+  return kTfLiteOk;
+}
+
+const Model* DecodeModelContainer(const MicroModelHeader* header,
+                                  const uint8_t* payload,
+                                  MicroAllocator* allocator,
+                                  ErrorReporter* error_reporter) {
+  if (header->flags == 0) {
+    return GetModel(payload);
+  }
+
+  uint8_t* decoded = reinterpret_cast<uint8_t*>(
+      allocator->AllocatePersistentBuffer(header->decoded_size));
+  if (decoded == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Failed to allocate %d bytes to decode the model",
+                         header->decoded_size);
+    return nullptr;
+  }
+  if (!internal::DecodeLz4Block(payload, header->payload_size, decoded,
+                                header->decoded_size) ||
+      !VerifyModel(decoded, header->decoded_size)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Failed to decode a %d byte compressed model",
+                         header->decoded_size);
+    return nullptr;
+  }
+  return GetModel(decoded);
+}
+
+MappedModel::MappedModel(ErrorReporter* error_reporter)
+    : error_reporter_(error_reporter) {}
+
+MappedModel::~MappedModel() { Unmap(); }
+
+TfLiteStatus MappedModel::Map(const char* source) {
+  Unmap();
+
+#if defined(ARDUINO_ARCH_ESP32)
+  const esp_partition_t* partition = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, source);
+  if (partition == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "No partition labeled '%s'.",
+                         source);
+    return kTfLiteError;
+  }
+  // Partitions start on a 64 KB flash page, so the mapping is page aligned.
+  const void* mapping = nullptr;
+  if (esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA,
+                         &mapping, &handle_) != ESP_OK) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Failed to map partition '%s'.",
+                         source);
+    return kTfLiteError;
+  }
+  mapping_ = mapping;
+  mapping_size_ = partition->size;
+#elif defined(TF_LITE_MICRO_POSIX_MMAP)
+  const int fd = open(source, O_RDONLY);
+  if (fd < 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Failed to open '%s'.", source);
+    return kTfLiteError;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    close(fd);
+    TF_LITE_REPORT_ERROR(error_reporter_, "'%s' is empty.", source);
+    return kTfLiteError;
+  }
+  // mmap() returns page aligned addresses.
+  void* mapping = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd,
+                       0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Failed to map '%s'.", source);
+    return kTfLiteError;
+  }
+  mapping_ = mapping;
+  mapping_size_ = file_stat.st_size;
+#else
+  TF_LITE_REPORT_ERROR(error_reporter_,
+                       "Mapping models is not supported on this platform.");
+  return kTfLiteError;
+#endif
+
+  if (ParseModelContainer(static_cast<const uint8_t*>(mapping_), mapping_size_,
+                          error_reporter_, &header_,
+                          &payload_) != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Invalid model container in '%s'.",
+                         source);
+    Unmap();
+    return kTfLiteError;
+  }
+  source_ = source;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MappedModel::MapNewest(const char* const* sources,
+                                    int source_count) {
+  Unmap();
+  for (int i = 0; i < source_count; ++i) {
+    MappedModel candidate(error_reporter_);
+    if (candidate.Map(sources[i]) != kTfLiteOk) {
+      continue;
+    }
+    if (!mapped() ||
+        candidate.header()->model_version > header_->model_version) {
+      // The previous choice, if any, is released when candidate goes out of
+      // scope.
+      Swap(&candidate);
+    }
+  }
+  if (!mapped()) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "None of the %d model sources is valid.",
+                         source_count);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+void MappedModel::Unmap() {
+  if (mapping_ != nullptr) {
+#if defined(ARDUINO_ARCH_ESP32)
+    spi_flash_munmap(handle_);
+    handle_ = 0;
+#elif defined(TF_LITE_MICRO_POSIX_MMAP)
+    munmap(const_cast<void*>(mapping_), mapping_size_);
+#endif
+  }
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  source_ = nullptr;
+  header_ = nullptr;
+  payload_ = nullptr;
+}
+
+const Model* MappedModel::model() const {
+  return payload_ == nullptr || header_->flags != 0 ? nullptr
+                                                    : GetModel(payload_);
+}
+
+const Model* MappedModel::Decode(MicroAllocator* allocator) const {
+  return payload_ == nullptr ? nullptr
+                             : DecodeModelContainer(header_, payload_,
+                                                    allocator,
+                                                    error_reporter_);
+}
+
+void MappedModel::Swap(MappedModel* other) {
+#if defined(ARDUINO_ARCH_ESP32)
+  spi_flash_mmap_handle_t handle = handle_;
+  handle_ = other->handle_;
+  other->handle_ = handle;
+#endif
+  const char* source = source_;
+  source_ = other->source_;
+  other->source_ = source;
+  const MicroModelHeader* header = header_;
+  header_ = other->header_;
+  other->header_ = header;
+  const uint8_t* payload = payload_;
+  payload_ = other->payload_;
+  other->payload_ = payload;
+  const void* mapping = mapping_;
+  mapping_ = other->mapping_;
+  other->mapping_ = mapping;
+  const size_t mapping_size = mapping_size_;
+  mapping_size_ = other->mapping_size_;
+  other->mapping_size_ = mapping_size;
+}
+
+}  // namespace tflite
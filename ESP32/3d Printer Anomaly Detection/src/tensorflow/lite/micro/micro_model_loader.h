@@ -0,0 +1,163 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_MODEL_LOADER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_MODEL_LOADER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "esp_partition.h"
+#endif
+
+namespace tflite {
+
+// Model containers wrap a serialized flatbuffer with a fixed little-endian
+// header so a model stored outside the firmware image can be checked before
+// GetModel() is run on it:
+//
+//   +--------------------+ 0
+//   | MicroModelHeader   |
+//   | padding            |
+//   +--------------------+ header_size (multiple of kMicroModelAlignment)
+//   | payload            |
+//   +--------------------+ header_size + payload_size
+//
+// The payload is either the flatbuffer itself, which can be used in place,
+// or an LZ4 block (kMicroModelLz4) that must be decoded into RAM first, see
+// DecodeModelContainer(). Containers are written by
+// tools/make_model_container.py.
+constexpr uint32_t kMicroModelMagic = 0x4d4d4654;  // "TFMM"
+constexpr uint16_t kMicroModelHeaderVersion = 1;
+// Flag set when the payload is an LZ4 compressed block.
+constexpr uint16_t kMicroModelLz4 = 1;
+// Required alignment of the payload, enough for every tensor type stored in
+// the flatbuffer.
+constexpr size_t kMicroModelAlignment = 16;
+
+struct MicroModelHeader {
+  uint32_t magic;
+  uint16_t header_version;
+  // Payload encoding, 0 for a plain flatbuffer or kMicroModelLz4.
+  uint16_t flags;
+  // Offset of the payload from the start of the container.
+  uint32_t header_size;
+  uint32_t payload_size;
+  // CRC-32 (IEEE 802.3) of the payload bytes as stored.
+  uint32_t payload_crc32;
+  // Set by whoever trains the model. When several containers are available
+  // the one with the highest version is loaded.
+  uint32_t model_version;
+  // Size of the flatbuffer once decoded. Only used for compressed payloads.
+  uint32_t decoded_size;
+  uint32_t reserved;
+};
+
+namespace internal {
+
+// Decodes a raw LZ4 block (no frame header) that must expand to exactly
+// `output_size` bytes. Every length and offset is checked, so corrupt input
+// fails instead of reading or writing out of bounds. Exposed for testing.
+bool DecodeLz4Block(const uint8_t* input, size_t input_size, uint8_t* output,
+                    size_t output_size);
+
+}  // namespace internal
+
+// Returns the CRC-32 (IEEE 802.3) of `size` bytes, continuing from `crc` so
+// large buffers can be checked in pieces.
+uint32_t MicroModelCrc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+// Checks that `data` holds a complete, uncorrupted container and that its
+// payload is suitably aligned. A plain payload must also pass the flatbuffers
+// Verifier. On success sets `payload` to the stored payload, which GetModel()
+// can use in place unless it is compressed.
+TfLiteStatus ParseModelContainer(const uint8_t* data, size_t size,
+                                 ErrorReporter* error_reporter,
+                                 const MicroModelHeader** header,
+                                 const uint8_t** payload);
+
+// Returns the model of a container checked by ParseModelContainer(), or
+// nullptr on failure. A plain payload is used in place. A compressed payload
+// is decoded straight from storage into a persistent buffer of `allocator`
+// and verified, so the model lives as long as the arena and no separate RAM
+// is needed for it. Build the interpreter on the same allocator (see the
+// MicroInterpreter constructor taking a MicroAllocator) so both share the
+// arena.
+const Model* DecodeModelContainer(const MicroModelHeader* header,
+                                  const uint8_t* payload,
+                                  MicroAllocator* allocator,
+                                  ErrorReporter* error_reporter);
+
+// A model container read straight from storage without copying it to RAM. On
+// ESP32 the source is the label of a data partition, which is mapped into the
+// address space with esp_partition_mmap() and read through the flash cache. On
+// POSIX hosts the source is a file path, mapped read-only with mmap().
+class MappedModel {
+ public:
+  explicit MappedModel(ErrorReporter* error_reporter);
+  ~MappedModel();
+
+  // Maps and validates the container at `source`, releasing any previous
+  // mapping first. Fails if the source does not exist or its container is
+  // invalid, in which case nothing stays mapped.
+  TfLiteStatus Map(const char* source);
+
+  // Maps each of `sources` in turn and keeps the valid container with the
+  // highest model_version, so a newer model written to a spare slot is picked
+  // up at boot without reflashing the firmware. Fails if none is valid.
+  TfLiteStatus MapNewest(const char* const* sources, int source_count);
+
+  // Releases the mapping. model() must no longer be used afterwards.
+  void Unmap();
+
+  bool mapped() const { return payload_ != nullptr; }
+  // The model in the mapping, or nullptr if nothing is mapped or the
+  // container is compressed.
+  const Model* model() const;
+  // The model in the mapping, decoded into `allocator` if the container is
+  // compressed, see DecodeModelContainer().
+  const Model* Decode(MicroAllocator* allocator) const;
+  const MicroModelHeader* header() const { return header_; }
+  const uint8_t* payload() const { return payload_; }
+  // The source currently mapped, as passed to Map().
+  const char* source() const { return source_; }
+
+ private:
+  void Swap(MappedModel* other);
+
+  ErrorReporter* error_reporter_;
+  const char* source_ = nullptr;
+  const MicroModelHeader* header_ = nullptr;
+  const uint8_t* payload_ = nullptr;
+
+#if defined(ARDUINO_ARCH_ESP32)
+  spi_flash_mmap_handle_t handle_ = 0;
+#endif
+  const void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+
+  // Not copyable, the mapping is owned.
+  MappedModel(const MappedModel&) = delete;
+  MappedModel& operator=(const MappedModel&) = delete;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_MODEL_LOADER_H_
@@ -0,0 +1,126 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_model_slots.h"
+
+#include <new>
+
+#include "tensorflow/lite/micro/micro_allocator.h"
+
+namespace tflite {
+
+MicroModelSlots::MicroModelSlots(const MicroOpResolver& op_resolver,
+                                 uint8_t* arena_a, uint8_t* arena_b,
+                                 size_t arena_size,
+                                 ErrorReporter* error_reporter,
+                                 tflite::Profiler* profiler)
+    : op_resolver_(op_resolver),
+      arenas_{arena_a, arena_b},
+      arena_size_(arena_size),
+      error_reporter_(error_reporter),
+      profiler_(profiler),
+      active_index_(-1) {
+  states_[0].store(kEmpty);
+  states_[1].store(kEmpty);
+}
+
+MicroModelSlots::~MicroModelSlots() {
+  Release(0);
+  Release(1);
+}
+
+TfLiteStatus MicroModelSlots::Stage(const Model* model, SetupFn setup,
+                                    void* setup_data) {
+  // Claim the standby slot. This only fails if SwapIfReady() is making a
+  // previously staged model active at the same time, and never blocks the
+  // thread running it.
+  const int slot = active_index_.load(std::memory_order_acquire) == 0 ? 1 : 0;
+  int state = states_[slot].load(std::memory_order_acquire);
+  if (state == kActive || state == kStaging ||
+      !states_[slot].compare_exchange_strong(state, kStaging,
+                                             std::memory_order_acq_rel)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Model slot %d is being swapped in, stage again "
+                         "after SwapIfReady()",
+                         slot);
+    return kTfLiteError;
+  }
+  Release(slot);
+
+  MicroAllocator* allocator =
+      MicroAllocator::Create(arenas_[slot], arena_size_, error_reporter_);
+  void* buffer = allocator == nullptr ? nullptr
+                                      : allocator->AllocatePersistentBuffer(
+                                            sizeof(MicroInterpreter));
+  if (buffer == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to create an interpreter in model slot %d",
+                         slot);
+    states_[slot].store(kEmpty, std::memory_order_release);
+    return kTfLiteError;
+  }
+  interpreters_[slot] = new (buffer) MicroInterpreter(
+      model, op_resolver_, allocator, error_reporter_, profiler_);
+  models_[slot] = model;
+
+  if (interpreters_[slot]->initialization_status() != kTfLiteOk ||
+      (setup != nullptr &&
+       setup(interpreters_[slot], setup_data) != kTfLiteOk) ||
+      interpreters_[slot]->AllocateTensors() != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to stage a model in slot %d", slot);
+    Release(slot);
+    states_[slot].store(kEmpty, std::memory_order_release);
+    return kTfLiteError;
+  }
+
+  states_[slot].store(kReady, std::memory_order_release);
+  return kTfLiteOk;
+}
+
+bool MicroModelSlots::SwapIfReady() {
+  const int previous = active_index_.load(std::memory_order_acquire);
+  if (previous >= 0 && interpreters_[previous]->invoke_in_progress()) {
+    return false;
+  }
+  const int slot = previous == 0 ? 1 : 0;
+  int state = kReady;
+  if (!states_[slot].compare_exchange_strong(state, kActive,
+                                             std::memory_order_acq_rel)) {
+    return false;
+  }
+  active_index_.store(slot, std::memory_order_release);
+  ++generation_;
+
+  // Nothing runs the previous interpreter any more, free its slot for the
+  // next Stage().
+  if (previous >= 0) {
+    Release(previous);
+    states_[previous].store(kEmpty, std::memory_order_release);
+  }
+  return true;
+}
+
+void MicroModelSlots::Release(int slot) {
+  if (interpreters_[slot] != nullptr) {
+    // The interpreter and its allocator live in the arena, so running the
+    // destructor to free kernel data is all the cleanup needed.
+    interpreters_[slot]->~MicroInterpreter();
+    interpreters_[slot] = nullptr;
+  }
+  models_[slot] = nullptr;
+}
+
+}  // namespace tflite
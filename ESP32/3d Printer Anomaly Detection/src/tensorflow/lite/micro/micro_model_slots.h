@@ -0,0 +1,113 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_MODEL_SLOTS_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_MODEL_SLOTS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Double-buffered interpreter slots for replacing a model without pausing
+// inference. Each slot owns one of two arenas. A new model is staged into
+// the standby slot, where its interpreter is built and its tensors are
+// allocated, while the active interpreter keeps running. SwapIfReady() then
+// makes it active between two windows, and the previous interpreter is
+// destroyed so its arena becomes the next standby slot.
+//
+// Stage() may run on a different thread (e.g. a low priority FreeRTOS task)
+// than the one calling active() and SwapIfReady(). The two only coordinate
+// through an atomic state per slot, so neither ever blocks the other. Stage()
+// itself must not be called concurrently from several threads.
+class MicroModelSlots {
+ public:
+  // Called on a staged interpreter before AllocateTensors(), e.g. to bind
+  // inputs and outputs or select a target tensor.
+  typedef TfLiteStatus (*SetupFn)(MicroInterpreter* interpreter, void* data);
+
+  // The op resolver, arenas, error reporter and profiler must outlive the
+  // slots. Both arenas must hold the largest model that will be staged.
+  MicroModelSlots(const MicroOpResolver& op_resolver, uint8_t* arena_a,
+                  uint8_t* arena_b, size_t arena_size,
+                  ErrorReporter* error_reporter,
+                  tflite::Profiler* profiler = nullptr);
+  ~MicroModelSlots();
+
+  // Builds an interpreter for `model` in the standby slot, replacing any
+  // model that was staged but not swapped in yet. `model` must stay valid
+  // until it has been swapped out again. On failure the standby slot is left
+  // empty and the active interpreter is unaffected.
+  TfLiteStatus Stage(const Model* model, SetupFn setup = nullptr,
+                     void* setup_data = nullptr);
+
+  // Makes a completely staged interpreter active and destroys the previous
+  // one. Call it at a window boundary: it does nothing and returns false
+  // while no staged model is ready or the active interpreter is in the middle
+  // of an InvokeStep() run. Interpreter and tensor pointers obtained from the
+  // previous interpreter are invalid once this returns true.
+  bool SwapIfReady();
+
+  // The interpreter to run, or nullptr until the first swap.
+  MicroInterpreter* active() {
+    const int index = active_index_.load(std::memory_order_acquire);
+    return index < 0 ? nullptr : interpreters_[index];
+  }
+  // The model of the active interpreter, or nullptr until the first swap.
+  const Model* active_model() {
+    const int index = active_index_.load(std::memory_order_acquire);
+    return index < 0 ? nullptr : models_[index];
+  }
+
+  // Number of successful swaps so far.
+  uint32_t generation() const { return generation_; }
+
+ private:
+  enum SlotState {
+    kEmpty,
+    // Stage() is building an interpreter in the slot.
+    kStaging,
+    // A staged interpreter waits for SwapIfReady().
+    kReady,
+    kActive,
+  };
+
+  // Destroys the interpreter in `slot`, if any.
+  void Release(int slot);
+
+  const MicroOpResolver& op_resolver_;
+  uint8_t* arenas_[2];
+  size_t arena_size_;
+  ErrorReporter* error_reporter_;
+  tflite::Profiler* profiler_;
+
+  // Interpreters live at the tail of their slot's arena.
+  MicroInterpreter* interpreters_[2] = {};
+  const Model* models_[2] = {};
+  std::atomic<int> states_[2];
+  std::atomic<int> active_index_;
+  uint32_t generation_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_MODEL_SLOTS_H_
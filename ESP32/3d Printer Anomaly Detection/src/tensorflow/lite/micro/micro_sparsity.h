@@ -0,0 +1,33 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_SPARSITY_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_SPARSITY_H_
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Returns the sparsity parameters the model stores for tensor `tensor_index`
+// of the interpreter running `context`, or nullptr if the tensor is dense.
+// TfLiteTensor has no sparsity field under TF_LITE_STATIC_MEMORY, so kernels
+// read the parameters from the model instead. The result lives as long as
+// the model.
+const SparsityParameters* GetMicroTensorSparsity(TfLiteContext* context,
+                                                 int tensor_index);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_SPARSITY_H_
@@ -0,0 +1,130 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_streaming.h"
+
+#include <cstring>
+
+#include "tensorflow/lite/micro/memory_helpers.h"
+
+namespace tflite {
+
+namespace {
+
+// Splits a tensor into `batches` x `rows` rows of `row_bytes` each along
+// dimension 1. Returns false if it has no such dimension or is empty.
+bool GetRows(const TfLiteEvalTensor* tensor, int* batches, int* rows,
+             size_t* row_bytes) {
+  size_t bytes;
+  if (tensor->dims->size < 2 ||
+      TfLiteEvalTensorByteLength(tensor, &bytes) != kTfLiteOk) {
+    return false;
+  }
+  *batches = tensor->dims->data[0];
+  *rows = tensor->dims->data[1];
+  if (*batches <= 0 || *rows <= 0) {
+    return false;
+  }
+  *row_bytes = bytes / (static_cast<size_t>(*batches) * *rows);
+  return true;
+}
+
+}  // namespace
+
+void PrepareStreamingOutput(TfLiteContext* context, int input_tensor,
+                            int output_tensor, int stride, bool reads_padding,
+                            bool cache_output) {
+  MicroStreaming* streaming = GetMicroStreaming(context);
+  if (streaming == nullptr) {
+    return;
+  }
+  const int input_shift = streaming->tensors[input_tensor].shift;
+  StreamingTensor& output = streaming->tensors[output_tensor];
+  if (input_shift == kStreamingShiftUnknown || reads_padding || stride <= 0 ||
+      input_shift % stride != 0) {
+    output.shift = kStreamingShiftUnknown;
+    return;
+  }
+  output.shift = input_shift / stride;
+  output.cache_requested = cache_output;
+}
+
+int BeginStreamingOutput(TfLiteContext* context, int output_tensor,
+                         TfLiteEvalTensor* output) {
+  MicroStreaming* streaming = GetMicroStreaming(context);
+  if (streaming == nullptr) {
+    return 0;
+  }
+  const StreamingTensor& entry = streaming->tensors[output_tensor];
+  int batches, rows;
+  size_t row_bytes;
+  if (entry.cache == nullptr || entry.window == 0 ||
+      entry.window + 1 != streaming->window || entry.shift <= 0 ||
+      !GetRows(output, &batches, &rows, &row_bytes) || entry.shift >= rows) {
+    return 0;
+  }
+
+  // Row r of this window is row r + shift of the previous one.
+  const int kept = rows - entry.shift;
+  const int first = (entry.head + entry.shift) % rows;
+  const int contiguous = kept < rows - first ? kept : rows - first;
+  const size_t batch_bytes = rows * row_bytes;
+  uint8_t* output_data = static_cast<uint8_t*>(output->data.data);
+  for (int batch = 0; batch < batches; ++batch) {
+    const uint8_t* ring = entry.cache + batch * batch_bytes;
+    uint8_t* destination = output_data + batch * batch_bytes;
+    memcpy(destination, ring + first * row_bytes, contiguous * row_bytes);
+    memcpy(destination + contiguous * row_bytes, ring,
+           (kept - contiguous) * row_bytes);
+  }
+  return kept;
+}
+
+void EndStreamingOutput(TfLiteContext* context, int output_tensor,
+                        const TfLiteEvalTensor* output, int first_row) {
+  MicroStreaming* streaming = GetMicroStreaming(context);
+  if (streaming == nullptr) {
+    return;
+  }
+  StreamingTensor& entry = streaming->tensors[output_tensor];
+  int batches, rows;
+  size_t row_bytes;
+  if (entry.cache == nullptr ||
+      !GetRows(output, &batches, &rows, &row_bytes)) {
+    return;
+  }
+
+  const size_t batch_bytes = rows * row_bytes;
+  const uint8_t* output_data = static_cast<const uint8_t*>(output->data.data);
+  if (first_row == 0) {
+    memcpy(entry.cache, output_data, batches * batch_bytes);
+    entry.head = 0;
+  } else {
+    // The new rows replace the oldest ones, which the next window drops.
+    const int added = rows - first_row;
+    for (int batch = 0; batch < batches; ++batch) {
+      uint8_t* ring = entry.cache + batch * batch_bytes;
+      const uint8_t* source = output_data + batch * batch_bytes;
+      for (int i = 0; i < added; ++i) {
+        memcpy(ring + ((entry.head + i) % rows) * row_bytes,
+               source + (first_row + i) * row_bytes, row_bytes);
+      }
+    }
+    entry.head = (entry.head + added) % rows;
+  }
+  entry.window = streaming->window;
+}
+
+}  // namespace tflite
@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_STREAMING_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_STREAMING_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// Shift of a tensor that is not known to be a shifted copy of its value in
+// the previous window.
+constexpr int kStreamingShiftUnknown = -1;
+
+// Streaming state of one tensor of the model.
+struct StreamingTensor {
+  // Rows along dimension 1 the tensor moved by since the previous window, or
+  // kStreamingShiftUnknown.
+  int shift;
+  // Set by kernels that want the output of the previous window kept.
+  bool cache_requested;
+  // Ring buffer of the rows of the last computed window of every batch, or
+  // nullptr. Row r of a batch is stored at physical row (head + r) % rows.
+  uint8_t* cache;
+  size_t cache_capacity;
+  int head;
+  // Window the cache holds, 0 when it is empty.
+  uint32_t window;
+};
+
+// Sliding-window execution set up by MicroInterpreter::SetStreamingHop().
+struct MicroStreaming {
+  // Rows along dimension 1 every model input advances by between invokes.
+  int hop;
+  // Incremented at the start of every invoke, never 0.
+  uint32_t window;
+  // One entry per tensor of the model.
+  StreamingTensor* tensors;
+};
+
+// Returns the streaming state of the interpreter running `context`, or
+// nullptr if it is not streaming.
+MicroStreaming* GetMicroStreaming(TfLiteContext* context);
+
+// Returns true if any of `output_size` windows of `filter_size` taps along an
+// axis, starting `padding` before the input, reads outside the input.
+inline bool WindowReadsPadding(int input_size, int output_size,
+                               int filter_size, int stride, int dilation,
+                               int padding) {
+  return padding != 0 ||
+         (output_size - 1) * stride + (filter_size - 1) * dilation >=
+             input_size;
+}
+
+// Called from Prepare by operators that slide a window along dimension 1 of
+// `input_tensor` with `stride`, such as convolutions and pooling. Records the
+// shift of `output_tensor` between consecutive windows, which is known when
+// the shift of the input is, is a multiple of the stride and no output row
+// reads padding. With `cache_output` the interpreter also keeps the output of
+// the previous window for BeginStreamingOutput(). Does nothing when the
+// interpreter is not streaming.
+void PrepareStreamingOutput(TfLiteContext* context, int input_tensor,
+                            int output_tensor, int stride, bool reads_padding,
+                            bool cache_output);
+
+// Called from Eval before computing `output_tensor`. Copies the rows that are
+// unchanged from the previous window into `output` and returns the first row
+// along dimension 1 the kernel still has to compute, in every batch. Returns
+// 0 when nothing can be reused.
+int BeginStreamingOutput(TfLiteContext* context, int output_tensor,
+                         TfLiteEvalTensor* output);
+
+// Called from Eval once rows [first_row, rows) of every batch of `output` have
+// been computed. Stores them in the cache for the next window.
+void EndStreamingOutput(TfLiteContext* context, int output_tensor,
+                        const TfLiteEvalTensor* output, int first_row);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_STREAMING_H_
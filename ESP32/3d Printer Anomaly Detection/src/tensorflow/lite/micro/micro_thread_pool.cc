@@ -0,0 +1,182 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_thread_pool.h"
+
+namespace tflite {
+
+constexpr int MicroWorkerPool::kMaxThreads;
+constexpr int64_t MicroWorkerPool::kDefaultMinParallelWork;
+
+MicroThreadPool::MicroThreadPool(int64_t min_parallel_work)
+    : min_parallel_work_(min_parallel_work) {
+  external_context_.base.type = kTfLiteCpuBackendContext;
+  external_context_.base.Refresh = nullptr;
+  external_context_.pool = this;
+}
+
+MicroThreadPool* GetMicroThreadPool(TfLiteContext* context) {
+  if (context->GetExternalContext == nullptr) {
+    return nullptr;
+  }
+  TfLiteExternalContext* external_context =
+      context->GetExternalContext(context, kTfLiteCpuBackendContext);
+  if (external_context == nullptr) {
+    return nullptr;
+  }
+  return reinterpret_cast<MicroThreadPool::ExternalContext*>(external_context)
+      ->pool;
+}
+
+MicroWorkerPool::MicroWorkerPool(int num_threads, int64_t min_parallel_work)
+    : MicroThreadPool(min_parallel_work), next_task_(0) {
+  if (num_threads > kMaxThreads) {
+    num_threads = kMaxThreads;
+  }
+
+#if defined(TF_LITE_MICRO_FREERTOS_WORKERS)
+  start_ = xSemaphoreCreateCounting(kMaxThreads, 0);
+  done_ = xSemaphoreCreateCounting(kMaxThreads, 0);
+  if (start_ == nullptr || done_ == nullptr) {
+    return;
+  }
+  // Spread the workers over the cores, starting with the one the caller is
+  // not running on.
+  const BaseType_t first_core = xPortGetCoreID() + 1;
+  const UBaseType_t priority = uxTaskPriorityGet(nullptr);
+  for (int i = 0; i < num_threads - 1; ++i) {
+    if (xTaskCreatePinnedToCore(WorkerEntry, "tflm_worker", 4096, this,
+                                priority, &workers_[i],
+                                (first_core + i) % portNUM_PROCESSORS) !=
+        pdPASS) {
+      break;
+    }
+    ++num_threads_;
+  }
+#elif defined(TF_LITE_MICRO_STD_THREAD_WORKERS)
+  for (int i = 0; i < num_threads - 1; ++i) {
+    workers_[i] = std::thread(&MicroWorkerPool::WorkerLoop, this);
+    ++num_threads_;
+  }
+#endif
+}
+
+MicroWorkerPool::~MicroWorkerPool() {
+#if defined(TF_LITE_MICRO_FREERTOS_WORKERS)
+  for (int i = 0; i < num_threads_ - 1; ++i) {
+    vTaskDelete(workers_[i]);
+  }
+  if (start_ != nullptr) {
+    vSemaphoreDelete(start_);
+  }
+  if (done_ != nullptr) {
+    vSemaphoreDelete(done_);
+  }
+#elif defined(TF_LITE_MICRO_STD_THREAD_WORKERS)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  start_condition_.notify_all();
+  for (int i = 0; i < num_threads_ - 1; ++i) {
+    workers_[i].join();
+  }
+#endif
+}
+
+void MicroWorkerPool::RunTasks() {
+  for (int i = next_task_.fetch_add(1); i < task_count_;
+       i = next_task_.fetch_add(1)) {
+    task_(data_, i);
+  }
+}
+
+void MicroWorkerPool::Run(Task task, void* data, int task_count) {
+  task_ = task;
+  data_ = data;
+  task_count_ = task_count;
+  next_task_.store(0);
+
+  if (num_threads_ == 1 || task_count <= 1) {
+    RunTasks();
+    return;
+  }
+
+#if defined(TF_LITE_MICRO_FREERTOS_WORKERS)
+  // Only wake as many workers as there are tasks beyond the caller's own.
+  int helpers = num_threads_ - 1;
+  if (helpers > task_count - 1) {
+    helpers = task_count - 1;
+  }
+  for (int i = 0; i < helpers; ++i) {
+    xSemaphoreGive(start_);
+  }
+  RunTasks();
+  for (int i = 0; i < helpers; ++i) {
+    xSemaphoreTake(done_, portMAX_DELAY);
+  }
+#elif defined(TF_LITE_MICRO_STD_THREAD_WORKERS)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    busy_workers_ = num_threads_ - 1;
+    ++generation_;
+  }
+  start_condition_.notify_all();
+  RunTasks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_condition_.wait(lock, [this] { return busy_workers_ == 0; });
+#else
+  RunTasks();
+#endif
+}
+
+#if defined(TF_LITE_MICRO_FREERTOS_WORKERS)
+
+void MicroWorkerPool::WorkerEntry(void* arg) {
+  MicroWorkerPool* pool = static_cast<MicroWorkerPool*>(arg);
+  for (;;) {
+    xSemaphoreTake(pool->start_, portMAX_DELAY);
+    pool->RunTasks();
+    xSemaphoreGive(pool->done_);
+  }
+}
+
+#elif defined(TF_LITE_MICRO_STD_THREAD_WORKERS)
+
+void MicroWorkerPool::WorkerLoop() {
+  uint32_t seen_generation = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_condition_.wait(lock, [this, seen_generation] {
+        return stopping_ || generation_ != seen_generation;
+      });
+      if (stopping_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+    RunTasks();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --busy_workers_;
+    }
+    done_condition_.notify_one();
+  }
+}
+
+#endif
+
+}  // namespace tflite
@@ -0,0 +1,137 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_THREAD_POOL_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_THREAD_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+
+// Selects the MicroWorkerPool backend. Define TF_LITE_MICRO_NO_THREADS to
+// always run kernels on the calling thread.
+#if defined(TF_LITE_MICRO_NO_THREADS)
+// No workers.
+#elif defined(ARDUINO_ARCH_ESP32)
+#define TF_LITE_MICRO_FREERTOS_WORKERS
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#elif defined(__linux__) || defined(__APPLE__)
+#define TF_LITE_MICRO_STD_THREAD_WORKERS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace tflite {
+
+// A pool of worker threads used by large kernels (FULLY_CONNECTED, CONV_2D
+// and DEPTHWISE_CONV_2D) to split their output across cores. A pool is
+// registered with MicroInterpreter::SetThreadPool() and reaches kernels as the
+// kTfLiteCpuBackendContext external context, see GetMicroThreadPool().
+class MicroThreadPool {
+ public:
+  typedef void (*Task)(void* data, int task_index);
+
+  // Operators doing fewer multiply-accumulates than `min_parallel_work` stay
+  // on the calling thread, since waking the workers would cost more than it
+  // saves.
+  explicit MicroThreadPool(int64_t min_parallel_work);
+  virtual ~MicroThreadPool() {}
+
+  // Returns the number of threads tasks are spread across, including the
+  // thread calling Run().
+  virtual int num_threads() const = 0;
+
+  // Calls task(data, i) for every i in [0, task_count) and returns once all
+  // calls have completed. The calling thread runs tasks as well.
+  virtual void Run(Task task, void* data, int task_count) = 0;
+
+  int64_t min_parallel_work() const { return min_parallel_work_; }
+
+  TfLiteExternalContext* external_context() {
+    return &external_context_.base;
+  }
+
+ private:
+  struct ExternalContext {
+    TfLiteExternalContext base;
+    MicroThreadPool* pool;
+  };
+
+  ExternalContext external_context_;
+  int64_t min_parallel_work_;
+
+  friend MicroThreadPool* GetMicroThreadPool(TfLiteContext* context);
+};
+
+// Returns the pool registered with the interpreter running `context`, or
+// nullptr if kernels should run single-threaded.
+MicroThreadPool* GetMicroThreadPool(TfLiteContext* context);
+
+// Default MicroThreadPool backend. Workers are FreeRTOS tasks on ESP32 and
+// std::threads on Linux and macOS hosts. Idle workers block and use no CPU.
+// Tasks are claimed from a shared counter, so a worker that finishes early
+// takes over the remaining tasks. On other platforms no workers are started
+// and every task runs on the calling thread.
+//
+// Run() must not be called concurrently from several threads; give each
+// interpreter that runs in parallel its own pool.
+class MicroWorkerPool : public MicroThreadPool {
+ public:
+  static constexpr int kMaxThreads = 8;
+  static constexpr int64_t kDefaultMinParallelWork = 32768;
+
+  explicit MicroWorkerPool(int num_threads,
+                           int64_t min_parallel_work = kDefaultMinParallelWork);
+  ~MicroWorkerPool() override;
+
+  int num_threads() const override { return num_threads_; }
+  void Run(Task task, void* data, int task_count) override;
+
+ private:
+  // Claims and runs tasks of the current job until none are left.
+  void RunTasks();
+
+  int num_threads_ = 1;
+  Task task_ = nullptr;
+  void* data_ = nullptr;
+  int task_count_ = 0;
+  std::atomic<int> next_task_;
+
+#if defined(TF_LITE_MICRO_FREERTOS_WORKERS)
+  static void WorkerEntry(void* arg);
+
+  TaskHandle_t workers_[kMaxThreads - 1];
+  // Given once per worker by Run(), and by each worker when it is done.
+  SemaphoreHandle_t start_ = nullptr;
+  SemaphoreHandle_t done_ = nullptr;
+#elif defined(TF_LITE_MICRO_STD_THREAD_WORKERS)
+  void WorkerLoop();
+
+  std::thread workers_[kMaxThreads - 1];
+  std::mutex mutex_;
+  std::condition_variable start_condition_;
+  std::condition_variable done_condition_;
+  uint32_t generation_ = 0;
+  int busy_workers_ = 0;
+  bool stopping_ = false;
+#endif
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_THREAD_POOL_H_
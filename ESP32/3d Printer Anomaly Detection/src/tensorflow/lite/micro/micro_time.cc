@@ -29,11 +29,23 @@ limitations under the License.
 
 #if defined(TF_LITE_USE_CTIME)
 #include <ctime>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include "esp_timer.h"
 #endif
 
 namespace tflite {
 
-#if !defined(TF_LITE_USE_CTIME)
+#if defined(ARDUINO_ARCH_ESP32) && !defined(TF_LITE_USE_CTIME)
+
+// The ESP32 high resolution timer counts microseconds since boot. Truncating it
+// to 32 bits wraps about every 71 minutes, callers compare tick differences.
+int32_t ticks_per_second() { return 1000000; }
+
+int32_t GetCurrentTimeTicks() {
+  return static_cast<int32_t>(esp_timer_get_time());
+}
+
+#elif !defined(TF_LITE_USE_CTIME)
 
 // Reference implementation of the ticks_per_second() function that's required
 // for a platform to support Tensorflow Lite for Microcontrollers profiling.
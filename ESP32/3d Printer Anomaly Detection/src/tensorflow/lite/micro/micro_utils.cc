@@ -20,7 +20,9 @@ limitations under the License.
 #include <limits>
 
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/op_macros.h"
+#include "tensorflow/lite/micro/kernels/conversion_util.h"
 
 namespace tflite {
 
@@ -32,6 +34,17 @@ int ElementCount(const TfLiteIntArray& dims) {
   return result;
 }
 
+void QuantizeSamples(const int16_t* samples, int num_elements,
+                     float sample_scale, float scale, int zero_point,
+                     int8_t* output) {
+  int32_t multiplier;
+  int shift;
+  QuantizeMultiplier(static_cast<double>(sample_scale) / scale, &multiplier,
+                     &shift);
+  micro::RequantizeToType(samples, num_elements, multiplier, shift, 0,
+                          zero_point, output);
+}
+
 void SignedSymmetricPerChannelQuantize(const float* values,
                                        TfLiteIntArray* dims,
                                        int quantized_dimension,
@@ -19,8 +19,10 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <limits>
 
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/conversion_util.h"
 
 namespace tflite {
 
@@ -62,20 +64,23 @@ T FloatToSymmetricQuantizedType(const float value, const float scale) {
 //
 // The per-op quantization spec can be found here:
 // https://www.tensorflow.org/lite/performance/quantization_spec
+//
+// The array helpers round like the scalar ones above and saturate values out
+// of range, but convert several values at a time on hosts with a vector unit.
 template <typename T>
 void Quantize(const float* input, T* output, int num_elements, float scale,
               int zero_point) {
-  for (int i = 0; i < num_elements; i++) {
-    output[i] = FloatToQuantizedType<T>(input[i], scale, zero_point);
-  }
+  micro::QuantizeFloat(input, num_elements, scale, zero_point,
+                       std::numeric_limits<T>::min(),
+                       std::numeric_limits<T>::max(), output);
 }
 
 template <typename T>
 void SymmetricQuantize(const float* input, T* output, int num_elements,
                        float scale) {
-  for (int i = 0; i < num_elements; i++) {
-    output[i] = FloatToSymmetricQuantizedType<T>(input[i], scale);
-  }
+  micro::QuantizeFloat(input, num_elements, scale, 0,
+                       std::numeric_limits<T>::min() + 1,
+                       std::numeric_limits<T>::max(), output);
 }
 
 template <typename T>
@@ -84,13 +89,20 @@ void SymmetricPerChannelQuantize(const float* input, T* output,
                                  float* scales) {
   int elements_per_channel = num_elements / num_channels;
   for (int i = 0; i < num_channels; i++) {
-    for (int j = 0; j < elements_per_channel; j++) {
-      output[i * elements_per_channel + j] = FloatToSymmetricQuantizedType<T>(
-          input[i * elements_per_channel + j], scales[i]);
-    }
+    SymmetricQuantize(input + i * elements_per_channel,
+                      output + i * elements_per_channel, elements_per_channel,
+                      scales[i]);
   }
 }
 
+// Quantizes a window of raw integer samples, such as accelerometer counts of
+// `sample_scale` real units each, into the int8 input of a model with `scale`
+// and `zero_point`. Uses fixed-point arithmetic only, like the QUANTIZE
+// kernel does for int16 inputs.
+void QuantizeSamples(const int16_t* samples, int num_elements,
+                     float sample_scale, float scale, int zero_point,
+                     int8_t* output);
+
 void SignedSymmetricPerChannelQuantize(const float* values,
                                        TfLiteIntArray* dims,
                                        int quantized_dimension,
@@ -0,0 +1,38 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_weight_packing.h"
+
+namespace tflite {
+
+void* AllocatePackedWeights(TfLiteContext* context, size_t bytes) {
+  if (context->AllocatePersistentBuffer == nullptr) {
+    return nullptr;
+  }
+  MicroWeightPacking* packing = GetMicroWeightPacking(context);
+  if (packing == nullptr) {
+    return nullptr;
+  }
+  if (bytes > packing->max_bytes - packing->used_bytes) {
+    return nullptr;
+  }
+  void* buffer = context->AllocatePersistentBuffer(context, bytes);
+  if (buffer != nullptr) {
+    packing->used_bytes += bytes;
+  }
+  return buffer;
+}
+
+}  // namespace tflite
@@ -0,0 +1,76 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_WEIGHT_PACKING_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_WEIGHT_PACKING_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// Number of output channels interleaved in a panel of packed weights.
+constexpr int kWeightPanelWidth = 4;
+
+// Arena budget for weights that FULLY_CONNECTED and CONV_2D repack at Prepare
+// time, see MicroInterpreter::SetWeightPacking().
+struct MicroWeightPacking {
+  // Total bytes all kernels together may use for packed weights.
+  size_t max_bytes;
+  // Bytes handed out since the interpreter last started preparing nodes.
+  size_t used_bytes;
+};
+
+// Returns the weight packing budget of the interpreter running `context`, or
+// nullptr if packing is not enabled on it.
+MicroWeightPacking* GetMicroWeightPacking(TfLiteContext* context);
+
+// Returns a persistent buffer of `bytes` for packed weights, or nullptr if
+// packing is not enabled on the interpreter running `context` or the buffer
+// would exceed its budget. Kernels then keep reading the weights from the
+// model. Must be called from Prepare.
+void* AllocatePackedWeights(TfLiteContext* context, size_t bytes);
+
+// Number of elements needed to pack an `output_depth` x `accum_depth` weight
+// matrix with PackWeightPanels().
+inline size_t PackedWeightsSize(int output_depth, int accum_depth) {
+  const int panels = (output_depth + kWeightPanelWidth - 1) / kWeightPanelWidth;
+  return static_cast<size_t>(panels) * kWeightPanelWidth * accum_depth;
+}
+
+// Repacks a row-major `output_depth` x `accum_depth` weight matrix into panels
+// of kWeightPanelWidth output channels. Within a panel the weights of all its
+// channels for the same depth are next to each other, so an inner loop
+// reading the input once updates kWeightPanelWidth accumulators from a single
+// sequential stream. The last panel is padded with zeros.
+template <typename T>
+void PackWeightPanels(const T* weights, int output_depth, int accum_depth,
+                      T* packed) {
+  for (int panel = 0; panel < output_depth; panel += kWeightPanelWidth) {
+    for (int d = 0; d < accum_depth; ++d) {
+      for (int lane = 0; lane < kWeightPanelWidth; ++lane) {
+        const int channel = panel + lane;
+        *packed++ = channel < output_depth
+                        ? weights[channel * accum_depth + d]
+                        : static_cast<T>(0);
+      }
+    }
+  }
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_WEIGHT_PACKING_H_
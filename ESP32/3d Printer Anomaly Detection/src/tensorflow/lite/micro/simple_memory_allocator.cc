@@ -88,9 +88,9 @@ TfLiteStatus SimpleMemoryAllocator::SetHeadBufferSize(size_t size,
 uint8_t* SimpleMemoryAllocator::AllocateFromTail(size_t size,
                                                  size_t alignment) {
   uint8_t* const aligned_result = AlignPointerDown(tail_ - size, alignment);
-  if (aligned_result < head_) {
+  if (aligned_result < temp_) {
 #ifndef TF_LITE_STRIP_ERROR_STRINGS
-    const size_t missing_memory = head_ - aligned_result;
+    const size_t missing_memory = temp_ - aligned_result;
     TF_LITE_REPORT_ERROR(error_reporter_,
                          "Failed to allocate tail memory. Requested: %u, "
                          "available %u, missing: %u",
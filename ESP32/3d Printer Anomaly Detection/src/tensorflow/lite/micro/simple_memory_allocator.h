@@ -52,7 +52,7 @@ class SimpleMemoryAllocator {
   virtual TfLiteStatus SetHeadBufferSize(size_t size, size_t alignment);
 
   // Allocates memory starting at the tail of the arena (highest address and
-  // moving downwards).
+  // moving downwards). Fails rather than overlap a pending temp allocation.
   virtual uint8_t* AllocateFromTail(size_t size, size_t alignment);
 
   // Allocates a temporary buffer from the head of the arena (lowest address and
@@ -402,11 +402,12 @@ enum TensorType {
   TensorType_FLOAT64 = 10,
   TensorType_COMPLEX128 = 11,
   TensorType_UINT64 = 12,
+  TensorType_INT4 = 17,
   TensorType_MIN = TensorType_FLOAT32,
-  TensorType_MAX = TensorType_UINT64
+  TensorType_MAX = TensorType_INT4
 };
 
-inline const TensorType (&EnumValuesTensorType())[13] {
+inline const TensorType (&EnumValuesTensorType())[14] {
   static const TensorType values[] = {
     TensorType_FLOAT32,
     TensorType_FLOAT16,
@@ -420,13 +421,14 @@ inline const TensorType (&EnumValuesTensorType())[13] {
     TensorType_INT8,
     TensorType_FLOAT64,
     TensorType_COMPLEX128,
-    TensorType_UINT64
+    TensorType_UINT64,
+    TensorType_INT4
   };
   return values;
 }
 
 inline const char * const *EnumNamesTensorType() {
-  static const char * const names[14] = {
+  static const char * const names[19] = {
     "FLOAT32",
     "FLOAT16",
     "INT32",
@@ -440,13 +442,18 @@ inline const char * const *EnumNamesTensorType() {
     "FLOAT64",
     "COMPLEX128",
     "UINT64",
+    "",
+    "",
+    "",
+    "",
+    "INT4",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameTensorType(TensorType e) {
-  if (flatbuffers::IsOutRange(e, TensorType_FLOAT32, TensorType_UINT64)) return "";
+  if (flatbuffers::IsOutRange(e, TensorType_FLOAT32, TensorType_INT4)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesTensorType()[index];
 }
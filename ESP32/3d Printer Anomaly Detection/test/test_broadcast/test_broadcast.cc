@@ -0,0 +1,361 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks the broadcasts of ADD, SUB and MUL against the Slow reference
+// kernels. Every shape class of tflite::micro::BroadcastFivefold() is
+// covered with either input broadcasting, along with shapes that keep the
+// reference kernels.
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/add.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/add.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/mul.h"
+#include "tensorflow/lite/kernels/internal/reference/mul.h"
+#include "tensorflow/lite/kernels/internal/reference/sub.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/broadcast_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+
+using tflite::micro::FloatBinaryOp;
+
+constexpr int kMaxElements = 256;
+constexpr float kInput1Scale = 0.02f;
+constexpr int kInput1ZeroPoint = 3;
+constexpr float kInput2Scale = 0.035f;
+constexpr int kInput2ZeroPoint = -7;
+constexpr float kAddOutputScale = 0.04f;
+constexpr float kMulOutputScale = 0.01f;
+constexpr int kOutputZeroPoint = 2;
+
+// Dims in the IntArrayFromInts() layout, and whether the kernels take the
+// BroadcastFivefold() path for them.
+struct BroadcastCase {
+  int input1_dims[5];
+  int input2_dims[5];
+  int output_dims[5];
+  bool fivefold;
+};
+
+// A scalar on either side.
+constexpr BroadcastCase kScalarInput2 = {
+    {4, 1, 4, 5, 6}, {1, 1}, {4, 1, 4, 5, 6}, true};
+constexpr BroadcastCase kScalarInput1 = {
+    {1, 1}, {3, 2, 3, 5}, {3, 2, 3, 5}, true};
+// Innermost row, such as a bias over channels.
+constexpr BroadcastCase kRowInput2 = {
+    {4, 1, 4, 5, 6}, {1, 6}, {4, 1, 4, 5, 6}, true};
+constexpr BroadcastCase kRowInput1 = {
+    {1, 6}, {4, 1, 4, 5, 6}, {4, 1, 4, 5, 6}, true};
+// Innermost row repeated for every batch.
+constexpr BroadcastCase kBatchRow = {
+    {4, 2, 5, 1, 6}, {4, 2, 1, 1, 6}, {4, 2, 5, 1, 6}, true};
+// Outer row, such as a per-pixel scale over channels.
+constexpr BroadcastCase kOuterRowInput2 = {
+    {4, 1, 4, 5, 6}, {4, 1, 4, 5, 1}, {4, 1, 4, 5, 6}, true};
+constexpr BroadcastCase kOuterRowInput1 = {
+    {4, 1, 4, 5, 1}, {4, 1, 4, 5, 6}, {4, 1, 4, 5, 6}, true};
+// Both inputs broadcast, over different dims around a common row.
+constexpr BroadcastCase kCrossedRows = {
+    {3, 3, 1, 5}, {3, 1, 4, 5}, {3, 3, 4, 5}, true};
+constexpr BroadcastCase kOuterProduct = {{2, 5, 1}, {2, 1, 7}, {2, 5, 7},
+                                         true};
+// The same, repeated for every batch so that all five dims are used.
+constexpr BroadcastCase kBatchCrossedRows = {
+    {4, 2, 3, 1, 4}, {4, 2, 1, 5, 4}, {4, 2, 3, 5, 4}, true};
+constexpr BroadcastCase kBatchCrossedOuterRows = {
+    {4, 2, 1, 5, 6}, {4, 2, 3, 1, 1}, {4, 2, 3, 5, 6}, true};
+// Broadcasts alternating between the inputs, which only the reference
+// kernels handle.
+constexpr BroadcastCase kAlternating = {
+    {4, 1, 2, 1, 3}, {4, 2, 1, 3, 1}, {4, 2, 2, 3, 3}, false};
+
+TfLiteRegistration GetRegistration(FloatBinaryOp op) {
+  switch (op) {
+    case FloatBinaryOp::kAdd:
+      return tflite::ops::micro::Register_ADD();
+    case FloatBinaryOp::kSub:
+      return tflite::ops::micro::Register_SUB();
+    default:
+      return tflite::ops::micro::Register_MUL();
+  }
+}
+
+tflite::RuntimeShape GetShape(const int* dims) {
+  return tflite::RuntimeShape(dims[0], &dims[1]);
+}
+
+// Runs `op` on `tensors` with the builtin data of the operator.
+void RunBinaryOp(FloatBinaryOp op, TfLiteFusedActivation activation,
+                 TfLiteTensor* tensors) {
+  TfLiteAddParams add_params = {};
+  add_params.activation = activation;
+  TfLiteSubParams sub_params = {};
+  sub_params.activation = activation;
+  TfLiteMulParams mul_params = {};
+  mul_params.activation = activation;
+  void* params = op == FloatBinaryOp::kAdd   ? static_cast<void*>(&add_params)
+                 : op == FloatBinaryOp::kSub ? static_cast<void*>(&sub_params)
+                                             : static_cast<void*>(&mul_params);
+  TF_LITE_MICRO_EXPECT_EQ(
+      tflite::micro::RunKernel(GetRegistration(op), tensors, 3, 2, params,
+                               micro_test::reporter),
+      kTfLiteOk);
+}
+
+// Expects the shapes of `tensors` to take the path `broadcast` is meant for.
+void ExpectFivefold(const BroadcastCase& broadcast,
+                    const TfLiteTensor* tensors) {
+  tflite::micro::ElementwiseBroadcast elementwise;
+  tflite::micro::PrepareElementwiseBroadcast(&tensors[0], &tensors[1],
+                                             &elementwise);
+  TF_LITE_MICRO_EXPECT_EQ(broadcast.fivefold,
+                          tflite::micro::IsFivefoldBroadcast(elementwise));
+}
+
+// Runs `op` on float inputs of the shapes of `broadcast`, and expects exactly
+// the output of the Slow reference kernel.
+void TestBroadcastFloat(FloatBinaryOp op, const BroadcastCase& broadcast,
+                        TfLiteFusedActivation activation) {
+  TfLiteIntArray* input1_dims =
+      tflite::testing::IntArrayFromInts(broadcast.input1_dims);
+  TfLiteIntArray* input2_dims =
+      tflite::testing::IntArrayFromInts(broadcast.input2_dims);
+  TfLiteIntArray* output_dims =
+      tflite::testing::IntArrayFromInts(broadcast.output_dims);
+  const int input1_count = tflite::ElementCount(*input1_dims);
+  const int input2_count = tflite::ElementCount(*input2_dims);
+  const int output_count = tflite::ElementCount(*output_dims);
+  TF_LITE_MICRO_EXPECT(output_count <= kMaxElements);
+
+  float input1[kMaxElements];
+  float input2[kMaxElements];
+  for (int i = 0; i < input1_count; ++i) {
+    input1[i] = 0.37f * ((i * 7 + 3) % 11) - 1.5f;
+  }
+  for (int i = 0; i < input2_count; ++i) {
+    input2[i] = 0.29f * ((i * 5 + 1) % 13) - 1.7f;
+  }
+
+  float output[kMaxElements];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateTensor(input1, input1_dims),
+      tflite::testing::CreateTensor(input2, input2_dims),
+      tflite::testing::CreateTensor(output, output_dims),
+  };
+  ExpectFivefold(broadcast, tensors);
+  RunBinaryOp(op, activation, tensors);
+
+  float activation_min;
+  float activation_max;
+  tflite::CalculateActivationRange(activation, &activation_min,
+                                   &activation_max);
+  tflite::ArithmeticParams params = {};
+  tflite::SetActivationParams(activation_min, activation_max, &params);
+  float expected[kMaxElements];
+  const tflite::RuntimeShape input1_shape = GetShape(broadcast.input1_dims);
+  const tflite::RuntimeShape input2_shape = GetShape(broadcast.input2_dims);
+  const tflite::RuntimeShape output_shape = GetShape(broadcast.output_dims);
+  if (op == FloatBinaryOp::kAdd) {
+    tflite::reference_ops::BroadcastAdd4DSlow(params, input1_shape, input1,
+                                              input2_shape, input2,
+                                              output_shape, expected);
+  } else if (op == FloatBinaryOp::kSub) {
+    tflite::reference_ops::BroadcastSubSlow(params, input1_shape, input1,
+                                            input2_shape, input2,
+                                            output_shape, expected);
+  } else {
+    tflite::reference_ops::BroadcastMul4DSlow(params, input1_shape, input1,
+                                              input2_shape, input2,
+                                              output_shape, expected);
+  }
+
+  for (int i = 0; i < output_count; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(expected[i], output[i], 0.0f);
+  }
+}
+
+// The quantized parameters of `op`, as the Prepare() of its kernel computes
+// them. ADD divides the scales in double and SUB in float.
+tflite::ArithmeticParams GetInt8Params(FloatBinaryOp op,
+                                       TfLiteFusedActivation activation) {
+  tflite::ArithmeticParams params = {};
+  params.input1_offset = -kInput1ZeroPoint;
+  params.input2_offset = -kInput2ZeroPoint;
+  params.output_offset = kOutputZeroPoint;
+  // CalculateActivationRangeQuantized() clamps RELU at the zero point.
+  tflite::SetActivationParams(
+      activation == kTfLiteActRelu ? kOutputZeroPoint
+                                   : std::numeric_limits<int8_t>::min(),
+      static_cast<int32_t>(std::numeric_limits<int8_t>::max()), &params);
+  if (op == FloatBinaryOp::kMul) {
+    tflite::QuantizeMultiplier(static_cast<double>(kInput1Scale) *
+                                   static_cast<double>(kInput2Scale) /
+                                   static_cast<double>(kMulOutputScale),
+                               &params.output_multiplier,
+                               &params.output_shift);
+    return params;
+  }
+
+  params.left_shift = 20;
+  double input1_multiplier;
+  double input2_multiplier;
+  double output_multiplier;
+  if (op == FloatBinaryOp::kAdd) {
+    const double twice_max_input_scale =
+        2 * static_cast<double>(std::max(kInput1Scale, kInput2Scale));
+    input1_multiplier = static_cast<double>(kInput1Scale) /
+                        twice_max_input_scale;
+    input2_multiplier = static_cast<double>(kInput2Scale) /
+                        twice_max_input_scale;
+    output_multiplier =
+        twice_max_input_scale /
+        ((1 << params.left_shift) * static_cast<double>(kAddOutputScale));
+  } else {
+    const float twice_max_input_scale =
+        2 * std::max(kInput1Scale, kInput2Scale);
+    input1_multiplier =
+        static_cast<double>(kInput1Scale / twice_max_input_scale);
+    input2_multiplier =
+        static_cast<double>(kInput2Scale / twice_max_input_scale);
+    output_multiplier = static_cast<double>(
+        twice_max_input_scale / ((1 << params.left_shift) * kAddOutputScale));
+  }
+  tflite::QuantizeMultiplierSmallerThanOneExp(
+      input1_multiplier, &params.input1_multiplier, &params.input1_shift);
+  tflite::QuantizeMultiplierSmallerThanOneExp(
+      input2_multiplier, &params.input2_multiplier, &params.input2_shift);
+  tflite::QuantizeMultiplierSmallerThanOneExp(
+      output_multiplier, &params.output_multiplier, &params.output_shift);
+  return params;
+}
+
+// Runs `op` on int8 inputs of the shapes of `broadcast`, and expects the
+// output of the Slow reference kernel.
+void TestBroadcastInt8(FloatBinaryOp op, const BroadcastCase& broadcast,
+                       TfLiteFusedActivation activation) {
+  TfLiteIntArray* input1_dims =
+      tflite::testing::IntArrayFromInts(broadcast.input1_dims);
+  TfLiteIntArray* input2_dims =
+      tflite::testing::IntArrayFromInts(broadcast.input2_dims);
+  TfLiteIntArray* output_dims =
+      tflite::testing::IntArrayFromInts(broadcast.output_dims);
+  const int input1_count = tflite::ElementCount(*input1_dims);
+  const int input2_count = tflite::ElementCount(*input2_dims);
+  const int output_count = tflite::ElementCount(*output_dims);
+  TF_LITE_MICRO_EXPECT(output_count <= kMaxElements);
+
+  int8_t input1[kMaxElements];
+  int8_t input2[kMaxElements];
+  for (int i = 0; i < input1_count; ++i) {
+    input1[i] = static_cast<int8_t>((i * 37 + 11) % 256 - 128);
+  }
+  for (int i = 0; i < input2_count; ++i) {
+    input2[i] = static_cast<int8_t>((i * 53 + 5) % 256 - 128);
+  }
+
+  const float output_scale =
+      op == FloatBinaryOp::kMul ? kMulOutputScale : kAddOutputScale;
+  int8_t output[kMaxElements];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(input1, input1_dims, kInput1Scale,
+                                             kInput1ZeroPoint),
+      tflite::testing::CreateQuantizedTensor(input2, input2_dims, kInput2Scale,
+                                             kInput2ZeroPoint),
+      tflite::testing::CreateQuantizedTensor(output, output_dims, output_scale,
+                                             kOutputZeroPoint),
+  };
+  ExpectFivefold(broadcast, tensors);
+  RunBinaryOp(op, activation, tensors);
+
+  const tflite::ArithmeticParams params = GetInt8Params(op, activation);
+  int8_t expected[kMaxElements];
+  const tflite::RuntimeShape input1_shape = GetShape(broadcast.input1_dims);
+  const tflite::RuntimeShape input2_shape = GetShape(broadcast.input2_dims);
+  const tflite::RuntimeShape output_shape = GetShape(broadcast.output_dims);
+  if (op == FloatBinaryOp::kAdd) {
+    tflite::reference_integer_ops::BroadcastAdd4DSlow(
+        params, input1_shape, input1, input2_shape, input2, output_shape,
+        expected);
+  } else if (op == FloatBinaryOp::kSub) {
+    tflite::reference_ops::BroadcastSubSlow(params, input1_shape, input1,
+                                            input2_shape, input2,
+                                            output_shape, expected);
+  } else {
+    tflite::reference_integer_ops::BroadcastMul4DSlow(
+        params, input1_shape, input1, input2_shape, input2, output_shape,
+        expected);
+  }
+
+  for (int i = 0; i < output_count; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected[i], output[i]);
+  }
+}
+
+// Runs every case through `test` for `op`, with and without an activation.
+template <typename TestFunction>
+void TestAllCases(TestFunction test, FloatBinaryOp op) {
+  const BroadcastCase* cases[] = {
+      &kScalarInput2,     &kScalarInput1,          &kRowInput2,
+      &kRowInput1,        &kBatchRow,              &kOuterRowInput2,
+      &kOuterRowInput1,   &kCrossedRows,           &kOuterProduct,
+      &kBatchCrossedRows, &kBatchCrossedOuterRows, &kAlternating,
+  };
+  for (const BroadcastCase* broadcast : cases) {
+    test(op, *broadcast, kTfLiteActNone);
+    test(op, *broadcast, kTfLiteActRelu);
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestAddBroadcastFloatMatchesReference) {
+  TestAllCases(TestBroadcastFloat, FloatBinaryOp::kAdd);
+}
+
+TF_LITE_MICRO_TEST(TestSubBroadcastFloatMatchesReference) {
+  TestAllCases(TestBroadcastFloat, FloatBinaryOp::kSub);
+}
+
+TF_LITE_MICRO_TEST(TestMulBroadcastFloatMatchesReference) {
+  TestAllCases(TestBroadcastFloat, FloatBinaryOp::kMul);
+}
+
+TF_LITE_MICRO_TEST(TestAddBroadcastInt8MatchesReference) {
+  TestAllCases(TestBroadcastInt8, FloatBinaryOp::kAdd);
+}
+
+TF_LITE_MICRO_TEST(TestSubBroadcastInt8MatchesReference) {
+  TestAllCases(TestBroadcastInt8, FloatBinaryOp::kSub);
+}
+
+TF_LITE_MICRO_TEST(TestMulBroadcastInt8MatchesReference) {
+  TestAllCases(TestBroadcastInt8, FloatBinaryOp::kMul);
+}
+
+TF_LITE_MICRO_TESTS_END
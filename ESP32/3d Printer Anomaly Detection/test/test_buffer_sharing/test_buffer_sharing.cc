@@ -0,0 +1,360 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks the buffers the memory planner shares between tensors: elementwise
+// and reshaping ops run in place, and concatenations and splits along the
+// outermost dimension become views. The same graph with an offline plan that
+// leaves every offset to the online planner gets no shared buffers, and must
+// compute the same outputs in at least as much arena.
+
+#include <cstdint>
+#include <cstring>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr int kRows = 4;
+constexpr int kColumns = 8;
+// Bytes of a [kRows, kColumns] float tensor, a multiple of the 16 byte
+// alignment views need.
+constexpr int kBlockBytes = kRows * kColumns * sizeof(float);
+constexpr size_t kArenaSize = 8 * 1024;
+constexpr int kMaxTensors = 16;
+
+alignas(16) uint8_t shared_arena[kArenaSize];
+alignas(16) uint8_t separate_arena[kArenaSize];
+
+// Builds the tensors, buffers and operators of a model one at a time.
+class GraphBuilder {
+ public:
+  explicit GraphBuilder(flatbuffers::FlatBufferBuilder* builder)
+      : builder_(builder) {
+    buffers_[buffer_count_++] = tflite::CreateBuffer(*builder_);
+  }
+
+  int AddActivation(const int32_t* shape, int rank) {
+    return AddTensor(shape, rank, tflite::TensorType_FLOAT32, 0);
+  }
+
+  int AddInt32Constant(const int32_t* shape, int rank, const int32_t* values,
+                       int count) {
+    buffers_[buffer_count_] = tflite::CreateBuffer(
+        *builder_,
+        builder_->CreateVector(reinterpret_cast<const uint8_t*>(values),
+                               count * sizeof(int32_t)));
+    return AddTensor(shape, rank, tflite::TensorType_INT32, buffer_count_++);
+  }
+
+  void AddOperator(
+      tflite::BuiltinOperator code, const int32_t* inputs, int inputs_size,
+      const int32_t* outputs, int outputs_size,
+      tflite::BuiltinOptions options_type = tflite::BuiltinOptions_NONE,
+      flatbuffers::Offset<void> options = 0) {
+    int opcode_index = 0;
+    while (opcode_index < opcode_count_ &&
+           builtins_[opcode_index] != code) {
+      ++opcode_index;
+    }
+    if (opcode_index == opcode_count_) {
+      builtins_[opcode_count_++] = code;
+    }
+    operators_[operator_count_++] = tflite::CreateOperator(
+        *builder_, opcode_index, builder_->CreateVector(inputs, inputs_size),
+        builder_->CreateVector(outputs, outputs_size), options_type, options);
+  }
+
+  // Finishes the model. `separate_buffers` adds an offline memory plan that
+  // leaves every tensor to the online planner, which plans it without
+  // sharing.
+  const tflite::Model* Build(const int32_t* inputs, int inputs_size,
+                             const int32_t* outputs, int outputs_size,
+                             bool separate_buffers) {
+    flatbuffers::Offset<tflite::OperatorCode> opcodes[kMaxTensors];
+    for (int i = 0; i < opcode_count_; ++i) {
+      opcodes[i] = tflite::CreateOperatorCode(
+          *builder_, static_cast<int8_t>(builtins_[i]), 0, 1, builtins_[i]);
+    }
+    flatbuffers::Offset<
+        flatbuffers::Vector<flatbuffers::Offset<tflite::Metadata>>>
+        metadata = 0;
+    if (separate_buffers) {
+      // Version, subgraph, tensor count and then -1 for every tensor.
+      int32_t plan[3 + kMaxTensors] = {0, 0, tensor_count_};
+      for (int i = 0; i < tensor_count_; ++i) {
+        plan[3 + i] = -1;
+      }
+      const int plan_bytes = (3 + tensor_count_) * sizeof(int32_t);
+      builder_->ForceVectorAlignment(plan_bytes, sizeof(uint8_t),
+                                     sizeof(int32_t));
+      buffers_[buffer_count_] = tflite::CreateBuffer(
+          *builder_, builder_->CreateVector(
+                         reinterpret_cast<const uint8_t*>(plan), plan_bytes));
+      const flatbuffers::Offset<tflite::Metadata> entries[] = {
+          tflite::CreateMetadata(
+              *builder_, builder_->CreateString("OfflineMemoryAllocation"),
+              buffer_count_++)};
+      metadata = builder_->CreateVector(entries, 1);
+    }
+    const flatbuffers::Offset<tflite::SubGraph> subgraphs[] = {
+        tflite::CreateSubGraph(
+            *builder_, builder_->CreateVector(tensors_, tensor_count_),
+            builder_->CreateVector(inputs, inputs_size),
+            builder_->CreateVector(outputs, outputs_size),
+            builder_->CreateVector(operators_, operator_count_))};
+    builder_->Finish(tflite::CreateModel(
+        *builder_, TFLITE_SCHEMA_VERSION,
+        builder_->CreateVector(opcodes, opcode_count_),
+        builder_->CreateVector(subgraphs, 1), builder_->CreateString("share"),
+        builder_->CreateVector(buffers_, buffer_count_), 0, metadata));
+    return tflite::GetModel(builder_->GetBufferPointer());
+  }
+
+ private:
+  int AddTensor(const int32_t* shape, int rank, tflite::TensorType type,
+                uint32_t buffer) {
+    tensors_[tensor_count_] = tflite::CreateTensor(
+        *builder_, builder_->CreateVector(shape, rank), type, buffer);
+    return tensor_count_++;
+  }
+
+  flatbuffers::FlatBufferBuilder* builder_;
+  flatbuffers::Offset<tflite::Buffer> buffers_[4];
+  flatbuffers::Offset<tflite::Tensor> tensors_[kMaxTensors];
+  flatbuffers::Offset<tflite::Operator> operators_[kMaxTensors];
+  tflite::BuiltinOperator builtins_[kMaxTensors];
+  int buffer_count_ = 0;
+  int tensor_count_ = 0;
+  int operator_count_ = 0;
+  int opcode_count_ = 0;
+};
+
+// Tensors of the graph BuildGraph() builds.
+enum GraphTensor {
+  kInput,
+  kAbs,
+  kNeg,
+  kConcat,
+  kSplitAxis,
+  kSplitFirst,
+  kSplitSecond,
+  kTanh,
+  kReshape,
+  kReshapeShape,
+  kLogistic,
+  kRelu,
+};
+
+// Builds
+//   input -> ABS, NEG -> CONCATENATION along rows -> SPLIT along rows
+//   first half -> TANH -> RESHAPE -> LOGISTIC (output)
+//   second half (output) -> RELU (output)
+// where every sharing the planner supports is possible except around the
+// input and the second half, which are subgraph input and output.
+const tflite::Model* BuildGraph(flatbuffers::FlatBufferBuilder* builder,
+                                bool separate_buffers) {
+  GraphBuilder graph(builder);
+  const int32_t block_shape[] = {kRows, kColumns};
+  const int32_t concat_shape[] = {2 * kRows, kColumns};
+  const int32_t flat_shape[] = {kRows * kColumns};
+  const int32_t split_axis[] = {0};
+  const int32_t one[] = {1};
+  graph.AddActivation(block_shape, 2);
+  graph.AddActivation(block_shape, 2);
+  graph.AddActivation(block_shape, 2);
+  graph.AddActivation(concat_shape, 2);
+  graph.AddInt32Constant(one, 0, split_axis, 1);
+  graph.AddActivation(block_shape, 2);
+  graph.AddActivation(block_shape, 2);
+  graph.AddActivation(block_shape, 2);
+  graph.AddActivation(flat_shape, 1);
+  graph.AddInt32Constant(one, 1, flat_shape, 1);
+  graph.AddActivation(flat_shape, 1);
+  graph.AddActivation(block_shape, 2);
+
+  const int32_t input[] = {kInput};
+  const int32_t abs[] = {kAbs};
+  const int32_t neg[] = {kNeg};
+  const int32_t concat_inputs[] = {kAbs, kNeg};
+  const int32_t concat[] = {kConcat};
+  const int32_t split_inputs[] = {kSplitAxis, kConcat};
+  const int32_t split[] = {kSplitFirst, kSplitSecond};
+  const int32_t first[] = {kSplitFirst};
+  const int32_t second[] = {kSplitSecond};
+  const int32_t tanh[] = {kTanh};
+  const int32_t reshape_inputs[] = {kTanh, kReshapeShape};
+  const int32_t reshape[] = {kReshape};
+  const int32_t logistic[] = {kLogistic};
+  const int32_t relu[] = {kRelu};
+  graph.AddOperator(tflite::BuiltinOperator_ABS, input, 1, abs, 1);
+  graph.AddOperator(tflite::BuiltinOperator_NEG, input, 1, neg, 1);
+  graph.AddOperator(tflite::BuiltinOperator_CONCATENATION, concat_inputs, 2,
+                    concat, 1, tflite::BuiltinOptions_ConcatenationOptions,
+                    tflite::CreateConcatenationOptions(*builder, 0).Union());
+  graph.AddOperator(tflite::BuiltinOperator_SPLIT, split_inputs, 2, split, 2,
+                    tflite::BuiltinOptions_SplitOptions,
+                    tflite::CreateSplitOptions(*builder, 2).Union());
+  graph.AddOperator(tflite::BuiltinOperator_TANH, first, 1, tanh, 1);
+  graph.AddOperator(
+      tflite::BuiltinOperator_RESHAPE, reshape_inputs, 2, reshape, 1,
+      tflite::BuiltinOptions_ReshapeOptions,
+      tflite::CreateReshapeOptions(*builder,
+                                   builder->CreateVector(flat_shape, 1))
+          .Union());
+  graph.AddOperator(tflite::BuiltinOperator_LOGISTIC, reshape, 1, logistic,
+                    1);
+  graph.AddOperator(tflite::BuiltinOperator_RELU, second, 1, relu, 1);
+
+  const int32_t outputs[] = {kLogistic, kSplitSecond, kRelu};
+  return graph.Build(input, 1, outputs, 3, separate_buffers);
+}
+
+uint8_t* Data(tflite::MicroInterpreter* interpreter, int tensor) {
+  return static_cast<uint8_t*>(interpreter->eval_tensor(tensor)->data.data);
+}
+
+// Whether the float tensors `a` and `b` share any bytes.
+bool Overlaps(tflite::MicroInterpreter* interpreter, int a, int b) {
+  const uint8_t* data_a = Data(interpreter, a);
+  const uint8_t* data_b = Data(interpreter, b);
+  const int bytes_a =
+      tflite::ElementCount(*interpreter->eval_tensor(a)->dims) * sizeof(float);
+  const int bytes_b =
+      tflite::ElementCount(*interpreter->eval_tensor(b)->dims) * sizeof(float);
+  return data_a < data_b + bytes_b && data_b < data_a + bytes_a;
+}
+
+// Builds input -> TANH -> output, where the input is last read by the last
+// operator.
+const tflite::Model* BuildTanh(flatbuffers::FlatBufferBuilder* builder) {
+  GraphBuilder graph(builder);
+  const int32_t block_shape[] = {kRows, kColumns};
+  const int32_t input[] = {graph.AddActivation(block_shape, 2)};
+  const int32_t output[] = {graph.AddActivation(block_shape, 2)};
+  graph.AddOperator(tflite::BuiltinOperator_TANH, input, 1, output, 1);
+  return graph.Build(input, 1, output, 1, false);
+}
+
+void FillInput(tflite::MicroInterpreter* interpreter) {
+  float* input = interpreter->typed_input<float>(0).data();
+  for (int i = 0; i < kRows * kColumns; ++i) {
+    input[i] = 0.37f * ((i * 7 + 3) % 11) - 1.5f;
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestSharedBuffersMatchSeparateBuffers) {
+  flatbuffers::FlatBufferBuilder shared_builder;
+  flatbuffers::FlatBufferBuilder separate_builder;
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter shared(BuildGraph(&shared_builder, false),
+                                  op_resolver, shared_arena, kArenaSize,
+                                  micro_test::reporter);
+  tflite::MicroInterpreter separate(BuildGraph(&separate_builder, true),
+                                    op_resolver, separate_arena, kArenaSize,
+                                    micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(shared.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(separate.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(shared.arena_used_bytes() <
+                       separate.arena_used_bytes());
+
+  // Twice, so that a clobbered input would show up in the second outputs.
+  for (int round = 0; round < 2; ++round) {
+    FillInput(&shared);
+    FillInput(&separate);
+    TF_LITE_MICRO_EXPECT_EQ(shared.Invoke(), kTfLiteOk);
+    TF_LITE_MICRO_EXPECT_EQ(separate.Invoke(), kTfLiteOk);
+    for (size_t i = 0; i < shared.outputs_size(); ++i) {
+      TF_LITE_MICRO_EXPECT_EQ(
+          0, memcmp(shared.output(i)->data.raw, separate.output(i)->data.raw,
+                    kBlockBytes));
+    }
+  }
+}
+
+TF_LITE_MICRO_TEST(TestElementwiseOpsRunInPlace) {
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(BuildGraph(&builder, false),
+                                       op_resolver, shared_arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(Data(&interpreter, kTanh) ==
+                       Data(&interpreter, kSplitFirst));
+  TF_LITE_MICRO_EXPECT(Data(&interpreter, kReshape) ==
+                       Data(&interpreter, kTanh));
+  TF_LITE_MICRO_EXPECT(Data(&interpreter, kLogistic) ==
+                       Data(&interpreter, kReshape));
+
+  // The offline plan leaves no room for sharing.
+  flatbuffers::FlatBufferBuilder separate_builder;
+  tflite::MicroInterpreter separate(BuildGraph(&separate_builder, true),
+                                    op_resolver, separate_arena, kArenaSize,
+                                    micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(separate.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(!Overlaps(&separate, kTanh, kSplitFirst));
+  TF_LITE_MICRO_EXPECT(!Overlaps(&separate, kReshape, kTanh));
+}
+
+TF_LITE_MICRO_TEST(TestOuterConcatAndSplitAreViews) {
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(BuildGraph(&builder, false),
+                                       op_resolver, shared_arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  uint8_t* concat = Data(&interpreter, kConcat);
+  TF_LITE_MICRO_EXPECT(Data(&interpreter, kAbs) == concat);
+  TF_LITE_MICRO_EXPECT(Data(&interpreter, kNeg) == concat + kBlockBytes);
+  TF_LITE_MICRO_EXPECT(Data(&interpreter, kSplitFirst) == concat);
+  TF_LITE_MICRO_EXPECT(Data(&interpreter, kSplitSecond) ==
+                       concat + kBlockBytes);
+}
+
+TF_LITE_MICRO_TEST(TestSubgraphInputsAndOutputsAreNotSharedOver) {
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(BuildGraph(&builder, false),
+                                       op_resolver, shared_arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // ABS and NEG are the last readers of the input, and RELU of the second
+  // half. No tensor planned after them may take their memory either.
+  const int activations[] = {kAbs,  kNeg,     kConcat,  kSplitFirst,
+                             kTanh, kReshape, kLogistic, kRelu};
+  for (int tensor : activations) {
+    TF_LITE_MICRO_EXPECT(!Overlaps(&interpreter, kInput, tensor));
+  }
+  TF_LITE_MICRO_EXPECT(!Overlaps(&interpreter, kRelu, kSplitSecond));
+  TF_LITE_MICRO_EXPECT(!Overlaps(&interpreter, kRelu, kLogistic));
+
+  // Nor may the output of the last operator run in place over the input.
+  flatbuffers::FlatBufferBuilder tanh_builder;
+  tflite::MicroInterpreter tanh(BuildTanh(&tanh_builder), op_resolver,
+                                separate_arena, kArenaSize,
+                                micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(tanh.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(!Overlaps(&tanh, 0, 1));
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,144 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that copies made with MicroInterpreter::Clone() compute the same
+// outputs as the interpreter they were cloned from, also while they all run
+// concurrently on different threads.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 16 * 1024;
+constexpr int kThreads = 4;
+constexpr int kSeeds = 4;
+constexpr int kIterations = 50;
+constexpr size_t kMaxOutputBytes = 64;
+
+alignas(16) uint8_t template_arena[kArenaSize];
+alignas(16) uint8_t clone_arenas[kThreads][kArenaSize];
+
+void FillInput(tflite::MicroInterpreter* interpreter, int seed) {
+  TfLiteTensor* input = interpreter->input(0);
+  const int count = static_cast<int>(input->bytes / sizeof(float));
+  for (int i = 0; i < count; ++i) {
+    input->data.f[i] = 0.125f * ((i * 5 + seed * 3) % 17) - 1.0f;
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestClonesRunConcurrently) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, template_arena,
+                                       kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  const size_t output_bytes = interpreter.output(0)->bytes;
+  TF_LITE_MICRO_EXPECT(output_bytes <= kMaxOutputBytes);
+  uint8_t expected[kSeeds][kMaxOutputBytes];
+  for (int seed = 0; seed < kSeeds; ++seed) {
+    FillInput(&interpreter, seed);
+    TF_LITE_MICRO_EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+    memcpy(expected[seed], interpreter.output(0)->data.raw, output_bytes);
+  }
+
+  tflite::MicroInterpreter* clones[kThreads];
+  bool cloned = true;
+  for (int t = 0; t < kThreads; ++t) {
+    clones[t] = interpreter.Clone(clone_arenas[t], kArenaSize);
+    cloned = cloned && clones[t] != nullptr;
+  }
+  TF_LITE_MICRO_EXPECT(cloned);
+  // Each copy plans its own activations, and fetches its input and output
+  // tensors here so that the workers below do not allocate.
+  for (int t = 0; cloned && t < kThreads; ++t) {
+    TF_LITE_MICRO_EXPECT(clones[t]->input(0)->data.raw !=
+                         interpreter.input(0)->data.raw);
+    TF_LITE_MICRO_EXPECT_NE(nullptr, clones[t]->output(0));
+  }
+
+  // Every worker cycles through the inputs starting at a different one, and
+  // the template interpreter runs on the main thread at the same time.
+  std::atomic<int> mismatches(0);
+  std::atomic<int> failures(0);
+  auto run = [&](tflite::MicroInterpreter* worker, int first_seed) {
+    for (int i = 0; i < kIterations; ++i) {
+      const int seed = (first_seed + i) % kSeeds;
+      FillInput(worker, seed);
+      if (worker->Invoke() != kTfLiteOk) {
+        ++failures;
+      } else if (memcmp(expected[seed], worker->output(0)->data.raw,
+                        output_bytes) != 0) {
+        ++mismatches;
+      }
+    }
+  };
+  std::thread threads[kThreads];
+  for (int t = 0; cloned && t < kThreads; ++t) {
+    threads[t] = std::thread(run, clones[t], t);
+  }
+  run(&interpreter, 0);
+  for (int t = 0; cloned && t < kThreads; ++t) {
+    threads[t].join();
+  }
+  TF_LITE_MICRO_EXPECT_EQ(0, failures.load());
+  TF_LITE_MICRO_EXPECT_EQ(0, mismatches.load());
+}
+
+TF_LITE_MICRO_TEST(TestCloneRequiresAllocatedTensors) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, template_arena,
+                                       kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT(interpreter.Clone(clone_arenas[0], kArenaSize) ==
+                       nullptr);
+}
+
+TF_LITE_MICRO_TEST(TestClonedInterpreterCanNotBeResized) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, template_arena,
+                                       kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.EnableResizing(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  tflite::MicroInterpreter* clone =
+      interpreter.Clone(clone_arenas[0], kArenaSize);
+  TF_LITE_MICRO_EXPECT_NE(nullptr, clone);
+
+  // The copy shares the tensor dims of the interpreter it was cloned from, so
+  // neither of them can change them any more.
+  int dims_data[] = {4, 2, 16, 16, 1};
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(dims_data);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.ResizeInputTensor(0, dims),
+                          kTfLiteError);
+  TF_LITE_MICRO_EXPECT_EQ(clone->ResizeInputTensor(0, dims), kTfLiteError);
+  TF_LITE_MICRO_EXPECT_EQ(clone->Invoke(), kTfLiteOk);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,530 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks the 1-D paths of CONV_2D against the reference kernels, which the
+// kernel used for every layer before them, and that packing the weights of a
+// layer leaves its outputs unchanged. Packing runs through MicroInterpreter,
+// whose context is the only one that hands kernels a weight packing budget.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/conv.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/kernels/simd_util.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr int kMaxElements = 512;
+constexpr int kMaxChannels = 32;
+constexpr float kInputScale = 0.05f;
+constexpr float kOutputScale = 0.15f;
+constexpr int kOutputZeroPoint = 2;
+constexpr size_t kArenaSize = 32 * 1024;
+
+alignas(16) uint8_t arena[kArenaSize];
+
+struct ConvCase {
+  int batches;
+  int input_height;
+  int input_width;
+  int input_channels;
+  int filter_height;
+  int filter_width;
+  int output_channels;
+  TfLitePadding padding;
+  int stride;
+  int dilation;
+};
+
+// Tensor dims in the IntArrayFromInts() layout, and the padding, as CONV_2D
+// computes them for a ConvCase.
+struct ConvGeometry {
+  int input_dims[5];
+  int filter_dims[5];
+  int bias_dims[2];
+  int output_dims[5];
+  TfLitePaddingValues padding;
+};
+
+ConvGeometry GetGeometry(const ConvCase& conv) {
+  int output_height;
+  int output_width;
+  const TfLitePaddingValues padding = tflite::ComputePaddingHeightWidth(
+      conv.stride, conv.stride, conv.dilation, conv.dilation,
+      conv.input_height, conv.input_width, conv.filter_height,
+      conv.filter_width, conv.padding, &output_height, &output_width);
+  ConvGeometry geometry = {
+      {4, conv.batches, conv.input_height, conv.input_width,
+       conv.input_channels},
+      {4, conv.output_channels, conv.filter_height, conv.filter_width,
+       conv.input_channels},
+      {1, conv.output_channels},
+      {4, conv.batches, output_height, output_width, conv.output_channels},
+      padding};
+  return geometry;
+}
+
+TfLiteConvParams GetConvParams(const ConvCase& conv) {
+  TfLiteConvParams params = {conv.padding,   conv.stride,  conv.stride,
+                             kTfLiteActNone, conv.dilation, conv.dilation};
+  return params;
+}
+
+tflite::ConvParams GetReferenceParams(const ConvCase& conv,
+                                      const ConvGeometry& geometry) {
+  tflite::ConvParams params = {};
+  params.padding_values.height = geometry.padding.height;
+  params.padding_values.width = geometry.padding.width;
+  params.stride_height = conv.stride;
+  params.stride_width = conv.stride;
+  params.dilation_height_factor = conv.dilation;
+  params.dilation_width_factor = conv.dilation;
+  return params;
+}
+
+// Runs an int8 layer with per-channel filter scales through CONV_2D and
+// expects the same output as reference_integer_ops::ConvPerChannel().
+void TestConvInt8(const ConvCase& conv, int input_zero_point) {
+  ConvGeometry geometry = GetGeometry(conv);
+  TfLiteIntArray* input_dims =
+      tflite::testing::IntArrayFromInts(geometry.input_dims);
+  TfLiteIntArray* filter_dims =
+      tflite::testing::IntArrayFromInts(geometry.filter_dims);
+  TfLiteIntArray* bias_dims =
+      tflite::testing::IntArrayFromInts(geometry.bias_dims);
+  TfLiteIntArray* output_dims =
+      tflite::testing::IntArrayFromInts(geometry.output_dims);
+  const int input_count = tflite::ElementCount(*input_dims);
+  const int filter_count = tflite::ElementCount(*filter_dims);
+  const int output_count = tflite::ElementCount(*output_dims);
+  TF_LITE_MICRO_EXPECT(input_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(filter_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(output_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(conv.output_channels <= kMaxChannels);
+
+  int8_t input[kMaxElements];
+  int8_t filter[kMaxElements];
+  int32_t bias[kMaxChannels];
+  for (int i = 0; i < input_count; ++i) {
+    input[i] = static_cast<int8_t>((i * 37 + 11) % 256 - 128);
+  }
+  for (int i = 0; i < filter_count; ++i) {
+    filter[i] = static_cast<int8_t>((i * 73 + 5) % 255 - 127);
+  }
+  // Per-channel scales and zero points, with the element count first.
+  float filter_scales[kMaxChannels + 1] = {
+      static_cast<float>(conv.output_channels)};
+  float bias_scales[kMaxChannels + 1] = {
+      static_cast<float>(conv.output_channels)};
+  int zero_points[kMaxChannels + 1] = {conv.output_channels};
+  int32_t multipliers[kMaxChannels];
+  int shifts[kMaxChannels];
+  for (int c = 0; c < conv.output_channels; ++c) {
+    bias[c] = (c * 977) % 4001 - 2000;
+    filter_scales[c + 1] = 0.004f + 0.001f * (c % 5);
+    bias_scales[c + 1] = kInputScale * filter_scales[c + 1];
+    zero_points[c + 1] = 0;
+    // As PopulateConvolutionQuantizationParams() computes them.
+    tflite::QuantizeMultiplier(static_cast<double>(kInputScale) *
+                                   filter_scales[c + 1] / kOutputScale,
+                               &multipliers[c], &shifts[c]);
+  }
+
+  float input_scales[] = {1, kInputScale};
+  int input_zero_points[] = {1, input_zero_point};
+  float output_scales[] = {1, kOutputScale};
+  int output_zero_points[] = {1, kOutputZeroPoint};
+  TfLiteAffineQuantization input_quant = {
+      tflite::testing::FloatArrayFromFloats(input_scales),
+      tflite::testing::IntArrayFromInts(input_zero_points), 0};
+  TfLiteAffineQuantization filter_quant = {
+      tflite::testing::FloatArrayFromFloats(filter_scales),
+      tflite::testing::IntArrayFromInts(zero_points), 0};
+  TfLiteAffineQuantization bias_quant = {
+      tflite::testing::FloatArrayFromFloats(bias_scales),
+      tflite::testing::IntArrayFromInts(zero_points), 0};
+  TfLiteAffineQuantization output_quant = {
+      tflite::testing::FloatArrayFromFloats(output_scales),
+      tflite::testing::IntArrayFromInts(output_zero_points), 0};
+
+  int8_t output[kMaxElements];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(input, input_dims, kInputScale,
+                                             input_zero_point),
+      tflite::testing::CreateTensor(filter, filter_dims),
+      tflite::testing::CreateTensor(bias, bias_dims),
+      tflite::testing::CreateQuantizedTensor(output, output_dims, kOutputScale,
+                                             kOutputZeroPoint),
+  };
+  tensors[0].quantization = {kTfLiteAffineQuantization, &input_quant};
+  tensors[1].quantization = {kTfLiteAffineQuantization, &filter_quant};
+  tensors[2].quantization = {kTfLiteAffineQuantization, &bias_quant};
+  tensors[3].quantization = {kTfLiteAffineQuantization, &output_quant};
+
+  TfLiteConvParams params = GetConvParams(conv);
+  TF_LITE_MICRO_EXPECT_EQ(
+      tflite::micro::RunKernel(tflite::Register_CONV_2D(), tensors, 4, 3,
+                               &params, micro_test::reporter),
+      kTfLiteOk);
+
+  tflite::ConvParams reference_params = GetReferenceParams(conv, geometry);
+  reference_params.input_offset = -input_zero_point;
+  reference_params.output_offset = kOutputZeroPoint;
+  reference_params.quantized_activation_min =
+      std::numeric_limits<int8_t>::min();
+  reference_params.quantized_activation_max =
+      std::numeric_limits<int8_t>::max();
+  int8_t expected[kMaxElements];
+  tflite::reference_integer_ops::ConvPerChannel(
+      reference_params, multipliers, shifts,
+      tflite::RuntimeShape(4, &geometry.input_dims[1]), input,
+      tflite::RuntimeShape(4, &geometry.filter_dims[1]), filter,
+      tflite::RuntimeShape(1, &geometry.bias_dims[1]), bias,
+      tflite::RuntimeShape(4, &geometry.output_dims[1]), expected);
+
+  for (int i = 0; i < output_count; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected[i], output[i]);
+  }
+}
+
+// Runs a float layer through CONV_2D and expects the output of
+// reference_ops::Conv(), up to the rounding of a different summation order.
+void TestConvFloat(const ConvCase& conv) {
+  ConvGeometry geometry = GetGeometry(conv);
+  TfLiteIntArray* input_dims =
+      tflite::testing::IntArrayFromInts(geometry.input_dims);
+  TfLiteIntArray* filter_dims =
+      tflite::testing::IntArrayFromInts(geometry.filter_dims);
+  TfLiteIntArray* bias_dims =
+      tflite::testing::IntArrayFromInts(geometry.bias_dims);
+  TfLiteIntArray* output_dims =
+      tflite::testing::IntArrayFromInts(geometry.output_dims);
+  const int input_count = tflite::ElementCount(*input_dims);
+  const int filter_count = tflite::ElementCount(*filter_dims);
+  const int output_count = tflite::ElementCount(*output_dims);
+  TF_LITE_MICRO_EXPECT(input_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(filter_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(output_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(conv.output_channels <= kMaxChannels);
+
+  float input[kMaxElements];
+  float filter[kMaxElements];
+  float bias[kMaxChannels];
+  for (int i = 0; i < input_count; ++i) {
+    input[i] = 0.37f * ((i * 7 + 3) % 11) - 1.5f;
+  }
+  for (int i = 0; i < filter_count; ++i) {
+    filter[i] = 0.013f * ((i * 37 + 6) % 101) - 0.6f;
+  }
+  for (int c = 0; c < conv.output_channels; ++c) {
+    bias[c] = 0.013f * ((c * 37 + 7) % 101) - 0.6f;
+  }
+
+  float output[kMaxElements];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateTensor(input, input_dims),
+      tflite::testing::CreateTensor(filter, filter_dims),
+      tflite::testing::CreateTensor(bias, bias_dims),
+      tflite::testing::CreateTensor(output, output_dims),
+  };
+  TfLiteConvParams params = GetConvParams(conv);
+  TF_LITE_MICRO_EXPECT_EQ(
+      tflite::micro::RunKernel(tflite::Register_CONV_2D(), tensors, 4, 3,
+                               &params, micro_test::reporter),
+      kTfLiteOk);
+
+  tflite::ConvParams reference_params = GetReferenceParams(conv, geometry);
+  reference_params.float_activation_min = std::numeric_limits<float>::lowest();
+  reference_params.float_activation_max = std::numeric_limits<float>::max();
+  float expected[kMaxElements];
+  tflite::reference_ops::Conv(
+      reference_params, tflite::RuntimeShape(4, &geometry.input_dims[1]),
+      input, tflite::RuntimeShape(4, &geometry.filter_dims[1]), filter,
+      tflite::RuntimeShape(1, &geometry.bias_dims[1]), bias,
+      tflite::RuntimeShape(4, &geometry.output_dims[1]), expected,
+      tflite::RuntimeShape(), nullptr);
+
+  for (int i = 0; i < output_count; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(expected[i], output[i],
+                              1e-5f * (1.0f + std::fabs(expected[i])));
+  }
+}
+
+// 1-D along the height, with both borders padded.
+constexpr ConvCase kHeightSame = {1, 24, 1, 4, 5, 1, 6, kTfLitePaddingSame,
+                                  1, 1};
+// 1-D along the height, strided, with two batches and one input channel.
+constexpr ConvCase kHeightStrided = {2, 20, 1, 1, 7, 1, 8, kTfLitePaddingSame,
+                                     2, 1};
+// 1-D along the width, without padding.
+constexpr ConvCase kWidthValid = {1, 1, 30, 3, 1, 4, 5, kTfLitePaddingValid,
+                                  3, 1};
+// Enough channels for a full vector per filter tap.
+constexpr ConvCase kWideChannels = {1, 16, 1, 8, 3, 1, 16, kTfLitePaddingSame,
+                                    1, 1};
+// Dilated layers are not 1-D convolutions and keep the reference path.
+constexpr ConvCase kHeightDilated = {1, 24, 1, 2, 3, 1, 4, kTfLitePaddingSame,
+                                     1, 2};
+
+// Fills the filter and bias of a layer of `type`, float or int8, with the
+// values the tests above use, and per-channel scales for an int8 filter.
+void FillWeights(const ConvCase& conv, const ConvGeometry& geometry,
+                 tflite::TensorType type, uint8_t* filter, uint8_t* bias,
+                 float* filter_scales) {
+  const int filter_count = tflite::ElementCount(
+      *tflite::testing::IntArrayFromInts(geometry.filter_dims));
+  for (int i = 0; i < filter_count; ++i) {
+    if (type == tflite::TensorType_INT8) {
+      reinterpret_cast<int8_t*>(filter)[i] =
+          static_cast<int8_t>((i * 73 + 5) % 255 - 127);
+    } else {
+      reinterpret_cast<float*>(filter)[i] =
+          0.013f * ((i * 37 + 6) % 101) - 0.6f;
+    }
+  }
+  for (int c = 0; c < conv.output_channels; ++c) {
+    if (type == tflite::TensorType_INT8) {
+      reinterpret_cast<int32_t*>(bias)[c] = (c * 977) % 4001 - 2000;
+      filter_scales[c] = 0.004f + 0.001f * (c % 5);
+    } else {
+      reinterpret_cast<float*>(bias)[c] = 0.013f * ((c * 37 + 7) % 101) - 0.6f;
+    }
+  }
+}
+
+flatbuffers::Offset<tflite::QuantizationParameters> BuildQuantization(
+    flatbuffers::FlatBufferBuilder* builder, int count, const float* scales,
+    const int64_t* zero_points) {
+  return tflite::CreateQuantizationParameters(
+      *builder, 0, 0, builder->CreateVector(scales, count),
+      builder->CreateVector(zero_points, count));
+}
+
+// Builds a model of a single CONV_2D layer of `type`, float or int8, with the
+// filter and bias of FillWeights() as constant tensors. Int8 layers use the
+// input and output quantization of TestConvInt8().
+const tflite::Model* BuildConvModel(flatbuffers::FlatBufferBuilder* builder,
+                                    const ConvCase& conv,
+                                    tflite::TensorType type,
+                                    int input_zero_point) {
+  using flatbuffers::Offset;
+  const ConvGeometry geometry = GetGeometry(conv);
+  const bool quantized = type == tflite::TensorType_INT8;
+  const int filter_count = tflite::ElementCount(
+      *tflite::testing::IntArrayFromInts(geometry.filter_dims));
+  uint8_t filter[kMaxElements * sizeof(float)];
+  uint8_t bias[kMaxChannels * sizeof(float)];
+  float filter_scales[kMaxChannels];
+  FillWeights(conv, geometry, type, filter, bias, filter_scales);
+
+  const Offset<tflite::Buffer> buffers[] = {
+      tflite::CreateBuffer(*builder),
+      tflite::CreateBuffer(
+          *builder,
+          builder->CreateVector(filter, filter_count * (quantized ? 1 : 4))),
+      tflite::CreateBuffer(*builder,
+                           builder->CreateVector(bias, conv.output_channels *
+                                                           sizeof(float)))};
+
+  Offset<tflite::QuantizationParameters> quantization[4] = {0, 0, 0, 0};
+  if (quantized) {
+    const int64_t zero_points[kMaxChannels] = {};
+    float bias_scales[kMaxChannels];
+    for (int c = 0; c < conv.output_channels; ++c) {
+      bias_scales[c] = kInputScale * filter_scales[c];
+    }
+    const int64_t input_zero_points[] = {input_zero_point};
+    const int64_t output_zero_points[] = {kOutputZeroPoint};
+    quantization[0] =
+        BuildQuantization(builder, 1, &kInputScale, input_zero_points);
+    quantization[1] = BuildQuantization(builder, conv.output_channels,
+                                        filter_scales, zero_points);
+    quantization[2] = BuildQuantization(builder, conv.output_channels,
+                                        bias_scales, zero_points);
+    quantization[3] =
+        BuildQuantization(builder, 1, &kOutputScale, output_zero_points);
+  }
+  const tflite::TensorType bias_type =
+      quantized ? tflite::TensorType_INT32 : tflite::TensorType_FLOAT32;
+  const Offset<tflite::Tensor> tensors[] = {
+      tflite::CreateTensor(
+          *builder, builder->CreateVector(&geometry.input_dims[1], 4), type, 0,
+          0, quantization[0]),
+      tflite::CreateTensor(
+          *builder, builder->CreateVector(&geometry.filter_dims[1], 4), type,
+          1, 0, quantization[1]),
+      tflite::CreateTensor(*builder,
+                           builder->CreateVector(&geometry.bias_dims[1], 1),
+                           bias_type, 2, 0, quantization[2]),
+      tflite::CreateTensor(
+          *builder, builder->CreateVector(&geometry.output_dims[1], 4), type,
+          0, 0, quantization[3])};
+
+  const int32_t operator_inputs[] = {0, 1, 2};
+  const int32_t operator_outputs[] = {3};
+  const Offset<tflite::Operator> operators[] = {tflite::CreateOperator(
+      *builder, 0, builder->CreateVector(operator_inputs, 3),
+      builder->CreateVector(operator_outputs, 1),
+      tflite::BuiltinOptions_Conv2DOptions,
+      tflite::CreateConv2DOptions(
+          *builder,
+          conv.padding == kTfLitePaddingSame ? tflite::Padding_SAME
+                                             : tflite::Padding_VALID,
+          conv.stride, conv.stride, tflite::ActivationFunctionType_NONE,
+          conv.dilation, conv.dilation)
+          .Union())};
+  const Offset<tflite::OperatorCode> opcodes[] = {tflite::CreateOperatorCode(
+      *builder, tflite::BuiltinOperator_CONV_2D, 0, 1,
+      tflite::BuiltinOperator_CONV_2D)};
+  const int32_t inputs[] = {0};
+  const int32_t outputs[] = {3};
+  const Offset<tflite::SubGraph> subgraphs[] = {tflite::CreateSubGraph(
+      *builder, builder->CreateVector(tensors, 4),
+      builder->CreateVector(inputs, 1), builder->CreateVector(outputs, 1),
+      builder->CreateVector(operators, 1))};
+  builder->Finish(tflite::CreateModel(
+      *builder, TFLITE_SCHEMA_VERSION, builder->CreateVector(opcodes, 1),
+      builder->CreateVector(subgraphs, 1), builder->CreateString("conv"),
+      builder->CreateVector(buffers, 3)));
+  return tflite::GetModel(builder->GetBufferPointer());
+}
+
+// Runs `model` on the inputs the tests above use with a weight packing budget
+// of `packing_bytes`, 0 to leave the filter as the model stores it, and
+// copies its output to `output`. Sets `packed_bytes` to the budget the layer
+// used.
+TfLiteStatus RunConvModel(const tflite::Model* model, size_t packing_bytes,
+                          uint8_t* output, size_t* packed_bytes) {
+  tflite::MicroMutableOpResolver<1> op_resolver;
+  op_resolver.AddConv2D();
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  if (packing_bytes != 0) {
+    interpreter.SetWeightPacking(packing_bytes);
+  }
+  TF_LITE_ENSURE_STATUS(interpreter.AllocateTensors());
+  TfLiteTensor* input = interpreter.input(0);
+  if (interpreter.output(0)->bytes > kMaxElements * sizeof(float)) {
+    return kTfLiteError;
+  }
+  const int input_count = tflite::ElementCount(*input->dims);
+  for (int i = 0; i < input_count; ++i) {
+    if (input->type == kTfLiteInt8) {
+      input->data.int8[i] = static_cast<int8_t>((i * 37 + 11) % 256 - 128);
+    } else {
+      input->data.f[i] = 0.37f * ((i * 7 + 3) % 11) - 1.5f;
+    }
+  }
+  TF_LITE_ENSURE_STATUS(interpreter.Invoke());
+  memcpy(output, interpreter.output(0)->data.raw,
+         interpreter.output(0)->bytes);
+  *packed_bytes = interpreter.packed_weight_bytes();
+  return kTfLiteOk;
+}
+
+// Runs a layer without packing, with room to pack its weights, and with a
+// budget one byte short of that, and expects the same output every time.
+// `packs` tells whether this build packs the layer at all.
+void TestPackingKeepsOutputs(const ConvCase& conv, tflite::TensorType type,
+                             int input_zero_point, bool packs) {
+  flatbuffers::FlatBufferBuilder builder;
+  const tflite::Model* model =
+      BuildConvModel(&builder, conv, type, input_zero_point);
+  const int output_bytes =
+      tflite::ElementCount(*tflite::testing::IntArrayFromInts(
+          GetGeometry(conv).output_dims)) *
+      (type == tflite::TensorType_INT8 ? 1 : 4);
+
+  uint8_t expected[kMaxElements * sizeof(float)];
+  uint8_t output[kMaxElements * sizeof(float)];
+  size_t packed_bytes = 0;
+  TF_LITE_MICRO_EXPECT_EQ(RunConvModel(model, 0, expected, &packed_bytes),
+                          kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(
+      RunConvModel(model, kArenaSize, output, &packed_bytes), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(packs, packed_bytes > 0);
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, output, output_bytes));
+
+  if (packed_bytes > 0) {
+    memset(output, 0, sizeof(output));
+    TF_LITE_MICRO_EXPECT_EQ(
+        RunConvModel(model, packed_bytes - 1, output, &packed_bytes),
+        kTfLiteOk);
+    TF_LITE_MICRO_EXPECT_EQ(0, static_cast<int>(packed_bytes));
+    TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, output, output_bytes));
+  }
+}
+
+// 2-D, with 6 output channels, which leaves the last panel half empty.
+constexpr ConvCase kSquareSame = {1, 6, 6, 5, 3, 3, 6, kTfLitePaddingSame,
+                                  1, 1};
+// 2-D, strided, with two batches and 7 output channels.
+constexpr ConvCase kSquareStrided = {2, 7, 5, 4, 3, 3, 7, kTfLitePaddingSame,
+                                     2, 1};
+// 2-D, without padding, with fewer output channels than a panel.
+constexpr ConvCase kSquareValid = {1, 6, 7, 3, 2, 3, 3, kTfLitePaddingValid,
+                                   1, 1};
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestConv1DInt8MatchesReference) {
+  TestConvInt8(kHeightSame, -3);
+  TestConvInt8(kHeightStrided, 5);
+  TestConvInt8(kWidthValid, 0);
+  TestConvInt8(kWideChannels, -128);
+  TestConvInt8(kHeightDilated, 1);
+}
+
+TF_LITE_MICRO_TEST(TestConv1DFloatMatchesReference) {
+  TestConvFloat(kHeightSame);
+  TestConvFloat(kHeightStrided);
+  TestConvFloat(kWidthValid);
+  TestConvFloat(kWideChannels);
+  TestConvFloat(kHeightDilated);
+}
+
+TF_LITE_MICRO_TEST(TestConvPackingKeepsOutputs) {
+  const tflite::TensorType types[] = {tflite::TensorType_FLOAT32,
+                                      tflite::TensorType_INT8};
+  for (tflite::TensorType type : types) {
+    TestPackingKeepsOutputs(kSquareSame, type, -3, true);
+    TestPackingKeepsOutputs(kSquareStrided, type, 5, true);
+    TestPackingKeepsOutputs(kSquareValid, type, 0, true);
+    TestPackingKeepsOutputs(kHeightDilated, type, 1, true);
+    // The vector backends read the filter of 1-D layers as stored.
+    TestPackingKeepsOutputs(kHeightSame, type, -3,
+                            !tflite::micro::kHasVectorDotProduct);
+  }
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,54 @@
+# Reads the output of the tests in this directory, which use
+# tensorflow/lite/micro/testing/micro_test.h: every test starts with
+# "Testing <name>", every failed expectation prints "<what> failed at
+# <file>:<line>", and the program ends with "~~~ALL TESTS PASSED~~~" or
+# "~~~SOME TESTS FAILED~~~".
+
+import re
+
+import click
+from platformio.public import TestCase, TestCaseSource, TestRunnerBase, TestStatus
+
+
+class CustomTestRunner(TestRunnerBase):
+    FAILURE_RE = re.compile(r"^(?P<message>.+) failed at (?P<file>.+):(?P<line>\d+)")
+
+    def __init__(self, *args, **kwargs):
+        super().__init__(*args, **kwargs)
+        self._test_name = None
+        self._test_failed = False
+
+    def _finish_test(self):
+        if self._test_name is not None and not self._test_failed:
+            self.test_suite.add_case(
+                TestCase(name=self._test_name, status=TestStatus.PASSED)
+            )
+        self._test_name = None
+        self._test_failed = False
+
+    def on_testing_line_output(self, line):
+        if self.options.verbose:
+            click.echo(line, nl=False)
+        line = line.strip()
+        if line.startswith("Testing "):
+            self._finish_test()
+            self._test_name = line[len("Testing ") :]
+            return
+        match = self.FAILURE_RE.match(line)
+        if match:
+            self._test_failed = True
+            self.test_suite.add_case(
+                TestCase(
+                    name=self._test_name or "unknown",
+                    status=TestStatus.FAILED,
+                    message=match.group("message"),
+                    source=TestCaseSource(
+                        filename=match.group("file"),
+                        line=int(match.group("line")),
+                    ),
+                )
+            )
+            return
+        if "~~~ALL TESTS PASSED~~~" in line or "~~~SOME TESTS FAILED~~~" in line:
+            self._finish_test()
+            self.test_suite.on_finish()
@@ -0,0 +1,319 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks the depth multiplier 1 paths of DEPTHWISE_CONV_2D against the
+// reference kernels. They add the taps in the same order, so the outputs
+// must be identical for float as well.
+
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/depthwiseconv_float.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+
+constexpr int kMaxElements = 1024;
+constexpr int kMaxChannels = 40;
+constexpr float kInputScale = 0.05f;
+constexpr float kOutputScale = 0.1f;
+constexpr int kOutputZeroPoint = -2;
+
+struct DepthwiseCase {
+  int input_height;
+  int input_width;
+  int input_channels;
+  int filter_height;
+  int filter_width;
+  int depth_multiplier;
+  TfLitePadding padding;
+  int stride;
+  int dilation;
+};
+
+// Tensor dims in the IntArrayFromInts() layout, and the padding, as
+// DEPTHWISE_CONV_2D computes them for a DepthwiseCase.
+struct DepthwiseGeometry {
+  int input_dims[5];
+  int filter_dims[5];
+  int bias_dims[2];
+  int output_dims[5];
+  TfLitePaddingValues padding;
+};
+
+DepthwiseGeometry GetGeometry(const DepthwiseCase& conv) {
+  int output_height;
+  int output_width;
+  const TfLitePaddingValues padding = tflite::ComputePaddingHeightWidth(
+      conv.stride, conv.stride, conv.dilation, conv.dilation,
+      conv.input_height, conv.input_width, conv.filter_height,
+      conv.filter_width, conv.padding, &output_height, &output_width);
+  const int output_channels = conv.input_channels * conv.depth_multiplier;
+  DepthwiseGeometry geometry = {
+      {4, 1, conv.input_height, conv.input_width, conv.input_channels},
+      {4, 1, conv.filter_height, conv.filter_width, output_channels},
+      {1, output_channels},
+      {4, 1, output_height, output_width, output_channels},
+      padding};
+  return geometry;
+}
+
+TfLiteDepthwiseConvParams GetConvParams(const DepthwiseCase& conv) {
+  TfLiteDepthwiseConvParams params = {};
+  params.padding = conv.padding;
+  params.stride_width = conv.stride;
+  params.stride_height = conv.stride;
+  params.depth_multiplier = conv.depth_multiplier;
+  params.activation = kTfLiteActNone;
+  params.dilation_width_factor = conv.dilation;
+  params.dilation_height_factor = conv.dilation;
+  return params;
+}
+
+tflite::DepthwiseParams GetReferenceParams(const DepthwiseCase& conv,
+                                           const DepthwiseGeometry& geometry) {
+  tflite::DepthwiseParams params = {};
+  params.padding_values.height = geometry.padding.height;
+  params.padding_values.width = geometry.padding.width;
+  params.stride_height = conv.stride;
+  params.stride_width = conv.stride;
+  params.dilation_height_factor = conv.dilation;
+  params.dilation_width_factor = conv.dilation;
+  params.depth_multiplier = conv.depth_multiplier;
+  return params;
+}
+
+// Runs an int8 layer with per-channel filter scales through
+// DEPTHWISE_CONV_2D and expects the output of
+// reference_integer_ops::DepthwiseConvPerChannel().
+void TestDepthwiseConvInt8(const DepthwiseCase& conv, int input_zero_point) {
+  DepthwiseGeometry geometry = GetGeometry(conv);
+  TfLiteIntArray* input_dims =
+      tflite::testing::IntArrayFromInts(geometry.input_dims);
+  TfLiteIntArray* filter_dims =
+      tflite::testing::IntArrayFromInts(geometry.filter_dims);
+  TfLiteIntArray* bias_dims =
+      tflite::testing::IntArrayFromInts(geometry.bias_dims);
+  TfLiteIntArray* output_dims =
+      tflite::testing::IntArrayFromInts(geometry.output_dims);
+  const int input_count = tflite::ElementCount(*input_dims);
+  const int filter_count = tflite::ElementCount(*filter_dims);
+  const int output_count = tflite::ElementCount(*output_dims);
+  const int channels = geometry.output_dims[4];
+  TF_LITE_MICRO_EXPECT(input_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(filter_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(output_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(channels <= kMaxChannels);
+
+  int8_t input[kMaxElements];
+  int8_t filter[kMaxElements];
+  int32_t bias[kMaxChannels];
+  for (int i = 0; i < input_count; ++i) {
+    input[i] = static_cast<int8_t>((i * 37 + 11) % 256 - 128);
+  }
+  for (int i = 0; i < filter_count; ++i) {
+    filter[i] = static_cast<int8_t>((i * 73 + 5) % 255 - 127);
+  }
+  // Per-channel scales and zero points, with the element count first. The
+  // quantized dimension of depthwise filters is the last one.
+  float filter_scales[kMaxChannels + 1] = {static_cast<float>(channels)};
+  float bias_scales[kMaxChannels + 1] = {static_cast<float>(channels)};
+  int zero_points[kMaxChannels + 1] = {channels};
+  int32_t multipliers[kMaxChannels];
+  int shifts[kMaxChannels];
+  for (int c = 0; c < channels; ++c) {
+    bias[c] = (c * 977) % 4001 - 2000;
+    filter_scales[c + 1] = 0.004f + 0.001f * (c % 7);
+    bias_scales[c + 1] = kInputScale * filter_scales[c + 1];
+    zero_points[c + 1] = 0;
+    // As PopulateConvolutionQuantizationParams() computes them.
+    tflite::QuantizeMultiplier(static_cast<double>(kInputScale) *
+                                   filter_scales[c + 1] / kOutputScale,
+                               &multipliers[c], &shifts[c]);
+  }
+
+  float input_scales[] = {1, kInputScale};
+  int input_zero_points[] = {1, input_zero_point};
+  float output_scales[] = {1, kOutputScale};
+  int output_zero_points[] = {1, kOutputZeroPoint};
+  TfLiteAffineQuantization input_quant = {
+      tflite::testing::FloatArrayFromFloats(input_scales),
+      tflite::testing::IntArrayFromInts(input_zero_points), 0};
+  TfLiteAffineQuantization filter_quant = {
+      tflite::testing::FloatArrayFromFloats(filter_scales),
+      tflite::testing::IntArrayFromInts(zero_points), 3};
+  TfLiteAffineQuantization bias_quant = {
+      tflite::testing::FloatArrayFromFloats(bias_scales),
+      tflite::testing::IntArrayFromInts(zero_points), 0};
+  TfLiteAffineQuantization output_quant = {
+      tflite::testing::FloatArrayFromFloats(output_scales),
+      tflite::testing::IntArrayFromInts(output_zero_points), 0};
+
+  int8_t output[kMaxElements];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(input, input_dims, kInputScale,
+                                             input_zero_point),
+      tflite::testing::CreateTensor(filter, filter_dims),
+      tflite::testing::CreateTensor(bias, bias_dims),
+      tflite::testing::CreateQuantizedTensor(output, output_dims, kOutputScale,
+                                             kOutputZeroPoint),
+  };
+  tensors[0].quantization = {kTfLiteAffineQuantization, &input_quant};
+  tensors[1].quantization = {kTfLiteAffineQuantization, &filter_quant};
+  tensors[2].quantization = {kTfLiteAffineQuantization, &bias_quant};
+  tensors[3].quantization = {kTfLiteAffineQuantization, &output_quant};
+
+  TfLiteDepthwiseConvParams params = GetConvParams(conv);
+  TF_LITE_MICRO_EXPECT_EQ(
+      tflite::micro::RunKernel(tflite::Register_DEPTHWISE_CONV_2D(), tensors,
+                               4, 3, &params, micro_test::reporter),
+      kTfLiteOk);
+
+  tflite::DepthwiseParams reference_params =
+      GetReferenceParams(conv, geometry);
+  reference_params.input_offset = -input_zero_point;
+  reference_params.output_offset = kOutputZeroPoint;
+  reference_params.quantized_activation_min =
+      std::numeric_limits<int8_t>::min();
+  reference_params.quantized_activation_max =
+      std::numeric_limits<int8_t>::max();
+  int8_t expected[kMaxElements];
+  tflite::reference_integer_ops::DepthwiseConvPerChannel(
+      reference_params, multipliers, shifts,
+      tflite::RuntimeShape(4, &geometry.input_dims[1]), input,
+      tflite::RuntimeShape(4, &geometry.filter_dims[1]), filter,
+      tflite::RuntimeShape(1, &geometry.bias_dims[1]), bias,
+      tflite::RuntimeShape(4, &geometry.output_dims[1]), expected);
+
+  for (int i = 0; i < output_count; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected[i], output[i]);
+  }
+}
+
+// Runs a float layer through DEPTHWISE_CONV_2D and expects exactly the
+// output of reference_ops::DepthwiseConv().
+void TestDepthwiseConvFloat(const DepthwiseCase& conv) {
+  DepthwiseGeometry geometry = GetGeometry(conv);
+  TfLiteIntArray* input_dims =
+      tflite::testing::IntArrayFromInts(geometry.input_dims);
+  TfLiteIntArray* filter_dims =
+      tflite::testing::IntArrayFromInts(geometry.filter_dims);
+  TfLiteIntArray* bias_dims =
+      tflite::testing::IntArrayFromInts(geometry.bias_dims);
+  TfLiteIntArray* output_dims =
+      tflite::testing::IntArrayFromInts(geometry.output_dims);
+  const int input_count = tflite::ElementCount(*input_dims);
+  const int filter_count = tflite::ElementCount(*filter_dims);
+  const int output_count = tflite::ElementCount(*output_dims);
+  const int channels = geometry.output_dims[4];
+  TF_LITE_MICRO_EXPECT(input_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(filter_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(output_count <= kMaxElements);
+  TF_LITE_MICRO_EXPECT(channels <= kMaxChannels);
+
+  float input[kMaxElements];
+  float filter[kMaxElements];
+  float bias[kMaxChannels];
+  for (int i = 0; i < input_count; ++i) {
+    input[i] = 0.37f * ((i * 7 + 3) % 11) - 1.5f;
+  }
+  for (int i = 0; i < filter_count; ++i) {
+    filter[i] = 0.013f * ((i * 37 + 6) % 101) - 0.6f;
+  }
+  for (int c = 0; c < channels; ++c) {
+    bias[c] = 0.013f * ((c * 37 + 7) % 101) - 0.6f;
+  }
+
+  float output[kMaxElements];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateTensor(input, input_dims),
+      tflite::testing::CreateTensor(filter, filter_dims),
+      tflite::testing::CreateTensor(bias, bias_dims),
+      tflite::testing::CreateTensor(output, output_dims),
+  };
+  TfLiteDepthwiseConvParams params = GetConvParams(conv);
+  TF_LITE_MICRO_EXPECT_EQ(
+      tflite::micro::RunKernel(tflite::Register_DEPTHWISE_CONV_2D(), tensors,
+                               4, 3, &params, micro_test::reporter),
+      kTfLiteOk);
+
+  tflite::DepthwiseParams reference_params =
+      GetReferenceParams(conv, geometry);
+  reference_params.float_activation_min = std::numeric_limits<float>::lowest();
+  reference_params.float_activation_max = std::numeric_limits<float>::max();
+  float expected[kMaxElements];
+  tflite::reference_ops::DepthwiseConv(
+      reference_params, tflite::RuntimeShape(4, &geometry.input_dims[1]),
+      input, tflite::RuntimeShape(4, &geometry.filter_dims[1]), filter,
+      tflite::RuntimeShape(1, &geometry.bias_dims[1]), bias,
+      tflite::RuntimeShape(4, &geometry.output_dims[1]), expected);
+
+  for (int i = 0; i < output_count; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(expected[i], output[i], 0.0f);
+  }
+}
+
+// 1-D along the height, with both borders padded.
+constexpr DepthwiseCase kHeight1D = {40, 1, 16, 5, 1, 1, kTfLitePaddingSame,
+                                     1, 1};
+// 1-D along the width, strided, without padding.
+constexpr DepthwiseCase kWidth1D = {1, 29, 8, 1, 3, 1, kTfLitePaddingValid,
+                                    2, 1};
+// 2-D with more channels than one block of the inner loop.
+constexpr DepthwiseCase kBlockTail = {5, 5, 33, 3, 3, 1, kTfLitePaddingSame,
+                                      1, 1};
+// 2-D with taps skipped on every border.
+constexpr DepthwiseCase kLargeFilter = {7, 6, 9, 5, 5, 1, kTfLitePaddingSame,
+                                        2, 1};
+// Dilated, without padding: Prepare() computes SAME padding as if the layer
+// was not dilated.
+constexpr DepthwiseCase kDilated = {9, 8, 4, 3, 3, 1, kTfLitePaddingValid, 1,
+                                    2};
+// Other depth multipliers keep the reference kernels.
+constexpr DepthwiseCase kMultiplier2 = {6, 6, 3, 3, 3, 2, kTfLitePaddingSame,
+                                        1, 1};
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestDepthwiseConvInt8MatchesReference) {
+  TestDepthwiseConvInt8(kHeight1D, -3);
+  TestDepthwiseConvInt8(kWidth1D, 5);
+  TestDepthwiseConvInt8(kBlockTail, 0);
+  TestDepthwiseConvInt8(kLargeFilter, -128);
+  TestDepthwiseConvInt8(kDilated, 7);
+  TestDepthwiseConvInt8(kMultiplier2, 1);
+}
+
+TF_LITE_MICRO_TEST(TestDepthwiseConvFloatMatchesReference) {
+  TestDepthwiseConvFloat(kHeight1D);
+  TestDepthwiseConvFloat(kWidth1D);
+  TestDepthwiseConvFloat(kBlockTail);
+  TestDepthwiseConvFloat(kLargeFilter);
+  TestDepthwiseConvFloat(kDilated);
+  TestDepthwiseConvFloat(kMultiplier2);
+}
+
+TF_LITE_MICRO_TESTS_END
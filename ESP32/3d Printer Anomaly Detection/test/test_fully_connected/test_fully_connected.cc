@@ -0,0 +1,702 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks the float layers of FULLY_CONNECTED whose filters are not stored as
+// float against a float layer over the filter they encode. The layers run
+// through MicroInterpreter, whose context is the only one that hands kernels
+// a weight packing budget. Packing the weights must not change the outputs
+// of any layer.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/micro/kernels/simd_util.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr int kMaxBatches = 3;
+constexpr int kMaxDepth = 32;
+constexpr int kMaxChannels = 12;
+constexpr int kMaxWeights = kMaxChannels * kMaxDepth;
+constexpr size_t kArenaSize = 32 * 1024;
+
+alignas(16) uint8_t arena[kArenaSize];
+
+// A FULLY_CONNECTED layer with float input, bias and output, and a filter in
+// any of the encodings the kernel accepts, or a layer quantized to int8 end
+// to end.
+struct FullyConnectedLayer {
+  int batches;
+  int accum_depth;
+  int output_depth;
+  // TensorType_INT8 gives the layer an int8 input and output with the scales
+  // and zero points below, and an int32 bias.
+  tflite::TensorType activation_type;
+  float input_scale;
+  int64_t input_zero_point;
+  float output_scale;
+  int64_t output_zero_point;
+  tflite::TensorType filter_type;
+  // The filter buffer as the model stores it.
+  const uint8_t* filter_data;
+  int filter_bytes;
+  // Scales and zero points of a quantized filter, one per tensor or one per
+  // output channel, or nullptr. The zero points may be left out with nullptr.
+  int filter_scale_count;
+  const float* filter_scales;
+  const int64_t* filter_zero_points;
+  // Float or int32, as the activation type asks for.
+  const void* bias;
+  // For a sparse float filter, the size of its blocks along the input depth
+  // and, in the converter's CSR layout, the first block of every output
+  // channel followed by the block count, and the column of every block.
+  // filter_data then holds the values of the kept blocks.
+  int block_size;
+  const int32_t* row_segments;
+  const uint16_t* block_columns;
+  int block_count;
+};
+
+flatbuffers::Offset<tflite::SparsityParameters> BuildSparsity(
+    flatbuffers::FlatBufferBuilder* builder, const FullyConnectedLayer& layer) {
+  using flatbuffers::Offset;
+  const Offset<tflite::DimensionMetadata> dim_metadata[] = {
+      tflite::CreateDimensionMetadata(*builder, tflite::DimensionType_DENSE,
+                                      layer.output_depth),
+      tflite::CreateDimensionMetadata(
+          *builder, tflite::DimensionType_SPARSE_CSR, 0,
+          tflite::SparseIndexVector_Int32Vector,
+          tflite::CreateInt32Vector(
+              *builder, builder->CreateVector(layer.row_segments,
+                                              layer.output_depth + 1))
+              .Union(),
+          tflite::SparseIndexVector_Uint16Vector,
+          tflite::CreateUint16Vector(
+              *builder,
+              builder->CreateVector(layer.block_columns, layer.block_count))
+              .Union()),
+      tflite::CreateDimensionMetadata(*builder, tflite::DimensionType_DENSE,
+                                      1),
+      tflite::CreateDimensionMetadata(*builder, tflite::DimensionType_DENSE,
+                                      layer.block_size)};
+  // Blocks of single weights leave out the block dimensions.
+  const int dim_count = layer.block_size == 1 ? 2 : 4;
+  const int32_t traversal_order[] = {0, 1, 2, 3};
+  const int32_t block_map[] = {0, 1};
+  return tflite::CreateSparsityParameters(
+      *builder, builder->CreateVector(traversal_order, dim_count),
+      dim_count == 4 ? builder->CreateVector(block_map, 2) : 0,
+      builder->CreateVector(dim_metadata, dim_count));
+}
+
+flatbuffers::Offset<tflite::QuantizationParameters> BuildQuantization(
+    flatbuffers::FlatBufferBuilder* builder, int count, const float* scales,
+    const int64_t* zero_points) {
+  return tflite::CreateQuantizationParameters(
+      *builder, 0, 0, builder->CreateVector(scales, count),
+      zero_points != nullptr ? builder->CreateVector(zero_points, count) : 0,
+      tflite::QuantizationDetails_NONE, 0, 0);
+}
+
+const tflite::Model* BuildModel(flatbuffers::FlatBufferBuilder* builder,
+                                const FullyConnectedLayer& layer) {
+  using flatbuffers::Offset;
+  const bool quantized = layer.activation_type == tflite::TensorType_INT8;
+  const Offset<tflite::Buffer> buffers[] = {
+      tflite::CreateBuffer(*builder),
+      tflite::CreateBuffer(*builder, builder->CreateVector(layer.filter_data,
+                                                           layer.filter_bytes)),
+      tflite::CreateBuffer(
+          *builder, builder->CreateVector(
+                        static_cast<const uint8_t*>(layer.bias),
+                        layer.output_depth * sizeof(float)))};
+
+  Offset<tflite::QuantizationParameters> filter_quantization = 0;
+  if (layer.filter_scales != nullptr) {
+    filter_quantization =
+        BuildQuantization(builder, layer.filter_scale_count,
+                          layer.filter_scales, layer.filter_zero_points);
+  }
+  Offset<tflite::QuantizationParameters> input_quantization = 0;
+  Offset<tflite::QuantizationParameters> bias_quantization = 0;
+  Offset<tflite::QuantizationParameters> output_quantization = 0;
+  if (quantized) {
+    const float bias_scale = layer.input_scale * layer.filter_scales[0];
+    const int64_t bias_zero_point = 0;
+    input_quantization = BuildQuantization(
+        builder, 1, &layer.input_scale, &layer.input_zero_point);
+    bias_quantization =
+        BuildQuantization(builder, 1, &bias_scale, &bias_zero_point);
+    output_quantization = BuildQuantization(
+        builder, 1, &layer.output_scale, &layer.output_zero_point);
+  }
+  flatbuffers::Offset<tflite::SparsityParameters> filter_sparsity = 0;
+  if (layer.row_segments != nullptr) {
+    filter_sparsity = BuildSparsity(builder, layer);
+  }
+  const int32_t input_shape[] = {layer.batches, layer.accum_depth};
+  const int32_t filter_shape[] = {layer.output_depth, layer.accum_depth};
+  const int32_t bias_shape[] = {layer.output_depth};
+  const int32_t output_shape[] = {layer.batches, layer.output_depth};
+  const Offset<tflite::Tensor> tensors[] = {
+      tflite::CreateTensor(*builder, builder->CreateVector(input_shape, 2),
+                           layer.activation_type, 0, 0, input_quantization),
+      tflite::CreateTensor(*builder, builder->CreateVector(filter_shape, 2),
+                           layer.filter_type, 1, 0, filter_quantization,
+                           false, filter_sparsity),
+      tflite::CreateTensor(
+          *builder, builder->CreateVector(bias_shape, 1),
+          quantized ? tflite::TensorType_INT32 : tflite::TensorType_FLOAT32, 2,
+          0, bias_quantization),
+      tflite::CreateTensor(*builder, builder->CreateVector(output_shape, 2),
+                           layer.activation_type, 0, 0, output_quantization)};
+
+  const int32_t operator_inputs[] = {0, 1, 2};
+  const int32_t operator_outputs[] = {3};
+  const Offset<tflite::Operator> operators[] = {tflite::CreateOperator(
+      *builder, 0, builder->CreateVector(operator_inputs, 3),
+      builder->CreateVector(operator_outputs, 1),
+      tflite::BuiltinOptions_FullyConnectedOptions,
+      tflite::CreateFullyConnectedOptions(*builder).Union())};
+  const Offset<tflite::OperatorCode> opcodes[] = {tflite::CreateOperatorCode(
+      *builder, tflite::BuiltinOperator_FULLY_CONNECTED, 0, 1,
+      tflite::BuiltinOperator_FULLY_CONNECTED)};
+  const int32_t inputs[] = {0};
+  const int32_t outputs[] = {3};
+  const Offset<tflite::SubGraph> subgraphs[] = {tflite::CreateSubGraph(
+      *builder, builder->CreateVector(tensors, 4),
+      builder->CreateVector(inputs, 1), builder->CreateVector(outputs, 1),
+      builder->CreateVector(operators, 1))};
+  builder->Finish(tflite::CreateModel(
+      *builder, TFLITE_SCHEMA_VERSION, builder->CreateVector(opcodes, 1),
+      builder->CreateVector(subgraphs, 1), builder->CreateString("fc"),
+      builder->CreateVector(buffers, 3)));
+  return tflite::GetModel(builder->GetBufferPointer());
+}
+
+void FillInput(int count, float* input) {
+  for (int i = 0; i < count; ++i) {
+    input[i] = 0.37f * ((i * 7 + 3) % 11) - 1.5f;
+  }
+}
+
+void FillBias(int count, float* bias) {
+  for (int c = 0; c < count; ++c) {
+    bias[c] = 0.013f * ((c * 37 + 7) % 101) - 0.6f;
+  }
+}
+
+// Runs `layer` on `input` with a weight packing budget of `packing_bytes`,
+// 0 to leave the filter as the model stores it, and copies its output to
+// `output`. Sets `packed_bytes` to the budget the layer used.
+TfLiteStatus RunLayer(const FullyConnectedLayer& layer, const void* input,
+                      void* output, size_t packing_bytes = 0,
+                      size_t* packed_bytes = nullptr) {
+  flatbuffers::FlatBufferBuilder builder;
+  const tflite::Model* model = BuildModel(&builder, layer);
+  tflite::MicroMutableOpResolver<1> op_resolver;
+  op_resolver.AddFullyConnected();
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  if (packing_bytes != 0) {
+    interpreter.SetWeightPacking(packing_bytes);
+  }
+  TF_LITE_ENSURE_STATUS(interpreter.AllocateTensors());
+  memcpy(interpreter.input(0)->data.raw, input, interpreter.input(0)->bytes);
+  TF_LITE_ENSURE_STATUS(interpreter.Invoke());
+  memcpy(output, interpreter.output(0)->data.raw,
+         interpreter.output(0)->bytes);
+  if (packed_bytes != nullptr) {
+    *packed_bytes = interpreter.packed_weight_bytes();
+  }
+  return kTfLiteOk;
+}
+
+// Expects `output` to be what a float layer computes from `input` and the
+// row-major `weights`. A hybrid layer quantizes each input row to int8 with
+// a step of its largest magnitude / 127, which moves every product by at
+// most half a step times its weight.
+void ExpectMatchesFloatLayer(const FullyConnectedLayer& layer,
+                             const float* input, const float* weights,
+                             bool quantizes_input, const float* output) {
+  const float* bias = static_cast<const float*>(layer.bias);
+  for (int b = 0; b < layer.batches; ++b) {
+    const float* row = &input[b * layer.accum_depth];
+    float max_abs = 0.0f;
+    for (int d = 0; d < layer.accum_depth; ++d) {
+      max_abs = std::max(max_abs, std::fabs(row[d]));
+    }
+    const float half_step = quantizes_input ? max_abs / 127.0f / 2.0f : 0.0f;
+    for (int c = 0; c < layer.output_depth; ++c) {
+      const float* weight_row = &weights[c * layer.accum_depth];
+      double expected = bias[c];
+      double weight_sum = 0.0;
+      double magnitude = std::fabs(bias[c]);
+      for (int d = 0; d < layer.accum_depth; ++d) {
+        expected += static_cast<double>(row[d]) * weight_row[d];
+        weight_sum += std::fabs(weight_row[d]);
+        magnitude += std::fabs(row[d] * weight_row[d]);
+      }
+      const float tolerance = static_cast<float>(
+          half_step * weight_sum + magnitude * 1e-5 + 1e-6);
+      TF_LITE_MICRO_EXPECT_NEAR(static_cast<float>(expected),
+                                output[b * layer.output_depth + c],
+                                tolerance);
+    }
+  }
+}
+
+// Runs a hybrid layer with a symmetric int8 filter and one scale per tensor
+// or per output channel, and expects the float layer over the dequantized
+// filter.
+void TestHybridInt8(bool per_channel) {
+  FullyConnectedLayer layer = {};
+  layer.batches = 3;
+  layer.accum_depth = 20;
+  layer.output_depth = 7;
+  layer.filter_type = tflite::TensorType_INT8;
+
+  int8_t filter[kMaxWeights];
+  float weights[kMaxWeights];
+  float filter_scales[kMaxChannels];
+  int64_t zero_points[kMaxChannels] = {};
+  float bias[kMaxChannels];
+  for (int c = 0; c < layer.output_depth; ++c) {
+    filter_scales[c] = per_channel ? 0.004f + 0.001f * (c % 5) : 0.006f;
+    for (int d = 0; d < layer.accum_depth; ++d) {
+      const int i = c * layer.accum_depth + d;
+      filter[i] = static_cast<int8_t>((i * 73 + 5) % 255 - 127);
+      weights[i] = filter_scales[c] * filter[i];
+    }
+  }
+  FillBias(layer.output_depth, bias);
+  layer.filter_data = reinterpret_cast<const uint8_t*>(filter);
+  layer.filter_bytes = layer.output_depth * layer.accum_depth;
+  layer.filter_scale_count = per_channel ? layer.output_depth : 1;
+  layer.filter_scales = filter_scales;
+  layer.filter_zero_points = zero_points;
+  layer.bias = bias;
+
+  float input[kMaxBatches * kMaxDepth];
+  FillInput(layer.batches * layer.accum_depth, input);
+  float output[kMaxBatches * kMaxChannels];
+  TF_LITE_MICRO_EXPECT_EQ(RunLayer(layer, input, output), kTfLiteOk);
+  ExpectMatchesFloatLayer(layer, input, weights, true, output);
+}
+
+// Fills `halves` with finite float16 values, subnormals among them, and
+// `values` with what they widen to.
+void FillFloat16(int count, uint16_t* halves, float* values) {
+  for (int i = 0; i < count; ++i) {
+    const bool negative = i % 3 == 0;
+    const int exponent = i % 11 == 0 ? 0 : 9 + (i * 5) % 7;
+    const int mantissa = (i * 389 + 11) % 1024;
+    halves[i] = static_cast<uint16_t>((negative ? 0x8000 : 0) |
+                                      (exponent << 10) | mantissa);
+    const float magnitude =
+        exponent == 0 ? std::ldexp(static_cast<float>(mantissa), -24)
+                      : std::ldexp(static_cast<float>(1024 + mantissa),
+                                   exponent - 25);
+    values[i] = negative ? -magnitude : magnitude;
+  }
+}
+
+// Runs a layer with a float16 filter and expects the output of a float layer
+// holding the widened filter. Packing widens the filter to the float panels
+// a float layer packs, so the packed outputs must be identical.
+void TestFloat16(int batches, int accum_depth, int output_depth) {
+  FullyConnectedLayer layer = {};
+  layer.batches = batches;
+  layer.accum_depth = accum_depth;
+  layer.output_depth = output_depth;
+  layer.filter_type = tflite::TensorType_FLOAT16;
+
+  uint16_t filter[kMaxWeights];
+  float weights[kMaxWeights];
+  float bias[kMaxChannels];
+  FillFloat16(output_depth * accum_depth, filter, weights);
+  FillBias(output_depth, bias);
+  layer.filter_data = reinterpret_cast<const uint8_t*>(filter);
+  layer.filter_bytes = output_depth * accum_depth * sizeof(uint16_t);
+  layer.bias = bias;
+  FullyConnectedLayer float_layer = layer;
+  float_layer.filter_type = tflite::TensorType_FLOAT32;
+  float_layer.filter_data = reinterpret_cast<const uint8_t*>(weights);
+  float_layer.filter_bytes = output_depth * accum_depth * sizeof(float);
+
+  float input[kMaxBatches * kMaxDepth];
+  FillInput(batches * accum_depth, input);
+  float output[kMaxBatches * kMaxChannels];
+  TF_LITE_MICRO_EXPECT_EQ(RunLayer(layer, input, output), kTfLiteOk);
+  ExpectMatchesFloatLayer(layer, input, weights, false, output);
+
+  float expected[kMaxBatches * kMaxChannels];
+  size_t packed_bytes = 0;
+  TF_LITE_MICRO_EXPECT_EQ(
+      RunLayer(float_layer, input, expected, kArenaSize), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(
+      RunLayer(layer, input, output, kArenaSize, &packed_bytes), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(packed_bytes > 0);
+  for (int i = 0; i < batches * output_depth; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(expected[i], output[i], 0.0f);
+  }
+}
+
+// Runs a hybrid layer with an int4 filter that has a scale and a zero point
+// per output channel, or one of each for the tensor, and expects the float
+// layer over the dequantized filter. Rows of an odd `accum_depth` start in
+// the middle of a byte every other channel. Unpacking the filter at Prepare
+// time must not change the outputs.
+void TestHybridInt4(int batches, int accum_depth, int output_depth,
+                    bool per_channel) {
+  FullyConnectedLayer layer = {};
+  layer.batches = batches;
+  layer.accum_depth = accum_depth;
+  layer.output_depth = output_depth;
+  layer.filter_type = tflite::TensorType_INT4;
+
+  // Two values per byte, the even index in the low nibble.
+  uint8_t filter[kMaxWeights / 2 + 1] = {};
+  float weights[kMaxWeights];
+  float filter_scales[kMaxChannels];
+  int64_t zero_points[kMaxChannels];
+  float bias[kMaxChannels];
+  for (int c = 0; c < output_depth; ++c) {
+    filter_scales[c] = per_channel ? 0.03f + 0.01f * (c % 4) : 0.04f;
+    zero_points[c] = per_channel ? (c * 5) % 16 - 8 : -3;
+  }
+  for (int c = 0; c < output_depth; ++c) {
+    for (int d = 0; d < accum_depth; ++d) {
+      const int i = c * accum_depth + d;
+      const int value = (i * 7 + 3) % 16 - 8;
+      filter[i / 2] |= static_cast<uint8_t>((value & 0xf) << (4 * (i % 2)));
+      weights[i] = filter_scales[c] * (value - zero_points[c]);
+    }
+  }
+  FillBias(output_depth, bias);
+  layer.filter_data = filter;
+  layer.filter_bytes = (output_depth * accum_depth + 1) / 2;
+  layer.filter_scale_count = per_channel ? output_depth : 1;
+  layer.filter_scales = filter_scales;
+  layer.filter_zero_points = zero_points;
+  layer.bias = bias;
+
+  float input[kMaxBatches * kMaxDepth];
+  FillInput(batches * accum_depth, input);
+  float output[kMaxBatches * kMaxChannels];
+  TF_LITE_MICRO_EXPECT_EQ(RunLayer(layer, input, output), kTfLiteOk);
+  ExpectMatchesFloatLayer(layer, input, weights, true, output);
+
+  float unpacked_output[kMaxBatches * kMaxChannels];
+  size_t packed_bytes = 0;
+  TF_LITE_MICRO_EXPECT_EQ(RunLayer(layer, input, unpacked_output, kArenaSize,
+                                   &packed_bytes),
+                          kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(packed_bytes > 0);
+  for (int i = 0; i < batches * output_depth; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(output[i], unpacked_output[i], 0.0f);
+  }
+}
+
+// Runs a float layer whose filter keeps only some of its blocks of
+// `block_size` weights, none of them in output channel 2, and expects the
+// float layer over the dense filter.
+void TestSparse(int block_size) {
+  FullyConnectedLayer layer = {};
+  layer.batches = 2;
+  layer.accum_depth = 16;
+  layer.output_depth = 6;
+  layer.filter_type = tflite::TensorType_FLOAT32;
+  layer.block_size = block_size;
+
+  const int column_count = layer.accum_depth / block_size;
+  float weights[kMaxWeights] = {};
+  float values[kMaxWeights];
+  int32_t row_segments[kMaxChannels + 1] = {0};
+  uint16_t block_columns[kMaxWeights];
+  int block_count = 0;
+  for (int c = 0; c < layer.output_depth; ++c) {
+    for (int column = 0; column < column_count; ++column) {
+      if (c == 2 || (c * 5 + column * 3) % 4 == 0) {
+        continue;
+      }
+      for (int i = 0; i < block_size; ++i) {
+        const int d = column * block_size + i;
+        const float value = 0.013f * ((c * 37 + d * 11) % 101) - 0.6f;
+        weights[c * layer.accum_depth + d] = value;
+        values[block_count * block_size + i] = value;
+      }
+      block_columns[block_count++] = static_cast<uint16_t>(column);
+    }
+    row_segments[c + 1] = block_count;
+  }
+  TF_LITE_MICRO_EXPECT_EQ(row_segments[2], row_segments[3]);
+  float bias[kMaxChannels];
+  FillBias(layer.output_depth, bias);
+  layer.filter_data = reinterpret_cast<const uint8_t*>(values);
+  layer.filter_bytes = block_count * block_size * sizeof(float);
+  layer.bias = bias;
+  layer.row_segments = row_segments;
+  layer.block_columns = block_columns;
+  layer.block_count = block_count;
+
+  float input[kMaxBatches * kMaxDepth];
+  FillInput(layer.batches * layer.accum_depth, input);
+  float output[kMaxBatches * kMaxChannels];
+  TF_LITE_MICRO_EXPECT_EQ(RunLayer(layer, input, output), kTfLiteOk);
+  ExpectMatchesFloatLayer(layer, input, weights, false, output);
+  // The channel without blocks is its bias.
+  for (int b = 0; b < layer.batches; ++b) {
+    TF_LITE_MICRO_EXPECT_NEAR(bias[2], output[b * layer.output_depth + 2],
+                              0.0f);
+  }
+}
+
+// Runs `layer` without packing, with room to pack its weights, and with a
+// budget one byte short of that, and expects the same output every time.
+// `packs` tells whether this build packs the layer at all.
+void ExpectPackingKeepsOutputs(const FullyConnectedLayer& layer,
+                               const void* input, bool packs) {
+  const bool quantized = layer.activation_type == tflite::TensorType_INT8;
+  const int output_bytes = layer.batches * layer.output_depth *
+                           (quantized ? sizeof(int8_t) : sizeof(float));
+  uint8_t expected[kMaxBatches * kMaxChannels * sizeof(float)];
+  uint8_t output[kMaxBatches * kMaxChannels * sizeof(float)];
+  TF_LITE_MICRO_EXPECT_EQ(RunLayer(layer, input, expected), kTfLiteOk);
+
+  size_t packed_bytes = 0;
+  TF_LITE_MICRO_EXPECT_EQ(
+      RunLayer(layer, input, output, kArenaSize, &packed_bytes), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(packs, packed_bytes > 0);
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, output, output_bytes));
+
+  if (packed_bytes > 0) {
+    const size_t needed_bytes = packed_bytes;
+    memset(output, 0, sizeof(output));
+    TF_LITE_MICRO_EXPECT_EQ(
+        RunLayer(layer, input, output, needed_bytes - 1, &packed_bytes),
+        kTfLiteOk);
+    TF_LITE_MICRO_EXPECT_EQ(0, static_cast<int>(packed_bytes));
+    TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, output, output_bytes));
+  }
+}
+
+// Packs a float layer whose channels fill `output_depth` / kWeightPanelWidth
+// panels, the last one padded.
+void TestFloatPacking(int batches, int accum_depth, int output_depth) {
+  FullyConnectedLayer layer = {};
+  layer.batches = batches;
+  layer.accum_depth = accum_depth;
+  layer.output_depth = output_depth;
+  layer.filter_type = tflite::TensorType_FLOAT32;
+
+  float filter[kMaxWeights];
+  for (int i = 0; i < output_depth * accum_depth; ++i) {
+    filter[i] = 0.013f * ((i * 37 + 1) % 101) - 0.6f;
+  }
+  float bias[kMaxChannels];
+  FillBias(output_depth, bias);
+  layer.filter_data = reinterpret_cast<const uint8_t*>(filter);
+  layer.filter_bytes = output_depth * accum_depth * sizeof(float);
+  layer.bias = bias;
+
+  float input[kMaxBatches * kMaxDepth];
+  FillInput(batches * accum_depth, input);
+  ExpectPackingKeepsOutputs(layer, input, true);
+}
+
+// Packs an int8 layer, whose packed bias also holds the input zero point
+// times the filter row sums.
+void TestInt8Packing(int batches, int accum_depth, int output_depth,
+                     int64_t input_zero_point, int64_t output_zero_point) {
+  FullyConnectedLayer layer = {};
+  layer.batches = batches;
+  layer.accum_depth = accum_depth;
+  layer.output_depth = output_depth;
+  layer.activation_type = tflite::TensorType_INT8;
+  layer.input_scale = 0.05f;
+  layer.input_zero_point = input_zero_point;
+  layer.output_scale = 0.1f;
+  layer.output_zero_point = output_zero_point;
+  layer.filter_type = tflite::TensorType_INT8;
+
+  int8_t filter[kMaxWeights];
+  for (int i = 0; i < output_depth * accum_depth; ++i) {
+    filter[i] = static_cast<int8_t>((i * 73 + 5) % 255 - 127);
+  }
+  const float filter_scale = 0.02f;
+  const int64_t filter_zero_point = 0;
+  int32_t bias[kMaxChannels];
+  for (int c = 0; c < output_depth; ++c) {
+    bias[c] = (c * 977 + 4) % 4001 - 2000;
+  }
+  layer.filter_data = reinterpret_cast<const uint8_t*>(filter);
+  layer.filter_bytes = output_depth * accum_depth;
+  layer.filter_scale_count = 1;
+  layer.filter_scales = &filter_scale;
+  layer.filter_zero_points = &filter_zero_point;
+  layer.bias = bias;
+
+  int8_t input[kMaxBatches * kMaxDepth];
+  for (int i = 0; i < batches * accum_depth; ++i) {
+    input[i] = static_cast<int8_t>((i * 37 + 11) % 256 - 128);
+  }
+  ExpectPackingKeepsOutputs(layer, input, true);
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestHybridInt8PerTensorMatchesFloat) {
+  TestHybridInt8(/*per_channel=*/false);
+}
+
+TF_LITE_MICRO_TEST(TestHybridInt8PerChannelMatchesFloat) {
+  TestHybridInt8(/*per_channel=*/true);
+}
+
+TF_LITE_MICRO_TEST(TestHybridInt8NeedsSymmetricQuantization) {
+  const int8_t filter[] = {1, -2, 3, -4, 5, -6};
+  const float filter_scales[] = {0.01f, 0.02f};
+  const int64_t zero_points[] = {0, 3};
+  const float bias[] = {0.5f, -0.5f};
+  FullyConnectedLayer layer = {};
+  layer.batches = 1;
+  layer.accum_depth = 3;
+  layer.output_depth = 2;
+  layer.filter_type = tflite::TensorType_INT8;
+  layer.filter_data = reinterpret_cast<const uint8_t*>(filter);
+  layer.filter_bytes = sizeof(filter);
+  layer.filter_scale_count = 2;
+  layer.filter_scales = filter_scales;
+  layer.filter_zero_points = zero_points;
+  layer.bias = bias;
+
+  // Only int4 filters may be asymmetric.
+  const float input[] = {1.0f, 2.0f, 3.0f};
+  float output[2];
+  TF_LITE_MICRO_EXPECT_EQ(RunLayer(layer, input, output), kTfLiteError);
+
+  // Without zero points the allocator drops the scales as well, which leaves
+  // nothing to dequantize the filter with.
+  layer.filter_zero_points = nullptr;
+  TF_LITE_MICRO_EXPECT_EQ(RunLayer(layer, input, output), kTfLiteError);
+}
+
+TF_LITE_MICRO_TEST(TestFloat16MatchesWidenedFloat) {
+  TestFloat16(1, 8, 4);
+  TestFloat16(3, 19, 6);
+  TestFloat16(2, 32, 12);
+}
+
+TF_LITE_MICRO_TEST(TestFloat16NeedsFiniteFilter) {
+  // 1, -2, infinity and 0.5.
+  const uint16_t filter[] = {0x3c00, 0xc000, 0x7c00, 0x3800};
+  const float bias[] = {0.0f, 0.0f};
+  FullyConnectedLayer layer = {};
+  layer.batches = 1;
+  layer.accum_depth = 2;
+  layer.output_depth = 2;
+  layer.filter_type = tflite::TensorType_FLOAT16;
+  layer.filter_data = reinterpret_cast<const uint8_t*>(filter);
+  layer.filter_bytes = sizeof(filter);
+  layer.bias = bias;
+
+  const float input[] = {1.0f, 2.0f};
+  float output[2];
+  TF_LITE_MICRO_EXPECT_EQ(RunLayer(layer, input, output), kTfLiteError);
+}
+
+TF_LITE_MICRO_TEST(TestHybridInt4MatchesFloat) {
+  TestHybridInt4(1, 16, 4, /*per_channel=*/true);
+  TestHybridInt4(3, 13, 7, /*per_channel=*/true);
+  TestHybridInt4(2, 31, 12, /*per_channel=*/true);
+  TestHybridInt4(3, 13, 7, /*per_channel=*/false);
+}
+
+TF_LITE_MICRO_TEST(TestHybridInt4ZeroPointMustFitInt4) {
+  const uint8_t filter[] = {0x21, 0x43, 0x65};
+  const float filter_scales[] = {0.01f, 0.02f};
+  const int64_t zero_points[] = {0, 8};
+  const float bias[] = {0.5f, -0.5f};
+  FullyConnectedLayer layer = {};
+  layer.batches = 1;
+  layer.accum_depth = 3;
+  layer.output_depth = 2;
+  layer.filter_type = tflite::TensorType_INT4;
+  layer.filter_data = filter;
+  layer.filter_bytes = sizeof(filter);
+  layer.filter_scale_count = 2;
+  layer.filter_scales = filter_scales;
+  layer.filter_zero_points = zero_points;
+  layer.bias = bias;
+
+  const float input[] = {1.0f, 2.0f, 3.0f};
+  float output[2];
+  TF_LITE_MICRO_EXPECT_EQ(RunLayer(layer, input, output), kTfLiteError);
+}
+
+TF_LITE_MICRO_TEST(TestSparseMatchesDenseFloat) {
+  TestSparse(1);
+  TestSparse(4);
+}
+
+TF_LITE_MICRO_TEST(TestFloatPackingKeepsOutputs) {
+  TestFloatPacking(1, 8, 4);
+  TestFloatPacking(3, 31, 10);
+  TestFloatPacking(2, 5, 3);
+}
+
+TF_LITE_MICRO_TEST(TestInt8PackingKeepsOutputs) {
+  TestInt8Packing(1, 32, 10, -5, 3);
+  TestInt8Packing(3, 29, 9, 7, -2);
+  TestInt8Packing(2, 16, 8, 0, 0);
+}
+
+TF_LITE_MICRO_TEST(TestHybridInt8PackingKeepsOutputs) {
+  // The vector backends keep hybrid int8 filters as they are.
+  const int8_t filter[] = {12, -7, 127, -127, 3, 0, 55, -90, 1, 2, 64, -33,
+                           9,  -9, 18,  -18,  4, 5, -6, 7,  8, 21, -2, 100};
+  const float filter_scales[] = {0.01f, 0.02f, 0.015f, 0.03f, 0.005f, 0.025f};
+  const int64_t zero_points[6] = {};
+  float bias[6];
+  FillBias(6, bias);
+  FullyConnectedLayer layer = {};
+  layer.batches = 2;
+  layer.accum_depth = 4;
+  layer.output_depth = 6;
+  layer.filter_type = tflite::TensorType_INT8;
+  layer.filter_data = reinterpret_cast<const uint8_t*>(filter);
+  layer.filter_bytes = sizeof(filter);
+  layer.filter_scale_count = 6;
+  layer.filter_scales = filter_scales;
+  layer.filter_zero_points = zero_points;
+  layer.bias = bias;
+
+  float input[8];
+  FillInput(8, input);
+  ExpectPackingKeepsOutputs(layer, input,
+                            !tflite::micro::kHasVectorDotProduct);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,157 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that running a model in time slices with InvokeStep() gives the
+// same outputs as Invoke().
+
+#include <cstdint>
+#include <cstring>
+
+#include "accel_model.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_time.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 16 * 1024;
+constexpr size_t kMaxOutputBytes = 64;
+alignas(16) uint8_t arena[kArenaSize];
+
+void FillInput(tflite::MicroInterpreter* interpreter, int seed) {
+  TfLiteTensor* input = interpreter->input(0);
+  const int count = static_cast<int>(input->bytes / sizeof(float));
+  for (int i = 0; i < count; ++i) {
+    input->data.f[i] = 0.25f * ((i * 7 + seed) % 11) - 1.0f;
+  }
+}
+
+// Runs `model` once with Invoke() and once in slices of one operator, and
+// compares the outputs.
+void TestStepsMatchInvoke(const tflite::Model* model) {
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TfLiteTensor* output = interpreter.output(0);
+  TF_LITE_MICRO_EXPECT(output->bytes <= kMaxOutputBytes);
+
+  for (int seed = 0; seed < 3; ++seed) {
+    FillInput(&interpreter, seed);
+    TF_LITE_MICRO_EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+    uint8_t expected[kMaxOutputBytes];
+    memcpy(expected, output->data.raw, output->bytes);
+    memset(output->data.raw, 0, output->bytes);
+
+    // A budget of 0 ticks runs one operator per call.
+    size_t steps = 0;
+    TfLiteStatus status;
+    do {
+      status = interpreter.InvokeStep(0);
+      ++steps;
+      TF_LITE_MICRO_EXPECT_EQ(
+          status == tflite::kTfLiteInvokeContinue,
+          interpreter.invoke_in_progress());
+    } while (status == tflite::kTfLiteInvokeContinue &&
+             steps <= interpreter.operators_size());
+    TF_LITE_MICRO_EXPECT_EQ(status, kTfLiteOk);
+    TF_LITE_MICRO_EXPECT_EQ(steps, interpreter.operators_size());
+    TF_LITE_MICRO_EXPECT_EQ(0,
+                            memcmp(expected, output->data.raw, output->bytes));
+
+    // With a timer, a budget the model can not use up completes it in one
+    // call.
+    if (tflite::ticks_per_second() != 0) {
+      memset(output->data.raw, 0, output->bytes);
+      TF_LITE_MICRO_EXPECT_EQ(interpreter.InvokeStep(INT32_MAX), kTfLiteOk);
+      TF_LITE_MICRO_EXPECT(!interpreter.invoke_in_progress());
+      TF_LITE_MICRO_EXPECT_EQ(
+          0, memcmp(expected, output->data.raw, output->bytes));
+    }
+  }
+}
+
+// Runs `model` in slices with a budget that is never used up, as on a
+// platform without a timer.
+void TestOneOperatorPerStep(const tflite::Model* model) {
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(interpreter.operators_size() > 1);
+
+  FillInput(&interpreter, 2);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.InvokeStep(INT32_MAX),
+                          tflite::kTfLiteInvokeContinue);
+  TF_LITE_MICRO_EXPECT(interpreter.invoke_in_progress());
+  size_t steps = 1;
+  while (interpreter.InvokeStep(INT32_MAX) == tflite::kTfLiteInvokeContinue &&
+         steps <= interpreter.operators_size()) {
+    ++steps;
+  }
+  TF_LITE_MICRO_EXPECT_EQ(steps + 1, interpreter.operators_size());
+  TF_LITE_MICRO_EXPECT(!interpreter.invoke_in_progress());
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestInvokeStepMatchesInvokeOnAccelModel) {
+  TestStepsMatchInvoke(tflite::GetModel(g_model));
+}
+
+TF_LITE_MICRO_TEST(TestInvokeStepMatchesInvokeOnConvModel) {
+  TestStepsMatchInvoke(tflite::GetModel(kTestConvModelData));
+}
+
+TF_LITE_MICRO_TEST(TestInvokeStepWithoutTimerRunsOneOperator) {
+  // The reference GetCurrentTimeTicks() of a host build always returns 0, so
+  // no budget is ever used up. Each call must still yield after one operator.
+  if (tflite::ticks_per_second() == 0) {
+    TestOneOperatorPerStep(tflite::GetModel(g_model));
+  }
+}
+
+TF_LITE_MICRO_TEST(TestInvokeDiscardsPartialRun) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TfLiteTensor* output = interpreter.output(0);
+
+  FillInput(&interpreter, 1);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+  uint8_t expected[kMaxOutputBytes];
+  memcpy(expected, output->data.raw, output->bytes);
+
+  // Stops a run half way, then runs the same input again from the start.
+  FillInput(&interpreter, 1);
+  for (size_t i = 0; i < interpreter.operators_size() / 2; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(interpreter.InvokeStep(0),
+                            tflite::kTfLiteInvokeContinue);
+  }
+  TF_LITE_MICRO_EXPECT(interpreter.invoke_in_progress());
+  memset(output->data.raw, 0, output->bytes);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(!interpreter.invoke_in_progress());
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, output->data.raw, output->bytes));
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,168 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that InvokeTarget() computes the target tensor exactly as a full
+// run does, without running the operators after it.
+
+#include <cstdint>
+#include <cstring>
+
+#include "accel_model.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 16 * 1024;
+constexpr size_t kMaxTargetBytes = 2048;
+constexpr size_t kMaxOutputBytes = 64;
+alignas(16) uint8_t target_arena[kArenaSize];
+alignas(16) uint8_t full_arena[kArenaSize];
+
+// The output of the third TANH of the accelerometer autoencoder, the
+// bottleneck between its 6 encoder and 3 decoder operators.
+constexpr int kAccelLatentTensor = 16;
+// The MAX_POOL_2D output of the conv model, written by its fourth operator.
+constexpr int kConvPoolTensor = 10;
+
+void FillInput(tflite::MicroInterpreter* interpreter, int seed) {
+  TfLiteTensor* input = interpreter->input(0);
+  const int count = static_cast<int>(input->bytes / sizeof(float));
+  for (int i = 0; i < count; ++i) {
+    input->data.f[i] = 0.25f * ((i * 7 + seed) % 11) - 1.0f;
+  }
+}
+
+// Returns the number of operators up to and including the one writing
+// `tensor`, which a chain of operators runs before the tensor is complete.
+size_t ProducerSteps(const tflite::Model* model, int tensor) {
+  const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+  for (size_t i = 0; i < subgraph->operators()->size(); ++i) {
+    const auto* outputs = subgraph->operators()->Get(i)->outputs();
+    for (size_t o = 0; o < outputs->size(); ++o) {
+      if (outputs->Get(o) == tensor) {
+        return i + 1;
+      }
+    }
+  }
+  return 0;
+}
+
+// Runs the encoder of `model` up to `target` with InvokeTarget(), and compares
+// the target with the tensor a full run produces. The full run is stopped
+// with InvokeStep() right after the target is written, since later operators
+// may reuse its memory.
+void TestTargetMatchesFullRun(const tflite::Model* model, int target) {
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, target_arena,
+                                       kArenaSize, micro_test::reporter);
+  tflite::MicroInterpreter full(model, op_resolver, full_arena, kArenaSize,
+                                micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.SetTargetTensor(target), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(full.AllocateTensors(), kTfLiteOk);
+
+  // Only the operators of the encoder are left in the pruned plan.
+  const size_t steps = ProducerSteps(model, target);
+  TF_LITE_MICRO_EXPECT(steps > 0);
+  TF_LITE_MICRO_EXPECT(steps < interpreter.operators_size());
+  TF_LITE_MICRO_EXPECT_EQ(steps, interpreter.target_operators_size());
+
+  const TfLiteEvalTensor* latent = interpreter.target_eval_tensor();
+  TF_LITE_MICRO_EXPECT(latent == interpreter.eval_tensor(target));
+  size_t latent_bytes = 0;
+  TF_LITE_MICRO_EXPECT_EQ(
+      tflite::TfLiteEvalTensorByteLength(latent, &latent_bytes), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(latent_bytes <= kMaxTargetBytes);
+
+  for (int seed = 0; seed < 3; ++seed) {
+    FillInput(&interpreter, seed);
+    FillInput(&full, seed);
+    TF_LITE_MICRO_EXPECT_EQ(interpreter.InvokeTarget(), kTfLiteOk);
+    for (size_t i = 0; i < steps; ++i) {
+      TF_LITE_MICRO_EXPECT_EQ(full.InvokeStep(0),
+                              tflite::kTfLiteInvokeContinue);
+    }
+    TF_LITE_MICRO_EXPECT_EQ(
+        0, memcmp(latent->data.data, full.eval_tensor(target)->data.data,
+                  latent_bytes));
+    // Finishes the full run before the next input is written.
+    TF_LITE_MICRO_EXPECT_EQ(full.Invoke(), kTfLiteOk);
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestInvokeTargetMatchesInvokeOnAccelModel) {
+  TestTargetMatchesFullRun(tflite::GetModel(g_model), kAccelLatentTensor);
+}
+
+TF_LITE_MICRO_TEST(TestInvokeTargetMatchesInvokeOnConvModel) {
+  TestTargetMatchesFullRun(tflite::GetModel(kTestConvModelData),
+                           kConvPoolTensor);
+}
+
+TF_LITE_MICRO_TEST(TestInvokeAfterInvokeTargetRunsEverything) {
+  const tflite::Model* model = tflite::GetModel(g_model);
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, target_arena,
+                                       kArenaSize, micro_test::reporter);
+  tflite::MicroInterpreter full(model, op_resolver, full_arena, kArenaSize,
+                                micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.SetTargetTensor(kAccelLatentTensor),
+                          kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(full.AllocateTensors(), kTfLiteOk);
+  TfLiteTensor* output = interpreter.output(0);
+  TF_LITE_MICRO_EXPECT(output->bytes <= kMaxOutputBytes);
+
+  FillInput(&full, 4);
+  TF_LITE_MICRO_EXPECT_EQ(full.Invoke(), kTfLiteOk);
+
+  // A partial InvokeStep() run is discarded by InvokeTarget(), and the
+  // targeted interpreter still runs the whole model on Invoke().
+  FillInput(&interpreter, 4);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.InvokeStep(0),
+                          tflite::kTfLiteInvokeContinue);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.InvokeTarget(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(!interpreter.invoke_in_progress());
+  memset(output->data.raw, 0, output->bytes);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(
+      0, memcmp(full.output(0)->data.raw, output->data.raw, output->bytes));
+}
+
+TF_LITE_MICRO_TEST(TestInvokeTargetNeedsTarget) {
+  const tflite::Model* model = tflite::GetModel(g_model);
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, target_arena,
+                                       kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(
+      interpreter.SetTargetTensor(
+          static_cast<int>(model->subgraphs()->Get(0)->tensors()->size())),
+      kTfLiteError);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(interpreter.target_eval_tensor() == nullptr);
+  TF_LITE_MICRO_EXPECT_EQ(0, static_cast<int>(
+                                 interpreter.target_operators_size()));
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.InvokeTarget(), kTfLiteError);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,117 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that the input, output and tensor accessors of MicroInterpreter do
+// not take arena memory when they are called again.
+
+#include <cstdint>
+
+#include "accel_model.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+constexpr int kRepeats = 100;
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestIoAccessorsDoNotGrowArena) {
+  const tflite::Model* model = tflite::testing::GetSimpleMultipleInputsModel();
+  TF_LITE_MICRO_EXPECT_NE(nullptr, model);
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+
+  constexpr size_t allocator_buffer_size = 2048;
+  alignas(16) uint8_t allocator_buffer[allocator_buffer_size];
+  tflite::MicroInterpreter interpreter(model, op_resolver, allocator_buffer,
+                                       allocator_buffer_size,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(3), interpreter.inputs_size());
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(1), interpreter.outputs_size());
+
+  // The first call for an input or output allocates its TfLiteTensor.
+  TfLiteTensor* inputs[3];
+  for (size_t i = 0; i < interpreter.inputs_size(); ++i) {
+    inputs[i] = interpreter.input(i);
+    TF_LITE_MICRO_EXPECT_NE(nullptr, inputs[i]);
+  }
+  TfLiteTensor* output = interpreter.output(0);
+  TF_LITE_MICRO_EXPECT_NE(nullptr, output);
+
+  const size_t used_bytes = interpreter.arena_used_bytes();
+  for (int repeat = 0; repeat < kRepeats; ++repeat) {
+    for (size_t i = 0; i < interpreter.inputs_size(); ++i) {
+      TF_LITE_MICRO_EXPECT(inputs[i] == interpreter.input(i));
+      TfLiteEvalTensor* eval_tensor = interpreter.input_eval_tensor(i);
+      TF_LITE_MICRO_EXPECT_NE(nullptr, eval_tensor);
+      TF_LITE_MICRO_EXPECT(inputs[i]->data.raw == eval_tensor->data.raw);
+    }
+    TF_LITE_MICRO_EXPECT(output == interpreter.output(0));
+    TF_LITE_MICRO_EXPECT(output->data.raw ==
+                         interpreter.output_eval_tensor(0)->data.raw);
+    TF_LITE_MICRO_EXPECT(interpreter.typed_input<int32_t>(0).valid());
+    TF_LITE_MICRO_EXPECT(interpreter.typed_input<int8_t>(1).valid());
+    TF_LITE_MICRO_EXPECT(interpreter.typed_output<int32_t>(0).valid());
+  }
+  TF_LITE_MICRO_EXPECT_EQ(used_bytes, interpreter.arena_used_bytes());
+
+  // Views of the wrong type are invalid instead of reinterpreting the data.
+  TF_LITE_MICRO_EXPECT(!interpreter.typed_input<float>(0).valid());
+  TF_LITE_MICRO_EXPECT(interpreter.input(3) == nullptr);
+  TF_LITE_MICRO_EXPECT(interpreter.input_eval_tensor(3) == nullptr);
+}
+
+TF_LITE_MICRO_TEST(TestTensorIsAllocatedOnlyOnFirstCall) {
+  const tflite::Model* model = tflite::GetModel(g_model);
+  tflite::AllOpsResolver op_resolver;
+
+  constexpr size_t allocator_buffer_size = 8192;
+  alignas(16) uint8_t allocator_buffer[allocator_buffer_size];
+  tflite::MicroInterpreter interpreter(model, op_resolver, allocator_buffer,
+                                       allocator_buffer_size,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // eval_tensor() never allocates.
+  const size_t allocated_bytes = interpreter.arena_used_bytes();
+  for (int repeat = 0; repeat < kRepeats; ++repeat) {
+    for (size_t i = 0; i < interpreter.tensors_size(); ++i) {
+      TF_LITE_MICRO_EXPECT_NE(nullptr, interpreter.eval_tensor(i));
+    }
+  }
+  TF_LITE_MICRO_EXPECT_EQ(allocated_bytes, interpreter.arena_used_bytes());
+
+  // tensor() allocates a TfLiteTensor once per index and caches it.
+  TfLiteTensor* tensors[32];
+  TF_LITE_MICRO_EXPECT(interpreter.tensors_size() <= 32);
+  for (size_t i = 0; i < interpreter.tensors_size(); ++i) {
+    tensors[i] = interpreter.tensor(i);
+    TF_LITE_MICRO_EXPECT_NE(nullptr, tensors[i]);
+  }
+  const size_t cached_bytes = interpreter.arena_used_bytes();
+  for (int repeat = 0; repeat < kRepeats; ++repeat) {
+    for (size_t i = 0; i < interpreter.tensors_size(); ++i) {
+      TF_LITE_MICRO_EXPECT(tensors[i] == interpreter.tensor(i));
+    }
+    TF_LITE_MICRO_EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(cached_bytes, interpreter.arena_used_bytes());
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,271 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks where MicroInterpreter::SetWeightPlacement() puts constant tensors,
+// and that placing them does not change the outputs.
+
+#include <cstdint>
+#include <cstring>
+
+#include "accel_model.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 16 * 1024;
+constexpr size_t kMaxOutputBytes = 64;
+constexpr size_t kNoLimit = 1 << 20;
+
+alignas(16) uint8_t arena[kArenaSize];
+alignas(16) uint8_t clone_arena[kArenaSize];
+// Rank 0 stands for internal SRAM, rank 1 for PSRAM.
+alignas(16) uint8_t fast_tier[8 * 1024];
+alignas(16) uint8_t slow_tier[32 * 1024];
+
+void FillInput(tflite::MicroInterpreter* interpreter) {
+  TfLiteTensor* input = interpreter->input(0);
+  const int count = static_cast<int>(input->bytes / sizeof(float));
+  for (int i = 0; i < count; ++i) {
+    input->data.f[i] = 0.125f * ((i * 5 + 3) % 17) - 1.0f;
+  }
+}
+
+// Runs `model` without memory tiers and stores its output in `expected`.
+size_t RunUntiered(const tflite::Model* model, uint8_t* expected) {
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  FillInput(&interpreter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+  const TfLiteTensor* output = interpreter.output(0);
+  TF_LITE_MICRO_EXPECT(output->bytes <= kMaxOutputBytes);
+  memcpy(expected, output->data.raw, output->bytes);
+  return output->bytes;
+}
+
+bool IsInBuffer(const void* data, const uint8_t* buffer, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  return bytes >= buffer && bytes < buffer + size;
+}
+
+size_t ByteLength(tflite::MicroInterpreter* interpreter, size_t index) {
+  size_t bytes = 0;
+  TF_LITE_MICRO_EXPECT_EQ(
+      tflite::TfLiteEvalTensorByteLength(interpreter->eval_tensor(index),
+                                         &bytes),
+      kTfLiteOk);
+  return bytes;
+}
+
+// Checks the placement of every tensor. Tensors are placed smallest first,
+// so every tensor in the fast tier is at most as large as every tensor in
+// the slow tier, and those are at most as large as every constant tensor of
+// at most `max_resident_bytes` that stayed in the model.
+void ExpectPlacement(tflite::MicroInterpreter* interpreter,
+                     size_t max_resident_bytes, int* placed_count) {
+  size_t largest[2] = {0, 0};
+  size_t smallest[3] = {kNoLimit, kNoLimit, kNoLimit};
+  *placed_count = 0;
+  for (size_t i = 0; i < interpreter->tensors_size(); ++i) {
+    const int placement = interpreter->weight_placement(i);
+    const size_t bytes = ByteLength(interpreter, i);
+    const void* data = interpreter->eval_tensor(i)->data.data;
+    if (placement == 0 || placement == 1) {
+      ++*placed_count;
+      TF_LITE_MICRO_EXPECT(bytes <= max_resident_bytes);
+      if (placement == 0) {
+        TF_LITE_MICRO_EXPECT(IsInBuffer(data, fast_tier, sizeof(fast_tier)));
+      } else {
+        TF_LITE_MICRO_EXPECT(IsInBuffer(data, slow_tier, sizeof(slow_tier)));
+      }
+      if (bytes > largest[placement]) {
+        largest[placement] = bytes;
+      }
+      if (bytes < smallest[placement]) {
+        smallest[placement] = bytes;
+      }
+    } else if (placement == tflite::kConstantTensorInModel) {
+      TF_LITE_MICRO_EXPECT(!IsInBuffer(data, fast_tier, sizeof(fast_tier)));
+      TF_LITE_MICRO_EXPECT(!IsInBuffer(data, slow_tier, sizeof(slow_tier)));
+      if (bytes <= max_resident_bytes && bytes < smallest[2]) {
+        smallest[2] = bytes;
+      }
+    } else {
+      TF_LITE_MICRO_EXPECT(placement == tflite::kNotConstantTensor ||
+                           placement == tflite::kConstantTensorPrefetched);
+    }
+  }
+  TF_LITE_MICRO_EXPECT(largest[0] <= smallest[1]);
+  TF_LITE_MICRO_EXPECT(largest[0] <= smallest[2]);
+  TF_LITE_MICRO_EXPECT(largest[1] <= smallest[2]);
+}
+
+void ExpectOutput(tflite::MicroInterpreter* interpreter,
+                  const uint8_t* expected, size_t bytes) {
+  FillInput(interpreter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const TfLiteTensor* output = interpreter->output(0);
+  TF_LITE_MICRO_EXPECT_EQ(bytes, output->bytes);
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, output->data.raw, bytes));
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestAccelWeightsFitInFastTier) {
+  const tflite::Model* model = tflite::GetModel(g_model);
+  uint8_t expected[kMaxOutputBytes];
+  const size_t output_bytes = RunUntiered(model, expected);
+
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(
+      interpreter.AddMemoryTier(slow_tier, sizeof(slow_tier), 1), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(
+      interpreter.AddMemoryTier(fast_tier, sizeof(fast_tier), 0), kTfLiteOk);
+  interpreter.SetWeightPlacement(kNoLimit, 0);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // All weights are small enough for the fast tier.
+  for (size_t i = 0; i < interpreter.tensors_size(); ++i) {
+    const int placement = interpreter.weight_placement(i);
+    TF_LITE_MICRO_EXPECT(placement == 0 ||
+                         placement == tflite::kNotConstantTensor);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(tflite::kNotConstantTensor,
+                          interpreter.weight_placement(0));
+  int placed_count;
+  ExpectPlacement(&interpreter, kNoLimit, &placed_count);
+  TF_LITE_MICRO_EXPECT(placed_count > 0);
+  ExpectOutput(&interpreter, expected, output_bytes);
+
+  // A clone shares the placed weights.
+  tflite::MicroInterpreter* clone =
+      interpreter.Clone(clone_arena, kArenaSize);
+  TF_LITE_MICRO_EXPECT_NE(nullptr, clone);
+  if (clone != nullptr) {
+    for (size_t i = 0; i < interpreter.tensors_size(); ++i) {
+      TF_LITE_MICRO_EXPECT_EQ(interpreter.weight_placement(i),
+                              clone->weight_placement(i));
+    }
+    ExpectOutput(clone, expected, output_bytes);
+  }
+}
+
+TF_LITE_MICRO_TEST(TestFastTierFillsSmallestFirst) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  uint8_t expected[kMaxOutputBytes];
+  const size_t output_bytes = RunUntiered(model, expected);
+
+  // The fast tier holds only the smallest weights of the conv model, the
+  // rest spill over into the slow tier.
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AddMemoryTier(fast_tier, 256, 0),
+                          kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(
+      interpreter.AddMemoryTier(slow_tier, sizeof(slow_tier), 1), kTfLiteOk);
+  interpreter.SetWeightPlacement(kNoLimit, 0);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  int fast_count = 0;
+  int slow_count = 0;
+  for (size_t i = 0; i < interpreter.tensors_size(); ++i) {
+    const int placement = interpreter.weight_placement(i);
+    fast_count += placement == 0 ? 1 : 0;
+    slow_count += placement == 1 ? 1 : 0;
+    TF_LITE_MICRO_EXPECT(placement != tflite::kConstantTensorInModel);
+  }
+  TF_LITE_MICRO_EXPECT(fast_count > 0);
+  TF_LITE_MICRO_EXPECT(slow_count > 0);
+  int placed_count;
+  ExpectPlacement(&interpreter, kNoLimit, &placed_count);
+  ExpectOutput(&interpreter, expected, output_bytes);
+}
+
+TF_LITE_MICRO_TEST(TestLargeWeightsStayInModel) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  uint8_t expected[kMaxOutputBytes];
+  const size_t output_bytes = RunUntiered(model, expected);
+
+  constexpr size_t kMaxResidentBytes = 1024;
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(
+      interpreter.AddMemoryTier(fast_tier, sizeof(fast_tier), 0), kTfLiteOk);
+  interpreter.SetWeightPlacement(kMaxResidentBytes, 0);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  int in_model_count = 0;
+  for (size_t i = 0; i < interpreter.tensors_size(); ++i) {
+    if (interpreter.weight_placement(i) == tflite::kConstantTensorInModel) {
+      ++in_model_count;
+      TF_LITE_MICRO_EXPECT(ByteLength(&interpreter, i) > kMaxResidentBytes);
+    }
+  }
+  TF_LITE_MICRO_EXPECT(in_model_count > 0);
+  int placed_count;
+  ExpectPlacement(&interpreter, kMaxResidentBytes, &placed_count);
+  TF_LITE_MICRO_EXPECT(placed_count > 0);
+  ExpectOutput(&interpreter, expected, output_bytes);
+}
+
+TF_LITE_MICRO_TEST(TestPrefetchedWeights) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  uint8_t expected[kMaxOutputBytes];
+  const size_t output_bytes = RunUntiered(model, expected);
+
+  // The staging buffer holds the 3x3x32x16 filter of the second convolution,
+  // but not the 11520 byte weights of the fully connected layer.
+  constexpr size_t kPrefetchBytes = 4608;
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(
+      interpreter.AddMemoryTier(fast_tier, sizeof(fast_tier), 0), kTfLiteOk);
+  interpreter.SetWeightPlacement(512, kPrefetchBytes);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  int prefetched_count = 0;
+  for (size_t i = 0; i < interpreter.tensors_size(); ++i) {
+    const int placement = interpreter.weight_placement(i);
+    const size_t bytes = ByteLength(&interpreter, i);
+    if (placement == tflite::kConstantTensorPrefetched) {
+      ++prefetched_count;
+      TF_LITE_MICRO_EXPECT(bytes > 512);
+      TF_LITE_MICRO_EXPECT(bytes <= kPrefetchBytes);
+    } else if (placement == tflite::kConstantTensorInModel) {
+      TF_LITE_MICRO_EXPECT(bytes > kPrefetchBytes);
+    }
+  }
+  TF_LITE_MICRO_EXPECT(prefetched_count > 0);
+  ExpectOutput(&interpreter, expected, output_bytes);
+  // Runs again, now that the staging buffer holds the last weights copied.
+  ExpectOutput(&interpreter, expected, output_bytes);
+
+  TF_LITE_MICRO_EXPECT(interpreter.Clone(clone_arena, kArenaSize) == nullptr);
+}
+
+TF_LITE_MICRO_TESTS_END
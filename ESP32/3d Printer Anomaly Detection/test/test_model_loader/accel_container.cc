@@ -0,0 +1,417 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "accel_container.h"
+
+alignas(16) const unsigned char kAccelContainer[] = {
+    0x54, 0x46, 0x4d, 0x4d, 0x01, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00,
+    0x58, 0x0b, 0x00, 0x00, 0xeb, 0x32, 0x9f, 0x18, 0x02, 0x00, 0x00, 0x00,
+    0x58, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00,
+    0x54, 0x46, 0x4c, 0x33, 0x14, 0x00, 0x20, 0x00, 0x04, 0x00, 0x08, 0x00,
+    0x0c, 0x00, 0x10, 0x00, 0x14, 0x00, 0x00, 0x00, 0x18, 0x00, 0x1c, 0x00,
+    0x14, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,
+    0x20, 0x00, 0x00, 0x00, 0xd4, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00,
+    0x7c, 0x00, 0x00, 0x00, 0x74, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x10, 0x06, 0x00, 0x00, 0x60, 0x05, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0xd8, 0x00, 0x00, 0x00, 0x16, 0x00, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00,
+    0xfc, 0x0a, 0x00, 0x00, 0x1c, 0x0a, 0x00, 0x00, 0xa0, 0x09, 0x00, 0x00,
+    0x34, 0x09, 0x00, 0x00, 0xc4, 0x08, 0x00, 0x00, 0x50, 0x08, 0x00, 0x00,
+    0xdc, 0x07, 0x00, 0x00, 0x70, 0x07, 0x00, 0x00, 0x14, 0x07, 0x00, 0x00,
+    0xb8, 0x06, 0x00, 0x00, 0x4c, 0x06, 0x00, 0x00, 0xd0, 0x0a, 0x00, 0x00,
+    0xcc, 0x0a, 0x00, 0x00, 0xc8, 0x0a, 0x00, 0x00, 0xc4, 0x0a, 0x00, 0x00,
+    0xc0, 0x0a, 0x00, 0x00, 0xbc, 0x0a, 0x00, 0x00, 0xb8, 0x0a, 0x00, 0x00,
+    0xb4, 0x0a, 0x00, 0x00, 0xb0, 0x0a, 0x00, 0x00, 0x3c, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x0c, 0x00, 0x04, 0x00, 0x08, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00,
+    0x6d, 0x69, 0x6e, 0x5f, 0x72, 0x75, 0x6e, 0x74, 0x69, 0x6d, 0x65, 0x5f,
+    0x76, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x00, 0x72, 0xf6, 0xff, 0xff,
+    0x04, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x31, 0x2e, 0x31, 0x34,
+    0x2e, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0f, 0x00, 0x00, 0x00, 0x4d, 0x4c, 0x49, 0x52, 0x20, 0x43, 0x6f, 0x6e,
+    0x76, 0x65, 0x72, 0x74, 0x65, 0x64, 0x2e, 0x00, 0x00, 0x00, 0x0e, 0x00,
+    0x18, 0x00, 0x04, 0x00, 0x08, 0x00, 0x0c, 0x00, 0x10, 0x00, 0x14, 0x00,
+    0x0e, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00,
+    0x68, 0x00, 0x00, 0x00, 0x6c, 0x00, 0x00, 0x00, 0x90, 0x00, 0x00, 0x00,
+    0x14, 0x00, 0x00, 0x00, 0xcc, 0x09, 0x00, 0x00, 0x5c, 0x09, 0x00, 0x00,
+    0xcc, 0x08, 0x00, 0x00, 0x5c, 0x08, 0x00, 0x00, 0xf0, 0x07, 0x00, 0x00,
+    0x80, 0x07, 0x00, 0x00, 0x24, 0x07, 0x00, 0x00, 0xac, 0x06, 0x00, 0x00,
+    0x40, 0x06, 0x00, 0x00, 0xe4, 0x05, 0x00, 0x00, 0x88, 0x05, 0x00, 0x00,
+    0xf4, 0x04, 0x00, 0x00, 0x44, 0x04, 0x00, 0x00, 0x94, 0x03, 0x00, 0x00,
+    0x10, 0x03, 0x00, 0x00, 0x7c, 0x02, 0x00, 0x00, 0xf8, 0x01, 0x00, 0x00,
+    0x64, 0x01, 0x00, 0x00, 0xe0, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x13, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x70, 0x04, 0x00, 0x00,
+    0xdc, 0x03, 0x00, 0x00, 0x2c, 0x03, 0x00, 0x00, 0xb8, 0x02, 0x00, 0x00,
+    0x14, 0x02, 0x00, 0x00, 0xa0, 0x01, 0x00, 0x00, 0xfc, 0x00, 0x00, 0x00,
+    0x88, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x6d, 0x61, 0x69, 0x6e, 0x00, 0x00, 0x00, 0x00, 0xce, 0xfb, 0xff, 0xff,
+    0x00, 0x00, 0x00, 0x08, 0x18, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x98, 0xf6, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00,
+    0x13, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00,
+    0x0a, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x0c, 0xf7, 0xff, 0xff,
+    0x14, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,
+    0x30, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x49, 0x64, 0x65, 0x6e, 0x74, 0x69, 0x74, 0x79, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00,
+    0xf4, 0xf6, 0xff, 0xff, 0xce, 0xfc, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x12, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00,
+    0x70, 0xf7, 0xff, 0xff, 0x14, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00,
+    0x18, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x00, 0x00, 0x2c, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x17, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69,
+    0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65, 0x5f, 0x33, 0x2f, 0x54,
+    0x61, 0x6e, 0x68, 0x00, 0x02, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+    0x02, 0x00, 0x00, 0x00, 0x64, 0xf7, 0xff, 0xff, 0xb2, 0xfc, 0xff, 0xff,
+    0x00, 0x00, 0x00, 0x08, 0x18, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x7c, 0xf7, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00,
+    0x11, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x09, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0xf0, 0xf7, 0xff, 0xff,
+    0x14, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,
+    0x5c, 0x00, 0x00, 0x00, 0x4c, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x34, 0x00, 0x00, 0x00,
+    0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64,
+    0x65, 0x6e, 0x73, 0x65, 0x5f, 0x33, 0x2f, 0x4d, 0x61, 0x74, 0x4d, 0x75,
+    0x6c, 0x3b, 0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c,
+    0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65, 0x5f, 0x33, 0x2f, 0x42, 0x69, 0x61,
+    0x73, 0x41, 0x64, 0x64, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0xff, 0xff, 0xff, 0xff, 0x02, 0x00, 0x00, 0x00, 0x04, 0xf8, 0xff, 0xff,
+    0xde, 0xfd, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x80, 0xf8, 0xff, 0xff,
+    0x14, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,
+    0x3c, 0x00, 0x00, 0x00, 0x2c, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00,
+    0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64,
+    0x65, 0x6e, 0x73, 0x65, 0x5f, 0x32, 0x2f, 0x54, 0x61, 0x6e, 0x68, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00,
+    0x74, 0xf8, 0xff, 0xff, 0xc2, 0xfd, 0xff, 0xff, 0x00, 0x00, 0x00, 0x08,
+    0x18, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x8c, 0xf8, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x00, 0xf9, 0xff, 0xff, 0x14, 0x00, 0x00, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x5c, 0x00, 0x00, 0x00,
+    0x4c, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x34, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75,
+    0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65,
+    0x5f, 0x32, 0x2f, 0x4d, 0x61, 0x74, 0x4d, 0x75, 0x6c, 0x3b, 0x73, 0x65,
+    0x71, 0x75, 0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e,
+    0x73, 0x65, 0x5f, 0x32, 0x2f, 0x42, 0x69, 0x61, 0x73, 0x41, 0x64, 0x64,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+    0x01, 0x00, 0x00, 0x00, 0x14, 0xf9, 0xff, 0xff, 0xee, 0xfe, 0xff, 0xff,
+    0x01, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x0d, 0x00, 0x00, 0x00, 0x90, 0xf9, 0xff, 0xff, 0x14, 0x00, 0x00, 0x00,
+    0x0f, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x00, 0x00,
+    0x2c, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75,
+    0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65,
+    0x5f, 0x31, 0x2f, 0x54, 0x61, 0x6e, 0x68, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0xff, 0xff, 0xff, 0xff, 0x02, 0x00, 0x00, 0x00, 0x84, 0xf9, 0xff, 0xff,
+    0xd2, 0xfe, 0xff, 0xff, 0x00, 0x00, 0x00, 0x08, 0x18, 0x00, 0x00, 0x00,
+    0x0c, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x9c, 0xf9, 0xff, 0xff,
+    0x01, 0x00, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x0c, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x10, 0xfa, 0xff, 0xff, 0x14, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00,
+    0x18, 0x00, 0x00, 0x00, 0x5c, 0x00, 0x00, 0x00, 0x4c, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x34, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69,
+    0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65, 0x5f, 0x31, 0x2f, 0x4d,
+    0x61, 0x74, 0x4d, 0x75, 0x6c, 0x3b, 0x73, 0x65, 0x71, 0x75, 0x65, 0x6e,
+    0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65, 0x5f, 0x31,
+    0x2f, 0x42, 0x69, 0x61, 0x73, 0x41, 0x64, 0x64, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x02, 0x00, 0x00, 0x00,
+    0x0c, 0xfb, 0xff, 0xff, 0x00, 0x00, 0x0a, 0x00, 0x10, 0x00, 0x04, 0x00,
+    0x08, 0x00, 0x0c, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x0c, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00,
+    0x60, 0xff, 0xff, 0xff, 0x1c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1c,
+    0x01, 0x00, 0x00, 0x00, 0xbc, 0xfa, 0xff, 0xff, 0x14, 0x00, 0x00, 0x00,
+    0x0d, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x00, 0x00,
+    0x2c, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75,
+    0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65,
+    0x2f, 0x54, 0x61, 0x6e, 0x68, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0xff, 0xff, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00, 0x98, 0xfb, 0xff, 0xff,
+    0x00, 0x00, 0x0e, 0x00, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x0c, 0x00,
+    0x07, 0x00, 0x10, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+    0x18, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0xd8, 0xfa, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x10, 0x00, 0x0b, 0x00, 0x00, 0x00,
+    0x0c, 0x00, 0x04, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x09, 0x01, 0x00, 0x00, 0x00, 0x68, 0xfb, 0xff, 0xff,
+    0x14, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,
+    0x58, 0x00, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00,
+    0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64,
+    0x65, 0x6e, 0x73, 0x65, 0x2f, 0x4d, 0x61, 0x74, 0x4d, 0x75, 0x6c, 0x3b,
+    0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64,
+    0x65, 0x6e, 0x73, 0x65, 0x2f, 0x42, 0x69, 0x61, 0x73, 0x41, 0x64, 0x64,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+    0x03, 0x00, 0x00, 0x00, 0x78, 0xfb, 0xff, 0xff, 0x5a, 0xfc, 0xff, 0xff,
+    0x04, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0xa7, 0xd0, 0x79, 0x3e,
+    0x61, 0x14, 0x85, 0x3e, 0xcb, 0xd9, 0xa9, 0x3f, 0x02, 0x08, 0x2b, 0xbf,
+    0xfa, 0x69, 0x4c, 0x3f, 0x81, 0x01, 0x80, 0x3f, 0x5e, 0xfc, 0xff, 0xff,
+    0x10, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00,
+    0x30, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x19, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75,
+    0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65,
+    0x5f, 0x34, 0x2f, 0x4d, 0x61, 0x74, 0x4d, 0x75, 0x6c, 0x00, 0x00, 0x00,
+    0xe0, 0xfb, 0xff, 0xff, 0xc2, 0xfc, 0xff, 0xff, 0x04, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x68, 0xf8, 0x85, 0xbf, 0xa7, 0xec, 0x9c, 0x3f,
+    0xb6, 0xfc, 0xff, 0xff, 0x10, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00,
+    0x14, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x19, 0x00, 0x00, 0x00,
+    0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64,
+    0x65, 0x6e, 0x73, 0x65, 0x5f, 0x33, 0x2f, 0x4d, 0x61, 0x74, 0x4d, 0x75,
+    0x6c, 0x00, 0x00, 0x00, 0x38, 0xfc, 0xff, 0xff, 0x1a, 0xfd, 0xff, 0xff,
+    0x04, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x4d, 0xbb, 0x3d, 0x3f,
+    0xd8, 0xde, 0x5b, 0xbb, 0x0e, 0xfd, 0xff, 0xff, 0x10, 0x00, 0x00, 0x00,
+    0x09, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x19, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69,
+    0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65, 0x5f, 0x32, 0x2f, 0x4d,
+    0x61, 0x74, 0x4d, 0x75, 0x6c, 0x00, 0x00, 0x00, 0x90, 0xfc, 0xff, 0xff,
+    0x72, 0xfd, 0xff, 0xff, 0x04, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,
+    0xde, 0x81, 0x11, 0xbd, 0x48, 0xb9, 0x10, 0x3f, 0x18, 0x17, 0x30, 0x3e,
+    0x58, 0xf4, 0x20, 0xbf, 0x44, 0x05, 0xe4, 0xbe, 0x69, 0xde, 0xb7, 0xbe,
+    0x76, 0xfd, 0xff, 0xff, 0x10, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x14, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x19, 0x00, 0x00, 0x00,
+    0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64,
+    0x65, 0x6e, 0x73, 0x65, 0x5f, 0x31, 0x2f, 0x4d, 0x61, 0x74, 0x4d, 0x75,
+    0x6c, 0x00, 0x00, 0x00, 0xf8, 0xfc, 0xff, 0xff, 0xda, 0xfd, 0xff, 0xff,
+    0x04, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x76, 0x7a, 0x9a, 0x3f,
+    0x31, 0x21, 0x76, 0x3f, 0x79, 0x63, 0x01, 0xbe, 0xd7, 0x34, 0x55, 0x3e,
+    0x0d, 0xe1, 0x95, 0xbf, 0xf1, 0xcf, 0x0c, 0xbe, 0x2b, 0xc3, 0x0d, 0xbf,
+    0x14, 0x9f, 0xba, 0xbe, 0x8c, 0x8d, 0x07, 0x3f, 0xea, 0xfd, 0xff, 0xff,
+    0x10, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00,
+    0x2c, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75,
+    0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65,
+    0x2f, 0x4d, 0x61, 0x74, 0x4d, 0x75, 0x6c, 0x00, 0x68, 0xfd, 0xff, 0xff,
+    0x4a, 0xfe, 0xff, 0xff, 0x04, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00,
+    0x05, 0x3a, 0xe2, 0xbd, 0xcc, 0x38, 0x77, 0x3e, 0xd1, 0x13, 0x9d, 0x3e,
+    0x42, 0xfe, 0xff, 0xff, 0x10, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x32, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75,
+    0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65,
+    0x5f, 0x34, 0x2f, 0x42, 0x69, 0x61, 0x73, 0x41, 0x64, 0x64, 0x2f, 0x52,
+    0x65, 0x61, 0x64, 0x56, 0x61, 0x72, 0x69, 0x61, 0x62, 0x6c, 0x65, 0x4f,
+    0x70, 0x2f, 0x72, 0x65, 0x73, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x00, 0x00,
+    0xd8, 0xfd, 0xff, 0xff, 0xba, 0xfe, 0xff, 0xff, 0x04, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x80, 0x6e, 0x88, 0x3e, 0x0f, 0x53, 0xd5, 0x3e,
+    0xae, 0xfe, 0xff, 0xff, 0x10, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x32, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75,
+    0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65,
+    0x5f, 0x33, 0x2f, 0x42, 0x69, 0x61, 0x73, 0x41, 0x64, 0x64, 0x2f, 0x52,
+    0x65, 0x61, 0x64, 0x56, 0x61, 0x72, 0x69, 0x61, 0x62, 0x6c, 0x65, 0x4f,
+    0x70, 0x2f, 0x72, 0x65, 0x73, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x00, 0x00,
+    0x44, 0xfe, 0xff, 0xff, 0x26, 0xff, 0xff, 0xff, 0x04, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0xb7, 0x36, 0x0e, 0x3e, 0x16, 0xff, 0xff, 0xff,
+    0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x44, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x32, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69,
+    0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65, 0x5f, 0x32, 0x2f, 0x42,
+    0x69, 0x61, 0x73, 0x41, 0x64, 0x64, 0x2f, 0x52, 0x65, 0x61, 0x64, 0x56,
+    0x61, 0x72, 0x69, 0x61, 0x62, 0x6c, 0x65, 0x4f, 0x70, 0x2f, 0x72, 0x65,
+    0x73, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x00, 0x00, 0xac, 0xfe, 0xff, 0xff,
+    0x8e, 0xff, 0xff, 0xff, 0x04, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0xbe, 0xe9, 0x95, 0x3d, 0xc8, 0x97, 0x89, 0x3d, 0x82, 0xff, 0xff, 0xff,
+    0x10, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x48, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x32, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69,
+    0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65, 0x5f, 0x31, 0x2f, 0x42,
+    0x69, 0x61, 0x73, 0x41, 0x64, 0x64, 0x2f, 0x52, 0x65, 0x61, 0x64, 0x56,
+    0x61, 0x72, 0x69, 0x61, 0x62, 0x6c, 0x65, 0x4f, 0x70, 0x2f, 0x72, 0x65,
+    0x73, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x00, 0x00, 0x04, 0x00, 0x06, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x08, 0x00, 0x04, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00,
+    0x30, 0x28, 0x44, 0x3d, 0xff, 0xcf, 0xac, 0xbd, 0xe2, 0x3a, 0x51, 0xbc,
+    0x00, 0x00, 0x0e, 0x00, 0x14, 0x00, 0x04, 0x00, 0x00, 0x00, 0x08, 0x00,
+    0x0c, 0x00, 0x10, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00,
+    0x73, 0x65, 0x71, 0x75, 0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x2f, 0x64,
+    0x65, 0x6e, 0x73, 0x65, 0x2f, 0x42, 0x69, 0x61, 0x73, 0x41, 0x64, 0x64,
+    0x2f, 0x52, 0x65, 0x61, 0x64, 0x56, 0x61, 0x72, 0x69, 0x61, 0x62, 0x6c,
+    0x65, 0x4f, 0x70, 0x2f, 0x72, 0x65, 0x73, 0x6f, 0x75, 0x72, 0x63, 0x65,
+    0x00, 0x00, 0x00, 0x00, 0xa4, 0xff, 0xff, 0xff, 0x14, 0x00, 0x18, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x08, 0x00, 0x0c, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x14, 0x00, 0x14, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00,
+    0x20, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x64, 0x65, 0x6e, 0x73,
+    0x65, 0x5f, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0xff, 0xff, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00, 0xfc, 0xff, 0xff, 0xff,
+    0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00,
+};
+const unsigned int kAccelContainerSize = 2936;
+
+alignas(16) const unsigned char kAccelLz4Container[] = {
+    0x54, 0x46, 0x4d, 0x4d, 0x01, 0x00, 0x01, 0x00, 0x20, 0x00, 0x00, 0x00,
+    0xc5, 0x06, 0x00, 0x00, 0x66, 0x8a, 0xb2, 0x71, 0x02, 0x00, 0x00, 0x00,
+    0x58, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf1, 0x0c, 0x1c, 0x00,
+    0x00, 0x00, 0x54, 0x46, 0x4c, 0x33, 0x14, 0x00, 0x20, 0x00, 0x04, 0x00,
+    0x08, 0x00, 0x0c, 0x00, 0x10, 0x00, 0x14, 0x00, 0x00, 0x00, 0x18, 0x00,
+    0x1c, 0x08, 0x00, 0x11, 0x03, 0x0c, 0x00, 0x82, 0x00, 0x00, 0x20, 0x00,
+    0x00, 0x00, 0xd4, 0x00, 0x08, 0x00, 0xf0, 0x66, 0x7c, 0x00, 0x00, 0x00,
+    0x74, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x10, 0x06, 0x00, 0x00,
+    0x60, 0x05, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xd8, 0x00, 0x00, 0x00,
+    0x16, 0x00, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0xfc, 0x0a, 0x00, 0x00,
+    0x1c, 0x0a, 0x00, 0x00, 0xa0, 0x09, 0x00, 0x00, 0x34, 0x09, 0x00, 0x00,
+    0xc4, 0x08, 0x00, 0x00, 0x50, 0x08, 0x00, 0x00, 0xdc, 0x07, 0x00, 0x00,
+    0x70, 0x07, 0x00, 0x00, 0x14, 0x07, 0x00, 0x00, 0xb8, 0x06, 0x00, 0x00,
+    0x4c, 0x06, 0x00, 0x00, 0xd0, 0x0a, 0x00, 0x00, 0xcc, 0x0a, 0x00, 0x00,
+    0xc8, 0x0a, 0x00, 0x00, 0xc4, 0x0a, 0x00, 0x00, 0xc0, 0x0a, 0x00, 0x00,
+    0xbc, 0x0a, 0x00, 0x00, 0xb8, 0x0a, 0x00, 0x00, 0xb4, 0x0a, 0x00, 0x00,
+    0xb0, 0x0a, 0x00, 0x00, 0x3c, 0x58, 0x00, 0x12, 0x00, 0x68, 0x00, 0x31,
+    0x0c, 0x00, 0x00, 0xaa, 0x00, 0x00, 0xb0, 0x00, 0x11, 0x08, 0x0c, 0x00,
+    0xf0, 0x14, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00,
+    0x6d, 0x69, 0x6e, 0x5f, 0x72, 0x75, 0x6e, 0x74, 0x69, 0x6d, 0x65, 0x5f,
+    0x76, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x00, 0x72, 0xf6, 0xff, 0xff,
+    0x04, 0xac, 0x00, 0x93, 0x00, 0x00, 0x00, 0x31, 0x2e, 0x31, 0x34, 0x2e,
+    0x30, 0x4d, 0x00, 0xf7, 0x0d, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00,
+    0x4d, 0x4c, 0x49, 0x52, 0x20, 0x43, 0x6f, 0x6e, 0x76, 0x65, 0x72, 0x74,
+    0x65, 0x64, 0x2e, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x18, 0x0e, 0x01, 0x31,
+    0x0e, 0x00, 0x00, 0x0c, 0x01, 0xd3, 0x64, 0x00, 0x00, 0x00, 0x68, 0x00,
+    0x00, 0x00, 0x6c, 0x00, 0x00, 0x00, 0x90, 0x14, 0x00, 0xf3, 0x3e, 0xcc,
+    0x09, 0x00, 0x00, 0x5c, 0x09, 0x00, 0x00, 0xcc, 0x08, 0x00, 0x00, 0x5c,
+    0x08, 0x00, 0x00, 0xf0, 0x07, 0x00, 0x00, 0x80, 0x07, 0x00, 0x00, 0x24,
+    0x07, 0x00, 0x00, 0xac, 0x06, 0x00, 0x00, 0x40, 0x06, 0x00, 0x00, 0xe4,
+    0x05, 0x00, 0x00, 0x88, 0x05, 0x00, 0x00, 0xf4, 0x04, 0x00, 0x00, 0x44,
+    0x04, 0x00, 0x00, 0x94, 0x03, 0x00, 0x00, 0x10, 0x03, 0x00, 0x00, 0x7c,
+    0x02, 0x00, 0x00, 0xf8, 0x01, 0x00, 0x00, 0x64, 0x01, 0x00, 0x00, 0xe0,
+    0x00, 0x00, 0x00, 0x78, 0xe0, 0x00, 0x00, 0x9e, 0x00, 0x00, 0x50, 0x01,
+    0x00, 0xd0, 0x00, 0xf3, 0x12, 0x09, 0x00, 0x00, 0x00, 0x70, 0x04, 0x00,
+    0x00, 0xdc, 0x03, 0x00, 0x00, 0x2c, 0x03, 0x00, 0x00, 0xb8, 0x02, 0x00,
+    0x00, 0x14, 0x02, 0x00, 0x00, 0xa0, 0x01, 0x00, 0x00, 0xfc, 0x00, 0x00,
+    0x00, 0x88, 0xd8, 0x00, 0x00, 0xe0, 0x00, 0x40, 0x6d, 0x61, 0x69, 0x6e,
+    0x3c, 0x00, 0x40, 0xce, 0xfb, 0xff, 0xff, 0x17, 0x01, 0x40, 0x18, 0x00,
+    0x00, 0x00, 0x2c, 0x01, 0x00, 0x1c, 0x00, 0x44, 0x98, 0xf6, 0xff, 0xff,
+    0x54, 0x00, 0x00, 0xd4, 0x01, 0x90, 0x12, 0x00, 0x00, 0x00, 0x0a, 0x00,
+    0x00, 0x00, 0x05, 0x24, 0x00, 0x30, 0xf7, 0xff, 0xff, 0xf4, 0x01, 0x00,
+    0x04, 0x00, 0x00, 0x34, 0x00, 0x00, 0x1f, 0x01, 0x00, 0xf0, 0x01, 0x00,
+    0xe0, 0x01, 0x00, 0x34, 0x00, 0x00, 0x30, 0x00, 0x00, 0x68, 0x01, 0x80,
+    0x49, 0x64, 0x65, 0x6e, 0x74, 0x69, 0x74, 0x79, 0x64, 0x00, 0x00, 0x1c,
+    0x00, 0x40, 0xff, 0xff, 0xff, 0xff, 0x1c, 0x00, 0x62, 0xf4, 0xf6, 0xff,
+    0xff, 0xce, 0xfc, 0x60, 0x00, 0x40, 0x10, 0x00, 0x00, 0x00, 0x70, 0x00,
+    0x00, 0x38, 0x00, 0x00, 0x64, 0x00, 0x00, 0x08, 0x00, 0x10, 0x11, 0xc4,
+    0x00, 0x03, 0x64, 0x00, 0x00, 0xd4, 0x00, 0x00, 0x64, 0x00, 0x00, 0xd0,
+    0x01, 0x13, 0x2c, 0x44, 0x02, 0x00, 0x24, 0x00, 0x00, 0x50, 0x00, 0x80,
+    0x17, 0x00, 0x00, 0x00, 0x73, 0x65, 0x71, 0x75, 0x66, 0x00, 0xf1, 0x00,
+    0x61, 0x6c, 0x2f, 0x64, 0x65, 0x6e, 0x73, 0x65, 0x5f, 0x33, 0x2f, 0x54,
+    0x61, 0x6e, 0x68, 0x6c, 0x02, 0x00, 0x70, 0x00, 0x00, 0x28, 0x00, 0x6e,
+    0x64, 0xf7, 0xff, 0xff, 0xb2, 0xfc, 0xe4, 0x00, 0x22, 0x7c, 0xf7, 0x84,
+    0x00, 0x00, 0x70, 0x00, 0x00, 0x98, 0x00, 0x00, 0x8c, 0x00, 0x00, 0x40,
+    0x01, 0x00, 0x90, 0x00, 0x13, 0xf0, 0x80, 0x00, 0x00, 0x94, 0x00, 0x00,
+    0x80, 0x00, 0x5b, 0x5c, 0x00, 0x00, 0x00, 0x4c, 0x80, 0x00, 0x1f, 0x34,
+    0x80, 0x00, 0x03, 0x7f, 0x4d, 0x61, 0x74, 0x4d, 0x75, 0x6c, 0x3b, 0x9a,
+    0x00, 0x00, 0x60, 0x42, 0x69, 0x61, 0x73, 0x41, 0x64, 0x17, 0x02, 0x09,
+    0xa0, 0x00, 0x62, 0x04, 0xf8, 0xff, 0xff, 0xde, 0xfd, 0x8c, 0x00, 0x00,
+    0x84, 0x00, 0x00, 0x80, 0x00, 0x00, 0xe4, 0x00, 0x00, 0x0c, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x74, 0x02, 0x22, 0x80, 0xf8, 0x74, 0x01, 0x00, 0xac,
+    0x00, 0x00, 0x90, 0x00, 0x0c, 0x10, 0x01, 0x00, 0x28, 0x00, 0x0f, 0x10,
+    0x01, 0x02, 0x1a, 0x32, 0x10, 0x01, 0x00, 0x28, 0x00, 0x6e, 0x74, 0xf8,
+    0xff, 0xff, 0xc2, 0xfd, 0x10, 0x01, 0x22, 0x8c, 0xf8, 0x84, 0x00, 0x00,
+    0x70, 0x00, 0x00, 0x10, 0x01, 0x00, 0xc8, 0x02, 0x00, 0xc8, 0x01, 0x00,
+    0x0c, 0x00, 0x22, 0x00, 0xf9, 0x80, 0x00, 0x00, 0x94, 0x00, 0x00, 0x80,
+    0x00, 0x0c, 0x10, 0x01, 0x00, 0x58, 0x00, 0x0f, 0x10, 0x01, 0x02, 0x2f,
+    0x32, 0x2f, 0x10, 0x01, 0x05, 0x2f, 0x32, 0x2f, 0x10, 0x01, 0x00, 0x00,
+    0x48, 0x00, 0x62, 0x14, 0xf9, 0xff, 0xff, 0xee, 0xfe, 0x8c, 0x00, 0x00,
+    0x70, 0x00, 0x04, 0x10, 0x01, 0x00, 0x90, 0x00, 0x00, 0x20, 0x00, 0x10,
+    0x0d, 0x50, 0x03, 0x03, 0x90, 0x00, 0x00, 0xac, 0x00, 0x00, 0x90, 0x00,
+    0x0c, 0x10, 0x01, 0x00, 0xf8, 0x01, 0x0f, 0x10, 0x01, 0x02, 0x1a, 0x31,
+    0x10, 0x01, 0x00, 0x28, 0x00, 0x6e, 0x84, 0xf9, 0xff, 0xff, 0xd2, 0xfe,
+    0x10, 0x01, 0x22, 0x9c, 0xf9, 0x84, 0x00, 0x00, 0x70, 0x00, 0x00, 0x04,
+    0x01, 0x00, 0x1c, 0x03, 0x13, 0x07, 0x04, 0x02, 0x22, 0x10, 0xfa, 0x10,
+    0x01, 0x00, 0x94, 0x00, 0x00, 0x80, 0x00, 0x0c, 0x10, 0x01, 0x00, 0x58,
+    0x00, 0x0f, 0x10, 0x01, 0x02, 0x1f, 0x31, 0x10, 0x01, 0x06, 0x1f, 0x31,
+    0x10, 0x01, 0x01, 0x00, 0x48, 0x00, 0x11, 0x0c, 0xa0, 0x03, 0x33, 0x0a,
+    0x00, 0x10, 0x64, 0x04, 0x00, 0x88, 0x03, 0x00, 0x08, 0x01, 0x08, 0x1c,
+    0x01, 0x00, 0x9c, 0x00, 0x00, 0x14, 0x00, 0x80, 0x0b, 0x00, 0x00, 0x00,
+    0x60, 0xff, 0xff, 0xff, 0xa8, 0x05, 0x40, 0x00, 0x00, 0x00, 0x1c, 0x14,
+    0x00, 0x13, 0xbc, 0xac, 0x00, 0x00, 0xc8, 0x00, 0x00, 0xac, 0x00, 0x0c,
+    0x2c, 0x01, 0x00, 0xdc, 0x00, 0x00, 0x10, 0x05, 0x0c, 0xb2, 0x02, 0x02,
+    0x2a, 0x01, 0x02, 0xb8, 0x05, 0x00, 0x4c, 0x03, 0x00, 0x28, 0x00, 0x11,
+    0x98, 0x8c, 0x00, 0x11, 0x0e, 0xe0, 0x04, 0x00, 0xfe, 0x05, 0x40, 0x07,
+    0x00, 0x10, 0x00, 0x04, 0x01, 0x0c, 0x40, 0x04, 0x22, 0xd8, 0xfa, 0x3c,
+    0x01, 0x00, 0x90, 0x00, 0x00, 0x38, 0x00, 0x00, 0x04, 0x04, 0x13, 0x06,
+    0xb0, 0x04, 0x00, 0x34, 0x06, 0x00, 0x18, 0x00, 0x31, 0x0c, 0x00, 0x04,
+    0x70, 0x04, 0x00, 0x74, 0x03, 0x40, 0x00, 0x00, 0x00, 0x09, 0xac, 0x00,
+    0x22, 0x68, 0xfb, 0x58, 0x01, 0x00, 0xd0, 0x00, 0x00, 0xac, 0x00, 0x53,
+    0x58, 0x00, 0x00, 0x00, 0x48, 0x74, 0x01, 0x00, 0x20, 0x00, 0x00, 0x4c,
+    0x00, 0x00, 0x70, 0x04, 0x0d, 0xac, 0x00, 0x0f, 0x66, 0x02, 0x04, 0x0f,
+    0x54, 0x01, 0x01, 0x00, 0x44, 0x00, 0x62, 0x78, 0xfb, 0xff, 0xff, 0x5a,
+    0xfc, 0xe8, 0x05, 0x00, 0x68, 0x00, 0xf0, 0x0d, 0xa7, 0xd0, 0x79, 0x3e,
+    0x61, 0x14, 0x85, 0x3e, 0xcb, 0xd9, 0xa9, 0x3f, 0x02, 0x08, 0x2b, 0xbf,
+    0xfa, 0x69, 0x4c, 0x3f, 0x81, 0x01, 0x80, 0x3f, 0x5e, 0xfc, 0xff, 0xff,
+    0x68, 0x01, 0x00, 0xb0, 0x00, 0x00, 0xf0, 0x04, 0x00, 0x7c, 0x00, 0x00,
+    0x94, 0x01, 0x00, 0x44, 0x00, 0x00, 0x08, 0x00, 0x1f, 0x19, 0x04, 0x04,
+    0x01, 0x13, 0x34, 0xe4, 0x01, 0x83, 0x00, 0x00, 0x00, 0xe0, 0xfb, 0xff,
+    0xff, 0xc2, 0x68, 0x00, 0x00, 0x4c, 0x03, 0x93, 0x68, 0xf8, 0x85, 0xbf,
+    0xa7, 0xec, 0x9c, 0x3f, 0xb6, 0x58, 0x00, 0x00, 0xcc, 0x01, 0x08, 0x58,
+    0x00, 0x00, 0x54, 0x00, 0x00, 0xe8, 0x00, 0x0f, 0x58, 0x00, 0x02, 0x16,
+    0x33, 0x58, 0x00, 0x62, 0x38, 0xfc, 0xff, 0xff, 0x1a, 0xfd, 0xc0, 0x00,
+    0x00, 0x58, 0x00, 0xa2, 0x4d, 0xbb, 0x3d, 0x3f, 0xd8, 0xde, 0x5b, 0xbb,
+    0x0e, 0xfd, 0xb0, 0x00, 0x00, 0x54, 0x01, 0x08, 0x58, 0x00, 0x00, 0x54,
+    0x00, 0x00, 0x5c, 0x00, 0x0f, 0x58, 0x00, 0x02, 0x04, 0xa4, 0x03, 0x00,
+    0x58, 0x03, 0x43, 0xfc, 0xff, 0xff, 0x72, 0x58, 0x00, 0x00, 0x18, 0x01,
+    0xf3, 0x0a, 0xde, 0x81, 0x11, 0xbd, 0x48, 0xb9, 0x10, 0x3f, 0x18, 0x17,
+    0x30, 0x3e, 0x58, 0xf4, 0x20, 0xbf, 0x44, 0x05, 0xe4, 0xbe, 0x69, 0xde,
+    0xb7, 0xbe, 0x76, 0x68, 0x00, 0x00, 0x7c, 0x00, 0x08, 0x68, 0x00, 0x00,
+    0x64, 0x00, 0x00, 0x1c, 0x01, 0x0f, 0x68, 0x00, 0x02, 0x04, 0xfc, 0x02,
+    0x83, 0x00, 0x00, 0x00, 0xf8, 0xfc, 0xff, 0xff, 0xda, 0x68, 0x00, 0xf3,
+    0x1a, 0x24, 0x00, 0x00, 0x00, 0x76, 0x7a, 0x9a, 0x3f, 0x31, 0x21, 0x76,
+    0x3f, 0x79, 0x63, 0x01, 0xbe, 0xd7, 0x34, 0x55, 0x3e, 0x0d, 0xe1, 0x95,
+    0xbf, 0xf1, 0xcf, 0x0c, 0xbe, 0x2b, 0xc3, 0x0d, 0xbf, 0x14, 0x9f, 0xba,
+    0xbe, 0x8c, 0x8d, 0x07, 0x3f, 0xea, 0x74, 0x00, 0x00, 0x84, 0x03, 0x00,
+    0x74, 0x00, 0x04, 0x10, 0x06, 0x00, 0x70, 0x00, 0x00, 0x04, 0x00, 0x0f,
+    0xf0, 0x03, 0x01, 0x04, 0x32, 0x01, 0x62, 0x68, 0xfd, 0xff, 0xff, 0x4a,
+    0xfe, 0x30, 0x01, 0x00, 0x5c, 0x02, 0xe2, 0x05, 0x3a, 0xe2, 0xbd, 0xcc,
+    0x38, 0x77, 0x3e, 0xd1, 0x13, 0x9d, 0x3e, 0x42, 0xfe, 0x34, 0x01, 0x00,
+    0xa0, 0x02, 0x00, 0xec, 0x01, 0x13, 0x44, 0xa8, 0x02, 0x00, 0x54, 0x00,
+    0x1f, 0x32, 0xe0, 0x01, 0x03, 0x03, 0xba, 0x04, 0xf3, 0x10, 0x2f, 0x52,
+    0x65, 0x61, 0x64, 0x56, 0x61, 0x72, 0x69, 0x61, 0x62, 0x6c, 0x65, 0x4f,
+    0x70, 0x2f, 0x72, 0x65, 0x73, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x00, 0x00,
+    0xd8, 0xfd, 0xff, 0xff, 0xba, 0x70, 0x00, 0x00, 0x24, 0x01, 0x93, 0x80,
+    0x6e, 0x88, 0x3e, 0x0f, 0x53, 0xd5, 0x3e, 0xae, 0x6c, 0x00, 0x00, 0x48,
+    0x07, 0x08, 0x6c, 0x00, 0x00, 0x38, 0x01, 0x0f, 0x6c, 0x00, 0x02, 0x14,
+    0x33, 0xc2, 0x02, 0x0f, 0x6c, 0x00, 0x07, 0x62, 0x44, 0xfe, 0xff, 0xff,
+    0x26, 0xff, 0xdc, 0x00, 0x00, 0x2c, 0x05, 0x62, 0xb7, 0x36, 0x0e, 0x3e,
+    0x16, 0xff, 0xd4, 0x00, 0x00, 0x10, 0x00, 0x08, 0x68, 0x00, 0x00, 0x08,
+    0x02, 0x0f, 0x68, 0x00, 0x02, 0x05, 0x8e, 0x05, 0x0f, 0x68, 0x00, 0x07,
+    0x53, 0xac, 0xfe, 0xff, 0xff, 0x8e, 0x68, 0x00, 0x00, 0xd4, 0x00, 0x93,
+    0xbe, 0xe9, 0x95, 0x3d, 0xc8, 0x97, 0x89, 0x3d, 0x82, 0x6c, 0x00, 0x00,
+    0x30, 0x01, 0x00, 0x6c, 0x00, 0x00, 0xb0, 0x03, 0x00, 0x68, 0x00, 0x0f,
+    0xd4, 0x00, 0x06, 0x05, 0xea, 0x04, 0x0f, 0x6c, 0x00, 0x07, 0x31, 0x04,
+    0x00, 0x06, 0x18, 0x08, 0x60, 0x00, 0x00, 0x06, 0x00, 0x08, 0x00, 0x0e,
+    0x00, 0x02, 0x28, 0x08, 0x00, 0xbc, 0x01, 0xc0, 0x30, 0x28, 0x44, 0x3d,
+    0xff, 0xcf, 0xac, 0xbd, 0xe2, 0x3a, 0x51, 0xbc, 0x7c, 0x09, 0x11, 0x14,
+    0x2a, 0x00, 0x00, 0x8e, 0x04, 0x02, 0x8c, 0x04, 0x00, 0x84, 0x00, 0x00,
+    0x7c, 0x00, 0x00, 0x08, 0x00, 0x08, 0xcc, 0x01, 0x00, 0xbc, 0x03, 0x0d,
+    0x38, 0x04, 0x0f, 0xca, 0x01, 0x0e, 0x40, 0x00, 0x00, 0xa4, 0xff, 0x94,
+    0x04, 0x00, 0xe2, 0x09, 0x02, 0x48, 0x0a, 0x00, 0x58, 0x00, 0x00, 0xe2,
+    0x09, 0x00, 0x84, 0x02, 0x00, 0x04, 0x00, 0x00, 0xec, 0x00, 0x00, 0x2c,
+    0x03, 0x00, 0x60, 0x00, 0x0c, 0x08, 0x09, 0x00, 0x38, 0x04, 0x02, 0x99,
+    0x08, 0x55, 0x69, 0x6e, 0x70, 0x75, 0x74, 0xf8, 0x07, 0x00, 0x2c, 0x01,
+    0xc0, 0xfc, 0xff, 0xff, 0xff, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00,
+    0x00,
+};
+const unsigned int kAccelLz4ContainerSize = 1765;
@@ -0,0 +1,28 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TEST_MODEL_LOADER_ACCEL_CONTAINER_H_
+#define TEST_MODEL_LOADER_ACCEL_CONTAINER_H_
+
+// The accel model of lib/Model wrapped by tools/make_model_container.py with
+// --model-version 2, as bytes.
+extern const unsigned char kAccelContainer[];
+extern const unsigned int kAccelContainerSize;
+
+// The same with --lz4 added.
+extern const unsigned char kAccelLz4Container[];
+extern const unsigned int kAccelLz4ContainerSize;
+
+#endif  // TEST_MODEL_LOADER_ACCEL_CONTAINER_H_
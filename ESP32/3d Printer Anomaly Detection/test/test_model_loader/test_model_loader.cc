@@ -0,0 +1,450 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that model containers written by tools/make_model_container.py
+// parse and decode, and that damaged or malicious containers and LZ4 blocks
+// are rejected before any byte outside them is read or written.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "accel_container.h"
+#include "accel_model.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_model_loader.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <unistd.h>
+#define TEST_MODEL_LOADER_POSIX
+#endif
+
+namespace {
+
+constexpr size_t kHeaderSize = 32;
+constexpr size_t kMaxContainerSize = 4096;
+alignas(16) uint8_t container[kMaxContainerSize];
+
+constexpr size_t kArenaSize = 8 * 1024;
+alignas(16) uint8_t arena[kArenaSize];
+
+// Decoded LZ4 output, followed by guard bytes that must never be written.
+constexpr size_t kMaxDecodedSize = 4096;
+constexpr size_t kGuardSize = 64;
+constexpr uint8_t kGuard = 0xa5;
+uint8_t decoded[kMaxDecodedSize + kGuardSize];
+
+tflite::MicroModelHeader* header() {
+  return reinterpret_cast<tflite::MicroModelHeader*>(container);
+}
+
+// Copies the container written by the tool, so it can be damaged.
+size_t CopyAccelContainer() {
+  memcpy(container, kAccelContainer, kAccelContainerSize);
+  return kAccelContainerSize;
+}
+
+// Recomputes the CRC after the payload was changed, so that only the checks
+// after the CRC see the change.
+void UpdateCrc() {
+  header()->payload_crc32 = tflite::MicroModelCrc32(
+      container + header()->header_size, header()->payload_size);
+}
+
+TfLiteStatus Parse(const uint8_t* data, size_t size) {
+  const tflite::MicroModelHeader* parsed_header = nullptr;
+  const uint8_t* payload = nullptr;
+  const TfLiteStatus status = tflite::ParseModelContainer(
+      data, size, micro_test::reporter, &parsed_header, &payload);
+  if (status != kTfLiteOk) {
+    TF_LITE_MICRO_EXPECT(parsed_header == nullptr);
+    TF_LITE_MICRO_EXPECT(payload == nullptr);
+  }
+  return status;
+}
+
+// Decodes `block` into `decoded`, checking that no byte past `output_size`
+// is written.
+bool DecodeBlock(const uint8_t* block, size_t block_size, size_t output_size) {
+  memset(decoded, kGuard, sizeof(decoded));
+  const bool result = tflite::internal::DecodeLz4Block(block, block_size,
+                                                       decoded, output_size);
+  for (size_t i = output_size; i < output_size + kGuardSize; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(kGuard, decoded[i]);
+  }
+  return result;
+}
+
+// Literals "abcd", a match repeating the last byte 8 times, then the last
+// literals "xyz".
+constexpr uint8_t kBlock[] = {0x44, 'a', 'b', 'c', 'd', 0x01,
+                              0x00, 0x30, 'x', 'y', 'z'};
+constexpr char kBlockOutput[] = "abcdddddddddxyz";
+constexpr size_t kBlockOutputSize = sizeof(kBlockOutput) - 1;
+
+#if defined(TEST_MODEL_LOADER_POSIX)
+// Writes `size` bytes of `data` to a new temporary file, whose path is
+// stored in `path`.
+void WriteTempFile(const uint8_t* data, size_t size, char* path) {
+  strcpy(path, "/tmp/model_container_XXXXXX");
+  const int fd = mkstemp(path);
+  TF_LITE_MICRO_EXPECT(fd >= 0);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<ssize_t>(size), write(fd, data, size));
+  close(fd);
+}
+#endif
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestCrc32MatchesIeee) {
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  TF_LITE_MICRO_EXPECT_EQ(0xcbf43926u, tflite::MicroModelCrc32(check, 9));
+  // Checking in pieces gives the same result.
+  TF_LITE_MICRO_EXPECT_EQ(
+      0xcbf43926u,
+      tflite::MicroModelCrc32(check + 4, 5, tflite::MicroModelCrc32(check, 4)));
+  TF_LITE_MICRO_EXPECT_EQ(0u, tflite::MicroModelCrc32(check, 0));
+}
+
+TF_LITE_MICRO_TEST(TestToolContainerParses) {
+  const tflite::MicroModelHeader* parsed_header = nullptr;
+  const uint8_t* payload = nullptr;
+  TF_LITE_MICRO_EXPECT_EQ(
+      tflite::ParseModelContainer(kAccelContainer, kAccelContainerSize,
+                                  micro_test::reporter, &parsed_header,
+                                  &payload),
+      kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(reinterpret_cast<const uint8_t*>(parsed_header) ==
+                       kAccelContainer);
+  TF_LITE_MICRO_EXPECT_EQ(kHeaderSize, parsed_header->header_size);
+  TF_LITE_MICRO_EXPECT_EQ(0, parsed_header->flags);
+  TF_LITE_MICRO_EXPECT_EQ(2u, parsed_header->model_version);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(g_model_len),
+                          parsed_header->payload_size);
+  TF_LITE_MICRO_EXPECT(payload == kAccelContainer + kHeaderSize);
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp(g_model, payload, g_model_len));
+
+  // A plain payload is used in place.
+  const tflite::Model* model = tflite::DecodeModelContainer(
+      parsed_header, payload, nullptr, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT(reinterpret_cast<const uint8_t*>(model) ==
+                       payload + *reinterpret_cast<const uint32_t*>(payload));
+}
+
+TF_LITE_MICRO_TEST(TestTruncatedContainerIsRejected) {
+  const size_t size = CopyAccelContainer();
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, 0), kTfLiteError);
+  TF_LITE_MICRO_EXPECT_EQ(
+      Parse(container, sizeof(tflite::MicroModelHeader) - 1), kTfLiteError);
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, kHeaderSize), kTfLiteError);
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size - 1), kTfLiteError);
+  // Trailing bytes, such as the rest of a flash partition, are ignored.
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, kMaxContainerSize), kTfLiteOk);
+}
+
+TF_LITE_MICRO_TEST(TestMisalignedContainerIsRejected) {
+  // The header and payload are read in place, so both must be aligned.
+  memmove(container + 4, kAccelContainer, kAccelContainerSize);
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container + 4, kAccelContainerSize),
+                          kTfLiteError);
+
+  // The payload moved to an offset that is not a multiple of 16.
+  CopyAccelContainer();
+  memmove(container + kHeaderSize + 4, container + kHeaderSize,
+          header()->payload_size);
+  header()->header_size = kHeaderSize + 4;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, kAccelContainerSize + 4),
+                          kTfLiteError);
+}
+
+TF_LITE_MICRO_TEST(TestBadHeaderIsRejected) {
+  const size_t size = CopyAccelContainer();
+  header()->magic ^= 1;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+
+  CopyAccelContainer();
+  header()->header_version = tflite::kMicroModelHeaderVersion + 1;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+
+  CopyAccelContainer();
+  header()->flags = 2;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+
+  // Smaller than the header itself.
+  CopyAccelContainer();
+  header()->header_size = 16;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+}
+
+TF_LITE_MICRO_TEST(TestBadCrcIsRejected) {
+  size_t size = CopyAccelContainer();
+  container[kHeaderSize + 100] ^= 0x10;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+
+  size = CopyAccelContainer();
+  header()->payload_crc32 ^= 0x80000000u;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+}
+
+TF_LITE_MICRO_TEST(TestOverflowingSizesAreRejected) {
+  // header_size + payload_size wraps around to less than the container size.
+  const size_t size = CopyAccelContainer();
+  header()->payload_size = 0xfffffff0u;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+
+  CopyAccelContainer();
+  header()->header_size = 0xfffffff0u;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+
+  CopyAccelContainer();
+  header()->payload_size += 1;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+}
+
+TF_LITE_MICRO_TEST(TestShortPayloadIsRejected) {
+  // An empty payload has a CRC of 0. Parsing it must not read the file
+  // identifier from the bytes after the container.
+  CopyAccelContainer();
+  header()->payload_size = 0;
+  header()->payload_crc32 = 0;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, kHeaderSize), kTfLiteError);
+
+  // Four bytes hold the root offset but no file identifier.
+  header()->payload_size = 4;
+  UpdateCrc();
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, kHeaderSize + 4), kTfLiteError);
+}
+
+TF_LITE_MICRO_TEST(TestCorruptModelIsRejected) {
+  // The CRC matches, but the root offset points past the payload.
+  size_t size = CopyAccelContainer();
+  container[kHeaderSize + 1] = 0x40;
+  UpdateCrc();
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+
+  // Not a TFLite model.
+  size = CopyAccelContainer();
+  container[kHeaderSize + 4] = 'X';
+  UpdateCrc();
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+
+  // The model is cut short, so its last tables end outside of the payload.
+  size = CopyAccelContainer();
+  header()->payload_size -= 64;
+  UpdateCrc();
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteError);
+}
+
+TF_LITE_MICRO_TEST(TestLz4DecodesLiteralsAndMatches) {
+  TF_LITE_MICRO_EXPECT(DecodeBlock(kBlock, sizeof(kBlock), kBlockOutputSize));
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp(kBlockOutput, decoded, kBlockOutputSize));
+
+  // A match that does not overlap its source, and an empty last sequence.
+  const uint8_t copy[] = {0x40, 'a', 'b', 'c', 'd', 0x04, 0x00, 0x00};
+  TF_LITE_MICRO_EXPECT(DecodeBlock(copy, sizeof(copy), 8));
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp("abcdabcd", decoded, 8));
+
+  // 20 literals and a match of 275 bytes, both with length extensions.
+  uint8_t extended[32] = {0xff, 20 - 15};
+  for (int i = 0; i < 20; ++i) {
+    extended[2 + i] = static_cast<uint8_t>('A' + i);
+  }
+  const uint8_t match[] = {20, 0x00, 255, 275 - 4 - 15 - 255, 0x00};
+  memcpy(&extended[22], match, sizeof(match));
+  TF_LITE_MICRO_EXPECT(DecodeBlock(extended, 22 + sizeof(match), 295));
+  for (int i = 0; i < 295; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ('A' + i % 20, decoded[i]);
+  }
+}
+
+TF_LITE_MICRO_TEST(TestLz4RejectsBadOffsets) {
+  uint8_t block[sizeof(kBlock)];
+  // An offset of 0 would copy from the byte being written.
+  memcpy(block, kBlock, sizeof(kBlock));
+  block[5] = 0;
+  TF_LITE_MICRO_EXPECT(!DecodeBlock(block, sizeof(block), kBlockOutputSize));
+
+  // Offsets reaching before the start of the output.
+  block[5] = 5;
+  TF_LITE_MICRO_EXPECT(!DecodeBlock(block, sizeof(block), kBlockOutputSize));
+  block[5] = 1;
+  block[6] = 1;
+  TF_LITE_MICRO_EXPECT(!DecodeBlock(block, sizeof(block), kBlockOutputSize));
+
+  // The block ends in the middle of an offset.
+  TF_LITE_MICRO_EXPECT(!DecodeBlock(kBlock, 6, kBlockOutputSize));
+}
+
+TF_LITE_MICRO_TEST(TestLz4RejectsOverlongLengths) {
+  // Literals longer than the rest of the input or than the output.
+  const uint8_t literals[] = {0x50, 'a', 'b', 'c', 'd', 'e'};
+  TF_LITE_MICRO_EXPECT(!DecodeBlock(literals, sizeof(literals) - 1, 5));
+  TF_LITE_MICRO_EXPECT(!DecodeBlock(literals, sizeof(literals), 4));
+
+  // A match longer than the rest of the output.
+  TF_LITE_MICRO_EXPECT(
+      !DecodeBlock(kBlock, sizeof(kBlock), kBlockOutputSize - 4));
+
+  // Length extensions that run off the input, or grow past any output.
+  const uint8_t open_literals[] = {0xf0, 0xff};
+  TF_LITE_MICRO_EXPECT(!DecodeBlock(open_literals, sizeof(open_literals), 16));
+  const uint8_t open_match[] = {0x4f, 'a', 'b', 'c', 'd', 0x01, 0x00};
+  TF_LITE_MICRO_EXPECT(!DecodeBlock(open_match, sizeof(open_match), 64));
+  uint8_t long_run[64];
+  memset(long_run, 0xff, sizeof(long_run));
+  TF_LITE_MICRO_EXPECT(!DecodeBlock(long_run, sizeof(long_run), 256));
+
+  // An output size the block does not fill.
+  TF_LITE_MICRO_EXPECT(
+      !DecodeBlock(kBlock, sizeof(kBlock), kBlockOutputSize + 1));
+}
+
+TF_LITE_MICRO_TEST(TestLz4RejectsTrailingTokens) {
+  // A last token whose literals are missing.
+  uint8_t block[sizeof(kBlock) + 2];
+  memcpy(block, kBlock, sizeof(kBlock));
+  TF_LITE_MICRO_EXPECT(
+      !DecodeBlock(block, sizeof(kBlock) - 3, kBlockOutputSize));
+
+  // Another sequence after the last literals, once the output is complete.
+  block[sizeof(kBlock)] = 0x10;
+  block[sizeof(kBlock) + 1] = 'q';
+  TF_LITE_MICRO_EXPECT(!DecodeBlock(block, sizeof(block), kBlockOutputSize));
+  TF_LITE_MICRO_EXPECT(
+      !DecodeBlock(block, sizeof(block), kBlockOutputSize + 1));
+}
+
+TF_LITE_MICRO_TEST(TestDamagedLz4PayloadStaysInBounds) {
+  const tflite::MicroModelHeader* lz4_header =
+      reinterpret_cast<const tflite::MicroModelHeader*>(kAccelLz4Container);
+  const uint8_t* payload = kAccelLz4Container + lz4_header->header_size;
+  const size_t payload_size = lz4_header->payload_size;
+  TF_LITE_MICRO_EXPECT(lz4_header->decoded_size <= kMaxDecodedSize);
+  TF_LITE_MICRO_EXPECT(
+      DecodeBlock(payload, payload_size, lz4_header->decoded_size));
+
+  // Every damaged byte either fails to decode or decodes to other bytes, but
+  // never touches memory past the output.
+  uint8_t damaged[kMaxContainerSize];
+  for (size_t position = 0; position < payload_size; ++position) {
+    memcpy(damaged, payload, payload_size);
+    damaged[position] ^= 0xff;
+    DecodeBlock(damaged, payload_size, lz4_header->decoded_size);
+  }
+  // Truncated blocks do not decode.
+  for (size_t size = 0; size < payload_size; size += 97) {
+    TF_LITE_MICRO_EXPECT(
+        !DecodeBlock(payload, size, lz4_header->decoded_size));
+  }
+}
+
+TF_LITE_MICRO_TEST(TestToolLz4ContainerDecodes) {
+  const tflite::MicroModelHeader* parsed_header = nullptr;
+  const uint8_t* payload = nullptr;
+  TF_LITE_MICRO_EXPECT_EQ(
+      tflite::ParseModelContainer(kAccelLz4Container, kAccelLz4ContainerSize,
+                                  micro_test::reporter, &parsed_header,
+                                  &payload),
+      kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(tflite::kMicroModelLz4, parsed_header->flags);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(g_model_len),
+                          parsed_header->decoded_size);
+  TF_LITE_MICRO_EXPECT(parsed_header->payload_size <
+                       static_cast<uint32_t>(g_model_len));
+
+  // The model is decoded into the arena.
+  tflite::MicroAllocator* allocator =
+      tflite::MicroAllocator::Create(arena, kArenaSize, micro_test::reporter);
+  const tflite::Model* model = tflite::DecodeModelContainer(
+      parsed_header, payload, allocator, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT(model != nullptr);
+  const uint8_t* model_data = reinterpret_cast<const uint8_t*>(model) -
+                              *reinterpret_cast<const uint32_t*>(g_model);
+  TF_LITE_MICRO_EXPECT(model_data >= arena && model_data < arena + kArenaSize);
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp(g_model, model_data, g_model_len));
+
+  // A decoded size that does not match the block fails.
+  const size_t size = CopyAccelContainer();
+  memcpy(container, kAccelLz4Container, kAccelLz4ContainerSize);
+  for (int delta = -1; delta <= 1; delta += 2) {
+    header()->decoded_size = g_model_len + delta;
+    TF_LITE_MICRO_EXPECT_EQ(Parse(container, size), kTfLiteOk);
+    allocator = tflite::MicroAllocator::Create(arena, kArenaSize,
+                                               micro_test::reporter);
+    TF_LITE_MICRO_EXPECT(tflite::DecodeModelContainer(
+                             header(), container + kHeaderSize, allocator,
+                             micro_test::reporter) == nullptr);
+  }
+}
+
+TF_LITE_MICRO_TEST(TestShortDecodedSizeIsRejected) {
+  // A single empty sequence decodes to 0 bytes, which would pass the LZ4
+  // decoder and leave nothing to read the file identifier from.
+  memcpy(container, kAccelLz4Container, kHeaderSize);
+  container[kHeaderSize] = 0x00;
+  header()->payload_size = 1;
+  header()->decoded_size = 0;
+  UpdateCrc();
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, kHeaderSize + 1), kTfLiteError);
+
+  header()->decoded_size = 7;
+  TF_LITE_MICRO_EXPECT_EQ(Parse(container, kHeaderSize + 1), kTfLiteError);
+}
+
+#if defined(TEST_MODEL_LOADER_POSIX)
+TF_LITE_MICRO_TEST(TestMapNewestPicksHighestVersion) {
+  // Slot 0 holds version 2, slot 1 version 5, slot 2 a damaged version 9 and
+  // slot 3 does not exist.
+  char paths[3][32];
+  const size_t size = CopyAccelContainer();
+  WriteTempFile(container, size, paths[0]);
+  header()->model_version = 5;
+  WriteTempFile(container, size, paths[1]);
+  header()->model_version = 9;
+  container[kHeaderSize + 100] ^= 0x10;
+  WriteTempFile(container, size, paths[2]);
+  const char* sources[] = {paths[0], paths[1], paths[2],
+                           "/nonexistent/model.bin"};
+
+  tflite::MappedModel mapped(micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(mapped.MapNewest(sources, 4), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(mapped.mapped());
+  TF_LITE_MICRO_EXPECT_EQ(5u, mapped.header()->model_version);
+  TF_LITE_MICRO_EXPECT(mapped.source() == paths[1]);
+  TF_LITE_MICRO_EXPECT(mapped.model() != nullptr);
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp(g_model, mapped.payload(), g_model_len));
+
+  // The order of the sources does not matter.
+  const char* reversed[] = {paths[2], paths[1], paths[0]};
+  TF_LITE_MICRO_EXPECT_EQ(mapped.MapNewest(reversed, 3), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(5u, mapped.header()->model_version);
+
+  // Only the damaged and the missing slots.
+  TF_LITE_MICRO_EXPECT_EQ(mapped.MapNewest(sources + 2, 2), kTfLiteError);
+  TF_LITE_MICRO_EXPECT(!mapped.mapped());
+  TF_LITE_MICRO_EXPECT(mapped.model() == nullptr);
+
+  for (const char* path : paths) {
+    remove(path);
+  }
+}
+#endif
+
+TF_LITE_MICRO_TESTS_END
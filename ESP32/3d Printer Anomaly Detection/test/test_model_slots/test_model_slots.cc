@@ -0,0 +1,183 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that MicroModelSlots swaps models at window boundaries while
+// another thread keeps staging new ones, without dropping or corrupting a
+// window.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "accel_model.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_model_slots.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 8192;
+constexpr int kInputSize = 3;
+// Loop iterations per window of the synthetic feed. InvokeStep(0) runs one
+// operator per iteration, and the accel model has 9 operators.
+constexpr int kIterationsPerWindow = 12;
+constexpr int kMinSwaps = 20;
+constexpr int kMaxWindows = 200000;
+
+alignas(16) uint8_t arena_a[kArenaSize];
+alignas(16) uint8_t arena_b[kArenaSize];
+alignas(16) uint8_t reference_arena[kArenaSize];
+// A second copy of the model, so that swaps alternate between two models.
+alignas(16) unsigned char model_copy[4096];
+
+float input[kInputSize];
+
+TfLiteStatus BindInput(tflite::MicroInterpreter* interpreter, void*) {
+  return interpreter->BindInput(0, input);
+}
+
+TfLiteStatus FailSetup(tflite::MicroInterpreter*, void*) {
+  return kTfLiteError;
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestSwapWaitsForRunToComplete) {
+  TF_LITE_MICRO_EXPECT(static_cast<size_t>(g_model_len) <= sizeof(model_copy));
+  memcpy(model_copy, g_model, g_model_len);
+  const tflite::Model* model_a = tflite::GetModel(g_model);
+  const tflite::Model* model_b = tflite::GetModel(model_copy);
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroModelSlots slots(op_resolver, arena_a, arena_b, kArenaSize,
+                                micro_test::reporter);
+  TF_LITE_MICRO_EXPECT(slots.active() == nullptr);
+  TF_LITE_MICRO_EXPECT(!slots.SwapIfReady());
+
+  TF_LITE_MICRO_EXPECT_EQ(slots.Stage(model_a, BindInput), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(slots.SwapIfReady());
+  TF_LITE_MICRO_EXPECT(slots.active_model() == model_a);
+
+  // A failed stage leaves the active interpreter alone.
+  TF_LITE_MICRO_EXPECT_EQ(slots.Stage(model_b, FailSetup), kTfLiteError);
+  TF_LITE_MICRO_EXPECT(!slots.SwapIfReady());
+  TF_LITE_MICRO_EXPECT(slots.active_model() == model_a);
+
+  // No swap happens in the middle of an InvokeStep() run.
+  TF_LITE_MICRO_EXPECT_EQ(slots.Stage(model_b, BindInput), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(slots.active()->InvokeStep(0),
+                          tflite::kTfLiteInvokeContinue);
+  TF_LITE_MICRO_EXPECT(!slots.SwapIfReady());
+  TfLiteStatus status;
+  do {
+    status = slots.active()->InvokeStep(0);
+  } while (status == tflite::kTfLiteInvokeContinue);
+  TF_LITE_MICRO_EXPECT_EQ(status, kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(slots.SwapIfReady());
+  TF_LITE_MICRO_EXPECT(slots.active_model() == model_b);
+  TF_LITE_MICRO_EXPECT_EQ(2u, slots.generation());
+}
+
+TF_LITE_MICRO_TEST(TestSwapUnderContinuousFeed) {
+  memcpy(model_copy, g_model, g_model_len);
+  const tflite::Model* models[2] = {tflite::GetModel(g_model),
+                                    tflite::GetModel(model_copy)};
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter reference(models[0], op_resolver, reference_arena,
+                                     kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(reference.AllocateTensors(), kTfLiteOk);
+
+  tflite::MicroModelSlots slots(op_resolver, arena_a, arena_b, kArenaSize,
+                                micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(slots.Stage(models[0], BindInput), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT(slots.SwapIfReady());
+
+  // Stages the two models in turn, each as soon as the previous one was
+  // swapped in, until the feed is done. Only Stage() may be called from
+  // another thread, so the feed loop publishes the number of swaps, which
+  // starts with the one above.
+  std::atomic<bool> stop(false);
+  std::atomic<int> swaps(1);
+  std::atomic<int> stage_failures(0);
+  std::thread stager([&] {
+    for (int k = 1; !stop.load(); ++k) {
+      while (!stop.load() && swaps.load() < k) {
+        std::this_thread::yield();
+      }
+      if (!stop.load() &&
+          slots.Stage(models[k & 1], BindInput) != kTfLiteOk) {
+        ++stage_failures;
+      }
+    }
+  });
+
+  // Every kIterationsPerWindow loop iterations a new window arrives. It is
+  // dropped if the previous one is still being scored.
+  int windows = 0;
+  int dropped = 0;
+  int wrong = 0;
+  bool pending = false;
+  for (int iteration = 0; windows < kMaxWindows; ++iteration) {
+    if (iteration % kIterationsPerWindow == 0) {
+      if (pending) {
+        ++dropped;
+      } else {
+        for (int i = 0; i < kInputSize; ++i) {
+          input[i] = 0.01f * ((windows * 7 + i * 3) % 50) - 0.25f;
+        }
+        pending = true;
+      }
+      ++windows;
+      if (swaps.load() > kMinSwaps) {
+        break;
+      }
+    }
+    if (!pending) {
+      continue;
+    }
+    tflite::MicroInterpreter* interpreter = slots.active();
+    const TfLiteStatus status = interpreter->InvokeStep(0);
+    if (status == tflite::kTfLiteInvokeContinue) {
+      continue;
+    }
+    pending = false;
+    memcpy(reference.input(0)->data.f, input, sizeof(input));
+    TF_LITE_MICRO_EXPECT_EQ(reference.Invoke(), kTfLiteOk);
+    if (status != kTfLiteOk ||
+        memcmp(reference.output(0)->data.f, interpreter->output(0)->data.f,
+               reference.output(0)->bytes) != 0) {
+      ++wrong;
+    }
+    // Window boundary.
+    if (slots.SwapIfReady()) {
+      ++swaps;
+    }
+  }
+  stop = true;
+  stager.join();
+
+  TF_LITE_MICRO_EXPECT_EQ(0, dropped);
+  TF_LITE_MICRO_EXPECT_EQ(0, wrong);
+  TF_LITE_MICRO_EXPECT_EQ(0, stage_failures.load());
+  TF_LITE_MICRO_EXPECT(swaps.load() > kMinSwaps);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(swaps.load()),
+                          slots.generation());
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,231 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that the bulk conversions of conversion_util.h round exactly like
+// the reference QUANTIZE, DEQUANTIZE and requantize kernels.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/dequantize.h"
+#include "tensorflow/lite/kernels/internal/reference/quantize.h"
+#include "tensorflow/lite/kernels/internal/reference/requantize.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/kernels/conversion_util.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+
+// Not a multiple of the vector widths, so the scalar tails run too.
+constexpr int kSize = 203;
+constexpr float kScales[] = {0.5f, 0.1f, 0.0173f, 3.0f};
+constexpr int32_t kZeroPoints[] = {0, -5, 17};
+
+// Fills `values` with exact halves of `scale`, their neighbours and values
+// in between, all within the range of T once quantized.
+template <typename T>
+void FillTies(float scale, int32_t zero_point, float* values) {
+  const float lower =
+      (std::numeric_limits<T>::min() - zero_point + 1) * scale;
+  const float upper =
+      (std::numeric_limits<T>::max() - zero_point - 1) * scale;
+  for (int i = 0; i < kSize; ++i) {
+    const int k = i / 3 - kSize / 6;
+    const float tie = (k + 0.5f) * scale;
+    float value = tie;
+    if (i % 3 == 1) {
+      value = std::nextafter(tie, 0.0f);
+    } else if (i % 3 == 2) {
+      value = std::nextafter(tie, tie < 0.0f ? -INFINITY : INFINITY);
+    }
+    values[i] = std::min(std::max(value, lower), upper);
+  }
+}
+
+template <typename T>
+void ExpectQuantizeMatchesReference(float scale, int32_t zero_point) {
+  float input[kSize];
+  FillTies<T>(scale, zero_point, input);
+  T expected[kSize];
+  tflite::QuantizationParams params;
+  params.scale = scale;
+  params.zero_point = zero_point;
+  const tflite::RuntimeShape shape({kSize});
+  tflite::reference_ops::AffineQuantize(params, shape, input, shape,
+                                        expected);
+
+  T output[kSize];
+  tflite::micro::QuantizeFloat(input, kSize, scale, zero_point,
+                               std::numeric_limits<T>::min(),
+                               std::numeric_limits<T>::max(), output);
+  for (int i = 0; i < kSize; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected[i], output[i]);
+  }
+}
+
+template <typename T>
+void ExpectDequantizeMatchesReference(float scale, int32_t zero_point) {
+  // Every value of T, or an evenly spaced sample of them.
+  const int32_t first = std::numeric_limits<T>::min();
+  const int32_t last = std::numeric_limits<T>::max();
+  const int32_t step = (last - first) / 4096 + 1;
+  T input[4096 + 1];
+  int size = 0;
+  for (int32_t value = first; value <= last; value += step) {
+    input[size++] = static_cast<T>(value);
+  }
+
+  float expected[4096 + 1];
+  tflite::DequantizationParams params;
+  params.scale = scale;
+  params.zero_point = zero_point;
+  const tflite::RuntimeShape shape({size});
+  tflite::reference_ops::Dequantize(params, shape, input, shape, expected);
+
+  float output[4096 + 1];
+  tflite::micro::DequantizeToFloat(input, size, scale, zero_point, output);
+  for (int i = 0; i < size; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(expected[i], output[i], 0.0f);
+  }
+}
+
+template <typename InputT, typename OutputT>
+void ExpectRequantizeMatchesReference(double scale, int32_t input_zero_point,
+                                      int32_t output_zero_point) {
+  int32_t multiplier;
+  int shift;
+  tflite::QuantizeMultiplier(scale, &multiplier, &shift);
+
+  // Every value of InputT, in chunks.
+  constexpr int kChunk = 1024;
+  const int32_t first = std::numeric_limits<InputT>::min();
+  const int32_t last = std::numeric_limits<InputT>::max();
+  int mismatches = 0;
+  for (int32_t start = first; start <= last; start += kChunk) {
+    InputT input[kChunk];
+    int size = 0;
+    for (int32_t value = start; value <= last && size < kChunk; ++value) {
+      input[size++] = static_cast<InputT>(value);
+    }
+    OutputT expected[kChunk];
+    tflite::reference_ops::Requantize(input, size, multiplier, shift,
+                                      input_zero_point, output_zero_point,
+                                      expected);
+    OutputT output[kChunk];
+    tflite::micro::RequantizeToType(input, size, multiplier, shift,
+                                    input_zero_point, output_zero_point,
+                                    output);
+    for (int i = 0; i < size; ++i) {
+      mismatches += expected[i] != output[i] ? 1 : 0;
+    }
+  }
+  TF_LITE_MICRO_EXPECT_EQ(0, mismatches);
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestQuantizeRoundsTiesLikeReference) {
+  for (float scale : kScales) {
+    for (int32_t zero_point : kZeroPoints) {
+      ExpectQuantizeMatchesReference<int8_t>(scale, zero_point);
+      ExpectQuantizeMatchesReference<int16_t>(scale, zero_point);
+      ExpectQuantizeMatchesReference<uint8_t>(scale, zero_point + 128);
+    }
+  }
+}
+
+TF_LITE_MICRO_TEST(TestQuantizeHalvesRoundAwayFromZero) {
+  const float input[] = {-2.5f, -1.5f, -0.5f, 0.5f, 1.5f, 2.5f};
+  const int8_t expected[] = {-3, -2, -1, 1, 2, 3};
+  int8_t output[6];
+  tflite::micro::QuantizeFloat(input, 6, 1.0f, 0, -128, 127, output);
+  for (int i = 0; i < 6; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected[i], output[i]);
+  }
+}
+
+TF_LITE_MICRO_TEST(TestQuantizeSaturates) {
+  // Values the reference can not convert to int32 saturate, and NaN maps to
+  // the minimum.
+  const float input[] = {1e20f, -1e20f, INFINITY, -INFINITY, NAN,
+                         200.0f, -200.0f, 0.0f, 1e20f};
+  const int8_t expected[] = {127, -128, 127, -128, -128, 127, -128, 3, 127};
+  int8_t output[9];
+  tflite::micro::QuantizeFloat(input, 9, 1.0f, 3, -128, 127, output);
+  for (int i = 0; i < 9; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected[i], output[i]);
+  }
+
+  // The clamp of a fused activation is applied after the zero point.
+  int8_t relu6[9];
+  tflite::micro::QuantizeFloat(input, 9, 1.0f, 3, 3, 9, relu6);
+  TF_LITE_MICRO_EXPECT_EQ(9, relu6[0]);
+  TF_LITE_MICRO_EXPECT_EQ(3, relu6[1]);
+  TF_LITE_MICRO_EXPECT_EQ(3, relu6[7]);
+}
+
+TF_LITE_MICRO_TEST(TestDequantizeMatchesReference) {
+  for (float scale : kScales) {
+    for (int32_t zero_point : kZeroPoints) {
+      ExpectDequantizeMatchesReference<int8_t>(scale, zero_point);
+      ExpectDequantizeMatchesReference<int16_t>(scale, zero_point);
+      ExpectDequantizeMatchesReference<uint8_t>(scale, zero_point + 128);
+    }
+  }
+}
+
+TF_LITE_MICRO_TEST(TestRequantizeMatchesReference) {
+  const double scales[] = {0.003, 0.37, 0.5, 1.0, 1.9, 37.5};
+  for (double scale : scales) {
+    ExpectRequantizeMatchesReference<int16_t, int8_t>(scale, 0, -4);
+    ExpectRequantizeMatchesReference<int8_t, int8_t>(scale, 7, -4);
+    ExpectRequantizeMatchesReference<int8_t, uint8_t>(scale, -3, 128);
+    ExpectRequantizeMatchesReference<uint8_t, int8_t>(scale, 131, 0);
+    ExpectRequantizeMatchesReference<int8_t, int16_t>(scale, 0, 0);
+  }
+}
+
+TF_LITE_MICRO_TEST(TestQuantizeSamplesMatchesRequantize) {
+  // Accelerometer counts of 1/2048 g into an input with a scale of 1/40 g.
+  constexpr float kSampleScale = 1.0f / 2048;
+  constexpr float kInputScale = 1.0f / 40;
+  constexpr int kInputZeroPoint = -1;
+  int16_t samples[kSize];
+  for (int i = 0; i < kSize; ++i) {
+    samples[i] = static_cast<int16_t>((i * 2731) % 65536 - 32768);
+  }
+  int32_t multiplier;
+  int shift;
+  tflite::QuantizeMultiplier(static_cast<double>(kSampleScale) / kInputScale,
+                             &multiplier, &shift);
+  int8_t expected[kSize];
+  tflite::reference_ops::Requantize(samples, kSize, multiplier, shift, 0,
+                                    kInputZeroPoint, expected);
+
+  int8_t output[kSize];
+  tflite::QuantizeSamples(samples, kSize, kSampleScale, kInputScale,
+                          kInputZeroPoint, output);
+  for (int i = 0; i < kSize; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected[i], output[i]);
+  }
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,226 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that ResizeInputTensor() gives the same outputs as batch 1 runs,
+// does not grow the arena when it is repeated, and rejects the resizes it
+// can not propagate.
+
+#include <cstdint>
+#include <cstring>
+
+#include "accel_model.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+
+namespace {
+
+constexpr int kMaxBatch = 64;
+constexpr int kMaxDims = 4;
+constexpr int kMaxWindowOutputs = 16;
+constexpr size_t kArenaSize = 1024 * 1024;
+alignas(16) uint8_t arena[kArenaSize];
+float expected[kMaxBatch * kMaxWindowOutputs];
+
+// Batch sizes cycled through by the resize test. Every size is visited more
+// than once, so a leak on any resize shows up in the arena usage.
+constexpr int kBatches[] = {64, 1, 4, 64, 16, 1, 64, 2};
+
+int ElementCount(const TfLiteEvalTensor* tensor) {
+  return tflite::ElementCount(*tensor->dims);
+}
+
+void FillWindow(float* window, int size, int window_index) {
+  for (int i = 0; i < size; ++i) {
+    window[i] = 0.0625f * ((i * 7 + window_index * 13) % 29) - 0.75f;
+  }
+}
+
+// Copies the dims of the first input with the batch set to `batch`.
+TfLiteIntArray* BatchDims(tflite::MicroInterpreter* interpreter, int batch,
+                          int* dims_data) {
+  const TfLiteIntArray* dims = interpreter->input_eval_tensor(0)->dims;
+  dims_data[0] = dims->size;
+  for (int i = 0; i < dims->size; ++i) {
+    dims_data[i + 1] = dims->data[i];
+  }
+  dims_data[1] = batch;
+  return tflite::testing::IntArrayFromInts(dims_data);
+}
+
+void TestResizeMatchesBatchOne(const tflite::Model* model) {
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.EnableResizing(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(1, interpreter.input_eval_tensor(0)->dims->data[0]);
+  TF_LITE_MICRO_EXPECT(interpreter.input_eval_tensor(0)->dims->size <=
+                       kMaxDims);
+
+  // Outputs of every window, one window per Invoke().
+  const int window_inputs = ElementCount(interpreter.input_eval_tensor(0));
+  const int window_outputs = ElementCount(interpreter.output_eval_tensor(0));
+  TF_LITE_MICRO_EXPECT(window_outputs <= kMaxWindowOutputs);
+  for (int window = 0; window < kMaxBatch; ++window) {
+    FillWindow(interpreter.typed_input<float>(0).data(), window_inputs,
+               window);
+    TF_LITE_MICRO_EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+    memcpy(&expected[window * window_outputs],
+           interpreter.typed_output<float>(0).data(),
+           window_outputs * sizeof(float));
+  }
+
+  // The first resize copies the activation dims out of the flatbuffer, every
+  // later one must reuse all arena memory.
+  size_t used_bytes = 0;
+  int dims_data[kMaxDims + 1];
+  for (int round = 0; round < 3; ++round) {
+    for (int batch : kBatches) {
+      TF_LITE_MICRO_EXPECT_EQ(
+          interpreter.ResizeInputTensor(
+              0, BatchDims(&interpreter, batch, dims_data)),
+          kTfLiteOk);
+      if (used_bytes == 0) {
+        used_bytes = interpreter.arena_used_bytes();
+      }
+      TF_LITE_MICRO_EXPECT_EQ(used_bytes, interpreter.arena_used_bytes());
+
+      TfLiteEvalTensor* input = interpreter.input_eval_tensor(0);
+      const TfLiteEvalTensor* output = interpreter.output_eval_tensor(0);
+      TF_LITE_MICRO_EXPECT_EQ(batch, input->dims->data[0]);
+      TF_LITE_MICRO_EXPECT_EQ(batch, output->dims->data[0]);
+      TF_LITE_MICRO_EXPECT_EQ(batch * window_inputs, ElementCount(input));
+      TF_LITE_MICRO_EXPECT_EQ(batch * window_outputs, ElementCount(output));
+
+      float* input_data = tflite::micro::GetTensorData<float>(input);
+      for (int window = 0; window < batch; ++window) {
+        FillWindow(&input_data[window * window_inputs], window_inputs,
+                   window);
+      }
+      TF_LITE_MICRO_EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+      TF_LITE_MICRO_EXPECT_EQ(
+          0, memcmp(expected, tflite::micro::GetTensorData<float>(output),
+                    batch * window_outputs * sizeof(float)));
+    }
+  }
+}
+
+// Expects `dims` to be rejected, and the interpreter to keep running at
+// batch 1.
+void ExpectResizeRejected(tflite::MicroInterpreter* interpreter,
+                          TfLiteIntArray* dims) {
+  const int window_inputs = ElementCount(interpreter->input_eval_tensor(0));
+  FillWindow(interpreter->typed_input<float>(0).data(), window_inputs, 3);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const int window_outputs = ElementCount(interpreter->output_eval_tensor(0));
+  float before[kMaxWindowOutputs];
+  memcpy(before, interpreter->typed_output<float>(0).data(),
+         window_outputs * sizeof(float));
+
+  TF_LITE_MICRO_EXPECT_EQ(interpreter->ResizeInputTensor(0, dims),
+                          kTfLiteError);
+  TF_LITE_MICRO_EXPECT_EQ(window_inputs,
+                          ElementCount(interpreter->input_eval_tensor(0)));
+  TF_LITE_MICRO_EXPECT_EQ(window_outputs,
+                          ElementCount(interpreter->output_eval_tensor(0)));
+  FillWindow(interpreter->typed_input<float>(0).data(), window_inputs, 3);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter->Invoke(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(
+      0, memcmp(before, interpreter->typed_output<float>(0).data(),
+                window_outputs * sizeof(float)));
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestResizeAccelModelMatchesBatchOne) {
+  TestResizeMatchesBatchOne(tflite::GetModel(g_model));
+}
+
+TF_LITE_MICRO_TEST(TestResizeConvModelMatchesBatchOne) {
+  // CONV_2D allocates persistent buffers in Prepare, which a re-prepare must
+  // get back instead of allocating new ones.
+  TestResizeMatchesBatchOne(tflite::GetModel(kTestConvModelData));
+}
+
+TF_LITE_MICRO_TEST(TestResizeRequiresEnableResizing) {
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(tflite::GetModel(g_model), op_resolver,
+                                       arena, kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  int dims_data[kMaxDims + 1];
+  ExpectResizeRejected(&interpreter, BatchDims(&interpreter, 4, dims_data));
+}
+
+TF_LITE_MICRO_TEST(TestWindowLengthResizeIsRejected) {
+  const tflite::Model* models[] = {tflite::GetModel(g_model),
+                                   tflite::GetModel(kTestConvModelData)};
+  for (const tflite::Model* model : models) {
+    tflite::AllOpsResolver op_resolver;
+    tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                         micro_test::reporter);
+    TF_LITE_MICRO_EXPECT_EQ(interpreter.EnableResizing(), kTfLiteOk);
+    TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+    // Doubles the second dimension, the window length of both models.
+    int dims_data[kMaxDims + 1];
+    TfLiteIntArray* dims = BatchDims(&interpreter, 1, dims_data);
+    dims->data[1] *= 2;
+    ExpectResizeRejected(&interpreter, dims);
+
+    // So is a change of the number of dimensions.
+    dims = BatchDims(&interpreter, 4, dims_data);
+    dims->size -= 1;
+    ExpectResizeRejected(&interpreter, dims);
+  }
+}
+
+TF_LITE_MICRO_TEST(TestResizeOfBoundTensorIsRejected) {
+  // Holds one window of the accel model, whose input and output are [1, 3].
+  alignas(16) float bound[3];
+  for (int bind_output = 0; bind_output < 2; ++bind_output) {
+    tflite::AllOpsResolver op_resolver;
+    tflite::MicroInterpreter interpreter(tflite::GetModel(g_model),
+                                         op_resolver, arena, kArenaSize,
+                                         micro_test::reporter);
+    if (bind_output) {
+      TF_LITE_MICRO_EXPECT_EQ(interpreter.BindOutput(0, bound), kTfLiteOk);
+    } else {
+      TF_LITE_MICRO_EXPECT_EQ(interpreter.BindInput(0, bound), kTfLiteOk);
+    }
+    TF_LITE_MICRO_EXPECT_EQ(interpreter.EnableResizing(), kTfLiteOk);
+    TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+    TF_LITE_MICRO_EXPECT_EQ(3, ElementCount(interpreter.input_eval_tensor(0)));
+    TF_LITE_MICRO_EXPECT_EQ(3,
+                            ElementCount(interpreter.output_eval_tensor(0)));
+
+    // Growing the bound tensor could overrun its buffer.
+    int dims_data[kMaxDims + 1];
+    ExpectResizeRejected(&interpreter, BatchDims(&interpreter, 4, dims_data));
+    TF_LITE_MICRO_EXPECT(bound == (bind_output
+                                       ? interpreter.output_eval_tensor(0)
+                                       : interpreter.input_eval_tensor(0))
+                                      ->data.data);
+  }
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,342 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that an interpreter in streaming mode, see
+// MicroInterpreter::SetStreamingHop(), computes exactly the outputs of one
+// that runs every window in full.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr int kWindow = 64;
+constexpr int kChannels = 3;
+constexpr int kFeatures = 8;
+constexpr int kHop = 4;
+constexpr int kWindows = 40;
+constexpr size_t kArenaSize = 32 * 1024;
+constexpr int kMaxConstantBytes = 1024;
+
+alignas(16) uint8_t full_arena[kArenaSize];
+alignas(16) uint8_t streaming_arena[kArenaSize];
+
+// Builds the tensors, buffers and operators of a model one at a time.
+class EncoderBuilder {
+ public:
+  EncoderBuilder(flatbuffers::FlatBufferBuilder* builder, bool quantized)
+      : builder_(builder), quantized_(quantized) {
+    buffers_[buffer_count_++] = tflite::CreateBuffer(*builder_);
+  }
+
+  int AddActivation(int height, int channels, float scale, int zero_point) {
+    const int32_t shape[] = {1, height, 1, channels};
+    flatbuffers::Offset<tflite::QuantizationParameters> quantization = 0;
+    if (quantized_) {
+      const int64_t zero_points[] = {zero_point};
+      quantization = tflite::CreateQuantizationParameters(
+          *builder_, 0, 0, builder_->CreateVector(&scale, 1),
+          builder_->CreateVector(zero_points, 1));
+    }
+    return AddTensor(shape, 4, ActivationType(), 0, quantization);
+  }
+
+  // Adds a filter of `shape` with per-channel scales along
+  // `quantized_dimension`, followed by its bias.
+  int AddWeights(const int32_t* shape, int quantized_dimension, int seed) {
+    const int channels = shape[quantized_dimension];
+    const int count = shape[0] * shape[1] * shape[2] * shape[3];
+    float filter_scales[kFeatures];
+    float bias_scales[kFeatures];
+    int64_t zero_points[kFeatures] = {};
+    for (int c = 0; c < channels; ++c) {
+      filter_scales[c] = 0.004f + 0.001f * (c % 5);
+      bias_scales[c] = 0.05f * filter_scales[c];
+    }
+
+    uint8_t data[kMaxConstantBytes];
+    int bytes;
+    if (quantized_) {
+      int8_t* values = reinterpret_cast<int8_t*>(data);
+      for (int i = 0; i < count; ++i) {
+        values[i] = static_cast<int8_t>((i * 73 + seed * 31) % 255 - 127);
+      }
+      bytes = count;
+    } else {
+      FillFloats(count, seed, data);
+      bytes = count * sizeof(float);
+    }
+    const int filter = AddTensor(
+        shape, 4, ActivationType(), AddBuffer(data, bytes),
+        AddQuantization(filter_scales, zero_points, channels,
+                        quantized_dimension));
+
+    const int32_t bias_shape[] = {channels};
+    if (quantized_) {
+      int32_t values[kFeatures];
+      for (int c = 0; c < channels; ++c) {
+        values[c] = (c * 977 + seed) % 4001 - 2000;
+      }
+      memcpy(data, values, channels * sizeof(int32_t));
+    } else {
+      FillFloats(channels, seed + 1, data);
+    }
+    AddTensor(bias_shape, 1,
+              quantized_ ? tflite::TensorType_INT32
+                         : tflite::TensorType_FLOAT32,
+              AddBuffer(data, channels * 4),
+              AddQuantization(bias_scales, zero_points, channels, 0));
+    return filter;
+  }
+
+  void AddOperator(int opcode_index, const int32_t* inputs, int inputs_size,
+                   int output, tflite::BuiltinOptions options_type,
+                   flatbuffers::Offset<void> options) {
+    operators_[operator_count_++] = tflite::CreateOperator(
+        *builder_, opcode_index, builder_->CreateVector(inputs, inputs_size),
+        builder_->CreateVector(&output, 1), options_type, options);
+  }
+
+  const tflite::Model* Build(int input, int output) {
+    const tflite::BuiltinOperator builtins[] = {
+        tflite::BuiltinOperator_CONV_2D,
+        tflite::BuiltinOperator_DEPTHWISE_CONV_2D,
+        tflite::BuiltinOperator_MAX_POOL_2D};
+    flatbuffers::Offset<tflite::OperatorCode> opcodes[3];
+    for (int i = 0; i < 3; ++i) {
+      opcodes[i] = tflite::CreateOperatorCode(
+          *builder_, static_cast<int8_t>(builtins[i]), 0, 1, builtins[i]);
+    }
+    const flatbuffers::Offset<tflite::SubGraph> subgraphs[] = {
+        tflite::CreateSubGraph(
+            *builder_, builder_->CreateVector(tensors_, tensor_count_),
+            builder_->CreateVector(&input, 1),
+            builder_->CreateVector(&output, 1),
+            builder_->CreateVector(operators_, operator_count_))};
+    builder_->Finish(tflite::CreateModel(
+        *builder_, TFLITE_SCHEMA_VERSION, builder_->CreateVector(opcodes, 3),
+        builder_->CreateVector(subgraphs, 1), builder_->CreateString("enc"),
+        builder_->CreateVector(buffers_, buffer_count_)));
+    return tflite::GetModel(builder_->GetBufferPointer());
+  }
+
+ private:
+  static void FillFloats(int count, int seed, uint8_t* data) {
+    for (int i = 0; i < count; ++i) {
+      const float value = 0.013f * ((i * 37 + seed) % 101) - 0.6f;
+      memcpy(data + i * sizeof(float), &value, sizeof(float));
+    }
+  }
+
+  uint32_t AddBuffer(const uint8_t* data, int bytes) {
+    buffers_[buffer_count_] =
+        tflite::CreateBuffer(*builder_, builder_->CreateVector(data, bytes));
+    return buffer_count_++;
+  }
+
+  flatbuffers::Offset<tflite::QuantizationParameters> AddQuantization(
+      const float* scales, const int64_t* zero_points, int channels,
+      int quantized_dimension) {
+    if (!quantized_) {
+      return 0;
+    }
+    return tflite::CreateQuantizationParameters(
+        *builder_, 0, 0, builder_->CreateVector(scales, channels),
+        builder_->CreateVector(zero_points, channels),
+        tflite::QuantizationDetails_NONE, 0, quantized_dimension);
+  }
+
+  // Type of activations and filters.
+  tflite::TensorType ActivationType() const {
+    return quantized_ ? tflite::TensorType_INT8 : tflite::TensorType_FLOAT32;
+  }
+
+  int AddTensor(const int32_t* shape, int rank, tflite::TensorType type,
+                uint32_t buffer,
+                flatbuffers::Offset<tflite::QuantizationParameters>
+                    quantization) {
+    tensors_[tensor_count_] = tflite::CreateTensor(
+        *builder_, builder_->CreateVector(shape, rank), type, buffer, 0,
+        quantization);
+    return tensor_count_++;
+  }
+
+  flatbuffers::FlatBufferBuilder* builder_;
+  bool quantized_;
+  flatbuffers::Offset<tflite::Buffer> buffers_[8];
+  flatbuffers::Offset<tflite::Tensor> tensors_[16];
+  flatbuffers::Offset<tflite::Operator> operators_[4];
+  int buffer_count_ = 0;
+  int tensor_count_ = 0;
+  int operator_count_ = 0;
+};
+
+// Builds a causal encoder over a [1, kWindow, 1, kChannels] window:
+// CONV_2D with 5 taps, DEPTHWISE_CONV_2D with 3 taps, MAX_POOL_2D by 2 and
+// CONV_2D with 3 taps. None of them pads, so every layer can stream.
+const tflite::Model* BuildEncoder(flatbuffers::FlatBufferBuilder* builder,
+                                  bool quantized) {
+  EncoderBuilder encoder(builder, quantized);
+  const int input = encoder.AddActivation(kWindow, kChannels, 0.05f, -3);
+  const int32_t conv1_shape[] = {kFeatures, 5, 1, kChannels};
+  const int conv1 = encoder.AddWeights(conv1_shape, 0, 1);
+  const int conv1_out = encoder.AddActivation(kWindow - 4, kFeatures, 0.1f, 1);
+  const int32_t depthwise_shape[] = {1, 3, 1, kFeatures};
+  const int depthwise = encoder.AddWeights(depthwise_shape, 3, 2);
+  const int depthwise_out =
+      encoder.AddActivation(kWindow - 6, kFeatures, 0.1f, -2);
+  const int pool_out =
+      encoder.AddActivation((kWindow - 6) / 2, kFeatures, 0.1f, -2);
+  const int32_t conv2_shape[] = {kFeatures, 3, 1, kFeatures};
+  const int conv2 = encoder.AddWeights(conv2_shape, 0, 3);
+  const int output =
+      encoder.AddActivation((kWindow - 6) / 2 - 2, kFeatures, 0.12f, 0);
+
+  const int32_t conv1_inputs[] = {input, conv1, conv1 + 1};
+  encoder.AddOperator(
+      0, conv1_inputs, 3, conv1_out, tflite::BuiltinOptions_Conv2DOptions,
+      tflite::CreateConv2DOptions(*builder, tflite::Padding_VALID, 1, 1)
+          .Union());
+  const int32_t depthwise_inputs[] = {conv1_out, depthwise, depthwise + 1};
+  encoder.AddOperator(1, depthwise_inputs, 3, depthwise_out,
+                      tflite::BuiltinOptions_DepthwiseConv2DOptions,
+                      tflite::CreateDepthwiseConv2DOptions(
+                          *builder, tflite::Padding_VALID, 1, 1, 1)
+                          .Union());
+  const int32_t pool_inputs[] = {depthwise_out};
+  encoder.AddOperator(2, pool_inputs, 1, pool_out,
+                      tflite::BuiltinOptions_Pool2DOptions,
+                      tflite::CreatePool2DOptions(
+                          *builder, tflite::Padding_VALID, 1, 2, 1, 2)
+                          .Union());
+  const int32_t conv2_inputs[] = {pool_out, conv2, conv2 + 1};
+  encoder.AddOperator(
+      0, conv2_inputs, 3, output, tflite::BuiltinOptions_Conv2DOptions,
+      tflite::CreateConv2DOptions(*builder, tflite::Padding_VALID, 1, 1)
+          .Union());
+  return encoder.Build(input, output);
+}
+
+// Copies the window of a synthetic sensor signal that starts at `start`.
+void FillWindow(tflite::MicroInterpreter* interpreter, int start) {
+  TfLiteTensor* input = interpreter->input(0);
+  for (int row = 0; row < kWindow; ++row) {
+    for (int c = 0; c < kChannels; ++c) {
+      const int t = start + row;
+      const float value =
+          std::sin(t * 0.13f + c) + 0.3f * std::sin(t * 0.71f + (t % 7));
+      if (input->type == kTfLiteFloat32) {
+        input->data.f[row * kChannels + c] = value;
+      } else {
+        input->data.int8[row * kChannels + c] =
+            static_cast<int8_t>(std::lround(value * 60.0f));
+      }
+    }
+  }
+}
+
+enum class StreamingMode {
+  kInvoke,
+  // Runs the streaming interpreter one operator at a time.
+  kInvokeStep,
+  // Jumps the input half way and calls ResetStreamingState().
+  kResetAfterJump,
+};
+
+// Slides both interpreters over the signal and counts the windows whose
+// outputs differ.
+void TestStreamingMatchesFullWindows(bool quantized, StreamingMode mode) {
+  flatbuffers::FlatBufferBuilder builder;
+  const tflite::Model* model = BuildEncoder(&builder, quantized);
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter full(model, op_resolver, full_arena, kArenaSize,
+                                micro_test::reporter);
+  tflite::MicroInterpreter streaming(model, op_resolver, streaming_arena,
+                                     kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(streaming.SetStreamingHop(kHop), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(full.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(streaming.AllocateTensors(), kTfLiteOk);
+  // Every layer keeps the rows of the previous window.
+  TF_LITE_MICRO_EXPECT(streaming.streaming_cache_bytes() > 0);
+  TF_LITE_MICRO_EXPECT_EQ(0u, full.streaming_cache_bytes());
+
+  int mismatches = 0;
+  int start = 0;
+  for (int window = 0; window < kWindows; ++window) {
+    if (mode == StreamingMode::kResetAfterJump && window == kWindows / 2) {
+      start += 3;
+      streaming.ResetStreamingState();
+    }
+    FillWindow(&full, start);
+    FillWindow(&streaming, start);
+    TF_LITE_MICRO_EXPECT_EQ(full.Invoke(), kTfLiteOk);
+    TfLiteStatus status;
+    if (mode == StreamingMode::kInvokeStep) {
+      do {
+        status = streaming.InvokeStep(0);
+      } while (status == tflite::kTfLiteInvokeContinue);
+    } else {
+      status = streaming.Invoke();
+    }
+    TF_LITE_MICRO_EXPECT_EQ(status, kTfLiteOk);
+    if (memcmp(full.output(0)->data.raw, streaming.output(0)->data.raw,
+               full.output(0)->bytes) != 0) {
+      ++mismatches;
+    }
+    start += kHop;
+  }
+  TF_LITE_MICRO_EXPECT_EQ(0, mismatches);
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestStreamingInt8MatchesFullWindows) {
+  TestStreamingMatchesFullWindows(true, StreamingMode::kInvoke);
+}
+
+TF_LITE_MICRO_TEST(TestStreamingFloatMatchesFullWindows) {
+  TestStreamingMatchesFullWindows(false, StreamingMode::kInvoke);
+}
+
+TF_LITE_MICRO_TEST(TestStreamingWithInvokeStep) {
+  TestStreamingMatchesFullWindows(true, StreamingMode::kInvokeStep);
+}
+
+TF_LITE_MICRO_TEST(TestResetStreamingStateAfterJump) {
+  TestStreamingMatchesFullWindows(true, StreamingMode::kResetAfterJump);
+}
+
+TF_LITE_MICRO_TEST(TestStreamingHopMustBeSetFirst) {
+  flatbuffers::FlatBufferBuilder builder;
+  const tflite::Model* model = BuildEncoder(&builder, true);
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, streaming_arena,
+                                       kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.SetStreamingHop(-1), kTfLiteError);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  TF_LITE_MICRO_EXPECT_EQ(interpreter.SetStreamingHop(kHop), kTfLiteError);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,361 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that FULLY_CONNECTED, CONV_2D and DEPTHWISE_CONV_2D layers split
+// across a MicroWorkerPool of 1 to kMaxThreads threads compute exactly the
+// outputs of a single-threaded run. The pools have no minimum amount of
+// work, so even these small layers are split, and the splits leave some
+// threads with one unit more than others.
+
+#include <cstdint>
+#include <cstring>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_thread_pool.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 32 * 1024;
+constexpr int kMaxConstantBytes = 4096;
+constexpr int kMaxOutputBytes = 4096;
+constexpr int kMaxChannels = 16;
+
+alignas(16) uint8_t arena[kArenaSize];
+
+// Builds a model of a single layer with an activation input, a constant
+// filter and bias, and an activation output.
+class LayerBuilder {
+ public:
+  LayerBuilder(flatbuffers::FlatBufferBuilder* builder, bool quantized)
+      : builder_(builder), quantized_(quantized) {
+    buffers_[buffer_count_++] = tflite::CreateBuffer(*builder_);
+  }
+
+  void AddActivation(const int32_t* shape, int rank, float scale,
+                     int zero_point) {
+    flatbuffers::Offset<tflite::QuantizationParameters> quantization = 0;
+    if (quantized_) {
+      const int64_t zero_points[] = {zero_point};
+      quantization = tflite::CreateQuantizationParameters(
+          *builder_, 0, 0, builder_->CreateVector(&scale, 1),
+          builder_->CreateVector(zero_points, 1));
+    }
+    AddTensor(shape, rank, ActivationType(), 0, quantization);
+  }
+
+  // Adds a filter of `shape` and its bias. Quantized filters get one scale
+  // per channel along `quantized_dimension`, except for FULLY_CONNECTED,
+  // which takes a single scale.
+  void AddWeights(const int32_t* shape, int rank, int quantized_dimension,
+                  bool per_channel) {
+    int count = 1;
+    for (int i = 0; i < rank; ++i) {
+      count *= shape[i];
+    }
+    const int channels = shape[quantized_dimension];
+    const int scale_count = per_channel ? channels : 1;
+    float filter_scales[kMaxChannels];
+    float bias_scales[kMaxChannels];
+    int64_t zero_points[kMaxChannels] = {};
+    for (int c = 0; c < scale_count; ++c) {
+      filter_scales[c] = 0.004f + 0.001f * (c % 5);
+      bias_scales[c] = 0.05f * filter_scales[c];
+    }
+
+    uint8_t data[kMaxConstantBytes];
+    if (quantized_) {
+      for (int i = 0; i < count; ++i) {
+        data[i] = static_cast<uint8_t>((i * 73 + 5) % 255 - 127);
+      }
+    } else {
+      FillFloats(count, 6, data);
+    }
+    AddTensor(shape, rank, ActivationType(),
+              AddBuffer(data, count * (quantized_ ? 1 : 4)),
+              AddQuantization(filter_scales, zero_points, scale_count,
+                              quantized_dimension));
+
+    if (quantized_) {
+      for (int c = 0; c < channels; ++c) {
+        const int32_t value = (c * 977 + 3) % 4001 - 2000;
+        memcpy(data + c * sizeof(int32_t), &value, sizeof(int32_t));
+      }
+    } else {
+      FillFloats(channels, 7, data);
+    }
+    const int32_t bias_shape[] = {channels};
+    AddTensor(bias_shape, 1,
+              quantized_ ? tflite::TensorType_INT32
+                         : tflite::TensorType_FLOAT32,
+              AddBuffer(data, channels * 4),
+              AddQuantization(bias_scales, zero_points, scale_count, 0));
+  }
+
+  const tflite::Model* Build(tflite::BuiltinOperator code,
+                             tflite::BuiltinOptions options_type,
+                             flatbuffers::Offset<void> options) {
+    const int32_t inputs[] = {0, 1, 2};
+    const int32_t outputs[] = {3};
+    const flatbuffers::Offset<tflite::Operator> operators[] = {
+        tflite::CreateOperator(*builder_, 0, builder_->CreateVector(inputs, 3),
+                               builder_->CreateVector(outputs, 1),
+                               options_type, options)};
+    const flatbuffers::Offset<tflite::OperatorCode> opcodes[] = {
+        tflite::CreateOperatorCode(*builder_, static_cast<int8_t>(code), 0, 1,
+                                   code)};
+    const flatbuffers::Offset<tflite::SubGraph> subgraphs[] = {
+        tflite::CreateSubGraph(
+            *builder_, builder_->CreateVector(tensors_, tensor_count_),
+            builder_->CreateVector(inputs, 1),
+            builder_->CreateVector(outputs, 1),
+            builder_->CreateVector(operators, 1))};
+    builder_->Finish(tflite::CreateModel(
+        *builder_, TFLITE_SCHEMA_VERSION, builder_->CreateVector(opcodes, 1),
+        builder_->CreateVector(subgraphs, 1), builder_->CreateString("layer"),
+        builder_->CreateVector(buffers_, buffer_count_)));
+    return tflite::GetModel(builder_->GetBufferPointer());
+  }
+
+ private:
+  static void FillFloats(int count, int seed, uint8_t* data) {
+    for (int i = 0; i < count; ++i) {
+      const float value = 0.013f * ((i * 37 + seed) % 101) - 0.6f;
+      memcpy(data + i * sizeof(float), &value, sizeof(float));
+    }
+  }
+
+  uint32_t AddBuffer(const uint8_t* data, int bytes) {
+    buffers_[buffer_count_] =
+        tflite::CreateBuffer(*builder_, builder_->CreateVector(data, bytes));
+    return buffer_count_++;
+  }
+
+  flatbuffers::Offset<tflite::QuantizationParameters> AddQuantization(
+      const float* scales, const int64_t* zero_points, int count,
+      int quantized_dimension) {
+    if (!quantized_) {
+      return 0;
+    }
+    return tflite::CreateQuantizationParameters(
+        *builder_, 0, 0, builder_->CreateVector(scales, count),
+        builder_->CreateVector(zero_points, count),
+        tflite::QuantizationDetails_NONE, 0, quantized_dimension);
+  }
+
+  tflite::TensorType ActivationType() const {
+    return quantized_ ? tflite::TensorType_INT8 : tflite::TensorType_FLOAT32;
+  }
+
+  void AddTensor(const int32_t* shape, int rank, tflite::TensorType type,
+                 uint32_t buffer,
+                 flatbuffers::Offset<tflite::QuantizationParameters>
+                     quantization) {
+    tensors_[tensor_count_++] = tflite::CreateTensor(
+        *builder_, builder_->CreateVector(shape, rank), type, buffer, 0,
+        quantization);
+  }
+
+  flatbuffers::FlatBufferBuilder* builder_;
+  bool quantized_;
+  flatbuffers::Offset<tflite::Buffer> buffers_[3];
+  flatbuffers::Offset<tflite::Tensor> tensors_[4];
+  int buffer_count_ = 0;
+  int tensor_count_ = 0;
+};
+
+const tflite::Model* BuildFullyConnected(
+    flatbuffers::FlatBufferBuilder* builder, bool quantized, int batches,
+    int accum_depth, int output_depth) {
+  LayerBuilder layer(builder, quantized);
+  const int32_t input_shape[] = {batches, accum_depth};
+  const int32_t filter_shape[] = {output_depth, accum_depth};
+  const int32_t output_shape[] = {batches, output_depth};
+  layer.AddActivation(input_shape, 2, 0.05f, -3);
+  layer.AddWeights(filter_shape, 2, 0, /*per_channel=*/false);
+  layer.AddActivation(output_shape, 2, 0.2f, 4);
+  return layer.Build(tflite::BuiltinOperator_FULLY_CONNECTED,
+                     tflite::BuiltinOptions_FullyConnectedOptions,
+                     tflite::CreateFullyConnectedOptions(*builder).Union());
+}
+
+// A CONV_2D with a `filter_size` x `filter_size` filter, or filter_size x 1
+// for an input of width 1.
+const tflite::Model* BuildConv(flatbuffers::FlatBufferBuilder* builder,
+                               bool quantized, const int32_t* input_shape,
+                               int filter_size, int output_channels,
+                               int stride) {
+  LayerBuilder layer(builder, quantized);
+  const int filter_width = input_shape[2] == 1 ? 1 : filter_size;
+  const int32_t filter_shape[] = {output_channels, filter_size, filter_width,
+                                  input_shape[3]};
+  // Padded to keep the input size at stride 1.
+  const int32_t output_shape[] = {
+      input_shape[0], (input_shape[1] + stride - 1) / stride,
+      (input_shape[2] + stride - 1) / stride, output_channels};
+  layer.AddActivation(input_shape, 4, 0.05f, -3);
+  layer.AddWeights(filter_shape, 4, 0, /*per_channel=*/true);
+  layer.AddActivation(output_shape, 4, 0.2f, 4);
+  return layer.Build(
+      tflite::BuiltinOperator_CONV_2D, tflite::BuiltinOptions_Conv2DOptions,
+      tflite::CreateConv2DOptions(*builder, tflite::Padding_SAME, stride,
+                                  stride)
+          .Union());
+}
+
+const tflite::Model* BuildDepthwiseConv(
+    flatbuffers::FlatBufferBuilder* builder, bool quantized,
+    const int32_t* input_shape, int depth_multiplier, int stride) {
+  LayerBuilder layer(builder, quantized);
+  const int output_channels = input_shape[3] * depth_multiplier;
+  const int32_t filter_shape[] = {1, 3, 3, output_channels};
+  const int32_t output_shape[] = {
+      input_shape[0], (input_shape[1] + stride - 1) / stride,
+      (input_shape[2] + stride - 1) / stride, output_channels};
+  layer.AddActivation(input_shape, 4, 0.05f, -3);
+  layer.AddWeights(filter_shape, 4, 3, /*per_channel=*/true);
+  layer.AddActivation(output_shape, 4, 0.2f, 4);
+  return layer.Build(tflite::BuiltinOperator_DEPTHWISE_CONV_2D,
+                     tflite::BuiltinOptions_DepthwiseConv2DOptions,
+                     tflite::CreateDepthwiseConv2DOptions(
+                         *builder, tflite::Padding_SAME, stride, stride,
+                         depth_multiplier)
+                         .Union());
+}
+
+// Runs `model` on `pool`, or single-threaded for nullptr, and copies its
+// output to `output`. A nonzero `packing_bytes` lets the layer pack its
+// weights first.
+TfLiteStatus RunModel(const tflite::Model* model,
+                      tflite::MicroThreadPool* pool, size_t packing_bytes,
+                      uint8_t* output, size_t* output_bytes) {
+  tflite::AllOpsResolver op_resolver;
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, kArenaSize,
+                                       micro_test::reporter);
+  interpreter.SetThreadPool(pool);
+  if (packing_bytes != 0) {
+    interpreter.SetWeightPacking(packing_bytes);
+  }
+  TF_LITE_ENSURE_STATUS(interpreter.AllocateTensors());
+  TfLiteTensor* input = interpreter.input(0);
+  if (input->type == kTfLiteInt8) {
+    for (size_t i = 0; i < input->bytes; ++i) {
+      input->data.int8[i] = static_cast<int8_t>((i * 37 + 11) % 256 - 128);
+    }
+  } else {
+    for (size_t i = 0; i < input->bytes / sizeof(float); ++i) {
+      input->data.f[i] = 0.37f * ((i * 7 + 3) % 11) - 1.5f;
+    }
+  }
+  TF_LITE_ENSURE_STATUS(interpreter.Invoke());
+  *output_bytes = interpreter.output(0)->bytes;
+  if (*output_bytes > kMaxOutputBytes) {
+    return kTfLiteError;
+  }
+  memcpy(output, interpreter.output(0)->data.raw, *output_bytes);
+  return kTfLiteOk;
+}
+
+// Expects `model` to give the same output bytes on every pool size, with its
+// weights packed or as stored.
+void ExpectSameOutputsOnAllPools(const tflite::Model* model) {
+  const size_t packing_budgets[] = {0, kArenaSize};
+  for (size_t packing_bytes : packing_budgets) {
+    uint8_t expected[kMaxOutputBytes];
+    size_t expected_bytes = 0;
+    TF_LITE_MICRO_EXPECT_EQ(
+        RunModel(model, nullptr, packing_bytes, expected, &expected_bytes),
+        kTfLiteOk);
+    for (int threads = 1; threads <= tflite::MicroWorkerPool::kMaxThreads;
+         ++threads) {
+      tflite::MicroWorkerPool pool(threads, /*min_parallel_work=*/0);
+      uint8_t output[kMaxOutputBytes];
+      size_t output_bytes = 0;
+      TF_LITE_MICRO_EXPECT_EQ(
+          RunModel(model, &pool, packing_bytes, output, &output_bytes),
+          kTfLiteOk);
+      TF_LITE_MICRO_EXPECT_EQ(expected_bytes, output_bytes);
+      TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, output, expected_bytes));
+    }
+  }
+}
+
+void TestFullyConnected(bool quantized) {
+  // A single batch is split by output channels, several by batches.
+  flatbuffers::FlatBufferBuilder channels_builder;
+  ExpectSameOutputsOnAllPools(
+      BuildFullyConnected(&channels_builder, quantized, 1, 40, 13));
+  flatbuffers::FlatBufferBuilder batches_builder;
+  ExpectSameOutputsOnAllPools(
+      BuildFullyConnected(&batches_builder, quantized, 5, 24, 9));
+}
+
+void TestConv(bool quantized) {
+  // Tasks split the rows of both batches, some across the batch boundary.
+  const int32_t input_shape[] = {2, 9, 7, 3};
+  flatbuffers::FlatBufferBuilder builder;
+  ExpectSameOutputsOnAllPools(
+      BuildConv(&builder, quantized, input_shape, 3, 5, 1));
+  flatbuffers::FlatBufferBuilder strided_builder;
+  ExpectSameOutputsOnAllPools(
+      BuildConv(&strided_builder, quantized, input_shape, 3, 6, 2));
+  const int32_t column_shape[] = {1, 24, 1, 4};
+  flatbuffers::FlatBufferBuilder column_builder;
+  ExpectSameOutputsOnAllPools(
+      BuildConv(&column_builder, quantized, column_shape, 5, 6, 1));
+}
+
+void TestDepthwiseConv(bool quantized) {
+  const int32_t input_shape[] = {2, 10, 6, 4};
+  flatbuffers::FlatBufferBuilder builder;
+  ExpectSameOutputsOnAllPools(
+      BuildDepthwiseConv(&builder, quantized, input_shape, 2, 1));
+  flatbuffers::FlatBufferBuilder strided_builder;
+  ExpectSameOutputsOnAllPools(
+      BuildDepthwiseConv(&strided_builder, quantized, input_shape, 1, 2));
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestFullyConnectedInt8MatchesSingleThread) {
+  TestFullyConnected(/*quantized=*/true);
+}
+
+TF_LITE_MICRO_TEST(TestFullyConnectedFloatMatchesSingleThread) {
+  TestFullyConnected(/*quantized=*/false);
+}
+
+TF_LITE_MICRO_TEST(TestConvInt8MatchesSingleThread) {
+  TestConv(/*quantized=*/true);
+}
+
+TF_LITE_MICRO_TEST(TestConvFloatMatchesSingleThread) {
+  TestConv(/*quantized=*/false);
+}
+
+TF_LITE_MICRO_TEST(TestDepthwiseConvInt8MatchesSingleThread) {
+  TestDepthwiseConv(/*quantized=*/true);
+}
+
+TF_LITE_MICRO_TEST(TestDepthwiseConvFloatMatchesSingleThread) {
+  TestDepthwiseConv(/*quantized=*/false);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,149 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Stores the float weights of the FULLY_CONNECTED and CONV_2D layers of a
+// TFLite model as FLOAT16, which halves their flash. The kernels widen them
+// back to float, either once at Prepare time into packed weights (see
+// MicroInterpreter::SetWeightPacking()) or while reading them in every invoke.
+// Build and run it on the host from the project directory, e.g.
+//
+//   g++ -Isrc tools/convert_weights_float16.cc -o convert_weights_float16
+//   ./convert_weights_float16 lib/Model/accel_model.cc accel_fp16.tflite
+//   tools/make_model_container.py accel_fp16.tflite model.bin
+//
+// The input may be a .tflite file or a C array such as
+// lib/Model/accel_model.cc. An output ending in .cc is written as such a C
+// array, named g_model like the one the firmware embeds, otherwise as a
+// .tflite file.
+//
+// Weights are rounded to the nearest half precision value. Tensors with
+// values outside its range, shared with other operators or not constant are
+// left as float.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "model_file_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+// Largest finite half precision value.
+constexpr float kMaxFloat16 = 65504.0f;
+
+// Rounds a float to the nearest half precision value, ties to even. The
+// caller ensures it is within the half precision range.
+uint16_t FloatToFloat16(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+  const int exponent = static_cast<int>((bits >> 23) & 0xff) - 127 + 15;
+  uint32_t mantissa = bits & 0x7fffff;
+  if (exponent >= 31) {
+    return sign | 0x7c00;
+  }
+  int shift = 13;
+  uint32_t half;
+  if (exponent <= 0) {
+    // Subnormal: the implicit one becomes part of the mantissa.
+    if (exponent < -10) {
+      return sign;
+    }
+    mantissa |= 0x800000;
+    shift = 14 - exponent;
+    half = mantissa >> shift;
+  } else {
+    half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> shift);
+  }
+  const uint32_t remainder = mantissa & ((1u << shift) - 1);
+  const uint32_t halfway = 1u << (shift - 1);
+  // A carry out of the mantissa correctly increments the exponent.
+  if (remainder > halfway || (remainder == halfway && (half & 1) != 0)) {
+    ++half;
+  }
+  return sign | static_cast<uint16_t>(half);
+}
+
+float Float16ToFloat(uint16_t half) {
+  const int exponent = (half >> 10) & 0x1f;
+  const int mantissa = half & 0x3ff;
+  const float magnitude =
+      exponent == 0 ? std::ldexp(static_cast<float>(mantissa), -24)
+                    : std::ldexp(static_cast<float>(mantissa | 0x400),
+                                 exponent - 25);
+  return (half & 0x8000) != 0 ? -magnitude : magnitude;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s input.tflite|input.cc output.tflite|output.cc\n",
+            argv[0]);
+    return 1;
+  }
+  size_t input_size;
+  std::unique_ptr<tflite::ModelT> model =
+      model_file_util::ReadModelT(argv[1], &input_size);
+  if (model == nullptr) {
+    return 1;
+  }
+
+  size_t saved_bytes = 0;
+  for (const auto& subgraph : model->subgraphs) {
+    for (tflite::TensorT* tensor : model_file_util::FindFloatFilters(
+             *model, *subgraph,
+             {tflite::BuiltinOperator_FULLY_CONNECTED,
+              tflite::BuiltinOperator_CONV_2D})) {
+      std::vector<uint8_t>& data = model->buffers[tensor->buffer]->data;
+      const size_t count = data.size() / sizeof(float);
+      std::vector<float> weights(count);
+      memcpy(weights.data(), data.data(), count * sizeof(float));
+      bool fits = true;
+      for (float weight : weights) {
+        fits = fits && std::abs(weight) <= kMaxFloat16;
+      }
+      if (!fits) {
+        printf("%s: kept as float, values exceed the float16 range\n",
+               tensor->name.c_str());
+        continue;
+      }
+      std::vector<uint16_t> halves(count);
+      float max_error = 0.0f;
+      for (size_t i = 0; i < count; ++i) {
+        halves[i] = FloatToFloat16(weights[i]);
+        max_error = std::max(
+            max_error, std::abs(Float16ToFloat(halves[i]) - weights[i]));
+      }
+      data.resize(count * sizeof(uint16_t));
+      memcpy(data.data(), halves.data(), data.size());
+      tensor->type = tflite::TensorType_FLOAT16;
+      saved_bytes += count * (sizeof(float) - sizeof(uint16_t));
+      printf("%s: %zu weights, max rounding error %g\n", tensor->name.c_str(),
+             count, max_error);
+    }
+  }
+
+  if (!model_file_util::WriteModelT(argv[2], *model, input_size)) {
+    return 1;
+  }
+  printf("%zu weight bytes saved\n", saved_bytes);
+  return 0;
+}
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""Wraps a TFLite flatbuffer in the container read by tflite::MappedModel.
+
+The container is a 32 byte header (see micro_model_loader.h) padded to the
+payload alignment, followed by the flatbuffer, either unmodified or as an LZ4
+block with --lz4. Write it to one of the model partitions from
+partitions.csv, e.g.
+
+  tools/make_model_container.py model.tflite model.bin --model-version 3
+  parttool.py write_partition --partition-name model1 --input model.bin
+
+An uncompressed model is used in place from flash. A compressed one takes
+less flash but is decoded into the tensor arena at boot.
+
+The input may also be a C array such as lib/Model/accel_model.cc.
+"""
+
+import argparse
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = 0x4d4d4654  # "TFMM"
+HEADER_VERSION = 1
+FLAG_LZ4 = 1
+ALIGNMENT = 16
+HEADER_FORMAT = "<IHHIIIII4x"
+
+# LZ4 block format limits: matches are at least 4 bytes, the last match must
+# start 12 bytes before the end and the last 5 bytes are always literals.
+LZ4_MIN_MATCH = 4
+LZ4_MF_LIMIT = 12
+LZ4_LAST_LITERALS = 5
+LZ4_MAX_OFFSET = 65535
+
+
+def read_model(path):
+  with open(path, "rb") as f:
+    data = f.read()
+  if path.endswith((".cc", ".c", ".h")):
+    array = data.decode("utf-8").split("{", 1)[1].split("}", 1)[0]
+    data = bytes(int(v, 16) for v in re.findall(r"0x[0-9a-fA-F]{1,2}", array))
+  if data[4:8] != b"TFL3":
+    sys.exit("%s does not hold a TFLite model" % path)
+  return data
+
+
+def _lz4_length(out, length):
+  while length >= 255:
+    out.append(255)
+    length -= 255
+  out.append(length)
+
+
+def _lz4_sequence(out, literals, offset, match_length):
+  match_code = match_length - LZ4_MIN_MATCH if offset else 0
+  out.append((min(len(literals), 15) << 4) | min(match_code, 15))
+  if len(literals) >= 15:
+    _lz4_length(out, len(literals) - 15)
+  out += literals
+  if offset:
+    out += struct.pack("<H", offset)
+    if match_code >= 15:
+      _lz4_length(out, match_code - 15)
+
+
+def lz4_compress_block(data):
+  """Greedy LZ4 block compressor, decoded by DecodeLz4Block()."""
+  out = bytearray()
+  last_position = {}
+  anchor = 0
+  i = 0
+  while i <= len(data) - LZ4_MF_LIMIT:
+    key = data[i:i + LZ4_MIN_MATCH]
+    candidate = last_position.get(key)
+    last_position[key] = i
+    if candidate is None or i - candidate > LZ4_MAX_OFFSET:
+      i += 1
+      continue
+    length = LZ4_MIN_MATCH
+    max_length = len(data) - LZ4_LAST_LITERALS - i
+    while length < max_length and data[candidate + length] == data[i + length]:
+      length += 1
+    _lz4_sequence(out, data[anchor:i], i - candidate, length)
+    i += length
+    anchor = i
+  _lz4_sequence(out, data[anchor:], 0, 0)
+  return bytes(out)
+
+
+def make_container(model, model_version, lz4=False):
+  payload = lz4_compress_block(model) if lz4 else model
+  header_size = struct.calcsize(HEADER_FORMAT)
+  header_size = (header_size + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+  header = struct.pack(HEADER_FORMAT, MAGIC, HEADER_VERSION,
+                       FLAG_LZ4 if lz4 else 0, header_size, len(payload),
+                       zlib.crc32(payload) & 0xffffffff, model_version,
+                       len(model))
+  return header.ljust(header_size, b"\0") + payload
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+  parser.add_argument("input", help=".tflite file or C array source")
+  parser.add_argument("output", help="container to write")
+  parser.add_argument("--model-version", type=int, default=1,
+                      help="the newest valid model partition is loaded")
+  parser.add_argument("--lz4", action="store_true",
+                      help="compress the model, it is decoded at boot")
+  args = parser.parse_args()
+
+  model = read_model(args.input)
+  container = make_container(model, args.model_version, args.lz4)
+  with open(args.output, "wb") as f:
+    f.write(container)
+  print("%s: %d byte container for a %d byte model, version %d" %
+        (args.output, len(container), len(model), args.model_version))
+
+
+if __name__ == "__main__":
+  main()
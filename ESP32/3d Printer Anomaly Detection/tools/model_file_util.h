@@ -0,0 +1,211 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Helpers shared by the host tools that rewrite the weights of a model, see
+// convert_weights_float16.cc, quantize_weights_int4.cc and
+// prune_weights_sparse.cc.
+
+#ifndef TOOLS_MODEL_FILE_UTIL_H_
+#define TOOLS_MODEL_FILE_UTIL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace model_file_util {
+
+inline bool EndsWith(const std::string& text, const std::string& suffix) {
+  return text.size() >= suffix.size() &&
+         text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Reads a .tflite file, or the bytes of the first array initializer of a C
+// source file such as lib/Model/accel_model.cc.
+inline bool ReadModel(const std::string& path, std::vector<uint8_t>* model) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    fprintf(stderr, "Can not read %s\n", path.c_str());
+    return false;
+  }
+  const std::string contents((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+  model->clear();
+  if (EndsWith(path, ".cc") || EndsWith(path, ".c") || EndsWith(path, ".h")) {
+    const size_t begin = contents.find('{');
+    const size_t end = contents.find('}', begin);
+    if (begin == std::string::npos || end == std::string::npos) {
+      fprintf(stderr, "%s holds no array\n", path.c_str());
+      return false;
+    }
+    const char* p = contents.c_str() + begin + 1;
+    const char* const array_end = contents.c_str() + end;
+    while (p < array_end) {
+      char* next;
+      const unsigned long value = strtoul(p, &next, 16);
+      if (next == p) {
+        ++p;
+      } else {
+        model->push_back(static_cast<uint8_t>(value));
+        p = next;
+      }
+    }
+  } else {
+    model->assign(contents.begin(), contents.end());
+  }
+  if (model->size() < 8 || memcmp(model->data() + 4, "TFL3", 4) != 0) {
+    fprintf(stderr, "%s does not hold a TFLite model\n", path.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Reads and verifies a model like ReadModel(), then unpacks it to the object
+// API. Returns nullptr on failure.
+inline std::unique_ptr<tflite::ModelT> ReadModelT(const std::string& path,
+                                                  size_t* size) {
+  std::vector<uint8_t> data;
+  if (!ReadModel(path, &data)) {
+    return nullptr;
+  }
+  flatbuffers::Verifier verifier(data.data(), data.size());
+  if (!tflite::VerifyModelBuffer(verifier)) {
+    fprintf(stderr, "%s is not a valid model\n", path.c_str());
+    return nullptr;
+  }
+  *size = data.size();
+  return std::unique_ptr<tflite::ModelT>(
+      tflite::GetModel(data.data())->UnPack());
+}
+
+// Writes a model as a .tflite file, or as a C array named g_model like the
+// one the firmware embeds if `path` ends in .cc.
+inline bool WriteModel(const std::string& path, const uint8_t* data,
+                       size_t size) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    fprintf(stderr, "Can not write %s\n", path.c_str());
+    return false;
+  }
+  if (!EndsWith(path, ".cc")) {
+    fwrite(data, 1, size, file);
+    return fclose(file) == 0;
+  }
+  std::string header = path.substr(0, path.size() - 3) + ".h";
+  const size_t slash = header.find_last_of('/');
+  if (slash != std::string::npos) {
+    header = header.substr(slash + 1);
+  }
+  fprintf(file,
+          "#include \"%s\"\n\n"
+          "// Const so the model stays in flash, aligned for the flatbuffer's "
+          "tensor data.\n"
+          "alignas(16) const unsigned char g_model[] = {",
+          header.c_str());
+  for (size_t i = 0; i < size; ++i) {
+    fprintf(file, "%s0x%02x%s", i % 12 == 0 ? "\n  " : "", data[i],
+            i + 1 < size ? (i % 12 == 11 ? "," : ", ") : "");
+  }
+  fprintf(file, "\n};\nconst int g_model_len = %zu;\n", size);
+  return fclose(file) == 0;
+}
+
+// Packs `model` and writes it with WriteModel(), then prints its size.
+inline bool WriteModelT(const std::string& path, const tflite::ModelT& model,
+                        size_t input_size) {
+  flatbuffers::FlatBufferBuilder builder;
+  builder.Finish(tflite::Model::Pack(builder, &model),
+                 tflite::ModelIdentifier());
+  if (!WriteModel(path, builder.GetBufferPointer(), builder.GetSize())) {
+    return false;
+  }
+  printf("model %zu -> %u bytes\n", input_size, builder.GetSize());
+  return true;
+}
+
+// Returns the builtin code of `op`, the larger of its two code fields, see
+// tflite::GetBuiltinCode().
+inline tflite::BuiltinOperator GetBuiltinCode(const tflite::ModelT& model,
+                                              const tflite::OperatorT& op) {
+  const tflite::OperatorCodeT& op_code = *model.operator_codes[op.opcode_index];
+  return std::max(op_code.builtin_code, static_cast<tflite::BuiltinOperator>(
+                                            op_code.deprecated_builtin_code));
+}
+
+// Returns the float filters, input 1, of the operators of `subgraph` with one
+// of `codes` and a float input. Only filters that own their buffer and that
+// nothing else reads are returned, so they can be rewritten in place.
+inline std::vector<tflite::TensorT*> FindFloatFilters(
+    const tflite::ModelT& model, const tflite::SubGraphT& subgraph,
+    const std::vector<tflite::BuiltinOperator>& codes) {
+  std::vector<int> buffer_uses(model.buffers.size(), 0);
+  for (const auto& graph : model.subgraphs) {
+    for (const auto& tensor : graph->tensors) {
+      if (tensor->buffer < buffer_uses.size()) {
+        ++buffer_uses[tensor->buffer];
+      }
+    }
+  }
+
+  std::vector<int> filter_uses(subgraph.tensors.size(), 0);
+  std::vector<int> other_uses(subgraph.tensors.size(), 0);
+  for (const auto& op : subgraph.operators) {
+    const bool has_filter =
+        std::find(codes.begin(), codes.end(), GetBuiltinCode(model, *op)) !=
+            codes.end() &&
+        op->inputs.size() >= 2 && op->inputs[0] >= 0 && op->inputs[1] >= 0 &&
+        subgraph.tensors[op->inputs[0]]->type == tflite::TensorType_FLOAT32;
+    for (size_t i = 0; i < op->inputs.size(); ++i) {
+      const int index = op->inputs[i];
+      if (index < 0) {
+        continue;
+      }
+      if (has_filter && i == 1) {
+        ++filter_uses[index];
+      } else {
+        ++other_uses[index];
+      }
+    }
+  }
+  for (int output : subgraph.outputs) {
+    ++other_uses[output];
+  }
+
+  std::vector<tflite::TensorT*> filters;
+  for (size_t t = 0; t < subgraph.tensors.size(); ++t) {
+    tflite::TensorT* tensor = subgraph.tensors[t].get();
+    if (filter_uses[t] != 0 && other_uses[t] == 0 &&
+        tensor->type == tflite::TensorType_FLOAT32 &&
+        tensor->buffer < model.buffers.size() &&
+        buffer_uses[tensor->buffer] == 1 &&
+        model.buffers[tensor->buffer]->data.size() >= sizeof(float)) {
+      filters.push_back(tensor);
+    }
+  }
+  return filters;
+}
+
+}  // namespace model_file_util
+
+#endif  // TOOLS_MODEL_FILE_UTIL_H_
@@ -0,0 +1,214 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Stores the float filters of the FULLY_CONNECTED layers of a TFLite model
+// sparse, keeping only the blocks of block_size consecutive weights along the
+// input depth that are not all zero. The FULLY_CONNECTED kernel reads the
+// sparsity parameters and skips the dropped blocks. Build and run it on the
+// host from the project directory, e.g.
+//
+//   g++ -Isrc tools/prune_weights_sparse.cc -o prune_weights_sparse
+//   ./prune_weights_sparse lib/Model/accel_model.cc accel_sparse.tflite 0.7 4
+//
+// The third argument is the fraction of blocks to prune by magnitude, 0 by
+// default, which only drops blocks that are already zero as after pruning
+// during training. Pruning after training costs accuracy, so check the pruned
+// model before using it. The fourth argument is the block size, 1, 4 or 16
+// (1 by default), which must divide the input depth of a layer.
+//
+// The sparsity parameters follow the layout the TFLite converter writes:
+// (DENSE, SPARSE_CSR) dimensions for a block size of 1, and (DENSE,
+// SPARSE_CSR, DENSE 1, DENSE block_size) with block map {0, 1} otherwise.
+// Input and output files are handled as by convert_weights_float16.cc.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "model_file_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+// Returns the bytes per value of the smallest index vector type that holds
+// all of `values`.
+size_t IndexWidth(const std::vector<int>& values) {
+  const int max_value =
+      values.empty() ? 0 : *std::max_element(values.begin(), values.end());
+  return max_value <= UINT8_MAX ? 1 : max_value <= UINT16_MAX ? 2 : 4;
+}
+
+// Stores `values` in the smallest index vector type that holds them all.
+void SetIndexVector(const std::vector<int>& values,
+                    tflite::SparseIndexVectorUnion* vector) {
+  const size_t width = IndexWidth(values);
+  if (width == 1) {
+    tflite::Uint8VectorT uint8_vector;
+    uint8_vector.values.assign(values.begin(), values.end());
+    vector->Set(std::move(uint8_vector));
+  } else if (width == 2) {
+    tflite::Uint16VectorT uint16_vector;
+    uint16_vector.values.assign(values.begin(), values.end());
+    vector->Set(std::move(uint16_vector));
+  } else {
+    tflite::Int32VectorT int32_vector;
+    int32_vector.values.assign(values.begin(), values.end());
+    vector->Set(std::move(int32_vector));
+  }
+}
+
+std::unique_ptr<tflite::DimensionMetadataT> DenseDimension(int size) {
+  std::unique_ptr<tflite::DimensionMetadataT> dimension(
+      new tflite::DimensionMetadataT);
+  dimension->format = tflite::DimensionType_DENSE;
+  dimension->dense_size = size;
+  return dimension;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3 || argc > 5) {
+    fprintf(stderr,
+            "Usage: %s input.tflite|input.cc output.tflite|output.cc "
+            "[sparsity] [block_size]\n",
+            argv[0]);
+    return 1;
+  }
+  const double target_sparsity = argc > 3 ? atof(argv[3]) : 0.0;
+  const int block_size = argc > 4 ? atoi(argv[4]) : 1;
+  if (target_sparsity < 0.0 || target_sparsity >= 1.0 ||
+      (block_size != 1 && block_size != 4 && block_size != 16)) {
+    fprintf(stderr, "The sparsity must be in [0, 1), the block size 1, 4 or "
+                    "16\n");
+    return 1;
+  }
+  size_t input_size;
+  std::unique_ptr<tflite::ModelT> model =
+      model_file_util::ReadModelT(argv[1], &input_size);
+  if (model == nullptr) {
+    return 1;
+  }
+
+  size_t saved_bytes = 0;
+  for (const auto& subgraph : model->subgraphs) {
+    for (tflite::TensorT* tensor : model_file_util::FindFloatFilters(
+             *model, *subgraph, {tflite::BuiltinOperator_FULLY_CONNECTED})) {
+      std::vector<uint8_t>& data = model->buffers[tensor->buffer]->data;
+      if (tensor->shape.size() != 2 || tensor->sparsity != nullptr ||
+          static_cast<size_t>(tensor->shape[0]) * tensor->shape[1] *
+                  sizeof(float) !=
+              data.size()) {
+        continue;
+      }
+      const int output_depth = tensor->shape[0];
+      const int accum_depth = tensor->shape[1];
+      if (accum_depth % block_size != 0 ||
+          accum_depth / block_size > UINT16_MAX + 1) {
+        printf("%s: kept dense, block size does not fit an input depth of "
+               "%d\n",
+               tensor->name.c_str(), accum_depth);
+        continue;
+      }
+      const int column_count = accum_depth / block_size;
+      std::vector<float> weights(data.size() / sizeof(float));
+      memcpy(weights.data(), data.data(), data.size());
+
+      // Ranks the blocks by the sum of their absolute weights and zeroes the
+      // smallest ones.
+      std::vector<float> block_norms(weights.size() / block_size, 0.0f);
+      for (size_t i = 0; i < weights.size(); ++i) {
+        block_norms[i / block_size] += std::abs(weights[i]);
+      }
+      const size_t prune_count =
+          static_cast<size_t>(target_sparsity * block_norms.size());
+      if (prune_count > 0) {
+        std::vector<float> sorted_norms(block_norms);
+        std::nth_element(sorted_norms.begin(),
+                         sorted_norms.begin() + prune_count - 1,
+                         sorted_norms.end());
+        const float threshold = sorted_norms[prune_count - 1];
+        size_t pruned = 0;
+        for (size_t k = 0; k < block_norms.size() && pruned < prune_count;
+             ++k) {
+          if (block_norms[k] <= threshold) {
+            block_norms[k] = 0.0f;
+            ++pruned;
+          }
+        }
+      }
+
+      std::vector<int> segments(1, 0);
+      std::vector<int> indices;
+      std::vector<float> values;
+      for (int c = 0; c < output_depth; ++c) {
+        for (int column = 0; column < column_count; ++column) {
+          const size_t k = static_cast<size_t>(c) * column_count + column;
+          if (block_norms[k] == 0.0f) {
+            continue;
+          }
+          indices.push_back(column);
+          values.insert(values.end(), weights.begin() + k * block_size,
+                        weights.begin() + (k + 1) * block_size);
+        }
+        segments.push_back(static_cast<int>(indices.size()));
+      }
+
+      std::unique_ptr<tflite::SparsityParametersT> sparsity(
+          new tflite::SparsityParametersT);
+      std::unique_ptr<tflite::DimensionMetadataT> csr(
+          new tflite::DimensionMetadataT);
+      csr->format = tflite::DimensionType_SPARSE_CSR;
+      SetIndexVector(segments, &csr->array_segments);
+      SetIndexVector(indices, &csr->array_indices);
+      sparsity->dim_metadata.push_back(DenseDimension(output_depth));
+      sparsity->dim_metadata.push_back(std::move(csr));
+      if (block_size == 1) {
+        sparsity->traversal_order = {0, 1};
+      } else {
+        sparsity->traversal_order = {0, 1, 2, 3};
+        sparsity->block_map = {0, 1};
+        sparsity->dim_metadata.push_back(DenseDimension(1));
+        sparsity->dim_metadata.push_back(DenseDimension(block_size));
+      }
+      tensor->sparsity = std::move(sparsity);
+
+      const size_t dense_bytes = data.size();
+      data.resize(values.size() * sizeof(float));
+      if (!values.empty()) {
+        memcpy(data.data(), values.data(), data.size());
+      }
+      const size_t index_bytes = segments.size() * IndexWidth(segments) +
+                                 indices.size() * IndexWidth(indices);
+      saved_bytes += dense_bytes - data.size() - index_bytes;
+      printf("%s: %d of %d blocks kept, %zu -> %zu weight + %zu index "
+             "bytes\n",
+             tensor->name.c_str(), segments.back(),
+             output_depth * column_count, dense_bytes, data.size(),
+             index_bytes);
+    }
+  }
+
+  if (!model_file_util::WriteModelT(argv[2], *model, input_size)) {
+    return 1;
+  }
+  printf("%zu bytes saved before flatbuffer overhead\n", saved_bytes);
+  return 0;
+}
@@ -0,0 +1,145 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Quantizes the float weights of the FULLY_CONNECTED layers of a TFLite model
+// to INT4, packed two per byte, which takes an eighth of their flash. Every
+// output channel gets its own scale and zero point. The layers keep their
+// float input, output and bias and run as hybrid layers, see
+// fully_connected.cc. Build and run it on the host from the project
+// directory, e.g.
+//
+//   g++ -Isrc tools/quantize_weights_int4.cc -o quantize_weights_int4
+//   ./quantize_weights_int4 lib/Model/accel_model.cc accel_int4.tflite
+//   tools/make_model_container.py accel_int4.tflite model.bin
+//
+// The input may be a .tflite file or a C array such as
+// lib/Model/accel_model.cc. An output ending in .cc is written as such a C
+// array, named g_model like the one the firmware embeds, otherwise as a
+// .tflite file.
+//
+// Filters shared with other operators or not constant are left as float.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "model_file_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr int kMinInt4 = -8;
+constexpr int kMaxInt4 = 7;
+
+// Quantizes one output channel. The range of the weights is extended to
+// include 0, so that it is represented exactly, and split into 15 steps.
+void QuantizeChannel(const float* weights, int size, float* scale,
+                     int* zero_point, int8_t* quantized) {
+  float min_value = 0.0f;
+  float max_value = 0.0f;
+  for (int i = 0; i < size; ++i) {
+    min_value = std::min(min_value, weights[i]);
+    max_value = std::max(max_value, weights[i]);
+  }
+  *scale = (max_value - min_value) / (kMaxInt4 - kMinInt4);
+  if (*scale == 0.0f) {
+    // All weights are 0.
+    *scale = 1.0f;
+  }
+  *zero_point = std::min(
+      kMaxInt4, std::max(kMinInt4, static_cast<int>(std::round(
+                                       kMinInt4 - min_value / *scale))));
+  for (int i = 0; i < size; ++i) {
+    const int value = static_cast<int>(std::round(weights[i] / *scale)) +
+                      *zero_point;
+    quantized[i] =
+        static_cast<int8_t>(std::min(kMaxInt4, std::max(kMinInt4, value)));
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s input.tflite|input.cc output.tflite|output.cc\n",
+            argv[0]);
+    return 1;
+  }
+  size_t input_size;
+  std::unique_ptr<tflite::ModelT> model =
+      model_file_util::ReadModelT(argv[1], &input_size);
+  if (model == nullptr) {
+    return 1;
+  }
+
+  size_t saved_bytes = 0;
+  for (const auto& subgraph : model->subgraphs) {
+    for (tflite::TensorT* tensor : model_file_util::FindFloatFilters(
+             *model, *subgraph, {tflite::BuiltinOperator_FULLY_CONNECTED})) {
+      std::vector<uint8_t>& data = model->buffers[tensor->buffer]->data;
+      const int count = static_cast<int>(data.size() / sizeof(float));
+      const int output_depth = tensor->shape.empty() ? 1 : tensor->shape[0];
+      if (output_depth <= 0 || count % output_depth != 0) {
+        printf("%s: kept as float, unexpected shape\n", tensor->name.c_str());
+        continue;
+      }
+      const int accum_depth = count / output_depth;
+      std::vector<float> weights(count);
+      memcpy(weights.data(), data.data(), count * sizeof(float));
+
+      std::unique_ptr<tflite::QuantizationParametersT> quantization(
+          new tflite::QuantizationParametersT);
+      quantization->quantized_dimension = 0;
+      std::vector<int8_t> quantized(count);
+      float max_error = 0.0f;
+      for (int c = 0; c < output_depth; ++c) {
+        float scale;
+        int zero_point;
+        QuantizeChannel(weights.data() + c * accum_depth, accum_depth, &scale,
+                        &zero_point, quantized.data() + c * accum_depth);
+        quantization->scale.push_back(scale);
+        quantization->zero_point.push_back(zero_point);
+        for (int d = 0; d < accum_depth; ++d) {
+          const int i = c * accum_depth + d;
+          max_error = std::max(
+              max_error,
+              std::abs(scale * (quantized[i] - zero_point) - weights[i]));
+        }
+      }
+
+      // Two values per byte, the one of even index in the low nibble.
+      data.assign((count + 1) / 2, 0);
+      for (int i = 0; i < count; ++i) {
+        data[i / 2] |= static_cast<uint8_t>((quantized[i] & 0x0f)
+                                            << (i % 2 == 0 ? 0 : 4));
+      }
+      tensor->type = tflite::TensorType_INT4;
+      tensor->quantization = std::move(quantization);
+      saved_bytes += count * sizeof(float) - data.size();
+      printf("%s: %d weights in %d channels, max quantization error %g\n",
+             tensor->name.c_str(), count, output_depth, max_error);
+    }
+  }
+
+  if (!model_file_util::WriteModelT(argv[2], *model, input_size)) {
+    return 1;
+  }
+  printf("%zu weight bytes saved\n", saved_bytes);
+  return 0;
+}